@@ -0,0 +1,82 @@
+/**
+ * @file adc_sampler.h
+ * @brief Timer-triggered, DMA-backed ADC acquisition with oversampling.
+ *
+ * ADC1 conversions are triggered by the TIM1 update event (PWM rate) and
+ * written by DMA into a circular buffer. Each half of the buffer is
+ * decimated in the DMA interrupt by averaging a configurable number of
+ * samples (16x..256x). The application only reads the latest averaged
+ * value and never waits for a conversion.
+ *
+ * The averaged result is kept with 4 extra fractional bits (Q4), which
+ * is where the additional effective resolution of oversampling lives.
+ *
+ * ADCS_ProcessBlock() does not touch any hardware and can be fed from a
+ * synthetic sample stream in a host build.
+ */
+
+#ifndef INC_ADC_SAMPLER_H_
+#define INC_ADC_SAMPLER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "config.h"
+
+/**
+ * Number of interleaved channels in one conversion sequence (scan mode,
+ * ranks 1..4 = IN0, IN3, IN10, IN13, see MX_ADC1_Init()): one per zone
+ * fitted.
+ */
+#define ADCS_NUM_CH          ZONE_ACTIVE_COUNT
+
+#define ADCS_OVERSAMPLE_MIN  16U
+#define ADCS_OVERSAMPLE_MAX  256U
+
+typedef struct {
+    uint16_t raw;     /**< Averaged value, 12-bit, rounded */
+    uint16_t raw_q4;  /**< Averaged value, 12.4 fixed point */
+    uint32_t seq;     /**< Incremented on every new averaged value, never 0 */
+} adcs_sample_t;
+
+/**
+ * @brief Reset the decimator.
+ * @param oversample Samples averaged per output, power of two in
+ *                   [ADCS_OVERSAMPLE_MIN, ADCS_OVERSAMPLE_MAX]. Other
+ *                   values are rounded down and clamped.
+ */
+void ADCS_Init(uint32_t oversample);
+
+/**
+ * @brief Start circular DMA acquisition on ADC1.
+ * @return true on success.
+ */
+bool ADCS_Start(void);
+
+/**
+ * @brief Feed interleaved samples into the decimator.
+ *
+ * Called from the DMA half/full transfer callbacks. @p count is the
+ * number of 16-bit samples and must be a multiple of ADCS_NUM_CH.
+ */
+void ADCS_ProcessBlock(const uint16_t *samples, uint32_t count);
+
+/**
+ * @brief Read the latest averaged value of a channel.
+ * @return false if no value has been produced yet.
+ */
+bool ADCS_GetLatest(uint8_t ch, adcs_sample_t *out);
+
+/**
+ * @brief Read the latest averaged values of all channels at once.
+ *
+ * All values come from the same decimation block.
+ * @param q4 Receives ADCS_NUM_CH values in 12.4 fixed point.
+ * @return Sequence number of the block, 0 if none has been produced yet.
+ *         It goes from 0xFFFFFFFF to 1 when it wraps, so 0 always means
+ *         no value.
+ */
+uint32_t ADCS_GetLatestAll(uint16_t q4[ADCS_NUM_CH]);
+
+uint32_t ADCS_GetOversample(void);
+
+#endif /* INC_ADC_SAMPLER_H_ */
@@ -0,0 +1,68 @@
+/**
+ * @file ambient.h
+ * @brief Ambient temperature estimate for the feed-forward of the zones.
+ *
+ * Two sources:
+ *
+ *  - fixed: a configured value (AMBIENT_FIXED_C, or Ambient_SetFixedC())
+ *  - MCU:   the internal temperature sensor of the STM32, converted with
+ *           the factory calibration (TS_CAL1 at 30 degC, TS_CAL2 at
+ *           110 degC), minus the self-heating of the die
+ *           (AMBIENT_MCU_OFFSET_C) and low-pass filtered
+ *
+ * The sensor is read as the single injected channel of ADC1, started by
+ * software from Ambient_Task(). An injected conversion suspends the
+ * regular zone scan for its duration (480 cycles sampling, ~14 us) and
+ * the scan resumes afterwards, well inside the 50 us TIM1 trigger
+ * period. The analog watchdog covers the regular channels only, so the
+ * sensor does not take part in the overtemperature cutoff.
+ *
+ * The sensor gives the temperature inside the enclosure, which is what
+ * the heated zones lose heat to when the board sits next to them. When
+ * it does not, configure the ambient instead.
+ */
+
+#ifndef INC_AMBIENT_H_
+#define INC_AMBIENT_H_
+
+#include <stdbool.h>
+
+typedef enum {
+    AMBIENT_SRC_FIXED = 0,
+    AMBIENT_SRC_MCU
+} ambient_src_t;
+
+/**
+ * @brief Configure the injected sensor channel and select the source
+ *        from config.h (AMBIENT_USE_MCU).
+ *
+ * Call after MX_ADC1_Init().
+ */
+void Ambient_Init(void);
+
+/**
+ * @brief Periodic task (AMBIENT_PERIOD_MS): take the result of the last
+ *        sensor conversion and start the next one.
+ */
+void Ambient_Task(void);
+
+/**
+ * @brief Current ambient estimate [degC].
+ *
+ * With the MCU source and no conversion done yet, the fixed value.
+ */
+float Ambient_GetC(void);
+
+/**
+ * @brief Use a fixed ambient temperature.
+ */
+void Ambient_SetFixedC(float t_c);
+
+/**
+ * @brief Switch between the fixed value and the MCU sensor.
+ */
+void Ambient_SetSource(ambient_src_t src);
+
+ambient_src_t Ambient_GetSource(void);
+
+#endif /* INC_AMBIENT_H_ */
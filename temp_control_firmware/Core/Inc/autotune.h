@@ -0,0 +1,96 @@
+/**
+ * @file autotune.h
+ * @brief Relay (Astrom-Hagglund) autotuner for the PI gains of a zone.
+ *
+ * While a session runs, the zone controller is held in manual mode and
+ * its output is a relay with hysteresis around the setpoint:
+ *
+ *   u = bias + d   while T_meas went below T_ref - h
+ *   u = bias - d   while T_meas went above T_ref + h
+ *
+ * The loop settles into a limit cycle. Every cycle gives the period Pu,
+ * the amplitude a of T_meas and the time from a relay switch to the
+ * following peak (the loop dead time L for a first-order-plus-dead-time
+ * plant). The bias follows the mean output of the last cycle, so the
+ * cycle becomes symmetric around the setpoint at the operating point.
+ *
+ * Once two consecutive cycles agree, the ultimate gain is taken from the
+ * describing function of the relay with hysteresis
+ *
+ *   Ku = 4 d / (pi * sqrt(a^2 - h^2))
+ *
+ * and the PI gains from the selected rule:
+ *
+ *   AT_RULE_ZN    Ziegler-Nichols   Kp = 0.45 Ku,  Ti = Pu / 1.2
+ *   AT_RULE_TL    Tyreus-Luyben     Kp = Ku / 3.2, Ti = 2.2 Pu
+ *   AT_RULE_SIMC  Skogestad SIMC on the FOPDT model fitted to Ku, Pu, L
+ *                 (tau_c = L):       Kp = tau / (2 K L), Ti = min(tau, 8 L)
+ *
+ * The gains are written to the zone table and applied without a bump:
+ * the last relay step holds the output at the bias and the controller
+ * goes back to automatic mode from there (PID_SetGains, PID_SetMode).
+ *
+ * Start a session with the loop settled near the setpoint: the bias
+ * starts at the current controller output. One session runs at a time.
+ * Control_Update() drives it, so it follows the control task rate.
+ */
+
+#ifndef INC_AUTOTUNE_H_
+#define INC_AUTOTUNE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    AT_RULE_ZN = 0,   /**< Ziegler-Nichols, fast, little damping */
+    AT_RULE_TL,       /**< Tyreus-Luyben, conservative */
+    AT_RULE_SIMC      /**< SIMC with tau_c = L */
+} at_rule_t;
+
+typedef enum {
+    AT_IDLE = 0,
+    AT_RUNNING,
+    AT_DONE,          /**< gains applied */
+    AT_FAILED,        /**< timeout or no usable limit cycle, gains unchanged */
+    AT_ABORTED        /**< stopped by command or alarm, gains unchanged */
+} at_state_t;
+
+typedef struct {
+    at_state_t state;
+    uint8_t    zone;
+    at_rule_t  rule;
+    uint8_t    cycles;   /**< limit cycles completed */
+    float      ku;       /**< ultimate gain [%/degC] */
+    float      pu_s;     /**< ultimate period [s] */
+    float      amp_c;    /**< limit cycle amplitude of T_meas [degC] */
+    float      dead_s;   /**< switch-to-peak time [s] */
+    float      kp;       /**< resulting gains */
+    float      ki;
+} at_result_t;
+
+/**
+ * @brief Start a session on @p zone.
+ * @return false if a session is already running or the zone is invalid.
+ */
+bool Autotune_Start(uint8_t zone, at_rule_t rule);
+
+/**
+ * @brief Stop the session on @p zone, keeping the previous gains.
+ */
+void Autotune_Abort(uint8_t zone);
+
+bool Autotune_IsRunning(uint8_t zone);
+
+/**
+ * @brief One relay step; call before the PID update of the zone.
+ *
+ * Does nothing unless a session runs on @p zone.
+ */
+void Autotune_Update(uint8_t zone, float ref_c, float meas_c);
+
+/**
+ * @brief State and measurements of the last session.
+ */
+const at_result_t *Autotune_GetResult(void);
+
+#endif /* INC_AUTOTUNE_H_ */
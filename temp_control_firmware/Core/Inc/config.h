@@ -5,11 +5,16 @@
  * This file contains configuration constants such as control range,
  * controller parameters and hardware-related settings. It separates
  * system configuration from application logic.
+ *
+ * The limits, gains, fan hysteresis, NTC constants and telemetry period
+ * are the defaults of run-time parameters (param.h), read and changed
+ * with LIST / GET / SET.
  */
 
 #pragma once
 
-// Control range
+// Control range; also the bounds of the sp, sp_min and sp_max parameters
+// (param.h), whose run-time limits can only be tighter
 #define T_SAFE_MIN_C   (30.0f)
 #define T_SAFE_MAX_C   (60.0f)
 
@@ -19,13 +24,84 @@
 
 #define T_SETPOINT_DEFAULT_C 35.0f
 
+// Fan request hysteresis, T_meas above T_ref [degC]
+#define FAN_ON_ABOVE_C       2.0f
+#define FAN_OFF_ABOVE_C      1.0f
+
+// Measurement filter of every zone (filter.h), parameters "filter" and
+// "filter_n" at run time
+#define TEMP_FILT_TYPE       1U    // filter_type_t: 0 none, 1 MA, 2 EMA, 3 median, 4 Kalman
+#define TEMP_FILT_N          9U    // length [samples], 1..16
+
+// Zones fitted (zone.h): zones 0 .. n-1, n = 1..4. The ADC scans only
+// their inputs, so the inputs of the others can be left open
+#define ZONE_ACTIVE_COUNT    4U
 
 // Sampling
-#define CONTROL_TS_S   0.1f   // 100 ms
+#define CONTROL_TS_S   (CONTROL_PERIOD_MS / 1000.0f)   // the control task period [s]
+
+// Scheduler task periods (TIM7 tick = 1 ms)
+#define CONTROL_PERIOD_MS    100U  // sets CONTROL_TS_S
+#define UART_TASK_PERIOD_MS  10U
+#define UI_TASK_PERIOD_MS    100U  // button and LED tasks
 
 // PI gains
 #define KP  0.7f
 #define KI  0.5f
+#define KD  0.0f
+
+// PID options
+#define PID_SP_WEIGHT_B  1.0f   // setpoint weight of the P term
+#define PID_TF_S         0.5f   // derivative filter time constant
+#define PID_TT_S         1.4f   // anti-windup tracking time if KI = 0 (else Ti = KP/KI)
+#define PID_RATE_MAX     0.0f   // output slope limit [%/s], 0 = off
+
+// Relay autotune (autotune.h)
+#define AUTOTUNE_RELAY_D     25.0f    // relay step around the bias [%]
+#define AUTOTUNE_RELAY_D_MIN 5.0f     // step kept near 0 % / 100 % bias
+#define AUTOTUNE_HYST_C      0.2f     // relay hysteresis, above the T_meas noise [degC]
+#define AUTOTUNE_TIMEOUT_S   1800.0f
+#define AUTOTUNE_MAX_CYCLES  20U
+
+// Online plant identification (ident.h)
+#define IDENT_DECIM          10U      // control steps per sample: Ts = 1 s
+#define IDENT_LAMBDA         0.98f    // RLS forgetting, memory ~50 samples
+#define IDENT_WARMUP_BLOCKS  60U      // samples before a model can be valid
+#define IDENT_CONF_RSD       0.1f     // max relative std of K and tau for valid
+#define IDENT_REF_RSD        0.03f    // max relative std to latch the drift reference
+#define IDENT_DRIFT_PCT      25.0f    // K / tau change against the reference [%]
+#define IDENT_DRIFT_HOLD_S   60.0f    // change must persist this long
+
+// Model-based feed-forward (control.c) and ambient estimate (ambient.h)
+#define FF_ENABLE_DEFAULT    0        // per zone at start-up, F<z>:<0|1> at run time
+#define FF_K_C_PER_PCT       0.5f     // plant gain while no identified model is valid [degC/%]
+#define FF_TAU_S             20.0f    // plant time constant, same [s]
+#define FF_TC_S              3.0f     // reference model time constant [s], <= 0: static duty only
+#define AMBIENT_USE_MCU      1        // 1: MCU temperature sensor, 0: AMBIENT_FIXED_C
+#define AMBIENT_FIXED_C      25.0f
+#define AMBIENT_MCU_OFFSET_C 5.0f     // die self-heating above the air around the board
+#define AMBIENT_PERIOD_MS    1000U    // sensor conversion / ambient task period
+
+// Smith predictor (smith.h), model set per zone with P<z>:<K>,<tau>,<L>
+#define SMITH_ENABLE_DEFAULT 0
+#define SMITH_K_C_PER_PCT    0.5f     // [degC/%]
+#define SMITH_TAU_S          20.0f    // [s]
+#define SMITH_DEAD_S         1.0f     // [s], up to SMITH_DELAY_MAX control steps
+#define SMITH_RESID_TAU_S    30.0f    // residual mean / RMS filter
+#define SMITH_RESID_MAX_C    0.5f     // residual RMS for a model mismatch [degC]
+#define SMITH_RESID_HOLD_S   30.0f    // ... held this long
+
+// Section profiling (perf.h), statistics read with PERF?
+#define PERF_ENABLE          1        // 0: PERF_BEGIN / PERF_END compile to nothing
+#define PERF_LOOP_BUDGET_US  1000U    // control task longer than this is an overrun
+
+// Event trace (trace.h), read with TRACE?
+#define TRACE_MASK_DEFAULT   0x01U    // TRACE_C_* classes recorded from reset
+#define TRACE_STOP_ON_ALARM  0        // 1: keep the history up to the first alarm
+
+// Settings saved in flash (settings.h, store.h)
+#define SETTINGS_PERIOD_MS   1000U
+#define SETTINGS_HOLD_MS     5000U    // a changed value is saved once stable this long
 
 
 // ADC / NTC parameters
@@ -35,8 +111,6 @@
 #define NTC_BETA       3950.0f
 #define NTC_R0         10000.0f
 #define NTC_T0_K       298.15f
-// POT
-#define T_SETPOINT_MIN_C  20.0f
-#define T_SETPOINT_MAX_C  60.0f
+#define ADC_OVERSAMPLE_RATIO 64U  // 16..256, power of two; 20 kHz / 64 = 312 Hz
 #define TELEMETRY_PERIOD_MS 10000U
 
@@ -9,13 +9,78 @@
 #ifndef INC_CONTROL_H_
 #define INC_CONTROL_H_
 #include <stdbool.h>
+#include <stdint.h>
+#include "pid.h"
+#include "smith.h"
 
 
 /**
- * @brief Compute PI controller output.
+ * @brief Compute PI controller output of a zone.
+ *
+ * While an autotune session runs on the zone, the output is its relay.
+ * @return Heater duty [%], 0 for an invalid zone.
+ */
+float Control_Update(uint8_t zone, float ref_c, float meas_c);
+
+/**
+ * @brief (Re)initialise the controller of a zone with the zone gains.
+ *
+ * Stops an autotune session running on the zone and restarts its plant
+ * identification.
+ */
+void Control_Init(uint8_t zone);
+
+/**
+ * @brief Restart the loop of a zone after an alarm.
+ *
+ * Stops an autotune session running on the zone and clears the
+ * controller state (integrator, derivative, output), so the heater
+ * restarts from 0 %. Unlike Control_Init(), the identified plant model
+ * and the Smith predictor are kept; Control_Hold() keeps them current
+ * while the alarm lasts.
+ */
+void Control_Reset(uint8_t zone);
+
+/**
+ * @brief Control step of a zone held off in alarm (heater at 0 %).
+ *
+ * Replaces Control_Update() for the step. With a usable measurement the
+ * plant identification and the Smith predictor are advanced with u = 0,
+ * so they continue without a gap when the alarm clears. Without one
+ * (ADC stalled, sample outside the alarm window, possibly a sensor
+ * fault) their history cannot be continued: the identification restarts
+ * (Ident_Init()) and the predictor delay line is refilled at 0 %.
+ */
+void Control_Hold(uint8_t zone, float meas_c, bool meas_ok);
+
+/**
+ * @brief Switch the model-based feed-forward of a zone on or off.
+ *
+ * The feed-forward is switched at the steady-state duty of the current
+ * setpoint and the integrator takes the difference, so switching with
+ * the loop settled does not step the output.
+ */
+void Control_SetFeedForward(uint8_t zone, bool enable);
+
+/**
+ * @brief Close the PI of a zone on the Smith predictor output (or not).
+ *
+ * The predictor model keeps running either way, so its residual can be
+ * checked before switching it in. With the loop settled the switch
+ * does not step the controller input.
+ */
+void Control_SetSmith(uint8_t zone, bool enable);
+
+/**
+ * @brief Replace the predictor model of a zone.
+ * @return false if the model is invalid or its dead time too long.
+ */
+bool Control_SetSmithModel(uint8_t zone, const smith_model_t *model);
+
+/**
+ * @brief Controller instance of a zone loop (gains, mode, state).
  */
-float Control_Update(float ref_c, float meas_c);
-void Control_Init(void);
+pid_ctrl_t *Control_GetPID(uint8_t zone);
 
 
 
@@ -0,0 +1,24 @@
+/**
+ * @file crc32.h
+ * @brief CRC-32 using the STM32 hardware CRC unit.
+ *
+ * The CRC peripheral is configured by MX_CRC_Init() with its defaults:
+ * polynomial 0x04C11DB7, initial value 0xFFFFFFFF, no bit reversal and
+ * no final XOR, byte-wise input. This is the CRC-32/MPEG-2 variant; PC
+ * side decoders must use the same parameters.
+ */
+
+#ifndef INC_CRC32_H_
+#define INC_CRC32_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief CRC-32/MPEG-2 of a byte buffer.
+ *
+ * Not reentrant (single hardware unit); call from thread mode only.
+ */
+uint32_t CRC32_Compute(const void *data, size_t len);
+
+#endif /* INC_CRC32_H_ */
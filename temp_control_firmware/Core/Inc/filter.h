@@ -0,0 +1,90 @@
+/**
+ * @file filter.h
+ * @brief Measurement filters with per-instance state.
+ *
+ * Every filter is a filter_t object owned by the caller, so any number
+ * of channels can be filtered independently and the filter type of a
+ * channel can be changed at run time by re-initialising its object.
+ *
+ * Available filters:
+ *  - FILTER_MA     : moving average of N samples (running sum, O(1))
+ *  - FILTER_EMA    : exponential moving average, y += alpha * (x - y)
+ *  - FILTER_MEDIAN : median of the last N samples (N odd), rejects spikes
+ *  - FILTER_KALMAN : 1-D Kalman filter for a random-walk signal
+ *
+ * Filter_GroupDelay() reports the low-frequency group delay of the
+ * configured filter in samples, which the control loop sees as extra
+ * dead time.
+ */
+
+#ifndef INC_FILTER_H_
+#define INC_FILTER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define FILTER_MA_MAX_N      16U
+#define FILTER_MEDIAN_MAX_N  9U
+
+typedef enum {
+    FILTER_NONE = 0,
+    FILTER_MA,
+    FILTER_EMA,
+    FILTER_MEDIAN,
+    FILTER_KALMAN
+} filter_type_t;
+
+typedef struct {
+    filter_type_t type;
+    union {
+        struct {
+            float   buf[FILTER_MA_MAX_N];
+            float   sum;
+            uint8_t n;
+            uint8_t idx;
+            uint8_t filled;
+        } ma;
+        struct {
+            float alpha;
+            float y;
+            bool  init;
+        } ema;
+        struct {
+            float   buf[FILTER_MEDIAN_MAX_N];     /* arrival order */
+            float   sorted[FILTER_MEDIAN_MAX_N];  /* ascending */
+            uint8_t n;
+            uint8_t idx;
+            uint8_t filled;
+        } med;
+        struct {
+            float q;  /* process noise variance per sample */
+            float r;  /* measurement noise variance */
+            float x;
+            float p;
+            bool  init;
+        } kf;
+    } s;
+} filter_t;
+
+void Filter_InitNone(filter_t *f);
+void Filter_InitMA(filter_t *f, uint8_t n);
+void Filter_InitEMA(filter_t *f, float alpha);
+void Filter_InitMedian(filter_t *f, uint8_t n);
+void Filter_InitKalman(filter_t *f, float q, float r);
+
+/**
+ * @brief Clear the filter history, keeping type and parameters.
+ */
+void Filter_Reset(filter_t *f);
+
+/**
+ * @brief Push one sample and return the filtered value.
+ */
+float Filter_Update(filter_t *f, float x);
+
+/**
+ * @brief Group delay of the filter in samples (steady state).
+ */
+float Filter_GroupDelay(const filter_t *f);
+
+#endif /* INC_FILTER_H_ */
@@ -0,0 +1,41 @@
+/**
+ * @file fmt.h
+ * @brief Allocation-free number formatting.
+ *
+ * Replacement for snprintf("%.Nf") / ("%lu") on the telemetry path.
+ * Floats are converted from their exact binary value using integer
+ * arithmetic only (no double promotion, no libm), rounded half to even
+ * like newlib and glibc printf, so the output is byte-identical to
+ * snprintf for the same precision.
+ */
+
+#ifndef INC_FMT_H_
+#define INC_FMT_H_
+
+#include <stdint.h>
+
+#define FMT_MAX_DECIMALS  6U
+
+/** Buffer size that fits any value: sign, 39 digits, point, decimals. */
+#define FMT_FLOAT_MAX     (1U + 39U + 1U + FMT_MAX_DECIMALS)
+#define FMT_UINT_MAX      10U
+#define FMT_INT_MAX       11U
+
+/**
+ * @brief Format @p v like "%.<decimals>f".
+ * @param dst  output, at least FMT_FLOAT_MAX bytes; not NUL terminated
+ * @return Number of characters written.
+ */
+uint8_t FMT_Float(char *dst, float v, uint8_t decimals);
+
+/**
+ * @brief Format @p v like "%lu" (at least FMT_UINT_MAX bytes).
+ */
+uint8_t FMT_Uint(char *dst, uint32_t v);
+
+/**
+ * @brief Format @p v like "%ld" (at least FMT_INT_MAX bytes).
+ */
+uint8_t FMT_Int(char *dst, int32_t v);
+
+#endif /* INC_FMT_H_ */
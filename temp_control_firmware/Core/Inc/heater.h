@@ -9,9 +9,15 @@
 #ifndef INC_HEATER_H_
 #define INC_HEATER_H_
 
+#include <stdint.h>
+
 /**
- * @brief Set heater PWM duty cycle.
+ * @brief Start the PWM outputs of all zones at 0 %.
  */
 void Heater_Init(void);
-void Heater_SetDutyPercent(float duty);
+
+/**
+ * @brief Set heater PWM duty cycle of a zone.
+ */
+void Heater_SetDutyPercent(uint8_t zone, float duty);
 #endif /* INC_HEATER_H_ */
@@ -0,0 +1,112 @@
+/**
+ * @file ident.h
+ * @brief Online first-order-plus-dead-time plant identification (RLS).
+ *
+ * Each ident_t instance fits, for one zone,
+ *
+ *   y[i] = a * y[i-1] + b * (u[i-d] + u[i-1-d]) / 2 + c
+ *
+ * to block means of T_meas (y) and heater duty (u) over IDENT_DECIM
+ * control steps, with recursive least squares and exponential forgetting
+ * (IDENT_LAMBDA). One estimator runs per dead time candidate
+ * d = 0..IDENT_NDELAY-1; the one with the smallest prediction error is
+ * reported. The continuous model follows from the winner:
+ *
+ *   K = b / (1 - a)           [degC/%]
+ *   tau = -Ts / ln(a)         [s]
+ *   L = d * Ts                [s]
+ *   T_amb = y0 + c / (1 - a)  [degC]
+ *
+ * with Ts = IDENT_DECIM * CONTROL_TS_S and the regression taken about
+ * the first block mean y0.
+ *
+ * Confidence is the relative standard deviation of K and tau, from the
+ * prediction error variance and the RLS covariance (sigma^2 * P, first
+ * order error propagation). Without excitation the covariance grows and
+ * the model drops out of "valid".
+ *
+ * Drift: the first model better than IDENT_REF_RSD is latched as
+ * reference. When K or tau
+ * stay more than IDENT_DRIFT_PCT (and three standard deviations) away
+ * from the reference for
+ * IDENT_DRIFT_HOLD_S, the matching drift flag is set (a degrading heater
+ * lowers K, a changed thermal load moves tau). Ident_Rebase() takes the
+ * current model as the new reference. Ident_Init() forgets everything,
+ * reference included.
+ *
+ * Cost: the control step only accumulates the block sums. Of the block
+ * work, one 3x3 RLS update runs per control step (candidate j in step j
+ * of the next block) and the model is derived in step IDENT_NDELAY, so
+ * no control step carries more than one update.
+ */
+
+#ifndef INC_IDENT_H_
+#define INC_IDENT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define IDENT_NDELAY  4U   /**< dead time candidates, 0..3 samples */
+#define IDENT_NPAR    3U
+
+/* Status flags */
+#define IDENT_VALID        0x01U   /**< enough data and confidence */
+#define IDENT_DRIFT_GAIN   0x02U   /**< K moved away from the reference */
+#define IDENT_DRIFT_TAU    0x04U   /**< tau moved away from the reference */
+
+typedef struct {
+    float k_c_per_pct;   /**< static gain [degC/%] */
+    float tau_s;         /**< time constant [s] */
+    float dead_s;        /**< dead time [s] */
+    float ambient_c;     /**< temperature at zero duty [degC] */
+    float k_rsd;         /**< relative standard deviation of K */
+    float tau_rsd;       /**< relative standard deviation of tau */
+    uint8_t flags;       /**< IDENT_VALID | IDENT_DRIFT_* */
+} ident_model_t;
+
+typedef struct {
+    float theta[IDENT_NPAR];              /**< a, b, c */
+    float P[IDENT_NPAR][IDENT_NPAR];
+    float err_var;                        /**< prediction error variance, filtered */
+} ident_rls_t;
+
+typedef struct {
+    ident_rls_t   rls[IDENT_NDELAY];
+
+    /* Block means */
+    float         u_acc, y_acc;
+    uint8_t       n_acc;
+    uint8_t       step;                   /**< control step within the block */
+    float         y_base;                 /**< first sample, regression origin */
+    float         u_hist[IDENT_NDELAY + 1U]; /**< u[i], u[i-1], ... */
+    float         y_prev;                 /**< y[i-1] */
+    float         y_last;                 /**< y[i] */
+    uint32_t      blocks;
+
+    ident_model_t model;
+    ident_model_t ref;                    /**< drift reference */
+    bool          has_ref;
+    uint16_t      drift_gain_n;           /**< blocks the deviation persisted */
+    uint16_t      drift_tau_n;
+} ident_t;
+
+void Ident_Init(ident_t *id);
+
+/**
+ * @brief Feed one control step: applied duty and measured temperature.
+ */
+void Ident_Update(ident_t *id, float u_pct, float y_c);
+
+/**
+ * @brief Latest model (updated once per block).
+ */
+const ident_model_t *Ident_GetModel(const ident_t *id);
+
+/**
+ * @brief Use the current model as drift reference and clear the flags.
+ * @return false if the current model is not valid (the reference is
+ *         then latched automatically once the model is good enough).
+ */
+bool Ident_Rebase(ident_t *id);
+
+#endif /* INC_IDENT_H_ */
@@ -0,0 +1,50 @@
+/**
+ * @file json_build.h
+ * @brief Flat JSON object builder for telemetry frames.
+ *
+ * Writes {"key":value,...}\r\n into a caller-provided buffer using the
+ * formatters from fmt.h. Keys and string values are emitted verbatim (no
+ * escaping), which is fine for the fixed names used by the firmware.
+ *
+ * On overflow the builder stops writing and JSONB_End() returns 0, so a
+ * truncated frame is never sent.
+ */
+
+#ifndef INC_JSON_BUILD_H_
+#define INC_JSON_BUILD_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    char     *buf;
+    uint16_t  cap;
+    uint16_t  len;
+    bool      first;
+    bool      overflow;
+} jsonb_t;
+
+void JSONB_Begin(jsonb_t *jb, char *buf, uint16_t cap);
+
+/** "key":v formatted like "%.<decimals>f" */
+void JSONB_AddFloat(jsonb_t *jb, const char *key, float v, uint8_t decimals);
+void JSONB_AddUint(jsonb_t *jb, const char *key, uint32_t v);
+void JSONB_AddInt(jsonb_t *jb, const char *key, int32_t v);
+
+/** "key":"v", v is emitted verbatim like the keys */
+void JSONB_AddStr(jsonb_t *jb, const char *key, const char *v);
+
+/** "key":[v0,v1,...] */
+void JSONB_AddUintArray(jsonb_t *jb, const char *key, const uint32_t *v, uint16_t n);
+
+/** "key":[v0,v1,...], each like JSONB_AddFloat() */
+void JSONB_AddFloatArray(jsonb_t *jb, const char *key, const float *v, uint16_t n,
+                         uint8_t decimals);
+
+/**
+ * @brief Close the object and append CR LF.
+ * @return Frame length, 0 on overflow.
+ */
+uint16_t JSONB_End(jsonb_t *jb);
+
+#endif /* INC_JSON_BUILD_H_ */
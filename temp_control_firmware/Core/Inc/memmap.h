@@ -0,0 +1,56 @@
+/**
+ * @file memmap.h
+ * @brief Memory placement of hot code and data, MPU and caches.
+ *
+ * Memory map (STM32F746ZGTX_FLASH.ld):
+ *
+ *   region   address      size  use
+ *   flash    0x08000000   32K   vector table (sector 0)
+ *            0x08008000   64K   parameter store (sectors 1-2, store.h)
+ *            0x08018000  928K   code, constants, initial data
+ *   ITCM     0x00000000   16K   ITCM_CODE: control step and ISR path
+ *   DTCM     0x20000000   64K   DTCM_DATA: their state
+ *   SRAM1    0x20010000  240K   everything else (.data, .bss, heap), and
+ *                               the stack at its top (_estack), cached
+ *   SRAM2    0x2004C000   16K   ETH descriptors and DMA_BUFFER, not cached
+ *
+ * The TCMs run at core speed without wait states and bypass the L1
+ * caches; code in ITCM does not compete with the rest of the firmware for
+ * the I-cache, nor data in DTCM for the D-cache. Both are copied from
+ * flash at reset (startup_stm32f746zgtx.s), like .data. Calls between
+ * ITCM and flash are out of BL range and go through linker veneers.
+ *
+ * With the D-cache on, memory written by a DMA must not be cached, or the
+ * CPU reads stale lines and the DMA misses writes still in the cache.
+ * Every DMA buffer is therefore placed with DMA_BUFFER in SRAM2, which
+ * the MPU maps as normal non-cacheable memory. The ETH descriptors at its
+ * start are mapped as shared device memory, as the ETH DMA requires.
+ *
+ * In the host build (HOST_BUILD) the placement macros are empty.
+ *
+ * To compare the control step with and without this layout, read the
+ * section times with PERF? (perf.h) or stream the exec_us field
+ * (tlm_stream.h) on the target.
+ */
+
+#ifndef INC_MEMMAP_H_
+#define INC_MEMMAP_H_
+
+#ifdef HOST_BUILD
+#define ITCM_CODE
+#define DTCM_DATA
+#define DMA_BUFFER
+#else
+#define ITCM_CODE   __attribute__((section(".itcm_text")))
+#define DTCM_DATA   __attribute__((section(".dtcm_data")))
+#define DMA_BUFFER  __attribute__((section(".dma_buffer"), aligned(32)))
+#endif
+
+/**
+ * @brief Configure the MPU regions and enable the I- and D-cache.
+ *
+ * Call first in main(), before any DMA is started.
+ */
+void MemMap_Init(void);
+
+#endif /* INC_MEMMAP_H_ */
@@ -0,0 +1,21 @@
+/**
+ * @file ntc_lut.h
+ * @brief NTC ADC-to-temperature lookup table.
+ *
+ * The table is generated at build time by tools/gen_ntc_lut.py from the
+ * NTC constants in config.h. Entry i is the temperature in degC at ADC
+ * code (i << NTC_LUT_SHIFT); values in between are interpolated linearly.
+ *
+ * NTC_LUT_SHIFT selects the table density. Smaller values give a larger
+ * and more accurate table, see the generator's --check option.
+ */
+
+#ifndef INC_NTC_LUT_H_
+#define INC_NTC_LUT_H_
+
+#define NTC_LUT_SHIFT  5
+#define NTC_LUT_SIZE   ((4096 >> NTC_LUT_SHIFT) + 1)
+
+extern const float ntc_lut_c[NTC_LUT_SIZE];
+
+#endif /* INC_NTC_LUT_H_ */
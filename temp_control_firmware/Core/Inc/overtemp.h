@@ -0,0 +1,83 @@
+/**
+ * @file overtemp.h
+ * @brief Hardware overtemperature cutoff (ADC analog watchdog + TIM1 break).
+ *
+ * The ADC1 analog watchdog compares every regular conversion against raw
+ * thresholds equivalent to T_ALARM_MIN_C / T_ALARM_MAX_C. The scan holds
+ * the inputs of the zones fitted only (ZONE_ACTIVE_COUNT, zone.h), so an
+ * unused, open input does not trip it.
+ * The NTC sits in the lower leg of the divider (v / Vref = r_ntc /
+ * (R_FIXED + r_ntc)) and its resistance falls with temperature, so a
+ * high temperature gives a low code: T_ALARM_MAX_C sets the low
+ * threshold and T_ALARM_MIN_C the high one. An open or shorted sensor is
+ * outside the window as well.
+ *
+ * On a violation the watchdog interrupt generates a TIM1 break by
+ * software, which clears MOE and drives all heater outputs to their idle
+ * (off) level within one conversion plus the interrupt latency, without
+ * waiting for the control task. MOE is common to the four TIM1 channels,
+ * so a fault in one zone cuts every zone. The trip is latched; the control task
+ * polls it and keeps the heater off until OverTemp_Rearm().
+ *
+ * No interrupt runs while a flash sector is erased (store.h): the vector
+ * table and the interrupt handlers are in flash. The store therefore
+ * holds the outputs off for every erase (OverTemp_HoldOutputs()). The
+ * ADC keeps converting meanwhile and latches a violation in its AWD flag;
+ * the interrupt is taken, and the trip latched, when the erase ends,
+ * before the outputs are released.
+ */
+
+#ifndef INC_OVERTEMP_H_
+#define INC_OVERTEMP_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Program the watchdog thresholds and enable its interrupt.
+ */
+void OverTemp_Init(void);
+
+/**
+ * @brief Recompute the thresholds after the NTC constants changed
+ *        (Temperature_SetNtc()), without touching a latched trip.
+ */
+void OverTemp_Update(void);
+
+/**
+ * @brief True once the watchdog has cut the heater output.
+ */
+bool OverTemp_IsTripped(void);
+
+/**
+ * @brief ADC code that caused the last trip.
+ */
+uint16_t OverTemp_GetTripRaw(void);
+
+/**
+ * @brief Watchdog thresholds in ADC codes.
+ */
+void OverTemp_GetThresholds(uint16_t *low, uint16_t *high);
+
+/**
+ * @brief Cut the heater outputs (clear MOE) ahead of a flash erase.
+ *
+ * Thread mode only, paired with OverTemp_ReleaseOutputs().
+ */
+void OverTemp_HoldOutputs(void);
+
+/**
+ * @brief End the hold: the outputs resume at their duty if they were on
+ *        before it and the watchdog has not tripped meanwhile.
+ */
+void OverTemp_ReleaseOutputs(void);
+
+/**
+ * @brief Clear the trip and re-enable the heater outputs.
+ * @param raw Current 12-bit ADC codes of the zone sensors.
+ * @param n   Number of codes in @p raw.
+ * @return false (still latched) if any code is outside the window.
+ */
+bool OverTemp_Rearm(const uint16_t *raw, uint8_t n);
+
+#endif /* INC_OVERTEMP_H_ */
@@ -0,0 +1,135 @@
+/**
+ * @file param.h
+ * @brief Registry of the run-time tunable parameters.
+ *
+ * Every tunable has a descriptor: name, unit, value type, range, default
+ * and flags. Parameters are addressed by id (param_id_t, the index into
+ * the descriptor table) or by name through a hash index built by
+ * Param_Init(). Both ids and names are part of the UART protocol (GET,
+ * SET, LIST in uart_if.c) and must not change.
+ *
+ * Values are exchanged as float; a PARAM_T_U32 parameter only takes whole
+ * numbers. A PARAM_F_ZONE parameter has one value per zone.
+ *
+ * Param_Set() validates a value and stages it. Staged values are applied
+ * together by Param_Apply() at the start of the next control step, so a
+ * step never sees part of a change (e.g. the new Kp with the old Ki, or
+ * a half rebuilt NTC table). A second Param_Set() of the same parameter before
+ * that replaces the staged one.
+ *
+ * Setpoints and alarm limits can only be set inside the compile-time
+ * range of config.h: the hardware cutoff (overtemp.h) stays at
+ * T_ALARM_MIN_C / T_ALARM_MAX_C, run-time alarm limits can only be
+ * tighter. CONTROL_TS_S is listed read-only: the control period is fixed
+ * by the scheduler and by the discretised filters and models.
+ *
+ * The measurement filter of a zone is chosen by filter (filter_type_t)
+ * and filter_n (its length, see Temperature_SetFilter()); a change
+ * clears the filter history. filter_delay reports the group delay of the
+ * filter in use, the dead time it adds to the loop.
+ */
+
+#ifndef INC_PARAM_H_
+#define INC_PARAM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PARAM_F_ZONE     0x01U   /**< one value per zone */
+#define PARAM_F_RO       0x02U   /**< read only */
+#define PARAM_F_PERSIST  0x04U   /**< saved in flash (settings.h) */
+
+typedef enum {
+    PARAM_T_F32 = 0,
+    PARAM_T_U32
+} param_type_t;
+
+typedef enum {
+    PARAM_SP_MIN = 0,
+    PARAM_SP_MAX,
+    PARAM_ALARM_MIN,
+    PARAM_ALARM_MAX,
+    PARAM_SP,            /**< after the limits: applied within them */
+    PARAM_KP,
+    PARAM_KI,
+    PARAM_FAN_ON,
+    PARAM_FAN_OFF,
+    PARAM_NTC_BETA,
+    PARAM_NTC_R0,
+    PARAM_NTC_T0,
+    PARAM_R_FIXED,
+    PARAM_TLM_PERIOD,
+    PARAM_CONTROL_TS,
+    PARAM_FILTER,        /**< filter_type_t of the measurement filter */
+    PARAM_FILTER_N,
+    PARAM_FILTER_DELAY,  /**< read only, Filter_GroupDelay() [s] */
+    PARAM_COUNT
+} param_id_t;
+
+typedef struct {
+    const char *name;
+    const char *unit;
+    uint8_t     type;    /**< param_type_t */
+    uint8_t     flags;   /**< PARAM_F_* */
+    uint8_t     key;     /**< store key, of zone 0 for PARAM_F_ZONE */
+    float       min;
+    float       max;
+    float       def;
+} param_desc_t;
+
+/** Build the name index. Call once at boot, before the other functions. */
+void Param_Init(void);
+
+/** Descriptor of a parameter, NULL for an invalid id. */
+const param_desc_t *Param_Desc(param_id_t id);
+
+/**
+ * @brief Id of a parameter by name.
+ * @param len Length of @p name, which need not be terminated.
+ * @return Id, or -1 if there is no such parameter.
+ */
+int Param_Find(const char *name, size_t len);
+
+/** Values per parameter: ZONE_COUNT for PARAM_F_ZONE, else 1. */
+uint8_t Param_Count(param_id_t id);
+
+/**
+ * @brief Current value (not a staged one).
+ * @return false for an invalid id or zone.
+ */
+bool Param_Get(param_id_t id, uint8_t zone, float *value);
+
+/**
+ * @brief Validate a value and stage it for the next Param_Apply().
+ *
+ * Refused if the parameter is read only, the value is out of range or
+ * not whole for PARAM_T_U32, or if it contradicts a related value
+ * (setpoint inside the zone's limits, each lower limit below its upper
+ * one), taking the staged values into account.
+ */
+bool Param_Set(param_id_t id, uint8_t zone, float value);
+
+/** Stage the default of every writable parameter. */
+void Param_SetDefaults(void);
+
+/** Apply the staged values. Called at the start of the control step. */
+void Param_Apply(void);
+
+/**
+ * @brief Stage a saved value at boot, without the checks against related
+ *        values (they are loaded one at a time).
+ *
+ * After the last one call Param_CheckLimits(), then Param_Apply().
+ */
+bool Param_Load(param_id_t id, uint8_t zone, float value);
+
+/**
+ * @brief Stage the defaults of pairs of limits that contradict each other.
+ *
+ * Values saved one at a time can do so after a power loss between two
+ * saves.
+ */
+void Param_CheckLimits(void);
+
+#endif /* INC_PARAM_H_ */
@@ -0,0 +1,120 @@
+/**
+ * @file perf.h
+ * @brief Execution time profiling of the main loop sections.
+ *
+ * A section is timed between PERF_BEGIN() and PERF_END() with the DWT
+ * cycle counter (CYCCNT) of the Cortex-M7. Every section keeps its count,
+ * minimum, maximum and mean, and a log2 histogram:
+ *
+ *   bin 0                      t < 2^(PERF_HIST_SHIFT + 1)
+ *   bin k                      2^(k + PERF_HIST_SHIFT) <= t < 2^(k + PERF_HIST_SHIFT + 1)
+ *   bin PERF_HIST_BINS - 1     t >= 2^(PERF_HIST_BINS - 1 + PERF_HIST_SHIFT)
+ *
+ * The control task also marks its start with PERF_LOOP_MARK(): the
+ * deviation of its period from CONTROL_PERIOD_MS is the loop jitter, and
+ * a PERF_LOOP section longer than PERF_LOOP_BUDGET_US is an overrun.
+ *
+ * Times are in counter ticks of Perf_GetHz(): core clock cycles on the
+ * target. The counter wraps after 2^32 ticks, 2^32 / Perf_GetHz() seconds
+ * (about 59.6 s at the 72 MHz SYSCLK of SystemClock_Config()); longer
+ * sections are not measured correctly.
+ *
+ * With PERF_ENABLE 0 (config.h) the macros expand to nothing and the
+ * statistics stay empty. In the host build (HOST_BUILD) the counter is
+ * CLOCK_MONOTONIC in nanoseconds, so host programs can time the firmware
+ * code with the same sections.
+ *
+ * The statistics are updated without locking: time sections of the main
+ * loop only, not of interrupt handlers.
+ */
+
+#ifndef INC_PERF_H_
+#define INC_PERF_H_
+
+#include "config.h"
+
+#include <stdint.h>
+
+#ifndef HOST_BUILD
+#include "main.h"
+#endif
+
+#define PERF_HIST_BINS   12U    /**< histogram bins */
+#define PERF_HIST_SHIFT  8U     /**< log2 of the first bin edge, 256 ticks */
+
+typedef enum {
+    PERF_ADC = 0,     /**< ADC snapshot */
+    PERF_FILTER,      /**< NTC conversion and filter of all zones */
+    PERF_CONTROL,     /**< profile, controller, heater and fan of all zones */
+    PERF_UART,        /**< command handling */
+    PERF_TLM,         /**< telemetry frames and the stream */
+    PERF_LOOP,        /**< the whole control task */
+    PERF_SEC_COUNT
+} perf_sec_t;
+
+typedef struct {
+    uint32_t n;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t hist[PERF_HIST_BINS];
+} perf_stat_t;
+
+typedef struct {
+    uint32_t n;             /**< periods measured */
+    int32_t  jitter_min;    /**< shortest period - nominal [ticks] */
+    int32_t  jitter_max;    /**< longest period - nominal [ticks] */
+    uint32_t overruns;      /**< PERF_LOOP sections over budget */
+} perf_loop_t;
+
+#if PERF_ENABLE
+#define PERF_BEGIN(sec)   uint32_t perf_t0_##sec = Perf_Now()
+#define PERF_END(sec)     Perf_Record((sec), Perf_Now() - perf_t0_##sec)
+#define PERF_LOOP_MARK()  Perf_LoopMark()
+#else
+#define PERF_BEGIN(sec)   do { } while (0)
+#define PERF_END(sec)     do { } while (0)
+#define PERF_LOOP_MARK()  do { } while (0)
+#endif
+
+#ifdef HOST_BUILD
+uint32_t Perf_Now(void);
+#else
+static inline uint32_t Perf_Now(void)
+{
+    return DWT->CYCCNT;
+}
+#endif
+
+/**
+ * @brief Start the cycle counter and clear the statistics.
+ *
+ * Call after SystemClock_Config(), the tick rate is taken from
+ * SystemCoreClock.
+ */
+void Perf_Init(void);
+
+/** Clear the statistics. */
+void Perf_Reset(void);
+
+/** Add one execution of a section. */
+void Perf_Record(perf_sec_t sec, uint32_t ticks);
+
+/** Start of a control task: period and jitter. */
+void Perf_LoopMark(void);
+
+const perf_stat_t *Perf_GetStat(perf_sec_t sec);
+const perf_loop_t *Perf_GetLoop(void);
+
+/** Mean of a section [ticks], 0 before the first execution. */
+uint32_t Perf_GetMean(perf_sec_t sec);
+
+/** Counter rate [Hz]. */
+uint32_t Perf_GetHz(void);
+
+float Perf_ToUs(uint32_t ticks);
+
+/** Short lower-case name of a section, "?" if out of range. */
+const char *Perf_SectionName(perf_sec_t sec);
+
+#endif /* INC_PERF_H_ */
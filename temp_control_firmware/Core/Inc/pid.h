@@ -0,0 +1,101 @@
+/**
+ * @file pid.h
+ * @brief Reusable discrete PID controller object.
+ *
+ * Each controller is a pid_ctrl_t instance, so several loops (zones) can
+ * run side by side without sharing state.
+ *
+ * Features:
+ *  - setpoint weighting of the proportional (b) and derivative (c) terms
+ *  - derivative term low-pass filtered with time constant tf_s
+ *  - back-calculation anti-windup with tracking time tt_s
+ *    (tt_s <= 0 falls back to conditional integration / clamping)
+ *  - output limits and output rate limit
+ *  - bumpless manual/auto transfer and bumpless gain changes
+ *  - additive feed-forward term, included before saturation so the
+ *    anti-windup sees the combined output
+ *
+ * The integrator is kept in output units (percent), which is what makes
+ * bumpless transfer a simple adjustment of the integrator state.
+ */
+
+#ifndef INC_PID_H_
+#define INC_PID_H_
+
+#include <stdbool.h>
+
+typedef struct {
+    float kp;        /**< proportional gain [%/degC] */
+    float ki;        /**< integral gain [%/(degC*s)] */
+    float kd;        /**< derivative gain [%*s/degC] */
+    float ts_s;      /**< sample time [s] */
+    float b;         /**< setpoint weight, proportional term */
+    float c;         /**< setpoint weight, derivative term */
+    float tf_s;      /**< derivative filter time constant [s] */
+    float tt_s;      /**< anti-windup tracking time [s], <= 0: clamping */
+    float out_min;   /**< output lower limit [%] */
+    float out_max;   /**< output upper limit [%] */
+    float rate_max;  /**< max output slope [%/s], <= 0: unlimited */
+} pid_params_t;
+
+typedef enum {
+    PID_MODE_AUTO = 0,
+    PID_MODE_MANUAL
+} pid_mode_t;
+
+typedef struct {
+    pid_params_t p;
+    pid_mode_t   mode;
+    float        i_term;  /**< integral part of the output [%] */
+    float        d_term;  /**< filtered derivative part of the output [%] */
+    float        prev_y;  /**< previous derivative input c*ref - meas */
+    float        last_ep; /**< last proportional input b*ref - meas */
+    float        u;       /**< last output [%] */
+    float        u_man;   /**< manual output [%] */
+    float        ff;      /**< feed-forward part of the output [%] */
+    bool         started;
+} pid_ctrl_t;
+
+void PID_Init(pid_ctrl_t *pid, const pid_params_t *params);
+
+/**
+ * @brief Clear integrator, derivative and output history.
+ */
+void PID_Reset(pid_ctrl_t *pid);
+
+/**
+ * @brief Run one controller step.
+ * @return Output after saturation and rate limiting.
+ */
+float PID_Update(pid_ctrl_t *pid, float ref, float meas);
+
+/**
+ * @brief Change gains without a step in the output.
+ */
+void PID_SetGains(pid_ctrl_t *pid, float kp, float ki, float kd);
+
+/**
+ * @brief Switch between manual and automatic mode without a bump.
+ */
+void PID_SetMode(pid_ctrl_t *pid, pid_mode_t mode);
+
+/**
+ * @brief Set the output used in manual mode.
+ */
+void PID_SetManual(pid_ctrl_t *pid, float u);
+
+/**
+ * @brief Set the feed-forward term added to the output from the next step.
+ *
+ * A change acts on the output directly (that is its purpose). To switch
+ * feed-forward on or off without a bump, use PID_SetFeedForwardBumpless().
+ */
+void PID_SetFeedForward(pid_ctrl_t *pid, float u_ff);
+
+/**
+ * @brief Change the feed-forward term, moving the difference into the
+ *        integrator so that the output does not step.
+ */
+void PID_SetFeedForwardBumpless(pid_ctrl_t *pid, float u_ff);
+
+#endif /* INC_PID_H_ */
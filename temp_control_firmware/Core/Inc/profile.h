@@ -0,0 +1,103 @@
+/**
+ * @file profile.h
+ * @brief Setpoint profiles: ramps, soaks and repeated sequences.
+ *
+ * A profile is a list of up to PROFILE_MAX_SEG segments per zone. Each
+ * segment moves the setpoint from where it is to its target at a given
+ * rate (0 = at once), then holds the target for its hold time:
+ *
+ *   T_ref
+ *     |          ______ hold           target, hold
+ *     |         /
+ *     |        / rate
+ *     |  _____/
+ *     +------------------ t
+ *
+ * A segment with repeat > 0 jumps back to segment loop_to after its hold,
+ * repeat times, then continues with the next one; loops can be nested.
+ * After the last segment the setpoint stays at its target.
+ *
+ * Profile_Update() runs once per control step, before the controller,
+ * and writes the interpolated setpoint through Setpoint_SetC(), so the
+ * zone limits apply as for any other source. The hold counts from the
+ * step the target is reached, in control steps.
+ *
+ * The setpoint staircase of the simulations (sim/temp_setpoint_staircase)
+ * is the profile of sim/temp_setpoint_staircase_profile.csv: seven
+ * segments with rate 0 and a 40 s hold.
+ */
+
+#ifndef INC_PROFILE_H_
+#define INC_PROFILE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PROFILE_MAX_SEG  16U    /**< segments per zone */
+
+typedef enum {
+    PROFILE_IDLE = 0,    /**< not started, or stopped */
+    PROFILE_RUNNING,
+    PROFILE_PAUSED,      /**< setpoint and segment time frozen */
+    PROFILE_DONE         /**< last segment completed */
+} profile_state_t;
+
+typedef struct {
+    float   rate_c_per_s;   /**< ramp rate [degC/s], 0 = step */
+    float   target_c;
+    float   hold_s;         /**< soak at the target [s] */
+    uint8_t loop_to;        /**< segment to go back to after the hold */
+    uint8_t repeat;         /**< times to go back, 0 = no loop */
+} profile_seg_t;
+
+typedef struct {
+    profile_seg_t seg[PROFILE_MAX_SEG];
+    uint8_t  loops[PROFILE_MAX_SEG];   /**< jumps taken by each segment */
+    uint8_t  n;                        /**< segments loaded */
+    uint8_t  i;                        /**< current segment */
+    uint8_t  state;                    /**< profile_state_t */
+    bool     reached;                  /**< target of the segment reached */
+    uint32_t seg_n;                    /**< control steps in the segment */
+    uint32_t hold_n;                   /**< control steps in the hold */
+    float    sp_c;                     /**< setpoint, before the zone limits */
+} profile_t;
+
+/**
+ * @brief Remove all segments of a zone (stops a running profile).
+ */
+void Profile_Clear(uint8_t zone);
+
+/**
+ * @brief Append a segment to the profile of a zone.
+ * @return false if the profile is full or running, the target is
+ *         outside the setpoint range of the zone, or loop_to points
+ *         past the segment.
+ */
+bool Profile_AddSegment(uint8_t zone, const profile_seg_t *seg);
+
+/**
+ * @brief Start the profile from its first segment, or resume it when
+ *        paused. The first ramp starts at the current setpoint.
+ * @return false if the profile is empty.
+ */
+bool Profile_Start(uint8_t zone);
+
+/** Freeze a running profile. */
+void Profile_Pause(uint8_t zone);
+
+/** Stop the profile; the setpoint stays where it is. */
+void Profile_Stop(uint8_t zone);
+
+/**
+ * @brief Advance the profile of a zone by one control step.
+ *
+ * Call from the control task before the setpoint is read.
+ */
+void Profile_Update(uint8_t zone);
+
+const profile_t *Profile_Get(uint8_t zone);
+
+/** Time spent in the current segment [s]. */
+float Profile_GetSegmentTimeS(uint8_t zone);
+
+#endif /* INC_PROFILE_H_ */
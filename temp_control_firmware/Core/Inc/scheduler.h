@@ -0,0 +1,82 @@
+/**
+ * @file scheduler.h
+ * @brief Cooperative time-triggered task scheduler.
+ *
+ * This module runs application tasks (control, UART, button, LED,
+ * telemetry, ...) at fixed periods derived from a millisecond tick.
+ * Each task has its own period and phase offset, so tasks with equal
+ * periods can be spread over different ticks.
+ *
+ * On target the tick is produced by TIM7 calling Sched_TickISR() once per
+ * millisecond. A host build can pass its own tick function to
+ * Sched_Init() to drive the scheduler from a fake clock.
+ *
+ * A task that starts a full period or more after its release time has
+ * missed one or more deadlines. Missed releases are counted and skipped,
+ * the task keeps its original phase.
+ */
+
+#ifndef INC_SCHEDULER_H_
+#define INC_SCHEDULER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SCHED_MAX_TASKS  8U
+
+typedef uint32_t (*sched_tick_fn_t)(void);
+typedef void (*sched_task_fn_t)(void);
+
+typedef struct {
+    const char     *name;
+    sched_task_fn_t fn;
+    uint32_t        period_ms;
+    uint32_t        next_due_ms;
+    uint32_t        runs;
+    uint32_t        misses;
+    uint32_t        max_late_ms;
+} sched_task_t;
+
+/**
+ * @brief Reset the task table and select the tick source.
+ * @param now_ms Tick function returning milliseconds, or NULL to use the
+ *               internal counter advanced by Sched_TickISR().
+ */
+void Sched_Init(sched_tick_fn_t now_ms);
+
+/**
+ * @brief Register a periodic task.
+ *
+ * Tasks run in registration order when several are due on the same tick,
+ * so register the most time-critical task first.
+ *
+ * @return Task id (>= 0) or -1 if the table is full or arguments are invalid.
+ */
+int Sched_AddTask(const char *name, sched_task_fn_t fn,
+                  uint32_t period_ms, uint32_t phase_ms);
+
+/**
+ * @brief Change the period of a task.
+ *
+ * The next release is at most one new period away.
+ * @return false for an invalid id or a zero period.
+ */
+bool Sched_SetPeriod(int id, uint32_t period_ms);
+
+/** @return Id of the task registered under @p name, or -1. */
+int Sched_FindTask(const char *name);
+
+/**
+ * @brief Run every task whose release time has been reached.
+ * @return true if at least one task was executed.
+ */
+bool Sched_RunPending(void);
+
+void     Sched_TickISR(void);
+uint32_t Sched_GetTick(void);
+
+const sched_task_t *Sched_GetTask(int id);
+uint32_t Sched_GetTaskCount(void);
+uint32_t Sched_GetTotalMisses(void);
+
+#endif /* INC_SCHEDULER_H_ */
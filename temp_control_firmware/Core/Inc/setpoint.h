@@ -15,7 +15,13 @@
 #ifndef INC_SETPOINT_H_
 #define INC_SETPOINT_H_
 
-float Setpoint_GetC(void);
-void  Setpoint_SetC(float value_c);
+#include <stdint.h>
+
+float Setpoint_GetC(uint8_t zone);
+
+/**
+ * @brief Set the setpoint of a zone, clamped to the zone's safe range.
+ */
+void  Setpoint_SetC(uint8_t zone, float value_c);
 
 #endif /* INC_SETPOINT_H_ */
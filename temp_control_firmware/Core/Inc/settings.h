@@ -0,0 +1,40 @@
+/**
+ * @file settings.h
+ * @brief Settings kept across resets in the flash store (store.h).
+ *
+ * The PARAM_F_PERSIST parameters of the registry (param.h): per zone the
+ * setpoint, its limits, the alarm limits, the controller gains and the
+ * fan hysteresis, and the NTC constants and telemetry period (set by
+ * command, the button or the autotuner). They are loaded at boot and
+ * saved by Settings_Task() once a changed value has been stable for
+ * SETTINGS_HOLD_MS, so a ramp or a series of button presses costs one
+ * record. The setpoint of a zone with a running or paused profile is not
+ * saved; the last target is, once the profile is done or stopped.
+ *
+ * The store key of each parameter is in its descriptor.
+ */
+
+#ifndef INC_SETTINGS_H_
+#define INC_SETTINGS_H_
+
+#include <stdbool.h>
+
+/**
+ * @brief Mount the store and apply the saved values.
+ *
+ * Call after Zone_Init(), Param_Init() and MX_CRC_Init(), before
+ * Control_Init(), which builds the controllers from the gains. Values out
+ * of range are ignored.
+ */
+void Settings_Load(void);
+
+/** Periodic task (SETTINGS_PERIOD_MS): save changed values. */
+void Settings_Task(void);
+
+/**
+ * @brief Clear the store and return the parameters to their config.h
+ *        defaults, from the next control step (Param_SetDefaults()).
+ */
+bool Settings_Restore(void);
+
+#endif /* INC_SETTINGS_H_ */
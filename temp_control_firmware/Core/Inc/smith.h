@@ -0,0 +1,91 @@
+/**
+ * @file smith.h
+ * @brief Smith predictor for zones with a long sensor dead time.
+ *
+ * A smith_t holds a first-order-plus-dead-time model of one zone,
+ *
+ *   tau * dx/dt = K * u - x,     y_model = T_amb + x(t - L)
+ *
+ * with x the heating above ambient. The model runs at the control rate;
+ * x(t - L) comes from a fixed delay line of SMITH_DELAY_MAX samples, so
+ * L is limited to SMITH_DELAY_MAX * CONTROL_TS_S.
+ *
+ * The controller is closed on the predicted undelayed temperature
+ *
+ *   y_fb = T_meas + x(t) - x(t - L)
+ *
+ * so with a correct model the loop sees a plant without dead time and
+ * tighter gains are stable. Model errors enter y_fb through the
+ * difference only; a constant offset (ambient) does not.
+ *
+ * Residual: r = T_meas - T_amb - x(t - L), the measurement minus the
+ * model output. Its mean (first-order filter, SMITH_RESID_TAU_S) holds
+ * the static error, which includes the error of the ambient estimate.
+ * Its RMS about that mean is the dynamic error: it stays near the sensor
+ * noise with a good model and grows on setpoint moves when K, tau or L
+ * are wrong. SMITH_MISMATCH is set while the RMS has stayed above
+ * SMITH_RESID_MAX_C for SMITH_RESID_HOLD_S.
+ */
+
+#ifndef INC_SMITH_H_
+#define INC_SMITH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SMITH_DELAY_MAX  128U   /**< delay line length [control steps] */
+
+/* Status flags */
+#define SMITH_MISMATCH   0x01U   /**< dynamic residual too large */
+
+typedef struct {
+    float k_c_per_pct;   /**< gain [degC/%] */
+    float tau_s;         /**< time constant [s] */
+    float dead_s;        /**< dead time [s] */
+} smith_model_t;
+
+typedef struct {
+    smith_model_t m;
+    float    a;                        /**< model pole step, 1 - exp(-Ts/tau) */
+    uint16_t delay;                    /**< dead time [control steps] */
+    uint16_t head;                     /**< next write position in line[] */
+    float    x;                        /**< undelayed model state [degC] */
+    float    line[SMITH_DELAY_MAX];    /**< past x, line[head] is the oldest */
+
+    float    resid_c;                  /**< last residual */
+    float    resid_mean_c;
+    float    resid_var;                /**< variance about the mean */
+    uint16_t bad_n;                    /**< steps the RMS stayed too high */
+    uint8_t  flags;
+} smith_t;
+
+/**
+ * @brief Set the model and restart at steady state with output @p u0.
+ * @return false if the model is invalid or L exceeds the delay line
+ *         (the predictor is left unchanged).
+ */
+bool Smith_Init(smith_t *sp, const smith_model_t *model, float u0_pct);
+
+/**
+ * @brief Fill the model with the steady state at output @p u0.
+ *
+ * With the plant settled at u0, T_meas then passes through unchanged:
+ * switching the predictor in does not step the controller input.
+ */
+void Smith_Reset(smith_t *sp, float u0_pct);
+
+/**
+ * @brief Controller input for this step, and residual update.
+ * @param ambient_c  ambient estimate, for the residual only
+ */
+float Smith_Feedback(smith_t *sp, float meas_c, float ambient_c);
+
+/**
+ * @brief Advance the model with the output applied in this step.
+ */
+void Smith_Update(smith_t *sp, float u_pct);
+
+/** RMS of the residual about its mean [degC]. */
+float Smith_GetResidualRms(const smith_t *sp);
+
+#endif /* INC_SMITH_H_ */
@@ -0,0 +1,105 @@
+/**
+ * @file store.h
+ * @brief Persistent key/value store in internal flash.
+ *
+ * Values are 32-bit words under keys 0 .. STORE_MAX_KEYS - 1, kept in a
+ * log in flash sectors 1 and 2 (32K each, 0x08008000 - 0x08017FFF),
+ * which the linker script keeps free of code. One sector is active; a
+ * write appends a record to it and the newest valid record of a key wins.
+ *
+ * Sector layout:
+ *
+ *   offset  size  field
+ *   0       4     magic STORE_MAGIC
+ *   4       4     generation, incremented by every compaction
+ *   8       4     commit word, programmed to 0 when the sector is complete
+ *   12      4     CRC-32 of bytes 0..7
+ *   16      12 n  records
+ *
+ * Record:
+ *
+ *   offset  size  field
+ *   0       2     key
+ *   2       2     ~key
+ *   4       4     value
+ *   8       4     CRC-32 of bytes 0..7 (crc32.h), programmed last
+ *
+ * When the active sector is full, compaction erases the other sector,
+ * writes the latest value of every key to it and then its commit word;
+ * only then does it become the active one. At boot the committed sector
+ * with the higher generation is active.
+ *
+ * Power loss:
+ *
+ *  - during a record write: the record fails its CRC and is skipped, the
+ *    previous value of the key stays in effect
+ *  - during a compaction: the new sector has no commit word and the old
+ *    one, which is not touched, stays active
+ *
+ * Boot time: Store_Init() reads the active sector once, up to 2729
+ * records, in about 2 ms on the target. When more than 3/4 of it is
+ * used it also compacts, so that the log rarely fills at run time;
+ * that boot takes one sector erase longer (typ. 250 ms).
+ *
+ * A sector erase stalls every read of the flash, including instruction
+ * fetches and the vector table: interrupts wait for it as well, the
+ * overtemperature interrupt included. The heater outputs are therefore
+ * held off for the erase (OverTemp_HoldOutputs(), overtemp.h) and resume
+ * after it unless the watchdog tripped meanwhile. At run time this
+ * happens once per ~2700 writes.
+ *
+ * Thread mode only (hardware CRC unit, flash controller).
+ */
+
+#ifndef INC_STORE_H_
+#define INC_STORE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define STORE_MAX_KEYS  128U
+#define STORE_MAGIC     0x50535431UL   /* "PST1" */
+
+typedef struct {
+    bool     mounted;       /**< flash usable, else values live in RAM only */
+    uint32_t generation;    /**< of the active sector */
+    uint16_t used;          /**< record slots used in the active sector */
+    uint16_t slots;         /**< record slots per sector */
+    uint16_t keys;          /**< keys with a value */
+    uint16_t bad;           /**< records skipped at boot (CRC, torn writes) */
+} store_info_t;
+
+/**
+ * @brief Find the active sector and load the latest value of every key.
+ *
+ * Formats the store when neither sector is committed (new device, or
+ * after a full chip erase). Call once at boot, before Store_Read().
+ * @return false if the flash could not be used; reads then find no
+ *         values and writes fail.
+ */
+bool Store_Init(void);
+
+/**
+ * @brief Latest value of a key.
+ * @return false if the key has never been written.
+ */
+bool Store_Read(uint16_t key, uint32_t *value);
+
+/**
+ * @brief Append a new value of a key.
+ *
+ * Nothing is written if the value equals the stored one. May compact
+ * (see the sector erase above).
+ * @return true once the value is in flash.
+ */
+bool Store_Write(uint16_t key, uint32_t value);
+
+bool Store_ReadFloat(uint16_t key, float *value);
+bool Store_WriteFloat(uint16_t key, float value);
+
+/** Erase both sectors and start an empty store. */
+bool Store_Format(void);
+
+void Store_GetInfo(store_info_t *info);
+
+#endif /* INC_STORE_H_ */
@@ -11,7 +11,89 @@
 #define INC_TEMPERATURE_H_
 
 #include <stdint.h>
+#include "filter.h"
+#include "zone.h"
 
+/** Filtered channels, one per zone. */
+#define TEMP_NUM_CH  ZONE_COUNT
+
+/** NTC divider and Beta model constants, defaults from config.h. */
+typedef struct {
+  float r_fixed;   /**< fixed divider resistor [ohm] */
+  float beta;      /**< Beta constant [K] */
+  float r0;        /**< NTC resistance at t0_k [ohm] */
+  float t0_k;      /**< reference temperature [K] */
+} ntc_params_t;
+
+/**
+ * @brief Set every channel filter to the config.h default, a 9-sample
+ *        moving average (TEMP_FILT_TYPE, TEMP_FILT_N).
+ *
+ * The filters live in the zone table; call after Zone_Init().
+ */
+void Temperature_Init(void);
+
+/**
+ * @brief Convert a 12-bit ADC code to degC (table interpolation).
+ */
 float Temperature_FromRaw(uint16_t raw);
+
+/**
+ * @brief Convert an oversampled 12.4 fixed-point ADC value to degC.
+ */
+float Temperature_FromRawQ4(uint16_t raw_q4);
+
+/**
+ * @brief Convert a 12-bit ADC code to degC using the Beta model (logf).
+ */
+float Temperature_FromRawExact(uint16_t raw);
+
+/**
+ * @brief Inverse of the Beta model: ADC code at a temperature.
+ *
+ * Rounded to the nearest code and clamped to 0..4095. The code falls as
+ * the temperature rises.
+ */
+uint16_t Temperature_ToRaw(float t_c);
+
+/**
+ * @brief Change the NTC constants used by every conversion.
+ *
+ * Other constants than the config.h ones rebuild the conversion table in
+ * RAM from the Beta model (NTC_LUT_SIZE logf() calls). The hardware
+ * cutoff thresholds are not updated here, see OverTemp_Update().
+ */
+void Temperature_SetNtc(const ntc_params_t *p);
+
+const ntc_params_t *Temperature_GetNtc(void);
+
+/**
+ * @brief Filter object of a channel.
+ */
+filter_t *Temperature_GetFilter(uint8_t ch);
+
+/**
+ * @brief Change the filter type and length of a channel.
+ *
+ * The length n (1..FILTER_MA_MAX_N samples) is the window of FILTER_MA
+ * and FILTER_MEDIAN (odd, at most FILTER_MEDIAN_MAX_N) and gives EMA and
+ * Kalman the same group delay, (n - 1) / 2 samples. The history is
+ * cleared. Kept in the zone table as filter_type[] and filter_n[].
+ */
+void Temperature_SetFilter(uint8_t ch, filter_type_t type, uint8_t n);
+
+/**
+ * @brief Group delay of the channel filter [s], Filter_GroupDelay() at
+ *        one sample per control step.
+ *
+ * The control loop sees it as extra dead time.
+ */
+float Temperature_GetFilterDelayS(uint8_t ch);
+
+/**
+ * @brief Pass a temperature sample through the channel filter.
+ */
+float Temperature_Filter(uint8_t ch, float t_c);
+
 float Temperature_FromRawFiltered(uint16_t raw);
 #endif /* INC_TEMPERATURE_H_ */
@@ -0,0 +1,162 @@
+/**
+ * @file tlm_bin.h
+ * @brief Binary telemetry packets with COBS framing and CRC-32.
+ *
+ * Packet layout before framing (little endian):
+ *
+ *   offset  size  field
+ *   0       1     protocol version (TLMB_VERSION)
+ *   1       1     packet type (tlmb_type_t)
+ *   2       2     sequence number
+ *   4       4     device timestamp [ms]
+ *   8       1     number of fields
+ *   9       ...   fields: id (1), value type (1), value (1/2/4 bytes, or
+ *                 for STR a length byte and that many characters)
+ *   n       4     CRC-32/MPEG-2 over bytes 0..n-1 (see crc32.h)
+ *
+ * The packet is COBS encoded and terminated by a single 0x00 byte, so a
+ * receiver can resynchronise on any zero byte in the stream.
+ *
+ * Field ids are stable across versions; a decoder skips ids it does not
+ * know using the value type, so new fields can be added freely. A new
+ * value type changes the version, since a decoder cannot skip a value of
+ * unknown size:
+ *
+ *   1  first version
+ *   2  TLMB_VT_STR (parameter names and units)
+ */
+
+#ifndef INC_TLM_BIN_H_
+#define INC_TLM_BIN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TLMB_VERSION      2U
+#define TLMB_MAX_RAW      128U
+
+/* Sizes before framing, to check packets against TLMB_MAX_RAW at compile
+   time: header, CRC and a field with a value of n bytes. */
+#define TLMB_HDR_LEN       9U
+#define TLMB_CRC_LEN       4U
+#define TLMB_FIELD_LEN(n)  (2U + (n))
+
+/** Encoded size of a packet of @p raw bytes: COBS overhead and the 0x00 delimiter. */
+#define TLMB_FRAME_LEN(raw)  ((raw) + ((raw) / 254U) + 2U)
+#define TLMB_MAX_FRAME       TLMB_FRAME_LEN(TLMB_MAX_RAW)
+
+typedef enum {
+    TLMB_TYPE_TELEMETRY = 1,
+    TLMB_TYPE_ACK       = 2,
+    TLMB_TYPE_TUNE      = 3,   /**< autotune report, see autotune.h */
+    TLMB_TYPE_PERF      = 4,   /**< section timing, see perf.h */
+    TLMB_TYPE_TRACE     = 5,   /**< event trace header or record, see trace.h */
+    TLMB_TYPE_PARAM     = 6,   /**< parameter descriptor and value, see param.h */
+    TLMB_TYPE_DIAG      = 7    /**< model diagnostics of a zone, see uart_if.c */
+} tlmb_type_t;
+
+typedef enum {
+    TLMB_VT_U8  = 1,
+    TLMB_VT_U16 = 2,
+    TLMB_VT_U32 = 3,
+    TLMB_VT_I16 = 4,
+    TLMB_VT_I32 = 5,
+    TLMB_VT_F32 = 6,
+    TLMB_VT_STR = 7
+} tlmb_vtype_t;
+
+typedef enum {
+    TLMB_F_T_MEAS     = 1,   /**< F32 measured temperature [degC] */
+    TLMB_F_T_REF      = 2,   /**< F32 reference temperature [degC] */
+    TLMB_F_PWM        = 3,   /**< F32 heater duty [%] */
+    TLMB_F_STATUS     = 4,   /**< U8 command status, 0 = OK (ACK packets) */
+    TLMB_F_RAW        = 5,   /**< U16 ADC value, 12 bit */
+    TLMB_F_ERROR      = 6,   /**< F32 control error T_ref - T_meas [degC] */
+    TLMB_F_INTEGRATOR = 7,   /**< F32 PID integral term [%] */
+    TLMB_F_FAN        = 8,   /**< U8 fan state */
+    TLMB_F_PERIOD_US  = 9,   /**< U32 control loop period [us] */
+    TLMB_F_EXEC_US    = 10,  /**< U32 control step execution time [us] */
+    TLMB_F_DROPS      = 11,  /**< U32 stream frames dropped */
+    TLMB_F_ZONE       = 12,  /**< U8  zone index, see zone.h */
+    TLMB_F_KP         = 13,  /**< F32 proportional gain [%/degC] */
+    TLMB_F_KI         = 14,  /**< F32 integral gain [%/(degC*s)] */
+    TLMB_F_TUNE       = 15,  /**< U8  autotune state (at_state_t) */
+    TLMB_F_TUNE_RULE  = 16,  /**< U8  autotune rule (at_rule_t) */
+    TLMB_F_KU         = 17,  /**< F32 ultimate gain [%/degC] */
+    TLMB_F_PU         = 18,  /**< F32 ultimate period [s] */
+    TLMB_F_AMP        = 19,  /**< F32 limit cycle amplitude [degC] */
+    TLMB_F_DEAD       = 20,  /**< F32 switch-to-peak time [s] */
+    TLMB_F_ID_K       = 21,  /**< F32 identified gain [degC/%] */
+    TLMB_F_ID_TAU     = 22,  /**< F32 identified time constant [s] */
+    TLMB_F_ID_DEAD    = 23,  /**< F32 identified dead time [s] */
+    TLMB_F_ID_K_RSD   = 24,  /**< F32 relative std of the gain */
+    TLMB_F_ID_TAU_RSD = 25,  /**< F32 relative std of the time constant */
+    TLMB_F_ID_FLAGS   = 26,  /**< U8  IDENT_VALID / IDENT_DRIFT_* */
+    TLMB_F_FF         = 27,  /**< F32 feed-forward part of the duty [%] */
+    TLMB_F_T_AMB      = 28,  /**< F32 ambient estimate [degC] */
+    TLMB_F_SMITH      = 29,  /**< U8  Smith predictor, bit 0 on, bit 1 mismatch */
+    TLMB_F_RESID      = 30,  /**< F32 predictor residual mean [degC] */
+    TLMB_F_RESID_RMS  = 31,  /**< F32 predictor residual RMS [degC] */
+    TLMB_F_PROF_STATE = 32,  /**< U8  setpoint profile state (profile.h) */
+    TLMB_F_PROF_SEG   = 33,  /**< U8  current profile segment */
+    TLMB_F_PROF_SEG_T = 34,  /**< F32 time in the segment [s] */
+    TLMB_F_PERF_SEC   = 35,  /**< U8  profiled section (perf_sec_t) */
+    TLMB_F_PERF_N     = 36,  /**< U32 executions, or loop periods */
+    TLMB_F_PERF_MIN   = 37,  /**< U32 shortest execution [ticks] */
+    TLMB_F_PERF_MAX   = 38,  /**< U32 longest execution [ticks] */
+    TLMB_F_PERF_MEAN  = 39,  /**< U32 mean execution [ticks] */
+    TLMB_F_PERF_HIST  = 40,  /**< U32 histogram bin, repeated PERF_HIST_BINS times */
+    TLMB_F_PERF_HZ    = 41,  /**< U32 tick rate [Hz] */
+    TLMB_F_PERF_JMIN  = 42,  /**< I32 shortest loop period - nominal [ticks] */
+    TLMB_F_PERF_JMAX  = 43,  /**< I32 longest loop period - nominal [ticks] */
+    TLMB_F_PERF_OVER  = 44,  /**< U32 control tasks over budget */
+    TLMB_F_TR_N       = 45,  /**< U32 records in the trace dump */
+    TLMB_F_TR_LOST    = 46,  /**< U32 records overwritten before the dump */
+    TLMB_F_TR_MASK    = 47,  /**< U8  recorded classes (TRACE_C_*) */
+    TLMB_F_TR_T       = 48,  /**< U32 record timestamp [ticks] */
+    TLMB_F_TR_EV      = 49,  /**< U8  event id (trace_ev_t) */
+    TLMB_F_TR_CTX     = 50,  /**< U8  context, exception number or 0 */
+    TLMB_F_TR_ARG     = 51,  /**< U16 event argument */
+    TLMB_F_PAR_ID     = 52,  /**< U8  parameter id (param_id_t) */
+    TLMB_F_PAR_NAME   = 53,  /**< STR parameter name */
+    TLMB_F_PAR_UNIT   = 54,  /**< STR unit */
+    TLMB_F_PAR_TYPE   = 55,  /**< U8  value type (param_type_t) */
+    TLMB_F_PAR_FLAGS  = 56,  /**< U8  PARAM_F_* */
+    TLMB_F_PAR_MIN    = 57,  /**< F32 lowest value */
+    TLMB_F_PAR_MAX    = 58,  /**< F32 highest value */
+    TLMB_F_PAR_DEF    = 59,  /**< F32 default */
+    TLMB_F_PAR_VAL    = 60   /**< F32 value, repeated per zone */
+} tlmb_field_t;
+
+typedef struct {
+    uint8_t  buf[TLMB_MAX_RAW];
+    uint16_t len;
+    bool     overflow;
+} tlmb_packet_t;
+
+void TLMB_Begin(tlmb_packet_t *p, tlmb_type_t type, uint16_t seq, uint32_t timestamp_ms);
+
+void TLMB_AddU8(tlmb_packet_t *p, uint8_t id, uint8_t v);
+void TLMB_AddU16(tlmb_packet_t *p, uint8_t id, uint16_t v);
+void TLMB_AddU32(tlmb_packet_t *p, uint8_t id, uint32_t v);
+void TLMB_AddI16(tlmb_packet_t *p, uint8_t id, int16_t v);
+void TLMB_AddI32(tlmb_packet_t *p, uint8_t id, int32_t v);
+void TLMB_AddF32(tlmb_packet_t *p, uint8_t id, float v);
+
+/** String field, at most 255 characters. */
+void TLMB_AddStr(tlmb_packet_t *p, uint8_t id, const char *s);
+
+/**
+ * @brief Append the CRC and write the COBS frame including delimiter.
+ * @return Frame length in bytes, 0 if the packet overflowed or @p cap is
+ *         too small.
+ */
+uint16_t TLMB_Finish(tlmb_packet_t *p, uint8_t *out, uint16_t cap);
+
+/**
+ * @brief COBS encode @p len bytes (no delimiter is written).
+ * @return Encoded length, at most len + len / 254 + 1.
+ */
+uint16_t COBS_Encode(const uint8_t *in, uint16_t len, uint8_t *out);
+
+#endif /* INC_TLM_BIN_H_ */
@@ -0,0 +1,84 @@
+/**
+ * @file tlm_stream.h
+ * @brief Continuous telemetry stream of control loop samples.
+ *
+ * When started, every n-th control sample (decimation) is sent with the
+ * selected set of fields, in the protocol currently selected on the UART
+ * (JSON line or binary packet, see uart_if.c). A control sample holds
+ * every zone; one frame is sent per selected zone, tagged with the zone
+ * index.
+ *
+ * STREAM_F_MODEL adds the plant model identified online (ident.h): K,
+ * tau, dead time, the relative standard deviations of K and tau and the
+ * IDENT_* flags, with the field names of the diagnostics report (D<z>).
+ * A host can follow the estimate and its confidence this way without
+ * polling.
+ *
+ * Samples are never queued beyond the UART transmit buffer: if a frame
+ * does not fit, it is dropped and counted. Every frame carries the drop
+ * count and the sample number, so gaps are visible on the PC side.
+ */
+
+#ifndef INC_TLM_STREAM_H_
+#define INC_TLM_STREAM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ident.h"
+#include "zone.h"
+
+/* Field selection mask bits. */
+#define STREAM_F_T_MEAS     (1U << 0)   /**< measured temperature [degC] */
+#define STREAM_F_RAW        (1U << 1)   /**< ADC value, 12 bit */
+#define STREAM_F_T_REF      (1U << 2)   /**< reference temperature [degC] */
+#define STREAM_F_PWM        (1U << 3)   /**< heater duty [%] */
+#define STREAM_F_ERROR      (1U << 4)   /**< control error T_ref - T_meas */
+#define STREAM_F_INTEGRATOR (1U << 5)   /**< PID integral term [%] */
+#define STREAM_F_FAN        (1U << 6)   /**< fan on/off */
+#define STREAM_F_TIMING     (1U << 7)   /**< loop period and execution time [us] */
+#define STREAM_F_MODEL      (1U << 8)   /**< identified plant model (ident.h) */
+#define STREAM_F_ALL        0x1FFU
+
+/** Zone selection mask with every zone. */
+#define STREAM_ZONES_ALL    ((1U << ZONE_COUNT) - 1U)
+
+typedef struct {
+    uint8_t  zone;
+    float    t_meas;
+    uint16_t raw;
+    float    t_ref;
+    float    pwm;
+    float    error;
+    float    i_term;
+    bool     fan;
+    uint32_t period_us;   /**< time since the previous control step */
+    uint32_t exec_us;     /**< execution time of this control step */
+    const ident_model_t *model;   /**< K, tau, dead time, their rsd, flags */
+} stream_sample_t;
+
+void Stream_Init(void);
+
+/**
+ * @brief Start streaming every @p decim-th control sample.
+ * @param zones Zone selection mask, bit n = zone n.
+ * @return false if @p decim is 0, or @p mask or @p zones selects nothing.
+ */
+bool Stream_Start(uint16_t decim, uint16_t mask, uint16_t zones);
+
+void Stream_Stop(void);
+
+bool Stream_IsActive(void);
+
+/**
+ * @brief Offer one control sample; called once per control period.
+ * @param s One entry per zone.
+ * @param n Number of entries.
+ */
+void Stream_OnSample(const stream_sample_t *s, uint8_t n);
+
+/**
+ * @brief Frames dropped since the stream was started.
+ */
+uint32_t Stream_GetDrops(void);
+
+#endif /* INC_TLM_STREAM_H_ */
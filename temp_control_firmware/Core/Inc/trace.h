@@ -0,0 +1,117 @@
+/**
+ * @file trace.h
+ * @brief Timestamped event trace in a RAM ring buffer.
+ *
+ * Every record is 8 bytes:
+ *
+ *   offset  size  field
+ *   0       4     timestamp, Perf_Now() ticks (core cycles on the target)
+ *   4       2     argument, see the event ids
+ *   6       1     event id (trace_ev_t)
+ *   7       1     context: 0 = thread mode, else the active exception
+ *                 number (IPSR, IRQn + 16)
+ *
+ * Records are written by the main loop and by interrupt handlers without
+ * locking: a writer reserves its slot with an atomic increment of the
+ * write index (LDREX/STREX) and fills it. A preempting handler takes the
+ * next slot, so records are in order of reservation; the timestamp is
+ * read after the reservation and may be slightly older than that of the
+ * record before it. When the ring is full the oldest records are
+ * overwritten.
+ *
+ * Event classes (id >> 6) are enabled with a mask, TRACE_C_EVENT always
+ * being recorded:
+ *
+ *   TRACE_C_EVENT  state changes: a few per second at most
+ *   TRACE_C_TASK   begin / end of every scheduler task run
+ *   TRACE_C_ISR    entry / exit of the interrupt handlers, several
+ *                  thousand per second: fills the ring in about 100 ms
+ *
+ * With TRACE_STOP_ON_ALARM (config.h) recording stops after the first
+ * alarm entry, so the ring keeps the history that led to it.
+ *
+ * The timestamp wraps after 2^32 ticks, 2^32 / Perf_GetHz() seconds
+ * (about 59.6 s at the 72 MHz SYSCLK). The scheduler tick records
+ * TRACE_EV_SYNC every TRACE_SYNC_MS, so a decoder can unwrap it from the
+ * difference to the previous record.
+ *
+ * Recording is paused while the ring is read out (Trace_BeginRead() to
+ * Trace_EndRead()), which is safe from the main loop: an interrupt
+ * handler finishes its record before the main loop runs again.
+ */
+
+#ifndef INC_TRACE_H_
+#define INC_TRACE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Ring size in records, must be a power of two. */
+#define TRACE_BUF_LEN   512U
+#define TRACE_SYNC_MS   5000U
+
+#define TRACE_C_EVENT   0x01U
+#define TRACE_C_TASK    0x02U
+#define TRACE_C_ISR     0x04U
+#define TRACE_C_ALL     0x07U
+
+/** Argument of the per-zone events: zone and a 12-bit value. */
+#define TRACE_ZARG(zone, v)  ((uint16_t)(((uint32_t)(zone) << 12) | ((uint32_t)(v) & 0x0FFFU)))
+
+typedef enum {
+    /* TRACE_C_EVENT */
+    TRACE_EV_SYNC        = 0x01,  /**< arg: scheduler tick / 1000 [s] */
+    TRACE_EV_UART_LINE   = 0x02,  /**< command line handled, arg: first character */
+    TRACE_EV_SETPOINT    = 0x03,  /**< setpoint command, arg: ZARG(zone, degC * 10) */
+    TRACE_EV_ALARM       = 0x04,  /**< alarm, arg: ZARG(zone, 1 entry / 0 exit) */
+    TRACE_EV_FAN         = 0x05,  /**< fan switched, arg: 1 on / 0 off */
+    TRACE_EV_ADC_TIMEOUT = 0x06,  /**< no new ADC block for a control step */
+    TRACE_EV_OVERTEMP    = 0x07,  /**< hardware overtemp trip, arg: ADC code */
+    TRACE_EV_PROFILE     = 0x08,  /**< profile segment, arg: ZARG(zone, segment) */
+    /* TRACE_C_TASK, arg: scheduler task id */
+    TRACE_EV_TASK_BEGIN  = 0x40,
+    TRACE_EV_TASK_END    = 0x41,
+    /* TRACE_C_ISR, arg: IRQn */
+    TRACE_EV_ISR_ENTER   = 0x80,
+    TRACE_EV_ISR_EXIT    = 0x81
+} trace_ev_t;
+
+typedef struct {
+    uint32_t ts;
+    uint16_t arg;
+    uint8_t  id;
+    uint8_t  ctx;
+} trace_rec_t;
+
+/** Clear the ring and start recording the classes of TRACE_MASK_DEFAULT. */
+void Trace_Init(void);
+
+/**
+ * @brief Clear the ring and start recording.
+ * @param mask TRACE_C_* classes, TRACE_C_EVENT is always added.
+ */
+void Trace_Start(uint8_t mask);
+
+/** Stop recording, the ring keeps its records. */
+void Trace_Stop(void);
+
+bool    Trace_IsRecording(void);
+uint8_t Trace_GetMask(void);
+
+/** Add a record, if its class is enabled. Callable from any context. */
+void Trace_Record(trace_ev_t id, uint16_t arg);
+
+/**
+ * @brief Pause recording for a read-out of the ring.
+ * @param first Set to the write index of the oldest record in the ring.
+ * @return Write index of the next record: records first .. return - 1
+ *         are in the ring, read them with Trace_Get().
+ */
+uint32_t Trace_BeginRead(uint32_t *first);
+
+const trace_rec_t *Trace_Get(uint32_t index);
+
+/** Resume recording after Trace_BeginRead(), unless it was stopped. */
+void Trace_EndRead(void);
+
+#endif /* INC_TRACE_H_ */
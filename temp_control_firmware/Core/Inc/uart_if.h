@@ -13,12 +13,23 @@
 #include <stdint.h>
 #include "main.h"
 
+typedef enum {
+    UARTIF_PROTO_JSON = 0,   /**< text replies and JSON telemetry */
+    UARTIF_PROTO_BINARY      /**< COBS/CRC-32 packets, see tlm_bin.h */
+} uartif_proto_t;
+
 void UARTIF_Init(void);
 void UARTIF_Task(void);
 bool UARTIF_HasSetpoint(void);
 float UARTIF_GetSetpointC(void);
-bool UARTIF_ConsumeTelemetryRequest(void);
-void UARTIF_SendTelemetry(float t_meas, float t_ref, float pwm);
+
+/**
+ * @brief Zones for which telemetry was requested since the last call.
+ * @return Zone mask, bit n = zone n.
+ */
+uint16_t UARTIF_ConsumeTelemetryRequest(void);
+uartif_proto_t UARTIF_GetProtocol(void);
+void UARTIF_SendTelemetry(uint8_t zone, float t_meas, float t_ref, float pwm);
 
 
 #endif /* INC_UART_IF_H_ */
@@ -0,0 +1,50 @@
+/**
+ * @file uart_rx.h
+ * @brief UART line reception with circular DMA and idle-line detection.
+ *
+ * USART3 RX writes continuously into a circular DMA buffer. The DMA
+ * half/full transfer and the UART IDLE interrupts hand the new bytes to
+ * a line assembler, which pushes every complete line (terminated by CR
+ * or LF) into a single-producer/single-consumer queue.
+ *
+ * The application drains the queue with UARTRX_GetLine(). Several
+ * commands sent back to back are all kept as long as the queue has room;
+ * lines that do not fit are dropped and counted, never silently lost.
+ */
+
+#ifndef INC_UART_RX_H_
+#define INC_UART_RX_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define UARTRX_DMA_SIZE     256U  /**< circular DMA buffer [bytes] */
+#define UARTRX_LINE_MAX     64U   /**< max line length incl. terminator */
+#define UARTRX_LINEQ_DEPTH  8U    /**< queued lines, power of two */
+
+typedef struct {
+    uint32_t lines;          /**< lines queued */
+    uint32_t lines_dropped;  /**< lines lost because the queue was full */
+    uint32_t overlong;       /**< lines discarded for exceeding LINE_MAX */
+    uint32_t rx_errors;      /**< UART errors (overrun, framing, noise) */
+} uartrx_stats_t;
+
+void UARTRX_Init(void);
+
+/**
+ * @brief Pop the oldest complete line.
+ * @param dst Destination, receives a NUL-terminated string.
+ * @param cap Size of @p dst.
+ * @return false if no line is pending.
+ */
+bool UARTRX_GetLine(char *dst, size_t cap);
+
+void UARTRX_GetStats(uartrx_stats_t *out);
+
+/**
+ * @brief Restart reception after a UART error.
+ */
+void UARTRX_OnError(void);
+
+#endif /* INC_UART_RX_H_ */
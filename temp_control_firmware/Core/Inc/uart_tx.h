@@ -0,0 +1,53 @@
+/**
+ * @file uart_tx.h
+ * @brief Non-blocking UART transmit queue drained by DMA.
+ *
+ * Outgoing bytes are copied into a ring buffer and the caller returns
+ * immediately. USART3 TX DMA sends the buffered data in the background;
+ * each transfer-complete interrupt starts the next chunk.
+ *
+ * Back-pressure policy: a message is queued completely or not at all.
+ * If it does not fit into the free space, the new message is dropped
+ * and counted, data already queued is never overwritten. The caller is
+ * never blocked.
+ */
+
+#ifndef INC_UART_TX_H_
+#define INC_UART_TX_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Ring buffer size in bytes, must be a power of two. */
+#define UARTTX_BUF_SIZE  1024U
+
+typedef struct {
+    uint32_t bytes_queued;   /**< bytes accepted by UARTTX_Write() */
+    uint32_t bytes_sent;     /**< bytes completed by DMA */
+    uint32_t msgs_dropped;   /**< messages rejected for lack of space */
+    uint32_t bytes_dropped;  /**< bytes of the rejected messages */
+    uint32_t tx_errors;      /**< DMA transfers aborted by an error */
+    uint16_t high_water;     /**< maximum buffer fill level seen */
+} uarttx_stats_t;
+
+void UARTTX_Init(void);
+
+/**
+ * @brief Queue a message for transmission.
+ * @return false if the message was dropped (buffer full).
+ */
+bool UARTTX_Write(const void *data, uint16_t len);
+
+/**
+ * @brief Free space in the ring buffer in bytes.
+ */
+uint16_t UARTTX_Free(void);
+
+void UARTTX_GetStats(uarttx_stats_t *out);
+
+/**
+ * @brief Recover from a failed DMA transfer (UART error interrupt).
+ */
+void UARTTX_OnError(void);
+
+#endif /* INC_UART_TX_H_ */
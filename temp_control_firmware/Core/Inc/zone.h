@@ -0,0 +1,103 @@
+/**
+ * @file zone.h
+ * @brief Zone table: per-zone state of the heated zones.
+ *
+ * A zone is one NTC input, one heater output and the loop between them.
+ * The table is a structure of arrays indexed by zone number, so one pass
+ * of the control task walks every array linearly for all zones.
+ *
+ * Wiring (fixed):
+ *
+ *   zone  ADC input      scan rank  heater
+ *   0     ADC1_IN0  PA0  1          TIM1_CH1 PE9
+ *   1     ADC1_IN3  PA3  2          TIM1_CH2 PE11
+ *   2     ADC1_IN10 PC0  3          TIM1_CH3 PE13
+ *   3     ADC1_IN13 PC3  4          TIM1_CH4 PE14
+ *
+ * A board can fit fewer zones: ZONE_ACTIVE_COUNT (config.h) takes the
+ * first rows. The ADC scan stops at the last of them, so the inputs of
+ * the others are neither converted nor seen by the overtemperature
+ * watchdog (overtemp.h), and nothing else knows about them.
+ *
+ * The modules keep their interfaces and work on their column of the
+ * table: temperature.c on filter[], control.c on pid[], ident[], ff_*[],
+ * smith*[] and the gains (written by autotune.c), setpoint.c on
+ * setpoint_c[] and the limits, profile.c on profile[], heater.c on
+ * pwm_ch[].
+ */
+
+#ifndef INC_ZONE_H_
+#define INC_ZONE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "config.h"
+#include "filter.h"
+#include "ident.h"
+#include "pid.h"
+#include "profile.h"
+#include "smith.h"
+
+#define ZONE_MAX    4U                   /**< rows of the wiring table */
+#define ZONE_COUNT  ZONE_ACTIVE_COUNT
+
+#if ZONE_COUNT < 1U || ZONE_COUNT > ZONE_MAX
+#error "ZONE_ACTIVE_COUNT must be 1 .. 4"
+#endif
+
+typedef struct {
+    /* Wiring */
+    uint8_t    adc_ch[ZONE_COUNT];       /**< channel index in the ADC scan */
+    uint32_t   pwm_ch[ZONE_COUNT];       /**< TIM1 output channel */
+
+    /* Limits [degC] */
+    float      sp_min_c[ZONE_COUNT];
+    float      sp_max_c[ZONE_COUNT];
+    float      alarm_min_c[ZONE_COUNT];
+    float      alarm_max_c[ZONE_COUNT];
+    float      fan_on_c[ZONE_COUNT];     /**< fan request above T_ref + this */
+    float      fan_off_c[ZONE_COUNT];    /**< ... until below T_ref + this */
+
+    /* Controller gains, from config.h or the autotuner */
+    float      kp[ZONE_COUNT];
+    float      ki[ZONE_COUNT];
+
+    /* Feed-forward and Smith predictor on (control.h), from config.h or by command */
+    bool       ff_enable[ZONE_COUNT];
+    bool       smith_enable[ZONE_COUNT];
+
+    /* Measurement filter (temperature.h), from config.h or by parameter */
+    uint8_t    filter_type[ZONE_COUNT];  /**< filter_type_t */
+    uint8_t    filter_n[ZONE_COUNT];     /**< length [samples] */
+
+    /* Loop state */
+    filter_t   filter[ZONE_COUNT];
+    pid_ctrl_t pid[ZONE_COUNT];
+    ident_t    ident[ZONE_COUNT];        /**< online plant model */
+    float      ff_ref_c[ZONE_COUNT];     /**< feed-forward reference model output */
+    float      ff_k[ZONE_COUNT];         /**< plant model of the feed-forward */
+    float      ff_tau[ZONE_COUNT];
+    smith_t    smith[ZONE_COUNT];        /**< predictor model, runs also when off */
+    float      setpoint_c[ZONE_COUNT];
+    profile_t  profile[ZONE_COUNT];      /**< setpoint profile, idle when empty */
+
+    /* Last control pass */
+    uint16_t   raw[ZONE_COUNT];          /**< 12-bit ADC code */
+    float      t_meas_c[ZONE_COUNT];     /**< filtered temperature */
+    float      pwm[ZONE_COUNT];          /**< heater duty [%] */
+    bool       in_range[ZONE_COUNT];
+    bool       alarm[ZONE_COUNT];
+    bool       fan_req[ZONE_COUNT];      /**< fan hysteresis state; one fan serves all zones */
+} zone_table_t;
+
+/**
+ * @brief Load wiring, limits and default setpoints from config.h.
+ *
+ * Must run before the modules that keep state in the table are
+ * initialised (Temperature_Init(), Control_Init()).
+ */
+void Zone_Init(void);
+
+zone_table_t *Zone_Table(void);
+
+#endif /* INC_ZONE_H_ */
@@ -0,0 +1,131 @@
+/**
+ * @file adc_sampler.c
+ * @brief Implementation of DMA-based ADC acquisition and decimation.
+ *
+ * The DMA buffer holds ADCS_DMA_FRAMES conversion sequences and runs in
+ * circular mode. The half-transfer and transfer-complete interrupts hand
+ * the half that is not being written to ADCS_ProcessBlock().
+ *
+ * Averaging is done with an integer accumulator per channel and a shift,
+ * so the oversampling ratio is restricted to powers of two.
+ */
+
+#include "adc_sampler.h"
+#include "main.h"
+#include "memmap.h"
+#include <stddef.h>
+
+#define ADCS_DMA_FRAMES  64U
+#define ADCS_DMA_LEN     (ADCS_DMA_FRAMES * ADCS_NUM_CH)
+
+extern ADC_HandleTypeDef hadc1;
+
+static uint16_t dma_buf[ADCS_DMA_LEN] DMA_BUFFER;
+
+static uint32_t acc[ADCS_NUM_CH] DTCM_DATA;
+static uint32_t acc_count DTCM_DATA = 0;
+static uint32_t os_ratio  DTCM_DATA = ADCS_OVERSAMPLE_MIN;
+static uint32_t os_shift  DTCM_DATA = 4;
+
+static volatile uint16_t latest_q4[ADCS_NUM_CH] DTCM_DATA;
+static volatile uint32_t latest_seq DTCM_DATA = 0;
+
+void ADCS_Init(uint32_t oversample)
+{
+    if (oversample < ADCS_OVERSAMPLE_MIN) oversample = ADCS_OVERSAMPLE_MIN;
+    if (oversample > ADCS_OVERSAMPLE_MAX) oversample = ADCS_OVERSAMPLE_MAX;
+
+    os_shift = 0;
+    while ((2UL << os_shift) <= oversample) os_shift++;
+    os_ratio = 1UL << os_shift;
+
+    for (uint32_t ch = 0; ch < ADCS_NUM_CH; ch++) {
+        acc[ch] = 0;
+        latest_q4[ch] = 0;
+    }
+    acc_count  = 0;
+    latest_seq = 0;
+}
+
+bool ADCS_Start(void)
+{
+    return HAL_ADC_Start_DMA(&hadc1, (uint32_t *)dma_buf, ADCS_DMA_LEN) == HAL_OK;
+}
+
+ITCM_CODE void ADCS_ProcessBlock(const uint16_t *samples, uint32_t count)
+{
+    /* Sum of N 12-bit samples scaled to Q4: divide by N / 16. */
+    const uint32_t q4_shift = os_shift - 4U;
+    const uint32_t round    = (q4_shift > 0U) ? (1UL << (q4_shift - 1U)) : 0U;
+
+    for (uint32_t i = 0; i + ADCS_NUM_CH <= count; i += ADCS_NUM_CH) {
+        for (uint32_t ch = 0; ch < ADCS_NUM_CH; ch++) {
+            acc[ch] += samples[i + ch];
+        }
+
+        if (++acc_count < os_ratio) continue;
+
+        for (uint32_t ch = 0; ch < ADCS_NUM_CH; ch++) {
+            latest_q4[ch] = (uint16_t)((acc[ch] + round) >> q4_shift);
+            acc[ch] = 0;
+        }
+        acc_count = 0;
+        /* 0 means "no value yet": skip it when the count wraps (after
+           about 40 days at the fastest rate). */
+        if (++latest_seq == 0U) latest_seq = 1U;
+    }
+}
+
+bool ADCS_GetLatest(uint8_t ch, adcs_sample_t *out)
+{
+    if (ch >= ADCS_NUM_CH || out == NULL) return false;
+
+    uint32_t seq;
+    uint16_t q4;
+    do {
+        seq = latest_seq;
+        q4  = latest_q4[ch];
+    } while (seq != latest_seq);
+
+    if (seq == 0U) return false;
+
+    uint32_t raw = (q4 + 8U) >> 4;
+    if (raw > 4095U) raw = 4095U;
+
+    out->raw    = (uint16_t)raw;
+    out->raw_q4 = q4;
+    out->seq    = seq;
+    return true;
+}
+
+ITCM_CODE uint32_t ADCS_GetLatestAll(uint16_t q4[ADCS_NUM_CH])
+{
+    uint32_t seq;
+    do {
+        seq = latest_seq;
+        for (uint32_t ch = 0; ch < ADCS_NUM_CH; ch++) {
+            q4[ch] = latest_q4[ch];
+        }
+    } while (seq != latest_seq);
+
+    return seq;
+}
+
+uint32_t ADCS_GetOversample(void)
+{
+    return os_ratio;
+}
+
+/* ===================== DMA callbacks ===================== */
+
+ITCM_CODE void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc)
+{
+    if (hadc != &hadc1) return;
+    ADCS_ProcessBlock(&dma_buf[0], ADCS_DMA_LEN / 2U);
+}
+
+ITCM_CODE void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
+{
+    if (hadc != &hadc1) return;
+    ADCS_ProcessBlock(&dma_buf[ADCS_DMA_LEN / 2U], ADCS_DMA_LEN / 2U);
+}
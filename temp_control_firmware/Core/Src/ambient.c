@@ -0,0 +1,111 @@
+/**
+ * @file ambient.c
+ * @brief Ambient temperature estimate implementation.
+ *
+ * The sensor is converted once per task call: the result of the
+ * conversion started in the previous call is read (JEOC set), then the
+ * next one is started. No interrupt is involved and the task never waits
+ * for the ADC.
+ *
+ * Conversion with the calibration values, for a reference voltage of
+ * ADC_VREF instead of the 3.3 V used at calibration:
+ *
+ *   T = 30 + (raw * ADC_VREF / 3.3 - TS_CAL1) * (110 - 30) / (TS_CAL2 - TS_CAL1)
+ *
+ * The die temperature changes slowly; a first-order filter with a time
+ * constant of about ten task periods removes the conversion noise.
+ */
+
+#include "ambient.h"
+#include "config.h"
+#include "main.h"
+#include "memmap.h"
+
+extern ADC_HandleTypeDef hadc1;
+
+#define AMB_CAL1_C      30.0f
+#define AMB_CAL2_C      110.0f
+#define AMB_CAL_VREF    3.3f
+#define AMB_FILTER_A    0.1f
+#define AMB_DIE_MIN_C   (-40.0f)   /* sensor operating range */
+#define AMB_DIE_MAX_C   125.0f
+
+static ambient_src_t src     = AMBIENT_SRC_FIXED;
+static float         fixed_c = AMBIENT_FIXED_C;
+static float         mcu_c   = AMBIENT_FIXED_C;
+static bool          mcu_valid = false;
+static bool          started = false;
+
+static float sensor_to_c(uint32_t raw)
+{
+    float cal1 = (float)*TEMPSENSOR_CAL1_ADDR_CMSIS;
+    float cal2 = (float)*TEMPSENSOR_CAL2_ADDR_CMSIS;
+    float code = (float)raw * (ADC_VREF / AMB_CAL_VREF);
+
+    return AMB_CAL1_C + (code - cal1) * (AMB_CAL2_C - AMB_CAL1_C) / (cal2 - cal1);
+}
+
+void Ambient_Init(void)
+{
+    ADC_InjectionConfTypeDef inj = {0};
+    inj.InjectedChannel               = ADC_CHANNEL_TEMPSENSOR;
+    inj.InjectedRank                  = ADC_INJECTED_RANK_1;
+    inj.InjectedNbrOfConversion       = 1;
+    inj.InjectedSamplingTime          = ADC_SAMPLETIME_480CYCLES;
+    inj.ExternalTrigInjecConv         = ADC_INJECTED_SOFTWARE_START;
+    inj.ExternalTrigInjecConvEdge     = ADC_EXTERNALTRIGINJECCONVEDGE_NONE;
+    inj.AutoInjectedConv              = DISABLE;
+    inj.InjectedDiscontinuousConvMode = DISABLE;
+    inj.InjectedOffset                = 0;
+
+    src       = AMBIENT_USE_MCU ? AMBIENT_SRC_MCU : AMBIENT_SRC_FIXED;
+    fixed_c   = AMBIENT_FIXED_C;
+    mcu_c     = AMBIENT_FIXED_C;
+    mcu_valid = false;
+    started   = false;
+
+    if (HAL_ADCEx_InjectedConfigChannel(&hadc1, &inj) != HAL_OK) {
+        Error_Handler();
+    }
+}
+
+void Ambient_Task(void)
+{
+    if (started && __HAL_ADC_GET_FLAG(&hadc1, ADC_FLAG_JEOC)) {
+        float t = sensor_to_c(HAL_ADCEx_InjectedGetValue(&hadc1, ADC_INJECTED_RANK_1)) -
+                  AMBIENT_MCU_OFFSET_C;
+
+        if (t >= AMB_DIE_MIN_C && t <= AMB_DIE_MAX_C) {
+            if (mcu_valid) {
+                mcu_c += AMB_FILTER_A * (t - mcu_c);
+            } else {
+                mcu_c = t;
+                mcu_valid = true;
+            }
+        }
+    }
+
+    /* Keeps converting with the fixed source, so switching is immediate. */
+    started = (HAL_ADCEx_InjectedStart(&hadc1) == HAL_OK);
+}
+
+ITCM_CODE float Ambient_GetC(void)
+{
+    return (src == AMBIENT_SRC_MCU && mcu_valid) ? mcu_c : fixed_c;
+}
+
+void Ambient_SetFixedC(float t_c)
+{
+    fixed_c = t_c;
+    src = AMBIENT_SRC_FIXED;
+}
+
+void Ambient_SetSource(ambient_src_t s)
+{
+    src = s;
+}
+
+ambient_src_t Ambient_GetSource(void)
+{
+    return src;
+}
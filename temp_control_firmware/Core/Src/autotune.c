@@ -0,0 +1,264 @@
+/**
+ * @file autotune.c
+ * @brief Relay autotuner implementation.
+ *
+ * Time is counted in control steps. A limit cycle runs from one switch
+ * of the relay to the high level to the next:
+ *
+ *   t_up: relay high -> T_meas falls for L more, minimum at t_up + L
+ *   t_down: relay low -> T_meas rises for L more, maximum at t_down + L
+ *
+ * so both extremes and both switch-to-peak times are found inside one
+ * cycle. The first cycle starts from whatever state the loop was in and
+ * is not used for the estimate; until the first switch to high the relay
+ * uses the full output range to reach the setpoint.
+ *
+ * The relay step d is AUTOTUNE_RELAY_D, reduced near the ends of the
+ * output range so that bias +- d stays inside 0..100 %.
+ */
+
+#include "autotune.h"
+#include "config.h"
+#include "control.h"
+#include "memmap.h"
+#include "zone.h"
+
+#include <math.h>
+#include <string.h>
+
+#define AT_PI  3.14159265f
+
+static at_result_t res;
+
+static struct {
+    uint32_t tick;       /* control steps since the start */
+    bool     started;    /* first up switch seen, a cycle is being measured */
+    bool     high;       /* relay level */
+    bool     apply;      /* gains computed, hand over on the next step */
+    float    bias;       /* [%] */
+    float    d;          /* relay step [%] */
+    float    y_max, y_min;
+    uint32_t t_max, t_min;
+    uint32_t t_up, t_down;
+    float    u_sum;
+    uint32_t u_n;
+    bool     have_prev;
+    float    prev_pu, prev_amp, prev_dead;
+} at;
+
+static float clampf(float x, float lo, float hi)
+{
+    if (x < lo) return lo;
+    if (x > hi) return hi;
+    return x;
+}
+
+static void set_bias(float bias)
+{
+    float room = fminf(bias, 100.0f - bias);
+
+    at.d    = clampf(room, AUTOTUNE_RELAY_D_MIN, AUTOTUNE_RELAY_D);
+    at.bias = clampf(bias, at.d, 100.0f - at.d);
+}
+
+/*
+ * First-order-plus-dead-time model through the ultimate point. The
+ * process phase at wu is -pi + asin(h/a) (phase of the relay with
+ * hysteresis), of which wu*L is dead time; the rest is the lag.
+ */
+static bool simc_gains(float ku, float pu, float amp, float dead, float *kp, float *ti)
+{
+    if (!(dead > 0.0f)) return false;
+
+    float wu  = 2.0f * AT_PI / pu;
+    float lag = AT_PI - asinf(AUTOTUNE_HYST_C / amp) - wu * dead;
+    float tau;
+
+    if (lag <= 0.0f) return false;
+    if (lag >= 0.5f * AT_PI - 0.01f) {
+        tau = 50.0f * dead;                   /* lag dominant: near integrating */
+    } else {
+        tau = tanf(lag) / wu;
+    }
+    float k = sqrtf(1.0f + (wu * tau) * (wu * tau)) / ku;
+
+    *kp = tau / (k * 2.0f * dead);
+    *ti = fminf(tau, 8.0f * dead);
+    return true;
+}
+
+static bool compute_gains(void)
+{
+    float amp = res.amp_c;
+    float h   = AUTOTUNE_HYST_C;
+    float ti;
+
+    if (amp <= h) return false;               /* cycle lost in the hysteresis */
+
+    res.ku = 4.0f * at.d / (AT_PI * sqrtf(amp * amp - h * h));
+
+    switch (res.rule) {
+    case AT_RULE_ZN:
+        res.kp = 0.45f * res.ku;
+        ti     = res.pu_s / 1.2f;
+        break;
+    case AT_RULE_TL:
+        res.kp = res.ku / 3.2f;
+        ti     = 2.2f * res.pu_s;
+        break;
+    case AT_RULE_SIMC:
+        if (!simc_gains(res.ku, res.pu_s, amp, res.dead_s, &res.kp, &ti)) return false;
+        break;
+    default:
+        return false;
+    }
+
+    res.ki = res.kp / ti;
+    return isfinite(res.kp) && isfinite(res.ki) && res.kp > 0.0f && res.ki > 0.0f;
+}
+
+static void stop(at_state_t state)
+{
+    pid_ctrl_t *pid = Control_GetPID(res.zone);
+
+    if (state == AT_DONE) {
+        zone_table_t *zt = Zone_Table();
+        zt->kp[res.zone] = res.kp;
+        zt->ki[res.zone] = res.ki;
+
+        PID_SetGains(pid, res.kp, res.ki, pid->p.kd);
+        pid->p.tt_s = res.kp / res.ki;
+    }
+    /* The integrator tracked the manual output: bumpless return. */
+    PID_SetMode(pid, PID_MODE_AUTO);
+    res.state = state;
+}
+
+/* A relay switch to high closes a cycle. */
+static void end_cycle(void)
+{
+    const float ts = CONTROL_TS_S;
+    float pu   = (float)(at.tick - at.t_up) * ts;
+    float amp  = 0.5f * (at.y_max - at.y_min);
+    int32_t lo = (int32_t)(at.t_min - at.t_up);
+    int32_t hi = (int32_t)(at.t_max - at.t_down);   /* < 0 if noise peaked before the switch */
+    float dead = 0.5f * (float)((lo > 0 ? lo : 0) + (hi > 0 ? hi : 0)) * ts;
+
+    /* Equal half cycles at the mean output of the last one. */
+    set_bias(at.u_sum / (float)at.u_n);
+    res.cycles++;
+
+    if (res.cycles == 1U) return;             /* start-up transient */
+
+    if (at.have_prev &&
+        fabsf(pu - at.prev_pu)   <= 0.05f * at.prev_pu &&
+        fabsf(amp - at.prev_amp) <= 0.10f * at.prev_amp) {
+        res.pu_s   = 0.5f * (pu + at.prev_pu);
+        res.amp_c  = 0.5f * (amp + at.prev_amp);
+        res.dead_s = 0.5f * (dead + at.prev_dead);
+
+        if (compute_gains()) {
+            at.apply = true;
+        } else {
+            stop(AT_FAILED);
+        }
+        return;
+    }
+
+    at.have_prev = true;
+    at.prev_pu   = pu;
+    at.prev_amp  = amp;
+    at.prev_dead = dead;
+}
+
+bool Autotune_Start(uint8_t zone, at_rule_t rule)
+{
+    if (zone >= ZONE_COUNT || rule > AT_RULE_SIMC || res.state == AT_RUNNING) return false;
+
+    pid_ctrl_t *pid = Control_GetPID(zone);
+
+    memset(&res, 0, sizeof(res));
+    memset(&at, 0, sizeof(at));
+    res.state = AT_RUNNING;
+    res.zone  = zone;
+    res.rule  = rule;
+    at.high   = true;
+    set_bias(pid->u);
+
+    PID_SetMode(pid, PID_MODE_MANUAL);
+    return true;
+}
+
+void Autotune_Abort(uint8_t zone)
+{
+    if (Autotune_IsRunning(zone)) {
+        stop(AT_ABORTED);
+    }
+}
+
+bool Autotune_IsRunning(uint8_t zone)
+{
+    return res.state == AT_RUNNING && res.zone == zone;
+}
+
+ITCM_CODE void Autotune_Update(uint8_t zone, float ref_c, float meas_c)
+{
+    if (!Autotune_IsRunning(zone)) return;
+
+    pid_ctrl_t *pid = Control_GetPID(zone);
+
+    if (at.apply) {
+        stop(AT_DONE);
+        return;
+    }
+
+    if ((float)at.tick * CONTROL_TS_S > AUTOTUNE_TIMEOUT_S ||
+        res.cycles > AUTOTUNE_MAX_CYCLES) {
+        stop(AT_FAILED);
+        return;
+    }
+
+    float e = meas_c - ref_c;
+
+    if (at.high && e > AUTOTUNE_HYST_C) {
+        at.high   = false;
+        at.t_down = at.tick;
+    } else if (!at.high && e < -AUTOTUNE_HYST_C) {
+        at.high = true;
+        if (at.started) {
+            end_cycle();
+            if (res.state != AT_RUNNING) return;
+        }
+        at.started = true;
+        at.t_up    = at.tick;
+        at.y_max   = meas_c;
+        at.y_min   = meas_c;
+        at.t_max   = at.tick;
+        at.t_min   = at.tick;
+        at.u_sum   = 0.0f;
+        at.u_n     = 0;
+    }
+
+    if (meas_c > at.y_max) { at.y_max = meas_c; at.t_max = at.tick; }
+    if (meas_c < at.y_min) { at.y_min = meas_c; at.t_min = at.tick; }
+
+    float u;
+    if (at.apply) {
+        u = at.bias;                          /* hold the operating point for the handover */
+    } else if (!at.started) {
+        u = at.high ? 100.0f : 0.0f;
+    } else {
+        u = at.bias + (at.high ? at.d : -at.d);
+    }
+
+    at.u_sum += u;
+    at.u_n++;
+    at.tick++;
+
+    PID_SetManual(pid, u);
+}
+
+const at_result_t *Autotune_GetResult(void)
+{
+    return &res;
+}
@@ -5,35 +5,227 @@
  * This module implements a discrete-time PI (or PID) controller used to
  * regulate the temperature of the heating element. The controller output
  * is limited to a safe range suitable for PWM control.
+ *
+ * The algorithm itself lives in pid.c; this module configures the
+ * controller of each zone (pid[] column of the zone table) from config.h
+ * and the zone gains, and lets a running autotune session (autotune.h)
+ * drive the output. The plant identification of the zone (ident.h) is
+ * fed with every output and measurement, also while the zone is held
+ * off in alarm (Control_Hold()).
+ *
+ * Model-based feed-forward (ff_enable[] of the zone): the duty that
+ * holds a first-order plant at the reference,
+ *
+ *   u_ff = (T_m - T_amb) / K + tau / K * dT_m/dt
+ *
+ * is added to the PI output, where T_m is a reference model that moves
+ * toward T_ref with time constant FF_TC_S:
+ *
+ *   dT_m/dt = (T_ref - T_m) / FF_TC_S
+ *
+ * u_ff is limited to the output range and T_m is then advanced with the
+ * plant model driven by the limited u_ff, so T_m is the response the
+ * feed-forward alone would produce. The PI controls T_meas to T_m, not to
+ * T_ref: with a correct model its error stays near zero through a
+ * setpoint step and the integrator does not wind up on the transient;
+ * it only covers the model error.
+ *
+ * With FF_TC_S = tau the feed-forward is the static steady-state duty
+ * (T_ref - T_amb) / K and T_m is the open-loop plant response; FF_TC_S
+ * <= 0 applies the static duty with the PI on T_ref directly. K and tau
+ * are the identified model once it is valid, else FF_K_C_PER_PCT and
+ * FF_TAU_S; T_amb comes from ambient.h.
+ *
+ * Smith predictor (smith.h): the model of every zone runs each step and
+ * keeps its residual up to date; with smith_enable[] the PI is closed on
+ * the predicted undelayed temperature instead of T_meas. Autotune and
+ * identification always see T_meas.
  */
 
 #include "control.h"
+#include "ambient.h"
+#include "autotune.h"
 #include "config.h"
+#include "memmap.h"
+#include "setpoint.h"
+#include "zone.h"
+
+#include <math.h>
+
+ITCM_CODE static float clampf(float x, float lo, float hi)
+{
+    if (x < lo) return lo;
+    if (x > hi) return hi;
+    return x;
+}
+
+/* Plant model used by the feed-forward. */
+ITCM_CODE static void ff_model(uint8_t zone, float *k, float *tau)
+{
+    const ident_model_t *m = Ident_GetModel(&Zone_Table()->ident[zone]);
+    const bool valid = (m->flags & IDENT_VALID) != 0U;
+
+    *k   = valid ? m->k_c_per_pct : FF_K_C_PER_PCT;
+    *tau = valid ? m->tau_s : FF_TAU_S;
+}
+
+ITCM_CODE static float ff_duty(float t_m, float ref_c, float amb, float k, float tau)
+{
+    float u = (t_m - amb) / k;
+
+    if (FF_TC_S > 0.0f) u += tau / k * (ref_c - t_m) / FF_TC_S;
+    return clampf(u, 0.0f, 100.0f);
+}
+
+/*
+ * Set the feed-forward of the step and advance the reference model.
+ * @return Reference for the PI.
+ */
+ITCM_CODE static float ff_step(uint8_t zone, float ref_c)
+{
+    zone_table_t *zt = Zone_Table();
+    pid_ctrl_t *pid = &zt->pid[zone];
+    const float amb = Ambient_GetC();
+    float k, tau;
+
+    if (!(FF_TC_S > 0.0f)) zt->ff_ref_c[zone] = ref_c;
+    const float t_m = zt->ff_ref_c[zone];
+
+    ff_model(zone, &k, &tau);
+    const float u = ff_duty(t_m, ref_c, amb, k, tau);
+
+    if (k != zt->ff_k[zone] || tau != zt->ff_tau[zone]) {
+        /* New model (once per identification block): the integrator
+           takes the change in duty, the output does not step. */
+        PID_SetFeedForward(pid, ff_duty(t_m, ref_c, amb, zt->ff_k[zone], zt->ff_tau[zone]));
+        PID_SetFeedForwardBumpless(pid, u);
+        zt->ff_k[zone]   = k;
+        zt->ff_tau[zone] = tau;
+    } else {
+        PID_SetFeedForward(pid, u);
+    }
+
+    if (FF_TC_S > 0.0f) {
+        /* Exact step of the first-order model with u held over the period. */
+        zt->ff_ref_c[zone] = t_m + (1.0f - expf(-CONTROL_TS_S / tau)) * (k * u + amb - t_m);
+    }
+    return t_m;
+}
+
+void Control_Init(uint8_t zone)
+{
+    if (zone >= ZONE_COUNT) return;
+    Autotune_Abort(zone);
+
+    const zone_table_t *zt = Zone_Table();
+    const float kp = zt->kp[zone];
+    const float ki = zt->ki[zone];
+    const pid_params_t params = {
+        .kp       = kp,
+        .ki       = ki,
+        .kd       = KD,
+        .ts_s     = CONTROL_TS_S,
+        .b        = PID_SP_WEIGHT_B,
+        .c        = 0.0f,
+        .tf_s     = PID_TF_S,
+        .tt_s     = (ki > 0.0f) ? kp / ki : PID_TT_S,
+        .out_min  = 0.0f,
+        .out_max  = 100.0f,
+        .rate_max = PID_RATE_MAX,
+    };
 
-static float integ = 0.0f;
+    PID_Init(&Zone_Table()->pid[zone], &params);
+    Ident_Init(&Zone_Table()->ident[zone]);
 
-void Control_Init(void)
+    smith_model_t sm = zt->smith[zone].m;
+    if (!Smith_Init(&Zone_Table()->smith[zone], &sm, 0.0f)) {
+        Zone_Table()->smith_enable[zone] = false;
+    }
+}
+
+void Control_Reset(uint8_t zone)
 {
-    integ = 0.0f;
+    if (zone >= ZONE_COUNT) return;
+
+    Autotune_Abort(zone);
+    PID_Reset(&Zone_Table()->pid[zone]);
 }
 
-float Control_Update(float ref_c, float meas_c)
+void Control_Hold(uint8_t zone, float meas_c, bool meas_ok)
 {
-    float e = ref_c - meas_c;
+    if (zone >= ZONE_COUNT) return;
 
-    float u_unsat = KP * e + KI * integ;
+    zone_table_t *zt = Zone_Table();
 
-    float u = u_unsat;
-    if (u < 0.0f)   u = 0.0f;
-    if (u > 100.0f) u = 100.0f;
+    if (meas_ok) {
+        /* The heater is off: the models see the step the plant sees. */
+        (void)Smith_Feedback(&zt->smith[zone], meas_c, Ambient_GetC());
+        Smith_Update(&zt->smith[zone], 0.0f);
+        Ident_Update(&zt->ident[zone], 0.0f, meas_c);
+    } else {
+        /* No usable sample: the history has a gap, start both over. */
+        Ident_Init(&zt->ident[zone]);
+        Smith_Reset(&zt->smith[zone], 0.0f);
+    }
+}
+
+ITCM_CODE float Control_Update(uint8_t zone, float ref_c, float meas_c)
+{
+    if (zone >= ZONE_COUNT) return 0.0f;
 
-    bool sat_high = (u >= 100.0f) && (e > 0.0f);
-    bool sat_low  = (u <= 0.0f)   && (e < 0.0f);
+    zone_table_t *zt = Zone_Table();
+    pid_ctrl_t *pid = &zt->pid[zone];
+    float pid_ref = ref_c;
 
-    if (!(sat_high || sat_low))
-    {
-        integ += e * CONTROL_TS_S;
+    Autotune_Update(zone, ref_c, meas_c);
+    if (zt->ff_enable[zone]) {
+        /* The model starts where the plant is. */
+        if (!pid->started) zt->ff_ref_c[zone] = meas_c;
+        pid_ref = ff_step(zone, ref_c);
     }
 
+    float fb = Smith_Feedback(&zt->smith[zone], meas_c, Ambient_GetC());
+    if (!zt->smith_enable[zone]) fb = meas_c;
+
+    float u = PID_Update(pid, pid_ref, fb);
+    Smith_Update(&zt->smith[zone], u);
+    Ident_Update(&zt->ident[zone], u, meas_c);
     return u;
 }
+
+void Control_SetFeedForward(uint8_t zone, bool enable)
+{
+    if (zone >= ZONE_COUNT) return;
+
+    zone_table_t *zt = Zone_Table();
+    const float ref_c = Setpoint_GetC(zone);
+    float u_ff = 0.0f;
+
+    zt->ff_enable[zone] = enable;
+    if (enable) {
+        /* Model at the setpoint: the P term keeps its input. */
+        ff_model(zone, &zt->ff_k[zone], &zt->ff_tau[zone]);
+        zt->ff_ref_c[zone] = ref_c;
+        u_ff = ff_duty(ref_c, ref_c, Ambient_GetC(), zt->ff_k[zone], zt->ff_tau[zone]);
+    }
+    PID_SetFeedForwardBumpless(Control_GetPID(zone), u_ff);
+}
+
+void Control_SetSmith(uint8_t zone, bool enable)
+{
+    if (zone < ZONE_COUNT) Zone_Table()->smith_enable[zone] = enable;
+}
+
+bool Control_SetSmithModel(uint8_t zone, const smith_model_t *model)
+{
+    if (zone >= ZONE_COUNT) return false;
+
+    /* Restarted at the current output, as if the plant had settled there. */
+    return Smith_Init(&Zone_Table()->smith[zone], model, Control_GetPID(zone)->u);
+}
+
+ITCM_CODE pid_ctrl_t *Control_GetPID(uint8_t zone)
+{
+    zone_table_t *zt = Zone_Table();
+    return (zone < ZONE_COUNT) ? &zt->pid[zone] : &zt->pid[0];
+}
@@ -0,0 +1,16 @@
+/**
+ * @file crc32.c
+ * @brief CRC-32 calculation on the hardware CRC unit.
+ */
+
+#include "crc32.h"
+#include "main.h"
+
+extern CRC_HandleTypeDef hcrc;
+
+uint32_t CRC32_Compute(const void *data, size_t len)
+{
+    /* InputDataFormat is bytes, so the length is a byte count and the
+       buffer does not need to be word aligned. */
+    return HAL_CRC_Calculate(&hcrc, (uint32_t *)(uintptr_t)data, (uint32_t)len);
+}
@@ -12,8 +12,17 @@
  */
 #include "fan.h"
 #include "main.h"
-void Fan_Set(bool on)
+#include "memmap.h"
+#include "trace.h"
+
+static bool fan_on = false;
+
+ITCM_CODE void Fan_Set(bool on)
 {
+    if (on != fan_on) {
+        fan_on = on;
+        Trace_Record(TRACE_EV_FAN, on ? 1U : 0U);
+    }
     HAL_GPIO_WritePin(FAN_GPIO_Port, FAN_Pin,
                       on ? GPIO_PIN_SET : GPIO_PIN_RESET);
 }
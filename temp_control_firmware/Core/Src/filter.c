@@ -0,0 +1,206 @@
+/**
+ * @file filter.c
+ * @brief Implementation of the measurement filters.
+ *
+ * The moving average keeps a running sum. Float rounding errors of the
+ * add/subtract updates would slowly accumulate, so the sum is rebuilt
+ * from the window once per wrap of the ring index (amortised O(1)).
+ *
+ * The median keeps the window both in arrival order and sorted; an
+ * update removes the oldest value from the sorted copy and inserts the
+ * new one, which costs O(N) moves for the small N used here.
+ */
+
+#include "filter.h"
+#include "memmap.h"
+#include <math.h>
+#include <string.h>
+
+void Filter_InitNone(filter_t *f)
+{
+    memset(f, 0, sizeof(*f));
+    f->type = FILTER_NONE;
+}
+
+void Filter_InitMA(filter_t *f, uint8_t n)
+{
+    memset(f, 0, sizeof(*f));
+    if (n < 1U) n = 1U;
+    if (n > FILTER_MA_MAX_N) n = FILTER_MA_MAX_N;
+    f->type = FILTER_MA;
+    f->s.ma.n = n;
+}
+
+void Filter_InitEMA(filter_t *f, float alpha)
+{
+    memset(f, 0, sizeof(*f));
+    if (!(alpha > 0.0f)) alpha = 1.0f;
+    if (alpha > 1.0f) alpha = 1.0f;
+    f->type = FILTER_EMA;
+    f->s.ema.alpha = alpha;
+}
+
+void Filter_InitMedian(filter_t *f, uint8_t n)
+{
+    memset(f, 0, sizeof(*f));
+    if (n < 1U) n = 1U;
+    if (n > FILTER_MEDIAN_MAX_N) n = FILTER_MEDIAN_MAX_N;
+    if ((n & 1U) == 0U) n--;
+    f->type = FILTER_MEDIAN;
+    f->s.med.n = n;
+}
+
+void Filter_InitKalman(filter_t *f, float q, float r)
+{
+    memset(f, 0, sizeof(*f));
+    if (!(q > 0.0f)) q = 1e-6f;
+    if (!(r > 0.0f)) r = 1.0f;
+    f->type = FILTER_KALMAN;
+    f->s.kf.q = q;
+    f->s.kf.r = r;
+}
+
+void Filter_Reset(filter_t *f)
+{
+    switch (f->type) {
+    case FILTER_MA:     Filter_InitMA(f, f->s.ma.n);                  break;
+    case FILTER_EMA:    Filter_InitEMA(f, f->s.ema.alpha);            break;
+    case FILTER_MEDIAN: Filter_InitMedian(f, f->s.med.n);             break;
+    case FILTER_KALMAN: Filter_InitKalman(f, f->s.kf.q, f->s.kf.r);   break;
+    default:            Filter_InitNone(f);                           break;
+    }
+}
+
+/* ===================== Moving average ===================== */
+
+ITCM_CODE static float ma_update(filter_t *f, float x)
+{
+    uint8_t n = f->s.ma.n;
+    float old = f->s.ma.buf[f->s.ma.idx];
+
+    f->s.ma.buf[f->s.ma.idx] = x;
+    f->s.ma.idx++;
+
+    if (f->s.ma.filled < n) {
+        f->s.ma.filled++;
+        f->s.ma.sum += x;
+    } else {
+        f->s.ma.sum += x - old;
+    }
+
+    if (f->s.ma.idx >= n) {
+        f->s.ma.idx = 0;
+
+        float sum = 0.0f;
+        for (uint8_t i = 0; i < n; i++) sum += f->s.ma.buf[i];
+        f->s.ma.sum = sum;
+    }
+
+    return f->s.ma.sum / (float)f->s.ma.filled;
+}
+
+/* ===================== Median ===================== */
+
+ITCM_CODE static float median_update(filter_t *f, float x)
+{
+    uint8_t n = f->s.med.n;
+    uint8_t len = f->s.med.filled;
+    float *srt = f->s.med.sorted;
+
+    if (len == n) {
+        /* Remove the oldest sample from the sorted window. */
+        float old = f->s.med.buf[f->s.med.idx];
+        uint8_t i = 0;
+        while (i < len - 1U && srt[i] != old) i++;
+        for (; i < len - 1U; i++) srt[i] = srt[i + 1U];
+        len--;
+    }
+
+    /* Insert the new sample. */
+    uint8_t j = len;
+    while (j > 0U && srt[j - 1U] > x) {
+        srt[j] = srt[j - 1U];
+        j--;
+    }
+    srt[j] = x;
+    len++;
+
+    f->s.med.buf[f->s.med.idx] = x;
+    f->s.med.idx = (uint8_t)((f->s.med.idx + 1U) % n);
+    f->s.med.filled = len;
+
+    if (len & 1U) return srt[len / 2U];
+    return 0.5f * (srt[len / 2U - 1U] + srt[len / 2U]);
+}
+
+/* ===================== Kalman ===================== */
+
+ITCM_CODE static float kalman_update(filter_t *f, float z)
+{
+    if (!f->s.kf.init) {
+        f->s.kf.x = z;
+        f->s.kf.p = f->s.kf.r;
+        f->s.kf.init = true;
+        return z;
+    }
+
+    float p = f->s.kf.p + f->s.kf.q;
+    float k = p / (p + f->s.kf.r);
+
+    f->s.kf.x += k * (z - f->s.kf.x);
+    f->s.kf.p = (1.0f - k) * p;
+
+    return f->s.kf.x;
+}
+
+ITCM_CODE float Filter_Update(filter_t *f, float x)
+{
+    switch (f->type) {
+    case FILTER_MA:
+        return ma_update(f, x);
+
+    case FILTER_EMA:
+        if (!f->s.ema.init) {
+            f->s.ema.y = x;
+            f->s.ema.init = true;
+        } else {
+            f->s.ema.y += f->s.ema.alpha * (x - f->s.ema.y);
+        }
+        return f->s.ema.y;
+
+    case FILTER_MEDIAN:
+        return median_update(f, x);
+
+    case FILTER_KALMAN:
+        return kalman_update(f, x);
+
+    default:
+        return x;
+    }
+}
+
+float Filter_GroupDelay(const filter_t *f)
+{
+    switch (f->type) {
+    case FILTER_MA:
+        return 0.5f * (float)(f->s.ma.n - 1U);
+
+    case FILTER_EMA:
+        return (1.0f - f->s.ema.alpha) / f->s.ema.alpha;
+
+    case FILTER_MEDIAN:
+        return 0.5f * (float)(f->s.med.n - 1U);
+
+    case FILTER_KALMAN: {
+        /* Steady-state gain of the random-walk model behaves like an EMA. */
+        float q = f->s.kf.q;
+        float r = f->s.kf.r;
+        float p = 0.5f * (q + sqrtf(q * q + 4.0f * q * r));
+        float k = p / (p + r);
+        return (1.0f - k) / k;
+    }
+
+    default:
+        return 0.0f;
+    }
+}
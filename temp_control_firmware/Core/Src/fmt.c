@@ -0,0 +1,162 @@
+/**
+ * @file fmt.c
+ * @brief Implementation of the number formatter.
+ *
+ * A finite float is M * 2^e with a 24-bit integer M. For e < 0 the value
+ * scaled by 10^decimals is M * 10^d / 2^-e; the quotient is the rounded
+ * fixed-point result and the remainder decides the rounding exactly.
+ * With d <= 6 the numerator stays below 2^44, so uint64_t is enough.
+ *
+ * For e >= 0 the value is an integer. Up to 2^63 it is printed from a
+ * uint64_t, beyond that (|v| >= 2^63, up to FLT_MAX ~ 2^128) a small
+ * multi-word integer is divided down in chunks of 10^9.
+ */
+
+#include "fmt.h"
+#include <stdbool.h>
+#include <string.h>
+
+static const uint32_t pow10_u32[FMT_MAX_DECIMALS + 1U] = {
+    1U, 10U, 100U, 1000U, 10000U, 100000U, 1000000U
+};
+
+/* Write the digits of v into dst, at least min_digits (zero padded). */
+static uint8_t put_u64(char *dst, uint64_t v, uint8_t min_digits)
+{
+    char tmp[20];
+    uint8_t n = 0;
+
+    /* Split so the loop runs on 32-bit divisions on the M7. */
+    while (v > 0xFFFFFFFFULL) {
+        uint32_t lo = (uint32_t)(v % 1000000000ULL);
+        v /= 1000000000ULL;
+        for (uint8_t i = 0; i < 9U; i++) {
+            tmp[n++] = (char)('0' + lo % 10U);
+            lo /= 10U;
+        }
+    }
+
+    uint32_t v32 = (uint32_t)v;
+    do {
+        tmp[n++] = (char)('0' + v32 % 10U);
+        v32 /= 10U;
+    } while (v32 != 0U);
+
+    while (n < min_digits) tmp[n++] = '0';
+
+    for (uint8_t i = 0; i < n; i++) dst[i] = tmp[n - 1U - i];
+    return n;
+}
+
+/* Integer M * 2^e for e >= 40, up to 2^128: five 32-bit words. */
+static uint8_t put_big(char *dst, uint32_t m, int e)
+{
+    uint32_t w[5] = {0};
+    uint32_t chunks[5];
+    uint8_t  nchunks = 0;
+
+    /* w = m << e */
+    int word = e / 32;
+    int bit  = e % 32;
+    uint64_t sh = (uint64_t)m << bit;
+    w[word] = (uint32_t)sh;
+    if (word + 1 < 5) w[word + 1] = (uint32_t)(sh >> 32);
+
+    /* Repeated division by 10^9, most significant word first. */
+    int top = 4;
+    while (top >= 0) {
+        uint64_t rem = 0;
+        for (int i = top; i >= 0; i--) {
+            uint64_t cur = (rem << 32) | w[i];
+            w[i] = (uint32_t)(cur / 1000000000U);
+            rem  = cur % 1000000000U;
+        }
+        chunks[nchunks++] = (uint32_t)rem;
+        while (top >= 0 && w[top] == 0U) top--;
+    }
+
+    uint8_t n = put_u64(dst, chunks[nchunks - 1U], 1U);
+    for (int i = (int)nchunks - 2; i >= 0; i--) {
+        n = (uint8_t)(n + put_u64(&dst[n], chunks[i], 9U));
+    }
+    return n;
+}
+
+uint8_t FMT_Float(char *dst, float v, uint8_t decimals)
+{
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+
+    bool     neg  = (bits >> 31) != 0U;
+    uint32_t bexp = (bits >> 23) & 0xFFU;
+    uint32_t m    = bits & 0x7FFFFFU;
+    uint8_t  n    = 0;
+
+    if (decimals > FMT_MAX_DECIMALS) decimals = FMT_MAX_DECIMALS;
+
+    if (bexp == 0xFFU) {
+        /* newlib prints NaN without a sign. */
+        if (m != 0U) {
+            memcpy(dst, "nan", 3);
+            return 3;
+        }
+        if (neg) dst[n++] = '-';
+        memcpy(&dst[n], "inf", 3);
+        return (uint8_t)(n + 3U);
+    }
+
+    int e;
+    if (bexp == 0U) {
+        e = 1 - 150;          /* subnormal */
+    } else {
+        m |= 0x800000U;
+        e = (int)bexp - 150;
+    }
+
+    if (neg) dst[n++] = '-';
+
+    uint64_t q;
+    if (e >= 0) {
+        if (e < 40) {
+            n = (uint8_t)(n + put_u64(&dst[n], (uint64_t)m << e, 1U));
+        } else {
+            n = (uint8_t)(n + put_big(&dst[n], m, e));
+        }
+        q = 0;
+    } else {
+        uint64_t num = (uint64_t)m * pow10_u32[decimals];
+        int sh = -e;
+
+        if (sh >= 64) {
+            q = 0;            /* num < 2^44: below one half */
+        } else {
+            uint64_t rem  = num & ((1ULL << sh) - 1U);
+            uint64_t half = 1ULL << (sh - 1);
+            q = num >> sh;
+            if (rem > half || (rem == half && (q & 1U))) q++;
+        }
+
+        n = (uint8_t)(n + put_u64(&dst[n], q / pow10_u32[decimals], 1U));
+        q %= pow10_u32[decimals];
+    }
+
+    if (decimals > 0U) {
+        dst[n++] = '.';
+        n = (uint8_t)(n + put_u64(&dst[n], q, decimals));
+    }
+    return n;
+}
+
+uint8_t FMT_Uint(char *dst, uint32_t v)
+{
+    return put_u64(dst, v, 1U);
+}
+
+uint8_t FMT_Int(char *dst, int32_t v)
+{
+    if (v < 0) {
+        dst[0] = '-';
+        return (uint8_t)(1U + put_u64(&dst[1], (uint64_t)(-(int64_t)v), 1U));
+    }
+    return put_u64(dst, (uint64_t)v, 1U);
+}
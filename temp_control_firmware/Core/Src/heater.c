@@ -5,25 +5,35 @@
  * This module provides an interface for controlling the heating element
  * by adjusting the PWM duty cycle applied to the MOSFET transistor.
  * Output saturation is applied to ensure safe operation.
+ *
+ * Each zone drives one TIM1 channel (pwm_ch[] column of the zone table).
+ * All channels share the 20 kHz period of TIM1.
  */
 
 
 #include "heater.h"
 #include "main.h"
+#include "memmap.h"
+#include "zone.h"
 extern TIM_HandleTypeDef htim1;
 
 void Heater_Init(void)
 {
-  HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_1);
-  Heater_SetDutyPercent(0.0f);
+  const zone_table_t *zt = Zone_Table();
+
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+    Heater_SetDutyPercent(z, 0.0f);
+    HAL_TIM_PWM_Start(&htim1, zt->pwm_ch[z]);
+  }
 }
 
-void Heater_SetDutyPercent(float duty)
+ITCM_CODE void Heater_SetDutyPercent(uint8_t zone, float duty)
 {
+  if (zone >= ZONE_COUNT) return;
   if (duty < 0.0f) duty = 0.0f;
   if (duty > 100.0f) duty = 100.0f;
 
   uint32_t arr = __HAL_TIM_GET_AUTORELOAD(&htim1);
   uint32_t ccr = (uint32_t)((duty / 100.0f) * (float)(arr + 1));
-  __HAL_TIM_SET_COMPARE(&htim1, TIM_CHANNEL_1, ccr);
+  __HAL_TIM_SET_COMPARE(&htim1, Zone_Table()->pwm_ch[zone], ccr);
 }
@@ -0,0 +1,212 @@
+/**
+ * @file ident.c
+ * @brief RLS identification of the zone plant.
+ *
+ * The regression runs on y - y0 (y0 = first block mean) and on the duty
+ * as a fraction, so the three regressors have similar magnitudes and the
+ * float covariance stays well conditioned.
+ *
+ * The plant responds to the duty of a block within the same block, so
+ * block means obey y[i] = a y[i-1] + b0 u[i] + b1 u[i-1] with
+ * b0 ~ b1 when Ts << tau. The input regressor for dead time d is
+ * therefore the mean of u[i-d] and u[i-1-d].
+ *
+ * Forgetting lets P grow in directions without excitation (steady
+ * state). Its trace is bounded by IDENT_P_TRACE_MAX so that the gain
+ * does not explode when excitation returns.
+ */
+
+#include "ident.h"
+#include "config.h"
+#include "memmap.h"
+
+#include <math.h>
+#include <string.h>
+
+#define IDENT_P0           100.0f
+#define IDENT_P_TRACE_MAX  1000.0f
+#define IDENT_ERR_ALPHA    0.02f     /* error variance filter, ~50 blocks */
+
+static const float ts_id = IDENT_DECIM * CONTROL_TS_S;
+
+static void rls_init(ident_rls_t *r)
+{
+    memset(r, 0, sizeof(*r));
+    for (uint8_t i = 0; i < IDENT_NPAR; i++) r->P[i][i] = IDENT_P0;
+}
+
+ITCM_CODE static void rls_update(ident_rls_t *r, const float phi[IDENT_NPAR], float y)
+{
+    float pphi[IDENT_NPAR];
+    float den = IDENT_LAMBDA;
+    float e = y;
+
+    for (uint8_t i = 0; i < IDENT_NPAR; i++) {
+        pphi[i] = 0.0f;
+        for (uint8_t j = 0; j < IDENT_NPAR; j++) pphi[i] += r->P[i][j] * phi[j];
+        den += phi[i] * pphi[i];
+        e   -= r->theta[i] * phi[i];
+    }
+
+    const float inv_den = 1.0f / den;
+    const float inv_lambda = 1.0f / IDENT_LAMBDA;
+    float trace = 0.0f;
+    for (uint8_t i = 0; i < IDENT_NPAR; i++) {
+        float k = pphi[i] * inv_den;
+        r->theta[i] += k * e;
+        for (uint8_t j = 0; j <= i; j++) {
+            float p = (r->P[i][j] - k * pphi[j]) * inv_lambda;
+            r->P[i][j] = p;
+            r->P[j][i] = p;
+        }
+        trace += r->P[i][i];
+    }
+
+    if (trace > IDENT_P_TRACE_MAX) {
+        float s = IDENT_P_TRACE_MAX / trace;
+        for (uint8_t i = 0; i < IDENT_NPAR; i++) {
+            for (uint8_t j = 0; j < IDENT_NPAR; j++) r->P[i][j] *= s;
+        }
+    }
+
+    r->err_var += IDENT_ERR_ALPHA * (e * e - r->err_var);
+}
+
+/* Continuous model of the best candidate, with confidence. */
+ITCM_CODE static void derive_model(ident_t *id)
+{
+    uint8_t best = 0;
+    for (uint8_t d = 1; d < IDENT_NDELAY; d++) {
+        if (id->rls[d].err_var < id->rls[best].err_var) best = d;
+    }
+
+    const ident_rls_t *r = &id->rls[best];
+    ident_model_t *m = &id->model;
+    float a = r->theta[0];
+    float b = r->theta[1] / 100.0f;          /* per percent */
+    float c = r->theta[2];
+
+    m->flags = 0;
+    if (!(a > 0.0f && a < 1.0f && b > 0.0f)) return;
+
+    float one_a = 1.0f - a;
+    float ln_a  = logf(a);
+
+    m->k_c_per_pct = b / one_a;
+    m->tau_s       = -ts_id / ln_a;
+    m->dead_s      = (float)best * ts_id;
+    m->ambient_c   = id->y_base + c / one_a;
+
+    /* var = sigma^2 * g' P g over (a, b); b is scaled by 100 in theta. */
+    float s2 = r->err_var;
+    float gk_a = r->theta[1] / (one_a * one_a);
+    float gk_b = 1.0f / one_a;
+    float var_k = s2 * (gk_a * gk_a * r->P[0][0] +
+                        2.0f * gk_a * gk_b * r->P[0][1] +
+                        gk_b * gk_b * r->P[1][1]);
+    float gt_a = ts_id / (a * ln_a * ln_a);
+    float var_t = s2 * gt_a * gt_a * r->P[0][0];
+
+    m->k_rsd   = sqrtf(fmaxf(var_k, 0.0f)) / (r->theta[1] / one_a);
+    m->tau_rsd = sqrtf(fmaxf(var_t, 0.0f)) / m->tau_s;
+
+    if (id->blocks >= IDENT_WARMUP_BLOCKS &&
+        m->k_rsd < IDENT_CONF_RSD && m->tau_rsd < IDENT_CONF_RSD) {
+        m->flags |= IDENT_VALID;
+    }
+}
+
+ITCM_CODE static void check_drift(ident_t *id)
+{
+    ident_model_t *m = &id->model;
+    const float lim = IDENT_DRIFT_PCT / 100.0f;
+    const uint16_t hold = (uint16_t)(IDENT_DRIFT_HOLD_S / ts_id);
+
+    if (!(m->flags & IDENT_VALID)) return;
+
+    if (!id->has_ref) {
+        if (m->k_rsd < IDENT_REF_RSD && m->tau_rsd < IDENT_REF_RSD) {
+            id->ref = *m;
+            id->has_ref = true;
+        }
+        return;
+    }
+
+    /* Significant too: while the estimate moves after a change, its
+       error variance (and so the rsd) is up. */
+    float ek = fabsf(m->k_c_per_pct / id->ref.k_c_per_pct - 1.0f);
+    float et = fabsf(m->tau_s / id->ref.tau_s - 1.0f);
+    bool dk = ek > lim && ek > 3.0f * m->k_rsd;
+    bool dt = et > lim && et > 3.0f * m->tau_rsd;
+
+    id->drift_gain_n = dk ? (uint16_t)(id->drift_gain_n + 1U) : 0U;
+    id->drift_tau_n  = dt ? (uint16_t)(id->drift_tau_n + 1U) : 0U;
+
+    if (id->drift_gain_n >= hold) m->flags |= IDENT_DRIFT_GAIN;
+    if (id->drift_tau_n  >= hold) m->flags |= IDENT_DRIFT_TAU;
+}
+
+void Ident_Init(ident_t *id)
+{
+    memset(id, 0, sizeof(*id));
+    for (uint8_t d = 0; d < IDENT_NDELAY; d++) rls_init(&id->rls[d]);
+}
+
+ITCM_CODE void Ident_Update(ident_t *id, float u_pct, float y_c)
+{
+    /* Work of the previous block, spread over the first steps. */
+    if (id->blocks > IDENT_NDELAY + 1U) {
+        if (id->step < IDENT_NDELAY) {
+            const float phi[IDENT_NPAR] = {
+                id->y_prev - id->y_base,
+                0.5f * (id->u_hist[id->step] + id->u_hist[id->step + 1U]) / 100.0f,
+                1.0f,
+            };
+            rls_update(&id->rls[id->step], phi, id->y_last - id->y_base);
+        } else if (id->step == IDENT_NDELAY) {
+            derive_model(id);
+            check_drift(id);
+        }
+    }
+
+    id->u_acc += u_pct;
+    id->y_acc += y_c;
+    id->n_acc++;
+
+    if (++id->step < IDENT_DECIM) return;
+
+    /* Block complete. */
+    float y = id->y_acc / (float)id->n_acc;
+    if (id->blocks == 0U) id->y_base = y;
+
+    for (uint8_t i = IDENT_NDELAY; i > 0U; i--) id->u_hist[i] = id->u_hist[i - 1U];
+    id->u_hist[0] = id->u_acc / (float)id->n_acc;
+    id->y_prev = (id->blocks == 0U) ? y : id->y_last;
+    id->y_last = y;
+    id->blocks++;
+
+    id->u_acc = 0.0f;
+    id->y_acc = 0.0f;
+    id->n_acc = 0;
+    id->step  = 0;
+}
+
+const ident_model_t *Ident_GetModel(const ident_t *id)
+{
+    return &id->model;
+}
+
+bool Ident_Rebase(ident_t *id)
+{
+    if (!(id->model.flags & IDENT_VALID)) {
+        id->has_ref = false;
+        return false;
+    }
+
+    id->ref = id->model;
+    id->has_ref = true;
+    id->drift_gain_n = 0;
+    id->drift_tau_n  = 0;
+    id->model.flags &= (uint8_t)~(IDENT_DRIFT_GAIN | IDENT_DRIFT_TAU);
+    return true;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file json_build.c
+ * @brief Implementation of the JSON frame builder.
+ *
+ * Numbers are formatted into a small stack buffer first, so a value is
+ * written to the frame completely or not at all.
+ */
+
+#include "json_build.h"
+#include "fmt.h"
+#include <string.h>
+
+static void put(jsonb_t *jb, const char *s, uint16_t n)
+{
+    if (jb->overflow || (uint32_t)jb->len + n > jb->cap) {
+        jb->overflow = true;
+        return;
+    }
+    memcpy(&jb->buf[jb->len], s, n);
+    jb->len = (uint16_t)(jb->len + n);
+}
+
+static void put_key(jsonb_t *jb, const char *key)
+{
+    if (!jb->first) put(jb, ",", 1);
+    jb->first = false;
+
+    put(jb, "\"", 1);
+    put(jb, key, (uint16_t)strlen(key));
+    put(jb, "\":", 2);
+}
+
+void JSONB_Begin(jsonb_t *jb, char *buf, uint16_t cap)
+{
+    jb->buf = buf;
+    jb->cap = cap;
+    jb->len = 0;
+    jb->first = true;
+    jb->overflow = false;
+    put(jb, "{", 1);
+}
+
+void JSONB_AddFloat(jsonb_t *jb, const char *key, float v, uint8_t decimals)
+{
+    char tmp[FMT_FLOAT_MAX];
+    put_key(jb, key);
+    put(jb, tmp, FMT_Float(tmp, v, decimals));
+}
+
+void JSONB_AddUint(jsonb_t *jb, const char *key, uint32_t v)
+{
+    char tmp[FMT_UINT_MAX];
+    put_key(jb, key);
+    put(jb, tmp, FMT_Uint(tmp, v));
+}
+
+void JSONB_AddInt(jsonb_t *jb, const char *key, int32_t v)
+{
+    char tmp[FMT_INT_MAX];
+    put_key(jb, key);
+    put(jb, tmp, FMT_Int(tmp, v));
+}
+
+void JSONB_AddStr(jsonb_t *jb, const char *key, const char *v)
+{
+    put_key(jb, key);
+    put(jb, "\"", 1);
+    put(jb, v, (uint16_t)strlen(v));
+    put(jb, "\"", 1);
+}
+
+void JSONB_AddUintArray(jsonb_t *jb, const char *key, const uint32_t *v, uint16_t n)
+{
+    char tmp[FMT_UINT_MAX];
+    put_key(jb, key);
+    put(jb, "[", 1);
+    for (uint16_t i = 0; i < n; i++) {
+        if (i > 0U) put(jb, ",", 1);
+        put(jb, tmp, FMT_Uint(tmp, v[i]));
+    }
+    put(jb, "]", 1);
+}
+
+void JSONB_AddFloatArray(jsonb_t *jb, const char *key, const float *v, uint16_t n,
+                         uint8_t decimals)
+{
+    char tmp[FMT_FLOAT_MAX];
+    put_key(jb, key);
+    put(jb, "[", 1);
+    for (uint16_t i = 0; i < n; i++) {
+        if (i > 0U) put(jb, ",", 1);
+        put(jb, tmp, FMT_Float(tmp, v[i], decimals));
+    }
+    put(jb, "]", 1);
+}
+
+uint16_t JSONB_End(jsonb_t *jb)
+{
+    put(jb, "}\r\n", 3);
+    return jb->overflow ? 0U : jb->len;
+}
@@ -29,12 +29,24 @@
 #include "temperature.h"
 #include "control.h"
 #include "heater.h"
+#include "memmap.h"
+#include "perf.h"
+#include "trace.h"
 #include "uart_if.h"
 #include "config.h"
 #include "ui_led.h"
 #include "setpoint.h"
+#include "profile.h"
 #include "fan.h"
 #include "button.h"
+#include "scheduler.h"
+#include "settings.h"
+#include "adc_sampler.h"
+#include "tlm_stream.h"
+#include "overtemp.h"
+#include "zone.h"
+#include "ambient.h"
+#include "param.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -73,6 +85,9 @@ ETH_DMADescTypeDef DMATxDscrTab[ETH_TX_DESC_CNT] __attribute__((section(".TxDecr
 ETH_TxPacketConfig TxConfig;
 
 ADC_HandleTypeDef hadc1;
+DMA_HandleTypeDef hdma_adc1;
+DMA_HandleTypeDef hdma_usart3_rx;
+DMA_HandleTypeDef hdma_usart3_tx;
 
 CRC_HandleTypeDef hcrc;
 
@@ -88,12 +103,16 @@ UART_HandleTypeDef huart3;
 PCD_HandleTypeDef hpcd_USB_OTG_FS;
 
 /* USER CODE BEGIN PV */
-
+// Summary of the last control pass (per-zone values are in the zone
+// table), shared between the scheduled tasks.
+static bool  g_in_range = false;
+static bool  g_alarm    = false;
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_ETH_Init(void);
 static void MX_I2C1_Init(void);
 static void MX_USART3_UART_Init(void);
@@ -103,7 +122,13 @@ static void MX_TIM1_Init(void);
 static void MX_CRC_Init(void);
 static void MX_TIM7_Init(void);
 /* USER CODE BEGIN PFP */
-
+static void Task_Control(void);
+static void Task_UART(void);
+static void Task_Button(void);
+static void Task_LED(void);
+static void Task_Telemetry(void);
+static void Send_ZoneTelemetry(uint8_t zone);
+static uint32_t Time_us(void);
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
@@ -119,7 +144,8 @@ int main(void)
 {
 
   /* USER CODE BEGIN 1 */
-
+  // MPU regions for the DMA memory, then the caches (memmap.h).
+  MemMap_Init();
   /* USER CODE END 1 */
 
   /* MCU Configuration--------------------------------------------------------*/
@@ -140,6 +166,7 @@ int main(void)
 
   /* Initialize all configured peripherals */
   MX_GPIO_Init();
+  MX_DMA_Init();
   MX_ETH_Init();
   MX_I2C1_Init();
   MX_USART3_UART_Init();
@@ -149,115 +176,57 @@ int main(void)
   MX_CRC_Init();
   MX_TIM7_Init();
   /* USER CODE BEGIN 2 */
-  Control_Init();
+  // Cycle counter for the section timing (PERF? command).
+  Perf_Init();
+  Trace_Init();
+  Zone_Init();
+  Param_Init();
+  // Saved parameters, before the controllers are built from them.
+  Settings_Load();
+  Temperature_Init();
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+      Control_Init(z);
+  }
   UARTIF_Init();
   UI_LED_Init();
   Heater_Init();
   Button_Init();
 
+  // Hardware cutoff armed before the first conversion is triggered.
+  OverTemp_Init();
+  Ambient_Init();
+
+  // TIM1 is running now, its update event paces the ADC conversions.
+  ADCS_Init(ADC_OVERSAMPLE_RATIO);
+  if (!ADCS_Start()) {
+      Error_Handler();
+  }
 
+  Sched_Init(NULL);
+  Sched_AddTask("control",   Task_Control,   CONTROL_PERIOD_MS,   0U);
+  Sched_AddTask("uart",      Task_UART,      UART_TASK_PERIOD_MS, 5U);
+  Sched_AddTask("button",    Task_Button,    UI_TASK_PERIOD_MS,   20U);
+  Sched_AddTask("led",       Task_LED,       UI_TASK_PERIOD_MS,   40U);
+  float tlm_period;
+  (void)Param_Get(PARAM_TLM_PERIOD, 0U, &tlm_period);
+  Sched_AddTask("telemetry", Task_Telemetry, (uint32_t)tlm_period, (uint32_t)tlm_period);
+  Sched_AddTask("ambient",   Ambient_Task,   AMBIENT_PERIOD_MS,   60U);
+  Sched_AddTask("settings",  Settings_Task,  SETTINGS_PERIOD_MS,  80U);
+
+  HAL_TIM_Base_Start_IT(&htim7);
   /* USER CODE END 2 */
 
   /* Infinite loop */
   /* USER CODE BEGIN WHILE */
-  uint32_t next_tick = HAL_GetTick();
-  const uint32_t Ts_ms = (uint32_t)(CONTROL_TS_S * 1000.0f + 0.5f);
-  uint32_t next_tel_ms = HAL_GetTick() + TELEMETRY_PERIOD_MS;
-
   while (1)
   {
-      // ---------- UART ----------
-      UARTIF_Task();
-
-      // ---------- ADC (NTC) ----------
-      uint16_t ntc_raw = 0;
-      HAL_ADC_Start(&hadc1);
-      if (HAL_ADC_PollForConversion(&hadc1, 10) == HAL_OK) {
-          ntc_raw = (uint16_t)HAL_ADC_GetValue(&hadc1);
-      }
-      HAL_ADC_Stop(&hadc1);
-
-      // ---------- Temperature ----------
-      // float t_meas = Temperature_FromRaw(ntc_raw);
-      float t_meas = Temperature_FromRawFiltered(ntc_raw);
-      float t_ref  = Setpoint_GetC();
-
-      // ---------- Range flags ----------
-      bool in_range = (t_meas >= T_SAFE_MIN_C  && t_meas <= T_SAFE_MAX_C);
-      bool alarm    = (t_meas <  T_ALARM_MIN_C || t_meas >  T_ALARM_MAX_C);
-
-      // ---------- Button (setpoint adjust) ----------
-      Button_Task_100ms();
-
-      button_event_t ev = Button_ConsumeEvent();
-      if (ev != BTN_EVT_NONE) {
-          float sp = Setpoint_GetC();
-
-          if (ev == BTN_EVT_SHORT) sp += 0.5f;
-          else if (ev == BTN_EVT_LONG) sp -= 0.5f;
-
-          Setpoint_SetC(sp);
-
-          t_ref = Setpoint_GetC();
-      }
-      HAL_Delay(200);
-
-      // ---------- Control + Safety ----------
-      static bool prev_alarm = false;
-      float pwm = 0.0f;
-
-      if (alarm) {
-          if (!prev_alarm) {
-              Control_Init();
-          }
-
-          pwm = 0.0f;
-          Heater_SetDutyPercent(0.0f);
-          Fan_Set(true);
-      } else {
-          pwm = Control_Update(t_ref, t_meas);
-          Heater_SetDutyPercent(pwm);
-
-          // ---------- Fan control (hysteresis) ----------
-          static bool fan_on = false;
-          if (!fan_on && (t_meas > t_ref + 2.0f)) fan_on = true;
-          if ( fan_on && (t_meas < t_ref + 1.0f)) fan_on = false;
-          Fan_Set(fan_on);
-      }
-
-      prev_alarm = alarm;
-
-      // ---------- Telemetry (periodic) ----------
-      bool send_tel = UARTIF_ConsumeTelemetryRequest();
-
-      uint32_t now_tel = HAL_GetTick();
-      if ((int32_t)(now_tel - next_tel_ms) >= 0) {
-          send_tel = true;
-          next_tel_ms += TELEMETRY_PERIOD_MS;
-      }
-
-      if (send_tel) {
-          UARTIF_SendTelemetry(t_meas, t_ref, pwm);
-      }
-
-
-      // ---------- LED indication ----------
-      UI_LED_Task_100ms(in_range, alarm);
-
-      // ---------- Sampling period (fixed Ts) ----------
-      next_tick += Ts_ms;
-      uint32_t now = HAL_GetTick();
-
-      if ((int32_t)(next_tick - now) > 0) {
-          HAL_Delay(next_tick - now);
-      } else {
-          next_tick = now;
-      }
-  }
-
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
+      // All periodic work runs from the scheduler; sleep until the next tick.
+      if (!Sched_RunPending()) {
+          __WFI();
+      }
   }
   /* USER CODE END 3 */
 }
@@ -334,15 +303,15 @@ static void MX_ADC1_Init(void)
   hadc1.Instance = ADC1;
   hadc1.Init.ClockPrescaler = ADC_CLOCK_SYNC_PCLK_DIV2;
   hadc1.Init.Resolution = ADC_RESOLUTION_12B;
-  hadc1.Init.ScanConvMode = ADC_SCAN_DISABLE;
+  hadc1.Init.ScanConvMode = ADC_SCAN_ENABLE;
   hadc1.Init.ContinuousConvMode = DISABLE;
   hadc1.Init.DiscontinuousConvMode = DISABLE;
-  hadc1.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_NONE;
-  hadc1.Init.ExternalTrigConv = ADC_SOFTWARE_START;
+  hadc1.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_RISING;
+  hadc1.Init.ExternalTrigConv = ADC_EXTERNALTRIGCONV_T1_TRGO;
   hadc1.Init.DataAlign = ADC_DATAALIGN_RIGHT;
-  hadc1.Init.NbrOfConversion = 1;
-  hadc1.Init.DMAContinuousRequests = DISABLE;
-  hadc1.Init.EOCSelection = ADC_EOC_SINGLE_CONV;
+  hadc1.Init.NbrOfConversion = 4;
+  hadc1.Init.DMAContinuousRequests = ENABLE;
+  hadc1.Init.EOCSelection = ADC_EOC_SEQ_CONV;
   if (HAL_ADC_Init(&hadc1) != HAL_OK)
   {
     Error_Handler();
@@ -357,8 +326,44 @@ static void MX_ADC1_Init(void)
   {
     Error_Handler();
   }
-  /* USER CODE BEGIN ADC1_Init 2 */
 
+  /** Configure for the selected ADC regular channel its corresponding rank in the sequencer and its sample time.
+  */
+  sConfig.Channel = ADC_CHANNEL_3;
+  sConfig.Rank = ADC_REGULAR_RANK_2;
+  if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Configure for the selected ADC regular channel its corresponding rank in the sequencer and its sample time.
+  */
+  sConfig.Channel = ADC_CHANNEL_10;
+  sConfig.Rank = ADC_REGULAR_RANK_3;
+  if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /** Configure for the selected ADC regular channel its corresponding rank in the sequencer and its sample time.
+  */
+  sConfig.Channel = ADC_CHANNEL_13;
+  sConfig.Rank = ADC_REGULAR_RANK_4;
+  if (HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  /* USER CODE BEGIN ADC1_Init 2 */
+  /* Scan the inputs of the zones fitted only (zone.h): ranks past the
+     sequence length are not converted, nor checked by the watchdog. */
+  if (ZONE_ACTIVE_COUNT != hadc1.Init.NbrOfConversion)
+  {
+    hadc1.Init.NbrOfConversion = ZONE_ACTIVE_COUNT;
+    if (HAL_ADC_Init(&hadc1) != HAL_OK)
+    {
+      Error_Handler();
+    }
+  }
   /* USER CODE END ADC1_Init 2 */
 
 }
@@ -531,7 +536,7 @@ static void MX_TIM1_Init(void)
   {
     Error_Handler();
   }
-  sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
+  sMasterConfig.MasterOutputTrigger = TIM_TRGO_UPDATE;
   sMasterConfig.MasterOutputTrigger2 = TIM_TRGO2_RESET;
   sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
   if (HAL_TIMEx_MasterConfigSynchronization(&htim1, &sMasterConfig) != HAL_OK)
@@ -549,8 +554,20 @@ static void MX_TIM1_Init(void)
   {
     Error_Handler();
   }
+  if (HAL_TIM_PWM_ConfigChannel(&htim1, &sConfigOC, TIM_CHANNEL_2) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  if (HAL_TIM_PWM_ConfigChannel(&htim1, &sConfigOC, TIM_CHANNEL_3) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  if (HAL_TIM_PWM_ConfigChannel(&htim1, &sConfigOC, TIM_CHANNEL_4) != HAL_OK)
+  {
+    Error_Handler();
+  }
   sBreakDeadTimeConfig.OffStateRunMode = TIM_OSSR_DISABLE;
-  sBreakDeadTimeConfig.OffStateIDLEMode = TIM_OSSI_DISABLE;
+  sBreakDeadTimeConfig.OffStateIDLEMode = TIM_OSSI_ENABLE;
   sBreakDeadTimeConfig.LockLevel = TIM_LOCKLEVEL_OFF;
   sBreakDeadTimeConfig.DeadTime = 0;
   sBreakDeadTimeConfig.BreakState = TIM_BREAK_DISABLE;
@@ -591,7 +608,7 @@ static void MX_TIM7_Init(void)
   htim7.Instance = TIM7;
   htim7.Init.Prescaler = 720 - 1;
   htim7.Init.CounterMode = TIM_COUNTERMODE_UP;
-  htim7.Init.Period = 20000 - 1;
+  htim7.Init.Period = 100 - 1;
   htim7.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
   if (HAL_TIM_Base_Init(&htim7) != HAL_OK)
   {
@@ -679,6 +696,29 @@ static void MX_USB_OTG_FS_PCD_Init(void)
 
 }
 
+/**
+  * Enable DMA controller clock
+  */
+static void MX_DMA_Init(void)
+{
+
+  /* DMA controller clock enable */
+  __HAL_RCC_DMA1_CLK_ENABLE();
+  __HAL_RCC_DMA2_CLK_ENABLE();
+
+  /* DMA interrupt init */
+  /* DMA1_Stream1_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream1_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream1_IRQn);
+  /* DMA1_Stream3_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA1_Stream3_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(DMA1_Stream3_IRQn);
+  /* DMA2_Stream0_IRQn interrupt configuration */
+  HAL_NVIC_SetPriority(DMA2_Stream0_IRQn, 2, 0);
+  HAL_NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+
+}
+
 /**
   * @brief GPIO Initialization Function
   * @param None
@@ -749,6 +789,240 @@ static void MX_GPIO_Init(void)
 
 /* USER CODE BEGIN 4 */
 
+/**
+  * @brief Control task: ADC sampling, temperature, PI control and safety.
+  *
+  * All zones are updated in one pass over the zone table, from one
+  * snapshot of the ADC channels. The stages are timed as perf.h sections.
+  */
+ITCM_CODE static void Task_Control(void)
+{
+  static uint32_t last_start_us = 0;
+  PERF_LOOP_MARK();
+  PERF_BEGIN(PERF_LOOP);
+  uint32_t start_us = Time_us();
+  zone_table_t *zt = Zone_Table();
+
+  // Parameters set since the last step, all at once (param.h).
+  Param_Apply();
+
+  // ---------- ADC (NTC) ----------
+  // Latest oversampled values from the DMA decimator. No new block since
+  // the previous tick means the acquisition stalled: fail safe.
+  PERF_BEGIN(PERF_ADC);
+  static uint32_t last_seq = 0;
+  uint16_t q4[ADCS_NUM_CH];
+  uint32_t seq = ADCS_GetLatestAll(q4);
+  bool adc_ok = (seq != 0U) && (seq != last_seq);
+  if (adc_ok) last_seq = seq;
+  PERF_END(PERF_ADC);
+
+  static bool last_adc_ok = true;
+  if (!adc_ok && last_adc_ok) Trace_Record(TRACE_EV_ADC_TIMEOUT, 0U);
+  last_adc_ok = adc_ok;
+
+  // ---------- Temperature ----------
+  PERF_BEGIN(PERF_FILTER);
+  if (adc_ok) {
+      for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+          uint16_t v = q4[zt->adc_ch[z]];
+          zt->raw[z] = (uint16_t)((v + 8U) >> 4);
+          zt->t_meas_c[z] = Temperature_Filter(z, Temperature_FromRawQ4(v));
+      }
+  }
+  PERF_END(PERF_FILTER);
+
+  // The analog watchdog latches a trip in its interrupt and has already
+  // cut the PWM outputs; here the loop only follows it.
+  bool hw_trip = OverTemp_IsTripped();
+  bool any_alarm = false;
+  bool any_fan   = false;
+  bool all_in_range = true;
+
+  PERF_BEGIN(PERF_CONTROL);
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+      float t_meas = zt->t_meas_c[z];
+
+      // ---------- Setpoint profile (holds while the zone is in alarm) ----------
+      if (!zt->alarm[z]) Profile_Update(z);
+      float t_ref  = zt->setpoint_c[z];
+
+      // ---------- Range flags ----------
+      bool in_range = (t_meas >= zt->sp_min_c[z] && t_meas <= zt->sp_max_c[z]);
+      bool meas_ok  = adc_ok &&
+                      (t_meas >= zt->alarm_min_c[z] && t_meas <= zt->alarm_max_c[z]);
+      bool alarm    = !meas_ok || hw_trip;
+
+      // ---------- Control + Safety ----------
+      float pwm = 0.0f;
+
+      if (alarm != zt->alarm[z]) {
+          Trace_Record(TRACE_EV_ALARM, TRACE_ZARG(z, alarm ? 1U : 0U));
+          if (alarm && TRACE_STOP_ON_ALARM) Trace_Stop();
+      }
+
+      if (alarm) {
+          // Restart from 0 %, keeping the plant and predictor models.
+          if (!zt->alarm[z]) {
+              Control_Reset(z);
+          }
+          // The models follow the plant with the heater off.
+          Control_Hold(z, t_meas, meas_ok);
+      } else {
+          pwm = Control_Update(z, t_ref, t_meas);
+
+          // ---------- Fan request (hysteresis) ----------
+          bool fan_on = zt->fan_req[z];
+          if (!fan_on && (t_meas > t_ref + zt->fan_on_c[z]))  fan_on = true;
+          if ( fan_on && (t_meas < t_ref + zt->fan_off_c[z])) fan_on = false;
+          zt->fan_req[z] = fan_on;
+      }
+      Heater_SetDutyPercent(z, pwm);
+
+      zt->pwm[z]      = pwm;
+      zt->in_range[z] = in_range;
+      zt->alarm[z]    = alarm;
+
+      any_alarm    |= alarm;
+      any_fan      |= alarm || zt->fan_req[z];
+      all_in_range &= in_range;
+  }
+
+  // One fan serves every zone.
+  Fan_Set(any_fan);
+  PERF_END(PERF_CONTROL);
+
+  g_in_range = all_in_range;
+  g_alarm    = any_alarm;
+
+  // ---------- Stream ----------
+  if (Stream_IsActive()) {
+      PERF_BEGIN(PERF_TLM);
+      stream_sample_t smp[ZONE_COUNT];
+      uint32_t period_us = start_us - last_start_us;
+      uint32_t exec_us   = Time_us() - start_us;
+
+      for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+          smp[z] = (stream_sample_t){
+              .zone      = z,
+              .t_meas    = zt->t_meas_c[z],
+              .raw       = zt->raw[z],
+              .t_ref     = zt->setpoint_c[z],
+              .pwm       = zt->pwm[z],
+              .error     = zt->setpoint_c[z] - zt->t_meas_c[z],
+              .i_term    = zt->pid[z].i_term,
+              .fan       = zt->alarm[z] || zt->fan_req[z],
+              .period_us = period_us,
+              .exec_us   = exec_us,
+              .model     = Ident_GetModel(&zt->ident[z]),
+          };
+      }
+      Stream_OnSample(smp, (uint8_t)ZONE_COUNT);
+      PERF_END(PERF_TLM);
+  }
+  last_start_us = start_us;
+  PERF_END(PERF_LOOP);
+}
+
+/**
+  * @brief UART task: command handling and on-demand telemetry.
+  */
+static void Task_UART(void)
+{
+  PERF_BEGIN(PERF_UART);
+  UARTIF_Task();
+  PERF_END(PERF_UART);
+
+  uint16_t zones = UARTIF_ConsumeTelemetryRequest();
+  if (zones != 0U) {
+      PERF_BEGIN(PERF_TLM);
+      for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+          if (zones & (1U << z)) Send_ZoneTelemetry(z);
+      }
+      PERF_END(PERF_TLM);
+  }
+}
+
+/**
+  * @brief Button task: setpoint adjustment of zone 0 by short/long press.
+  */
+static void Task_Button(void)
+{
+  Button_Task_100ms();
+
+  button_event_t ev = Button_ConsumeEvent();
+  if (ev != BTN_EVT_NONE) {
+      float sp = Setpoint_GetC(0);
+
+      if (ev == BTN_EVT_SHORT) sp += 0.5f;
+      else if (ev == BTN_EVT_LONG) sp -= 0.5f;
+
+      // A manual setpoint overrides a running profile.
+      Profile_Stop(0);
+      Setpoint_SetC(0, sp);
+      Trace_Record(TRACE_EV_SETPOINT, TRACE_ZARG(0, Setpoint_GetC(0) * 10.0f + 0.5f));
+  }
+}
+
+/**
+  * @brief LED task: status indication.
+  */
+static void Task_LED(void)
+{
+  UI_LED_Task_100ms(g_in_range, g_alarm);
+}
+
+/**
+  * @brief Telemetry task: periodic telemetry frame of every zone.
+  */
+static void Task_Telemetry(void)
+{
+  PERF_BEGIN(PERF_TLM);
+  for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+      Send_ZoneTelemetry(z);
+  }
+  PERF_END(PERF_TLM);
+}
+
+/**
+  * @brief Telemetry frame of one zone from the last control pass.
+  */
+static void Send_ZoneTelemetry(uint8_t zone)
+{
+  const zone_table_t *zt = Zone_Table();
+  UARTIF_SendTelemetry(zone, zt->t_meas_c[zone], zt->setpoint_c[zone], zt->pwm[zone]);
+}
+
+/**
+  * @brief Microsecond time base from the scheduler tick and the TIM7
+  *        counter (10 us resolution).
+  */
+ITCM_CODE static uint32_t Time_us(void)
+{
+  uint32_t ms, cnt;
+  do {
+      ms  = Sched_GetTick();
+      cnt = __HAL_TIM_GET_COUNTER(&htim7);
+  } while (ms != Sched_GetTick());
+
+  // A pending update means the counter wrapped before the tick ISR ran.
+  if (__HAL_TIM_GET_FLAG(&htim7, TIM_FLAG_UPDATE) &&
+      cnt < (__HAL_TIM_GET_AUTORELOAD(&htim7) / 2U)) {
+      ms++;
+  }
+  return ms * 1000U + cnt * 10U;
+}
+
+/**
+  * @brief TIM7 update interrupt: 1 ms scheduler tick.
+  */
+ITCM_CODE void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+  if (htim->Instance == TIM7) {
+      Sched_TickISR();
+  }
+}
+
 /* USER CODE END 4 */
 
 /**
@@ -0,0 +1,57 @@
+/**
+ * @file memmap.c
+ * @brief MPU regions and cache enable.
+ *
+ * Regions, higher numbers take precedence where they overlap:
+ *
+ *   0  0x00000000  4G    no access, subregions 0-2 and 7 disabled: the
+ *                        external memory space 0x60000000-0xDFFFFFFF,
+ *                        so that speculative reads cannot reach it
+ *   1  0x2004C000  16K   SRAM2, normal memory, shareable, not cached
+ *   2  0x2004C000  512B  ETH descriptors, shared device memory
+ *
+ * All other memory keeps the default map (MPU_PRIVILEGED_DEFAULT): flash
+ * and SRAM1 write-back cached, peripherals device memory.
+ */
+
+#include "memmap.h"
+#include "main.h"
+
+void MemMap_Init(void)
+{
+    MPU_Region_InitTypeDef r = {0};
+
+    HAL_MPU_Disable();
+
+    r.Enable           = MPU_REGION_ENABLE;
+    r.Number           = MPU_REGION_NUMBER0;
+    r.BaseAddress      = 0x00000000U;
+    r.Size             = MPU_REGION_SIZE_4GB;
+    r.SubRegionDisable = 0x87U;
+    r.TypeExtField     = MPU_TEX_LEVEL0;
+    r.AccessPermission = MPU_REGION_NO_ACCESS;
+    r.DisableExec      = MPU_INSTRUCTION_ACCESS_DISABLE;
+    r.IsShareable      = MPU_ACCESS_SHAREABLE;
+    r.IsCacheable      = MPU_ACCESS_NOT_CACHEABLE;
+    r.IsBufferable     = MPU_ACCESS_NOT_BUFFERABLE;
+    HAL_MPU_ConfigRegion(&r);
+
+    r.Number           = MPU_REGION_NUMBER1;
+    r.BaseAddress      = 0x2004C000U;
+    r.Size             = MPU_REGION_SIZE_16KB;
+    r.SubRegionDisable = 0x00U;
+    r.TypeExtField     = MPU_TEX_LEVEL1;
+    r.AccessPermission = MPU_REGION_FULL_ACCESS;
+    HAL_MPU_ConfigRegion(&r);
+
+    r.Number           = MPU_REGION_NUMBER2;
+    r.Size             = MPU_REGION_SIZE_512B;
+    r.TypeExtField     = MPU_TEX_LEVEL0;
+    r.IsBufferable     = MPU_ACCESS_BUFFERABLE;
+    HAL_MPU_ConfigRegion(&r);
+
+    HAL_MPU_Enable(MPU_PRIVILEGED_DEFAULT);
+
+    SCB_EnableICache();
+    SCB_EnableDCache();
+}
@@ -0,0 +1,56 @@
+/**
+ * @file ntc_lut.c
+ * @brief NTC ADC-to-temperature lookup table.
+ *
+ * Generated by tools/gen_ntc_lut.py from the Beta model in config.h.
+ * Do not edit by hand, re-run the generator instead.
+ *
+ * R_FIXED = 10000, NTC_BETA = 3950, NTC_R0 = 10000, NTC_T0_K = 298.15
+ */
+
+#include "ntc_lut.h"
+#include "config.h"
+
+#if NTC_LUT_SHIFT != 5
+#error "ntc_lut.c was generated for a different NTC_LUT_SHIFT, re-run tools/gen_ntc_lut.py"
+#endif
+
+_Static_assert((int)R_FIXED == 10000 && (int)NTC_BETA == 3950 &&
+               (int)NTC_R0 == 10000 && (int)(NTC_T0_K * 100.0f + 0.5f) == 29815,
+               "NTC constants changed, re-run tools/gen_ntc_lut.py");
+
+const float ntc_lut_c[NTC_LUT_SIZE] = {
+      527.89040f,   196.84057f,   160.65478f,   141.81333f,
+      129.31042f,   120.04631f,   112.72937f,   106.70361f,
+      101.59236f,    97.16035f,    93.25127f,    89.75626f,
+       86.59660f,    83.71363f,    81.06250f,    78.60822f,
+       76.32297f,    74.18429f,    72.17378f,    70.27622f,
+       68.47885f,    66.77090f,    65.14316f,    63.58775f,
+       62.09783f,    60.66743f,    59.29135f,    57.96498f,
+       56.68426f,    55.44555f,    54.24563f,    53.08158f,
+       51.95079f,    50.85089f,    49.77973f,    48.73536f,
+       47.71600f,    46.72000f,    45.74586f,    44.79221f,
+       43.85776f,    42.94133f,    42.04183f,    41.15823f,
+       40.28958f,    39.43499f,    38.59362f,    37.76470f,
+       36.94748f,    36.14127f,    35.34542f,    34.55930f,
+       33.78232f,    33.01392f,    32.25357f,    31.50074f,
+       30.75496f,    30.01574f,    29.28265f,    28.55523f,
+       27.83308f,    27.11577f,    26.40291f,    25.69412f,
+       24.98901f,    24.28721f,    23.58837f,    22.89212f,
+       22.19810f,    21.50597f,    20.81539f,    20.12599f,
+       19.43744f,    18.74940f,    18.06150f,    17.37340f,
+       16.68475f,    15.99518f,    15.30432f,    14.61181f,
+       13.91725f,    13.22026f,    12.52043f,    11.81734f,
+       11.11055f,    10.39961f,     9.68404f,     8.96337f,
+        8.23705f,     7.50456f,     6.76531f,     6.01868f,
+        5.26404f,     4.50068f,     3.72785f,     2.94477f,
+        2.15057f,     1.34432f,     0.52502f,    -0.30845f,
+       -1.15728f,    -2.02278f,    -2.90643f,    -3.80982f,
+       -4.73476f,    -5.68325f,    -6.65754f,    -7.66019f,
+       -8.69410f,    -9.76258f,   -10.86948f,   -12.01925f,
+      -13.21711f,   -14.46926f,   -15.78313f,   -17.16770f,
+      -18.63405f,   -20.19602f,   -21.87125f,   -23.68276f,
+      -25.66137f,   -27.84982f,   -30.30992f,   -33.13611f,
+      -36.48411f,   -40.64029f,   -46.23303f,   -55.21056f,
+      -89.98829f,
+};
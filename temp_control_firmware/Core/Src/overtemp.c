@@ -0,0 +1,128 @@
+/**
+ * @file overtemp.c
+ * @brief Implementation of the hardware overtemperature cutoff.
+ *
+ * TIM1 runs with OSSI set, so clearing MOE (software break, EGR.BG)
+ * forces CH1..CH4 to their idle level (low) instead of releasing the
+ * pins.
+ * Automatic output is disabled, so MOE stays cleared until
+ * OverTemp_Rearm() sets it again.
+ *
+ * The watchdog interrupt is disabled after a trip: the condition usually
+ * persists and would otherwise fire on every conversion (20 kHz).
+ */
+
+#include "overtemp.h"
+#include "config.h"
+#include "main.h"
+#include "memmap.h"
+#include "temperature.h"
+#include "trace.h"
+#include "zone.h"
+
+extern ADC_HandleTypeDef hadc1;
+extern TIM_HandleTypeDef htim1;
+
+static uint16_t thr_low;
+static uint16_t thr_high;
+
+static volatile bool     tripped  = false;
+static volatile uint16_t trip_raw = 0;
+static bool              held_on  = false;
+
+void OverTemp_Init(void)
+{
+    thr_low  = Temperature_ToRaw(T_ALARM_MAX_C);
+    thr_high = Temperature_ToRaw(T_ALARM_MIN_C);
+
+    ADC_AnalogWDGConfTypeDef awd = {0};
+    awd.WatchdogMode  = ADC_ANALOGWATCHDOG_ALL_REG;
+    awd.Channel       = ADC_CHANNEL_0;
+    awd.LowThreshold  = thr_low;
+    awd.HighThreshold = thr_high;
+    awd.ITMode        = ENABLE;
+
+    tripped = false;
+    if (HAL_ADC_AnalogWDGConfig(&hadc1, &awd) != HAL_OK) {
+        Error_Handler();
+    }
+}
+
+void OverTemp_Update(void)
+{
+    thr_low  = Temperature_ToRaw(T_ALARM_MAX_C);
+    thr_high = Temperature_ToRaw(T_ALARM_MIN_C);
+
+    /* Registers only: the interrupt stays as it is, off after a trip. */
+    hadc1.Instance->LTR = thr_low;
+    hadc1.Instance->HTR = thr_high;
+}
+
+ITCM_CODE bool OverTemp_IsTripped(void)
+{
+    return tripped;
+}
+
+uint16_t OverTemp_GetTripRaw(void)
+{
+    return trip_raw;
+}
+
+void OverTemp_GetThresholds(uint16_t *low, uint16_t *high)
+{
+    *low  = thr_low;
+    *high = thr_high;
+}
+
+ITCM_CODE static void outputs_off(void)
+{
+    const zone_table_t *zt = Zone_Table();
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+        __HAL_TIM_SET_COMPARE(&htim1, zt->pwm_ch[z], 0U);
+    }
+}
+
+void OverTemp_HoldOutputs(void)
+{
+    held_on = (htim1.Instance->BDTR & TIM_BDTR_MOE) != 0U;
+    __HAL_TIM_MOE_DISABLE_UNCONDITIONALLY(&htim1);
+}
+
+void OverTemp_ReleaseOutputs(void)
+{
+    /* A trip in between breaks again after this, MOE cannot stay set. */
+    if (held_on && !tripped) __HAL_TIM_MOE_ENABLE(&htim1);
+    held_on = false;
+}
+
+bool OverTemp_Rearm(const uint16_t *raw, uint8_t n)
+{
+    for (uint8_t i = 0; i < n; i++) {
+        if (raw[i] < thr_low || raw[i] > thr_high) return false;
+    }
+
+    /* Start from 0 % so the outputs do not resume at the old duty. */
+    outputs_off();
+    tripped = false;
+
+    __HAL_ADC_CLEAR_FLAG(&hadc1, ADC_FLAG_AWD);
+    __HAL_ADC_ENABLE_IT(&hadc1, ADC_IT_AWD);
+    __HAL_TIM_MOE_ENABLE(&htim1);
+    return true;
+}
+
+/* ===================== ADC watchdog interrupt ===================== */
+
+ITCM_CODE void HAL_ADC_LevelOutOfWindowCallback(ADC_HandleTypeDef *hadc)
+{
+    if (hadc != &hadc1) return;
+
+    /* Break first: clears MOE, the outputs go to their idle level. */
+    htim1.Instance->EGR = TIM_EGR_BG;
+    outputs_off();
+
+    __HAL_ADC_DISABLE_IT(hadc, ADC_IT_AWD);
+    trip_raw = (uint16_t)hadc->Instance->DR;
+    tripped  = true;
+    Trace_Record(TRACE_EV_OVERTEMP, trip_raw);
+}
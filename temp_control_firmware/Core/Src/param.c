@@ -0,0 +1,387 @@
+/**
+ * @file param.c
+ * @brief Parameter registry implementation.
+ *
+ * The descriptor table is indexed by id. Names are found through an
+ * open-addressing table of FNV-1a hashes with linear probing, built once
+ * by Param_Init(); a lookup compares the name of one or two candidates.
+ *
+ * Staged values are kept per id and zone, so staging never runs out of
+ * space and a later value of the same parameter replaces the earlier one.
+ * Param_Apply() applies them in id order: the setpoint limits before the
+ * setpoint.
+ *
+ * Store keys (settings.h) are part of the flash format: a zone parameter
+ * uses key + zone.
+ *
+ * The NTC constants and the filter type and length are collected over
+ * one Param_Apply() and applied once at its end.
+ */
+
+#include "param.h"
+#include "config.h"
+#include "control.h"
+#include "overtemp.h"
+#include "pid.h"
+#include "profile.h"
+#include "scheduler.h"
+#include "setpoint.h"
+#include "temperature.h"
+#include "zone.h"
+
+#include <math.h>
+#include <string.h>
+
+#define ZP  (PARAM_F_ZONE | PARAM_F_PERSIST)
+#define GP  (PARAM_F_PERSIST)
+
+#define HASH_SLOTS  64U   /* power of two, over twice PARAM_COUNT */
+
+_Static_assert(PARAM_COUNT * 2U <= HASH_SLOTS, "name index too small");
+_Static_assert(ZONE_COUNT <= 4U, "zone parameter store keys are 4 apart");
+
+static const param_desc_t desc[PARAM_COUNT] = {
+    [PARAM_SP_MIN]     = {"sp_min",     "degC",       PARAM_T_F32, ZP, 0x30,
+                          T_SAFE_MIN_C, T_SAFE_MAX_C, T_SAFE_MIN_C},
+    [PARAM_SP_MAX]     = {"sp_max",     "degC",       PARAM_T_F32, ZP, 0x34,
+                          T_SAFE_MIN_C, T_SAFE_MAX_C, T_SAFE_MAX_C},
+    [PARAM_ALARM_MIN]  = {"alarm_min",  "degC",       PARAM_T_F32, ZP, 0x38,
+                          T_ALARM_MIN_C, T_ALARM_MAX_C, T_ALARM_MIN_C},
+    [PARAM_ALARM_MAX]  = {"alarm_max",  "degC",       PARAM_T_F32, ZP, 0x3C,
+                          T_ALARM_MIN_C, T_ALARM_MAX_C, T_ALARM_MAX_C},
+    [PARAM_SP]         = {"sp",         "degC",       PARAM_T_F32, ZP, 0x00,
+                          T_SAFE_MIN_C, T_SAFE_MAX_C, T_SETPOINT_DEFAULT_C},
+    [PARAM_KP]         = {"kp",         "%/degC",     PARAM_T_F32, ZP, 0x10,
+                          0.01f, 100.0f, KP},
+    [PARAM_KI]         = {"ki",         "%/(degC*s)", PARAM_T_F32, ZP, 0x20,
+                          0.0f, 10.0f, KI},
+    [PARAM_FAN_ON]     = {"fan_on",     "degC",       PARAM_T_F32, ZP, 0x40,
+                          -10.0f, 20.0f, FAN_ON_ABOVE_C},
+    [PARAM_FAN_OFF]    = {"fan_off",    "degC",       PARAM_T_F32, ZP, 0x44,
+                          -10.0f, 20.0f, FAN_OFF_ABOVE_C},
+    [PARAM_NTC_BETA]   = {"ntc_beta",   "K",          PARAM_T_F32, GP, 0x50,
+                          1000.0f, 10000.0f, NTC_BETA},
+    [PARAM_NTC_R0]     = {"ntc_r0",     "ohm",        PARAM_T_F32, GP, 0x51,
+                          100.0f, 1.0e6f, NTC_R0},
+    [PARAM_NTC_T0]     = {"ntc_t0",     "K",          PARAM_T_F32, GP, 0x52,
+                          273.15f, 373.15f, NTC_T0_K},
+    [PARAM_R_FIXED]    = {"r_fixed",    "ohm",        PARAM_T_F32, GP, 0x53,
+                          100.0f, 1.0e6f, R_FIXED},
+    [PARAM_TLM_PERIOD] = {"tlm_period", "ms",         PARAM_T_U32, GP, 0x54,
+                          100.0f, 600000.0f, (float)TELEMETRY_PERIOD_MS},
+    [PARAM_CONTROL_TS] = {"control_ts", "s",          PARAM_T_F32, PARAM_F_RO, 0,
+                          CONTROL_TS_S, CONTROL_TS_S, CONTROL_TS_S},
+    [PARAM_FILTER]     = {"filter",     "",           PARAM_T_U32, ZP, 0x48,
+                          0.0f, (float)FILTER_KALMAN, (float)TEMP_FILT_TYPE},
+    [PARAM_FILTER_N]   = {"filter_n",   "samples",    PARAM_T_U32, ZP, 0x4C,
+                          1.0f, (float)FILTER_MA_MAX_N, (float)TEMP_FILT_N},
+    [PARAM_FILTER_DELAY] = {"filter_delay", "s",      PARAM_T_F32, PARAM_F_ZONE | PARAM_F_RO, 0,
+                          0.0f, 0.5f * (FILTER_MA_MAX_N - 1U) * CONTROL_TS_S,
+                          0.5f * (TEMP_FILT_N - 1U) * CONTROL_TS_S},
+};
+
+/* Lower and upper value of a pair that must stay ordered. */
+static const uint8_t pairs[][2] = {
+    {PARAM_SP_MIN,    PARAM_SP_MAX},
+    {PARAM_ALARM_MIN, PARAM_ALARM_MAX},
+    {PARAM_FAN_OFF,   PARAM_FAN_ON},
+};
+
+static uint8_t  index_slot[HASH_SLOTS];   /* id + 1, 0 = empty */
+
+static float    staged[PARAM_COUNT][ZONE_COUNT];
+static uint8_t  staged_mask[PARAM_COUNT];  /* bit z: staged[id][z] set */
+static uint32_t staged_n;
+
+static uint32_t tlm_period_ms = TELEMETRY_PERIOD_MS;
+
+/* NTC constants collected by one Param_Apply(), the table is rebuilt once. */
+static ntc_params_t ntc_new;
+static bool         ntc_changed;
+
+/* Zones whose filter type or length one Param_Apply() changed. */
+static uint8_t      filter_changed;
+
+static uint32_t hash(const char *s, size_t len)
+{
+    uint32_t h = 2166136261UL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)s[i];
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+static bool valid_zone(param_id_t id, uint8_t zone)
+{
+    return (uint32_t)id < PARAM_COUNT && zone < Param_Count(id);
+}
+
+static float get(param_id_t id, uint8_t z)
+{
+    const zone_table_t *zt  = Zone_Table();
+    const ntc_params_t *ntc = Temperature_GetNtc();
+
+    switch (id) {
+    case PARAM_SP_MIN:     return zt->sp_min_c[z];
+    case PARAM_SP_MAX:     return zt->sp_max_c[z];
+    case PARAM_ALARM_MIN:  return zt->alarm_min_c[z];
+    case PARAM_ALARM_MAX:  return zt->alarm_max_c[z];
+    case PARAM_SP:         return zt->setpoint_c[z];
+    case PARAM_KP:         return zt->kp[z];
+    case PARAM_KI:         return zt->ki[z];
+    case PARAM_FAN_ON:     return zt->fan_on_c[z];
+    case PARAM_FAN_OFF:    return zt->fan_off_c[z];
+    case PARAM_NTC_BETA:   return ntc->beta;
+    case PARAM_NTC_R0:     return ntc->r0;
+    case PARAM_NTC_T0:     return ntc->t0_k;
+    case PARAM_R_FIXED:    return ntc->r_fixed;
+    case PARAM_TLM_PERIOD: return (float)tlm_period_ms;
+    case PARAM_CONTROL_TS: return CONTROL_TS_S;
+    case PARAM_FILTER:     return (float)zt->filter_type[z];
+    case PARAM_FILTER_N:   return (float)zt->filter_n[z];
+    case PARAM_FILTER_DELAY: return Temperature_GetFilterDelayS(z);
+    default:               return 0.0f;
+    }
+}
+
+/* Value after the next Param_Apply(). */
+static float effective(param_id_t id, uint8_t z)
+{
+    if (staged_mask[id] & (1U << z)) return staged[id][z];
+    return get(id, z);
+}
+
+static void set_gains(uint8_t z)
+{
+    zone_table_t *zt  = Zone_Table();
+    pid_ctrl_t   *pid = Control_GetPID(z);
+
+    PID_SetGains(pid, zt->kp[z], zt->ki[z], pid->p.kd);
+    pid->p.tt_s = (zt->ki[z] > 0.0f) ? zt->kp[z] / zt->ki[z] : PID_TT_S;
+}
+
+static void apply(param_id_t id, uint8_t z, float v)
+{
+    zone_table_t *zt = Zone_Table();
+
+    switch (id) {
+    case PARAM_SP_MIN:
+        zt->sp_min_c[z] = v;
+        Setpoint_SetC(z, zt->setpoint_c[z]);   /* back into the range */
+        break;
+    case PARAM_SP_MAX:
+        zt->sp_max_c[z] = v;
+        Setpoint_SetC(z, zt->setpoint_c[z]);
+        break;
+    case PARAM_ALARM_MIN:
+        zt->alarm_min_c[z] = v;
+        break;
+    case PARAM_ALARM_MAX:
+        zt->alarm_max_c[z] = v;
+        break;
+    case PARAM_SP:
+        /* Also the T command: a set value replaces a running profile. */
+        Profile_Stop(z);
+        Setpoint_SetC(z, v);
+        break;
+    case PARAM_KP:
+        zt->kp[z] = v;
+        set_gains(z);
+        break;
+    case PARAM_KI:
+        zt->ki[z] = v;
+        set_gains(z);
+        break;
+    case PARAM_FAN_ON:
+        zt->fan_on_c[z] = v;
+        break;
+    case PARAM_FAN_OFF:
+        zt->fan_off_c[z] = v;
+        break;
+    case PARAM_NTC_BETA:
+        ntc_new.beta = v;
+        ntc_changed  = true;
+        break;
+    case PARAM_NTC_R0:
+        ntc_new.r0  = v;
+        ntc_changed = true;
+        break;
+    case PARAM_NTC_T0:
+        ntc_new.t0_k = v;
+        ntc_changed  = true;
+        break;
+    case PARAM_R_FIXED:
+        ntc_new.r_fixed = v;
+        ntc_changed     = true;
+        break;
+    case PARAM_TLM_PERIOD:
+        tlm_period_ms = (uint32_t)v;
+        /* Not registered yet while the saved values are loaded. */
+        (void)Sched_SetPeriod(Sched_FindTask("telemetry"), tlm_period_ms);
+        break;
+    case PARAM_FILTER:
+        zt->filter_type[z] = (uint8_t)v;
+        filter_changed |= (uint8_t)(1U << z);
+        break;
+    case PARAM_FILTER_N:
+        zt->filter_n[z] = (uint8_t)v;
+        filter_changed |= (uint8_t)(1U << z);
+        break;
+    default:
+        break;
+    }
+}
+
+/* Range and type of the descriptor. */
+static bool in_range(const param_desc_t *d, float v)
+{
+    if (!(v >= d->min && v <= d->max)) return false;   /* also NaN */
+    return d->type != PARAM_T_U32 || v == floorf(v);
+}
+
+/* Order against the related values, as they will be after Param_Apply(). */
+static bool consistent(param_id_t id, uint8_t z, float v)
+{
+    if (id == PARAM_SP) {
+        return v >= effective(PARAM_SP_MIN, z) && v <= effective(PARAM_SP_MAX, z);
+    }
+    for (uint32_t i = 0; i < sizeof(pairs) / sizeof(pairs[0]); i++) {
+        if (id == pairs[i][0]) return v < effective((param_id_t)pairs[i][1], z);
+        if (id == pairs[i][1]) return v > effective((param_id_t)pairs[i][0], z);
+    }
+    return true;
+}
+
+static void stage(param_id_t id, uint8_t z, float v)
+{
+    if (!(staged_mask[id] & (1U << z))) {
+        staged_mask[id] |= (uint8_t)(1U << z);
+        staged_n++;
+    }
+    staged[id][z] = v;
+}
+
+void Param_Init(void)
+{
+    memset(index_slot, 0, sizeof(index_slot));
+    memset(staged_mask, 0, sizeof(staged_mask));
+    staged_n      = 0;
+    tlm_period_ms = TELEMETRY_PERIOD_MS;
+
+    for (uint32_t id = 0; id < PARAM_COUNT; id++) {
+        uint32_t h = hash(desc[id].name, strlen(desc[id].name));
+        while (index_slot[h & (HASH_SLOTS - 1U)] != 0U) h++;
+        index_slot[h & (HASH_SLOTS - 1U)] = (uint8_t)(id + 1U);
+    }
+}
+
+const param_desc_t *Param_Desc(param_id_t id)
+{
+    return ((uint32_t)id < PARAM_COUNT) ? &desc[id] : NULL;
+}
+
+int Param_Find(const char *name, size_t len)
+{
+    uint32_t h = hash(name, len);
+
+    for (uint32_t n = 0; n < HASH_SLOTS; n++, h++) {
+        uint8_t slot = index_slot[h & (HASH_SLOTS - 1U)];
+        if (slot == 0U) break;
+
+        const char *s = desc[slot - 1U].name;
+        if (strncmp(s, name, len) == 0 && s[len] == '\0') return (int)(slot - 1U);
+    }
+    return -1;
+}
+
+uint8_t Param_Count(param_id_t id)
+{
+    if ((uint32_t)id >= PARAM_COUNT) return 0;
+    return (desc[id].flags & PARAM_F_ZONE) ? (uint8_t)ZONE_COUNT : 1U;
+}
+
+bool Param_Get(param_id_t id, uint8_t zone, float *value)
+{
+    if (!valid_zone(id, zone)) return false;
+    *value = get(id, zone);
+    return true;
+}
+
+bool Param_Set(param_id_t id, uint8_t zone, float value)
+{
+    if (!valid_zone(id, zone)) return false;
+
+    const param_desc_t *d = &desc[id];
+    if ((d->flags & PARAM_F_RO) || !in_range(d, value) || !consistent(id, zone, value)) {
+        return false;
+    }
+    stage(id, zone, value);
+    return true;
+}
+
+void Param_SetDefaults(void)
+{
+    /* The defaults are consistent with each other; no order checks. */
+    for (uint32_t id = 0; id < PARAM_COUNT; id++) {
+        if (desc[id].flags & PARAM_F_RO) continue;
+        for (uint8_t z = 0; z < Param_Count((param_id_t)id); z++) {
+            stage((param_id_t)id, z, desc[id].def);
+        }
+    }
+}
+
+void Param_Apply(void)
+{
+    if (staged_n == 0U) return;
+
+    ntc_new        = *Temperature_GetNtc();
+    ntc_changed    = false;
+    filter_changed = 0;
+
+    for (uint32_t id = 0; id < PARAM_COUNT; id++) {
+        uint8_t mask = staged_mask[id];
+        for (uint8_t z = 0; mask != 0U; z++, mask >>= 1) {
+            if (mask & 1U) apply((param_id_t)id, z, staged[id][z]);
+        }
+        staged_mask[id] = 0;
+    }
+    staged_n = 0;
+
+    if (ntc_changed) {
+        Temperature_SetNtc(&ntc_new);
+        OverTemp_Update();
+    }
+
+    /* Type and length together: one re-initialisation per zone. */
+    const zone_table_t *zt = Zone_Table();
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+        if (filter_changed & (1U << z)) {
+            Temperature_SetFilter(z, (filter_type_t)zt->filter_type[z], zt->filter_n[z]);
+        }
+    }
+}
+
+bool Param_Load(param_id_t id, uint8_t zone, float value)
+{
+    if (!valid_zone(id, zone)) return false;
+
+    const param_desc_t *d = &desc[id];
+    if ((d->flags & PARAM_F_RO) || !in_range(d, value)) return false;
+    stage(id, zone, value);
+    return true;
+}
+
+void Param_CheckLimits(void)
+{
+    for (uint32_t i = 0; i < sizeof(pairs) / sizeof(pairs[0]); i++) {
+        param_id_t lo = (param_id_t)pairs[i][0];
+        param_id_t hi = (param_id_t)pairs[i][1];
+
+        for (uint8_t z = 0; z < Param_Count(lo); z++) {
+            if (effective(lo, z) < effective(hi, z)) continue;
+            stage(lo, z, desc[lo].def);
+            stage(hi, z, desc[hi].def);
+        }
+    }
+}
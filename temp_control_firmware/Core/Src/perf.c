@@ -0,0 +1,127 @@
+/**
+ * @file perf.c
+ * @brief Execution time profiling implementation.
+ *
+ * On the target the DWT cycle counter is enabled through the trace enable
+ * bit of DEMCR; the Cortex-M7 also needs the DWT unlocked through its
+ * lock access register before CTRL can be written.
+ */
+
+#ifdef HOST_BUILD
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "perf.h"
+#include "memmap.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#ifdef HOST_BUILD
+#include <time.h>
+#endif
+
+static perf_stat_t stats[PERF_SEC_COUNT];
+static perf_loop_t loop;
+static uint32_t    loop_last;
+static bool        loop_started;
+static uint32_t    hz;
+
+static const char *const names[PERF_SEC_COUNT] = {
+    "adc", "filter", "control", "uart", "tlm", "loop"
+};
+
+#ifdef HOST_BUILD
+uint32_t Perf_Now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
+#endif
+
+void Perf_Init(void)
+{
+#ifdef HOST_BUILD
+    hz = 1000000000UL;
+#else
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55UL;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    hz = SystemCoreClock;
+#endif
+    Perf_Reset();
+}
+
+void Perf_Reset(void)
+{
+    memset(stats, 0, sizeof(stats));
+    memset(&loop, 0, sizeof(loop));
+    loop_started = false;
+}
+
+ITCM_CODE void Perf_Record(perf_sec_t sec, uint32_t ticks)
+{
+    perf_stat_t *s = &stats[sec];
+
+    s->n++;
+    s->sum += ticks;
+    if (s->n == 1U || ticks < s->min) s->min = ticks;
+    if (ticks > s->max) s->max = ticks;
+
+    uint32_t bin = (uint32_t)(31 - __builtin_clz(ticks | 1U));
+    bin = (bin > PERF_HIST_SHIFT) ? bin - PERF_HIST_SHIFT : 0U;
+    if (bin >= PERF_HIST_BINS) bin = PERF_HIST_BINS - 1U;
+    s->hist[bin]++;
+
+    if (sec == PERF_LOOP && ticks > hz / 1000000UL * PERF_LOOP_BUDGET_US) {
+        loop.overruns++;
+    }
+}
+
+ITCM_CODE void Perf_LoopMark(void)
+{
+    uint32_t now = Perf_Now();
+
+    /* The first mark after a reset only sets the reference. */
+    if (loop_started) {
+        int32_t jitter = (int32_t)(now - loop_last - hz / 1000UL * CONTROL_PERIOD_MS);
+        loop.n++;
+        if (loop.n == 1U || jitter < loop.jitter_min) loop.jitter_min = jitter;
+        if (loop.n == 1U || jitter > loop.jitter_max) loop.jitter_max = jitter;
+    }
+    loop_last    = now;
+    loop_started = true;
+}
+
+const perf_stat_t *Perf_GetStat(perf_sec_t sec)
+{
+    return &stats[(sec < PERF_SEC_COUNT) ? sec : PERF_ADC];
+}
+
+const perf_loop_t *Perf_GetLoop(void)
+{
+    return &loop;
+}
+
+uint32_t Perf_GetMean(perf_sec_t sec)
+{
+    const perf_stat_t *s = Perf_GetStat(sec);
+    return (s->n > 0U) ? (uint32_t)(s->sum / s->n) : 0U;
+}
+
+uint32_t Perf_GetHz(void)
+{
+    return hz;
+}
+
+float Perf_ToUs(uint32_t ticks)
+{
+    return (hz > 0U) ? (float)ticks * (1.0e6f / (float)hz) : 0.0f;
+}
+
+const char *Perf_SectionName(perf_sec_t sec)
+{
+    return (sec < PERF_SEC_COUNT) ? names[sec] : "?";
+}
@@ -0,0 +1,145 @@
+/**
+ * @file pid.c
+ * @brief Implementation of the discrete PID controller object.
+ *
+ * Control law (Astrom/Hagglund form, backward differences):
+ *
+ *   P = kp * (b*ref - meas)
+ *   D = tf/(tf+Ts) * D + kd/(tf+Ts) * (y - y_prev),   y = c*ref - meas
+ *   v = P + I + D + FF
+ *   u = rate_limit(sat(v))
+ *   I += ki*Ts*(ref - meas) + Ts/tt * (u - v)
+ *
+ * FF is the feed-forward term set from outside (PID_SetFeedForward()).
+ * Being part of v, it is covered by the saturation and the back-
+ * calculation: the integrator only winds down by what the combined
+ * output could not deliver.
+ *
+ * In manual mode the same terms are computed, but the integrator is
+ * forced to track the manual output so that returning to automatic mode
+ * starts from the current output.
+ */
+
+#include "pid.h"
+#include "memmap.h"
+
+ITCM_CODE static float clampf(float x, float lo, float hi)
+{
+    if (x < lo) return lo;
+    if (x > hi) return hi;
+    return x;
+}
+
+void PID_Init(pid_ctrl_t *pid, const pid_params_t *params)
+{
+    pid->p = *params;
+    pid->mode = PID_MODE_AUTO;
+    pid->u_man = params->out_min;
+    pid->ff = 0.0f;
+    PID_Reset(pid);
+}
+
+void PID_Reset(pid_ctrl_t *pid)
+{
+    pid->i_term  = 0.0f;
+    pid->d_term  = 0.0f;
+    pid->prev_y  = 0.0f;
+    pid->last_ep = 0.0f;
+    pid->u       = clampf(0.0f, pid->p.out_min, pid->p.out_max);
+    pid->started = false;
+}
+
+ITCM_CODE float PID_Update(pid_ctrl_t *pid, float ref, float meas)
+{
+    const pid_params_t *p = &pid->p;
+    const float ts = p->ts_s;
+
+    float e  = ref - meas;
+    float ep = p->b * ref - meas;
+    float y  = p->c * ref - meas;
+
+    /* No derivative kick on the first sample. */
+    if (!pid->started) {
+        pid->prev_y  = y;
+        pid->started = true;
+    }
+
+    float P = p->kp * ep;
+
+    float den = p->tf_s + ts;
+    pid->d_term = (p->tf_s / den) * pid->d_term + (p->kd / den) * (y - pid->prev_y);
+    pid->prev_y  = y;
+    pid->last_ep = ep;
+
+    float v = P + pid->i_term + pid->d_term + pid->ff;
+
+    if (pid->mode == PID_MODE_MANUAL) {
+        pid->u = clampf(pid->u_man, p->out_min, p->out_max);
+        pid->i_term = pid->u - P - pid->d_term - pid->ff;
+        return pid->u;
+    }
+
+    float u = clampf(v, p->out_min, p->out_max);
+
+    if (p->rate_max > 0.0f) {
+        float du = p->rate_max * ts;
+        u = clampf(u, pid->u - du, pid->u + du);
+    }
+
+    if (p->tt_s > 0.0f) {
+        pid->i_term += p->ki * ts * e + (ts / p->tt_s) * (u - v);
+    } else {
+        bool sat_high = (u >= p->out_max) && (e > 0.0f);
+        bool sat_low  = (u <= p->out_min) && (e < 0.0f);
+        if (!(sat_high || sat_low)) {
+            pid->i_term += p->ki * ts * e;
+        }
+    }
+
+    pid->u = u;
+    return u;
+}
+
+void PID_SetGains(pid_ctrl_t *pid, float kp, float ki, float kd)
+{
+    /* Keep P + I + D unchanged at the last operating point. */
+    float d_new = (pid->p.kd != 0.0f) ? pid->d_term * (kd / pid->p.kd) : 0.0f;
+
+    pid->i_term += (pid->p.kp - kp) * pid->last_ep + (pid->d_term - d_new);
+    pid->d_term  = d_new;
+
+    pid->p.kp = kp;
+    pid->p.ki = ki;
+    pid->p.kd = kd;
+}
+
+void PID_SetMode(pid_ctrl_t *pid, pid_mode_t mode)
+{
+    if (mode == pid->mode) return;
+
+    if (mode == PID_MODE_MANUAL) {
+        /* Hold the current output until a manual value is written. */
+        pid->u_man = pid->u;
+    }
+    /* Manual -> auto needs nothing: the integrator already tracks u. */
+    pid->mode = mode;
+}
+
+void PID_SetManual(pid_ctrl_t *pid, float u)
+{
+    pid->u_man = clampf(u, pid->p.out_min, pid->p.out_max);
+}
+
+void PID_SetFeedForward(pid_ctrl_t *pid, float u_ff)
+{
+    pid->ff = u_ff;
+}
+
+void PID_SetFeedForwardBumpless(pid_ctrl_t *pid, float u_ff)
+{
+    /* Before the first step there is no output to keep. */
+    if (pid->started) {
+        pid->i_term += pid->ff - u_ff;
+    }
+    pid->ff = u_ff;
+}
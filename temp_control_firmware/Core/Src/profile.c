@@ -0,0 +1,153 @@
+/**
+ * @file profile.c
+ * @brief Setpoint profile engine implementation.
+ *
+ * The profiles live in the profile[] column of the zone table. Segment
+ * times are counted in control steps, so a profile runs in step with the
+ * controller and needs no clock of its own.
+ */
+
+#include "profile.h"
+#include "config.h"
+#include "memmap.h"
+#include "setpoint.h"
+#include "trace.h"
+#include "zone.h"
+
+#include <math.h>
+#include <string.h>
+
+ITCM_CODE static profile_t *get(uint8_t zone)
+{
+    return &Zone_Table()->profile[zone];
+}
+
+ITCM_CODE static void enter(profile_t *p, uint8_t i)
+{
+    p->i       = i;
+    p->reached = false;
+    p->seg_n   = 0;
+    p->hold_n  = 0;
+    Trace_Record(TRACE_EV_PROFILE, TRACE_ZARG(p - Zone_Table()->profile, i));
+}
+
+/* Next segment after the hold of the current one. */
+ITCM_CODE static void advance(profile_t *p)
+{
+    const profile_seg_t *s = &p->seg[p->i];
+
+    if (s->repeat > 0U && p->loops[p->i] < s->repeat) {
+        p->loops[p->i]++;
+        /* Inner loops run their full count again on every pass. */
+        for (uint8_t j = s->loop_to; j < p->i; j++) p->loops[j] = 0;
+        enter(p, s->loop_to);
+        return;
+    }
+
+    p->loops[p->i] = 0;
+    if (p->i + 1U >= p->n) {
+        p->state = PROFILE_DONE;
+        return;
+    }
+    enter(p, (uint8_t)(p->i + 1U));
+}
+
+void Profile_Clear(uint8_t zone)
+{
+    if (zone >= ZONE_COUNT) return;
+    memset(get(zone), 0, sizeof(profile_t));
+}
+
+bool Profile_AddSegment(uint8_t zone, const profile_seg_t *seg)
+{
+    if (zone >= ZONE_COUNT) return false;
+
+    const zone_table_t *zt = Zone_Table();
+    profile_t *p = get(zone);
+
+    if (p->n >= PROFILE_MAX_SEG || p->state == PROFILE_RUNNING ||
+        p->state == PROFILE_PAUSED) {
+        return false;
+    }
+    if (!(seg->rate_c_per_s >= 0.0f) || !(seg->hold_s >= 0.0f) ||
+        !(seg->target_c >= zt->sp_min_c[zone] && seg->target_c <= zt->sp_max_c[zone]) ||
+        seg->loop_to > p->n) {
+        return false;
+    }
+
+    p->seg[p->n++] = *seg;
+    return true;
+}
+
+bool Profile_Start(uint8_t zone)
+{
+    if (zone >= ZONE_COUNT) return false;
+
+    profile_t *p = get(zone);
+    if (p->n == 0U) return false;
+
+    if (p->state != PROFILE_PAUSED) {
+        memset(p->loops, 0, sizeof(p->loops));
+        enter(p, 0);
+        p->sp_c = Setpoint_GetC(zone);
+    }
+    p->state = PROFILE_RUNNING;
+    return true;
+}
+
+void Profile_Pause(uint8_t zone)
+{
+    if (zone < ZONE_COUNT && get(zone)->state == PROFILE_RUNNING) {
+        get(zone)->state = PROFILE_PAUSED;
+    }
+}
+
+void Profile_Stop(uint8_t zone)
+{
+    if (zone < ZONE_COUNT && get(zone)->state != PROFILE_DONE) {
+        get(zone)->state = PROFILE_IDLE;
+    }
+}
+
+ITCM_CODE void Profile_Update(uint8_t zone)
+{
+    if (zone >= ZONE_COUNT) return;
+
+    profile_t *p = get(zone);
+    if (p->state != PROFILE_RUNNING) return;
+
+    const profile_seg_t *s = &p->seg[p->i];
+
+    if (p->reached) {
+        uint32_t hold = (uint32_t)lroundf(s->hold_s / CONTROL_TS_S);
+        if (++p->hold_n >= hold) {
+            advance(p);
+            if (p->state != PROFILE_RUNNING) return;
+            s = &p->seg[p->i];
+        }
+    }
+    p->seg_n++;
+
+    if (!p->reached) {
+        float step = s->rate_c_per_s * CONTROL_TS_S;
+        float d = s->target_c - p->sp_c;
+
+        if (s->rate_c_per_s <= 0.0f || fabsf(d) <= step) {
+            p->sp_c = s->target_c;
+            p->reached = true;
+        } else {
+            p->sp_c += (d > 0.0f) ? step : -step;
+        }
+        Setpoint_SetC(zone, p->sp_c);
+    }
+}
+
+const profile_t *Profile_Get(uint8_t zone)
+{
+    return get((zone < ZONE_COUNT) ? zone : 0U);
+}
+
+float Profile_GetSegmentTimeS(uint8_t zone)
+{
+    return (float)Profile_Get(zone)->seg_n * CONTROL_TS_S;
+}
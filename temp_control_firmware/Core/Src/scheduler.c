@@ -0,0 +1,129 @@
+/**
+ * @file scheduler.c
+ * @brief Implementation of the cooperative task scheduler.
+ *
+ * Tasks are kept in a small static table. Release times are absolute
+ * tick values; all comparisons use wrap-safe signed differences, so the
+ * 32-bit millisecond counter may overflow freely.
+ */
+
+#include "scheduler.h"
+#include "memmap.h"
+#include "trace.h"
+#include <stddef.h>
+#include <string.h>
+
+static sched_task_t      tasks[SCHED_MAX_TASKS];
+static uint32_t          task_count = 0;
+static sched_tick_fn_t   tick_fn = NULL;
+static volatile uint32_t tick_ms DTCM_DATA = 0;
+
+void Sched_Init(sched_tick_fn_t now_ms)
+{
+    task_count = 0;
+    tick_ms = 0;
+    tick_fn = (now_ms != NULL) ? now_ms : Sched_GetTick;
+}
+
+int Sched_AddTask(const char *name, sched_task_fn_t fn,
+                  uint32_t period_ms, uint32_t phase_ms)
+{
+    if (fn == NULL || period_ms == 0U) return -1;
+    if (task_count >= SCHED_MAX_TASKS) return -1;
+
+    sched_task_t *t = &tasks[task_count];
+    t->name        = name;
+    t->fn          = fn;
+    t->period_ms   = period_ms;
+    t->next_due_ms = tick_fn() + phase_ms;
+    t->runs        = 0;
+    t->misses      = 0;
+    t->max_late_ms = 0;
+
+    return (int)task_count++;
+}
+
+bool Sched_SetPeriod(int id, uint32_t period_ms)
+{
+    if (id < 0 || (uint32_t)id >= task_count || period_ms == 0U) return false;
+
+    sched_task_t *t = &tasks[id];
+    uint32_t now = tick_fn();
+
+    /* A shorter period takes effect now, not after the old one. */
+    if ((int32_t)(t->next_due_ms - (now + period_ms)) > 0) {
+        t->next_due_ms = now + period_ms;
+    }
+    t->period_ms = period_ms;
+    return true;
+}
+
+int Sched_FindTask(const char *name)
+{
+    for (uint32_t i = 0; i < task_count; i++) {
+        if (tasks[i].name != NULL && strcmp(tasks[i].name, name) == 0) return (int)i;
+    }
+    return -1;
+}
+
+bool Sched_RunPending(void)
+{
+    bool ran = false;
+
+    for (uint32_t i = 0; i < task_count; i++) {
+        sched_task_t *t = &tasks[i];
+        uint32_t now = tick_fn();
+        int32_t late = (int32_t)(now - t->next_due_ms);
+
+        if (late < 0) continue;
+
+        uint32_t late_ms = (uint32_t)late;
+        if (late_ms > t->max_late_ms) t->max_late_ms = late_ms;
+
+        /* Skip releases that were overrun, keep the original phase. */
+        uint32_t skipped = late_ms / t->period_ms;
+        t->misses      += skipped;
+        t->next_due_ms += (skipped + 1U) * t->period_ms;
+
+        Trace_Record(TRACE_EV_TASK_BEGIN, (uint16_t)i);
+        t->fn();
+        Trace_Record(TRACE_EV_TASK_END, (uint16_t)i);
+        t->runs++;
+        ran = true;
+    }
+
+    return ran;
+}
+
+ITCM_CODE void Sched_TickISR(void)
+{
+    tick_ms++;
+
+    /* Lets a trace decoder unwrap the cycle counter timestamps. */
+    if (tick_ms % TRACE_SYNC_MS == 0U) {
+        Trace_Record(TRACE_EV_SYNC, (uint16_t)(tick_ms / 1000U));
+    }
+}
+
+uint32_t Sched_GetTick(void)
+{
+    return tick_ms;
+}
+
+const sched_task_t *Sched_GetTask(int id)
+{
+    if (id < 0 || (uint32_t)id >= task_count) return NULL;
+    return &tasks[id];
+}
+
+uint32_t Sched_GetTaskCount(void)
+{
+    return task_count;
+}
+
+uint32_t Sched_GetTotalMisses(void)
+{
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < task_count; i++) sum += tasks[i].misses;
+    return sum;
+}
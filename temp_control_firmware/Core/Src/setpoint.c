@@ -9,6 +9,8 @@
  * All setpoint values are constrained to a predefined safe range in order
  * to prevent unsafe operating conditions.
  *
+ * Each zone has its own setpoint and range, stored in the zone table.
+ *
  * Typical sources of setpoint changes:
  *  - UART commands
  *  - User button input
@@ -18,20 +20,22 @@
  * Borys Ovsiyenko
  */
 #include "setpoint.h"
-#include "config.h"
-
-static volatile float g_setpoint_c = T_SETPOINT_DEFAULT_C;
+#include "memmap.h"
+#include "zone.h"
 
-float Setpoint_GetC(void)
+float Setpoint_GetC(uint8_t zone)
 {
-    return g_setpoint_c;
+    if (zone >= ZONE_COUNT) return 0.0f;
+    return Zone_Table()->setpoint_c[zone];
 }
 
-void Setpoint_SetC(float value_c)
+ITCM_CODE void Setpoint_SetC(uint8_t zone, float value_c)
 {
-    if (value_c < T_SAFE_MIN_C) value_c = T_SAFE_MIN_C;
-    if (value_c > T_SAFE_MAX_C) value_c = T_SAFE_MAX_C;
+    zone_table_t *zt = Zone_Table();
+    if (zone >= ZONE_COUNT) return;
 
-    g_setpoint_c = value_c;
+    if (value_c < zt->sp_min_c[zone]) value_c = zt->sp_min_c[zone];
+    if (value_c > zt->sp_max_c[zone]) value_c = zt->sp_max_c[zone];
 
+    zt->setpoint_c[zone] = value_c;
 }
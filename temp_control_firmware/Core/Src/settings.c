@@ -0,0 +1,113 @@
+/**
+ * @file settings.c
+ * @brief Persistent settings implementation.
+ *
+ * Every PARAM_F_PERSIST parameter of the registry (param.h) is a setting,
+ * one value per zone or one for all. saved[] holds the value last loaded
+ * or written; a value that differs from it is a candidate, written when
+ * it has not changed for SETTINGS_HOLD_MS. A failed write is not retried
+ * until the value changes again, so a broken flash does not stall the
+ * main loop with an erase every period.
+ */
+
+#include "settings.h"
+#include "config.h"
+#include "main.h"
+#include "param.h"
+#include "profile.h"
+#include "store.h"
+#include "zone.h"
+
+static float    saved[PARAM_COUNT][ZONE_COUNT];
+static float    candidate[PARAM_COUNT][ZONE_COUNT];
+static uint32_t since_ms[PARAM_COUNT][ZONE_COUNT];
+static bool     pending[PARAM_COUNT][ZONE_COUNT];
+
+static bool persistent(param_id_t id)
+{
+    return (Param_Desc(id)->flags & PARAM_F_PERSIST) != 0U;
+}
+
+static uint16_t key(param_id_t id, uint8_t z)
+{
+    return (uint16_t)(Param_Desc(id)->key + z);
+}
+
+/* Take the current values as the saved ones. */
+static void mark_saved(void)
+{
+    for (uint32_t id = 0; id < PARAM_COUNT; id++) {
+        for (uint8_t z = 0; z < Param_Count((param_id_t)id); z++) {
+            (void)Param_Get((param_id_t)id, z, &saved[id][z]);
+            pending[id][z] = false;
+        }
+    }
+}
+
+void Settings_Load(void)
+{
+    (void)Store_Init();
+
+    for (uint32_t id = 0; id < PARAM_COUNT; id++) {
+        if (!persistent((param_id_t)id)) continue;
+
+        for (uint8_t z = 0; z < Param_Count((param_id_t)id); z++) {
+            float v;
+            if (Store_ReadFloat(key((param_id_t)id, z), &v)) {
+                (void)Param_Load((param_id_t)id, z, v);
+            }
+        }
+    }
+    Param_CheckLimits();
+    Param_Apply();
+    mark_saved();
+}
+
+void Settings_Task(void)
+{
+    uint32_t now = HAL_GetTick();
+
+    for (uint32_t id = 0; id < PARAM_COUNT; id++) {
+        if (!persistent((param_id_t)id)) continue;
+
+        for (uint8_t z = 0; z < Param_Count((param_id_t)id); z++) {
+            float v;
+            (void)Param_Get((param_id_t)id, z, &v);
+
+            if (id == PARAM_SP) {
+                uint8_t st = Profile_Get(z)->state;
+                if (st == PROFILE_RUNNING || st == PROFILE_PAUSED) {
+                    pending[id][z] = false;
+                    continue;
+                }
+            }
+
+            if (v == saved[id][z]) {
+                pending[id][z] = false;
+            } else if (!pending[id][z] || v != candidate[id][z]) {
+                candidate[id][z] = v;
+                since_ms[id][z]  = now;
+                pending[id][z]   = true;
+            } else if (now - since_ms[id][z] >= SETTINGS_HOLD_MS) {
+                (void)Store_WriteFloat(key((param_id_t)id, z), v);
+                saved[id][z]   = v;
+                pending[id][z] = false;
+            }
+        }
+    }
+}
+
+bool Settings_Restore(void)
+{
+    bool ok = Store_Format();
+
+    /* Applied at the next control step; nothing to save after that. */
+    Param_SetDefaults();
+    for (uint32_t id = 0; id < PARAM_COUNT; id++) {
+        for (uint8_t z = 0; z < Param_Count((param_id_t)id); z++) {
+            saved[id][z]   = Param_Desc((param_id_t)id)->def;
+            pending[id][z] = false;
+        }
+    }
+    return ok;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file smith.c
+ * @brief Smith predictor implementation.
+ *
+ * The model state is advanced with the exact step response of the first
+ * order lag for an output held over one control period. The delay line
+ * is a ring: Smith_Update() writes the new x at head and advances it, so
+ * x(t) sits at head - 1 and x(t - L) at head - 1 - delay.
+ *
+ * A control step costs one model update and the residual filters; only
+ * Smith_Init() (exp) and Smith_Reset() (delay line fill) do more.
+ */
+
+#include "smith.h"
+#include "config.h"
+#include "memmap.h"
+
+#include <math.h>
+
+static const float resid_alpha = CONTROL_TS_S / SMITH_RESID_TAU_S;
+
+ITCM_CODE static float delayed(const smith_t *sp)
+{
+    /* line[head - 1] is x itself, so no dead time needs no special case. */
+    return sp->line[(sp->head + SMITH_DELAY_MAX - 1U - sp->delay) % SMITH_DELAY_MAX];
+}
+
+bool Smith_Init(smith_t *sp, const smith_model_t *model, float u0_pct)
+{
+    float steps = model->dead_s / CONTROL_TS_S;
+
+    if (!(model->k_c_per_pct > 0.0f) || !(model->tau_s > 0.0f) ||
+        !(model->dead_s >= 0.0f) || steps > (float)(SMITH_DELAY_MAX - 1U)) {
+        return false;
+    }
+
+    sp->m     = *model;
+    sp->a     = 1.0f - expf(-CONTROL_TS_S / model->tau_s);
+    sp->delay = (uint16_t)lroundf(steps);
+    Smith_Reset(sp, u0_pct);
+    return true;
+}
+
+void Smith_Reset(smith_t *sp, float u0_pct)
+{
+    sp->x = sp->m.k_c_per_pct * u0_pct;
+    for (uint16_t i = 0; i < SMITH_DELAY_MAX; i++) sp->line[i] = sp->x;
+    sp->head = 0;
+
+    sp->resid_c      = 0.0f;
+    sp->resid_mean_c = 0.0f;
+    sp->resid_var    = 0.0f;
+    sp->bad_n        = 0;
+    sp->flags        = 0;
+}
+
+ITCM_CODE float Smith_Feedback(smith_t *sp, float meas_c, float ambient_c)
+{
+    const uint16_t hold = (uint16_t)(SMITH_RESID_HOLD_S / CONTROL_TS_S);
+    const float x_d = delayed(sp);
+
+    float r = meas_c - ambient_c - x_d;
+    float dev = r - sp->resid_mean_c;
+    sp->resid_c       = r;
+    sp->resid_mean_c += resid_alpha * dev;
+    sp->resid_var    += resid_alpha * (dev * dev - sp->resid_var);
+
+    if (sp->resid_var > SMITH_RESID_MAX_C * SMITH_RESID_MAX_C) {
+        if (sp->bad_n < hold) sp->bad_n++;
+    } else {
+        sp->bad_n = 0;
+    }
+    if (sp->bad_n >= hold) {
+        sp->flags |= SMITH_MISMATCH;
+    } else {
+        sp->flags &= (uint8_t)~SMITH_MISMATCH;
+    }
+
+    return meas_c + sp->x - x_d;
+}
+
+ITCM_CODE void Smith_Update(smith_t *sp, float u_pct)
+{
+    sp->x += sp->a * (sp->m.k_c_per_pct * u_pct - sp->x);
+    sp->line[sp->head] = sp->x;
+    sp->head = (uint16_t)((sp->head + 1U) % SMITH_DELAY_MAX);
+}
+
+float Smith_GetResidualRms(const smith_t *sp)
+{
+    return sqrtf(sp->resid_var);
+}
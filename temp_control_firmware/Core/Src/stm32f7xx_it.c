@@ -22,6 +22,7 @@
 #include "stm32f7xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "trace.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -199,8 +200,45 @@ void SysTick_Handler(void)
 /******************************************************************************/
 
 /* USER CODE BEGIN 1 */
+void ADC_IRQHandler(void)
+{
+  Trace_Record(TRACE_EV_ISR_ENTER, ADC_IRQn);
+  HAL_ADC_IRQHandler(&hadc1);
+  Trace_Record(TRACE_EV_ISR_EXIT, ADC_IRQn);
+}
+
 void USART3_IRQHandler(void)
 {
+  Trace_Record(TRACE_EV_ISR_ENTER, USART3_IRQn);
   HAL_UART_IRQHandler(&huart3);
+  Trace_Record(TRACE_EV_ISR_EXIT, USART3_IRQn);
+}
+
+void TIM7_IRQHandler(void)
+{
+  Trace_Record(TRACE_EV_ISR_ENTER, TIM7_IRQn);
+  HAL_TIM_IRQHandler(&htim7);
+  Trace_Record(TRACE_EV_ISR_EXIT, TIM7_IRQn);
+}
+
+void DMA2_Stream0_IRQHandler(void)
+{
+  Trace_Record(TRACE_EV_ISR_ENTER, DMA2_Stream0_IRQn);
+  HAL_DMA_IRQHandler(&hdma_adc1);
+  Trace_Record(TRACE_EV_ISR_EXIT, DMA2_Stream0_IRQn);
+}
+
+void DMA1_Stream1_IRQHandler(void)
+{
+  Trace_Record(TRACE_EV_ISR_ENTER, DMA1_Stream1_IRQn);
+  HAL_DMA_IRQHandler(&hdma_usart3_rx);
+  Trace_Record(TRACE_EV_ISR_EXIT, DMA1_Stream1_IRQn);
+}
+
+void DMA1_Stream3_IRQHandler(void)
+{
+  Trace_Record(TRACE_EV_ISR_ENTER, DMA1_Stream3_IRQn);
+  HAL_DMA_IRQHandler(&hdma_usart3_tx);
+  Trace_Record(TRACE_EV_ISR_EXIT, DMA1_Stream3_IRQn);
 }
 /* USER CODE END 1 */
@@ -0,0 +1,295 @@
+/**
+ * @file store.c
+ * @brief Flash key/value store implementation.
+ *
+ * The latest value of every key is cached in RAM; reads never touch the
+ * flash. The log end is the first erased record slot: records are only
+ * appended there, so every slot after it is erased as well. A torn
+ * record is not erased and the log continues after it.
+ *
+ * Flash is read through the D-cache (write-through for this region), so
+ * the lines of a sector are invalidated after it is programmed or
+ * erased.
+ */
+
+#include "store.h"
+#include "crc32.h"
+#include "main.h"
+#include "overtemp.h"
+
+#include <string.h>
+
+#define SECTOR_SIZE     0x8000U
+#define HDR_SIZE        16U
+#define REC_SIZE        12U
+#define SLOTS           ((SECTOR_SIZE - HDR_SIZE) / REC_SIZE)
+#define COMPACT_BOOT    (SLOTS * 3U / 4U)
+
+#define HDR_MAGIC       0U
+#define HDR_GEN         4U
+#define HDR_COMMIT      8U
+#define HDR_CRC         12U
+#define COMMITTED       0x00000000UL
+#define ERASED          0xFFFFFFFFUL
+
+static const uint32_t sector_addr[2] = {0x08008000UL, 0x08010000UL};
+static const uint32_t sector_num[2]  = {FLASH_SECTOR_1, FLASH_SECTOR_2};
+
+static uint32_t values[STORE_MAX_KEYS];
+static bool     have[STORE_MAX_KEYS];
+static bool     mounted;
+static uint8_t  active;
+static uint32_t generation;
+static uint16_t used;
+static uint16_t bad;
+
+static uint32_t flash_word(uint32_t addr)
+{
+#ifdef HOST_BUILD
+    uint32_t w;
+    memcpy(&w, HALFAKE_FLASH_Ptr(addr), sizeof(w));
+    return w;
+#else
+    return *(const volatile uint32_t *)(uintptr_t)addr;
+#endif
+}
+
+static void invalidate(uint8_t s)
+{
+    SCB_InvalidateDCache_by_Addr((uint32_t *)(uintptr_t)sector_addr[s], (int32_t)SECTOR_SIZE);
+}
+
+static bool program(uint32_t addr, uint32_t w)
+{
+    return HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr, w) == HAL_OK;
+}
+
+static uint32_t rec_addr(uint8_t s, uint32_t slot)
+{
+    return sector_addr[s] + HDR_SIZE + slot * REC_SIZE;
+}
+
+static uint32_t rec_crc(uint32_t kw, uint32_t value)
+{
+    const uint32_t buf[2] = {kw, value};
+    return CRC32_Compute(buf, sizeof(buf));
+}
+
+/* The header CRC rejects a sector whose erase was interrupted and left
+   the magic and commit word but not the generation. */
+static bool committed(uint8_t s)
+{
+    return flash_word(sector_addr[s] + HDR_MAGIC) == STORE_MAGIC &&
+           flash_word(sector_addr[s] + HDR_COMMIT) == COMMITTED &&
+           flash_word(sector_addr[s] + HDR_CRC) ==
+               rec_crc(STORE_MAGIC, flash_word(sector_addr[s] + HDR_GEN));
+}
+
+/* Append a record to the active sector; the slot is used even if the
+   write fails, it may be partly programmed. */
+static bool append(uint16_t key, uint32_t value)
+{
+    uint32_t a  = rec_addr(active, used++);
+    uint32_t kw = (uint32_t)key | ((uint32_t)(uint16_t)~key << 16);
+
+    HAL_FLASH_Unlock();
+    bool ok = program(a, kw) && program(a + 4U, value) &&
+              program(a + 8U, rec_crc(kw, value));
+    HAL_FLASH_Lock();
+    invalidate(active);
+    return ok;
+}
+
+/* Interrupts stall until the erase completes: the heater outputs are
+   held off meanwhile (overtemp.h). */
+static bool erase(uint8_t s)
+{
+    FLASH_EraseInitTypeDef e = {0};
+    uint32_t err;
+
+    e.TypeErase    = FLASH_TYPEERASE_SECTORS;
+    e.Sector       = sector_num[s];
+    e.NbSectors    = 1;
+    e.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+
+    OverTemp_HoldOutputs();
+    HAL_FLASH_Unlock();
+    bool ok = HAL_FLASHEx_Erase(&e, &err) == HAL_OK;
+    HAL_FLASH_Lock();
+    OverTemp_ReleaseOutputs();
+    invalidate(s);
+    return ok;
+}
+
+/* Write the cached values to the other sector and make it active. The
+   active sector is not modified, so a failure leaves the store as it
+   was. */
+static bool compact(void)
+{
+    uint8_t  s   = (uint8_t)(active ^ 1U);
+    uint32_t gen = generation + 1U;
+
+    if (!erase(s)) return false;
+
+    HAL_FLASH_Unlock();
+    bool ok = program(sector_addr[s] + HDR_MAGIC, STORE_MAGIC) &&
+              program(sector_addr[s] + HDR_GEN, gen) &&
+              program(sector_addr[s] + HDR_CRC, rec_crc(STORE_MAGIC, gen));
+    HAL_FLASH_Lock();
+    if (!ok) {
+        invalidate(s);
+        return false;
+    }
+
+    uint16_t old_used = used;
+    uint8_t  old      = active;
+    active = s;
+    used   = 0;
+    for (uint16_t k = 0; k < STORE_MAX_KEYS && ok; k++) {
+        if (have[k]) ok = append(k, values[k]);
+    }
+
+    if (ok) {
+        HAL_FLASH_Unlock();
+        ok = program(sector_addr[s] + HDR_COMMIT, COMMITTED);
+        HAL_FLASH_Lock();
+        invalidate(s);
+    }
+
+    if (!ok) {
+        active = old;
+        used   = old_used;
+        return false;
+    }
+    generation = gen;
+    return true;
+}
+
+/* Load the records of the active sector into the cache. */
+static void replay(void)
+{
+    memset(have, 0, sizeof(have));
+    used = 0;
+    bad  = 0;
+
+    for (uint32_t slot = 0; slot < SLOTS; slot++) {
+        uint32_t a     = rec_addr(active, slot);
+        uint32_t kw    = flash_word(a);
+        uint32_t value = flash_word(a + 4U);
+        uint32_t crc   = flash_word(a + 8U);
+
+        if (kw == ERASED && value == ERASED && crc == ERASED) break;
+        used++;
+
+        uint16_t key = (uint16_t)kw;
+        if ((kw >> 16) != (uint16_t)~key || key >= STORE_MAX_KEYS ||
+            crc != rec_crc(kw, value)) {
+            bad++;
+            continue;
+        }
+        values[key] = value;
+        have[key]   = true;
+    }
+}
+
+static bool format(void)
+{
+    memset(have, 0, sizeof(have));
+    used = 0;
+    bad  = 0;
+
+    /* Compaction of an empty cache into sector 0, with generation 1. */
+    active     = 1;
+    generation = 0;
+    mounted    = compact();
+    return mounted;
+}
+
+bool Store_Init(void)
+{
+    bool     ok[2];
+    uint32_t gen[2];
+
+    for (uint8_t s = 0; s < 2U; s++) {
+        ok[s]  = committed(s);
+        gen[s] = flash_word(sector_addr[s] + HDR_GEN);
+    }
+
+    if (!ok[0] && !ok[1]) return format();
+
+    if (ok[0] && ok[1]) active = ((int32_t)(gen[1] - gen[0]) > 0) ? 1U : 0U;
+    else                active = ok[1] ? 1U : 0U;
+    generation = gen[active];
+    mounted    = true;
+    replay();
+
+    if (used > COMPACT_BOOT) (void)compact();
+    return true;
+}
+
+bool Store_Read(uint16_t key, uint32_t *value)
+{
+    if (key >= STORE_MAX_KEYS || !have[key]) return false;
+    *value = values[key];
+    return true;
+}
+
+bool Store_Write(uint16_t key, uint32_t value)
+{
+    if (!mounted || key >= STORE_MAX_KEYS) return false;
+    if (have[key] && values[key] == value) return true;
+
+    if (used >= SLOTS) {
+        /* The compacted sector holds the new value. */
+        uint32_t prev      = values[key];
+        bool     prev_have = have[key];
+        values[key] = value;
+        have[key]   = true;
+        if (compact()) return true;
+        values[key] = prev;
+        have[key]   = prev_have;
+        return false;
+    }
+
+    if (!append(key, value)) return false;
+    values[key] = value;
+    have[key]   = true;
+    return true;
+}
+
+bool Store_ReadFloat(uint16_t key, float *value)
+{
+    uint32_t w;
+    if (!Store_Read(key, &w)) return false;
+    memcpy(value, &w, sizeof(w));
+    return true;
+}
+
+bool Store_WriteFloat(uint16_t key, float value)
+{
+    uint32_t w;
+    memcpy(&w, &value, sizeof(w));
+    return Store_Write(key, w);
+}
+
+bool Store_Format(void)
+{
+    /* format() erases sector 0 itself. */
+    mounted = false;
+    return erase(1U) && format();
+}
+
+void Store_GetInfo(store_info_t *info)
+{
+    uint16_t keys = 0;
+    for (uint16_t k = 0; k < STORE_MAX_KEYS; k++) {
+        if (have[k]) keys++;
+    }
+
+    info->mounted    = mounted;
+    info->generation = generation;
+    info->used       = used;
+    info->slots      = (uint16_t)SLOTS;
+    info->keys       = keys;
+    info->bad        = bad;
+}
@@ -5,48 +5,185 @@
  * This module implements temperature measurement based on an NTC thermistor.
  * It converts raw ADC values into temperature expressed in degrees Celsius
  * using a mathematical model of the thermistor.
+ *
+ * The run-time conversion interpolates in a lookup table generated from
+ * the Beta model (see ntc_lut.h). The exact model is kept as
+ * Temperature_FromRawExact() for reference and table generation checks,
+ * and its inverse Temperature_ToRaw() gives ADC thresholds for limits.
+ *
+ * The NTC constants start at their config.h values, for which the const
+ * table was generated. Temperature_SetNtc() changes them at run time; the
+ * table is then rebuilt in RAM from the exact model and the conversion
+ * switches to it.
+ *
+ * Each zone owns a filter object (see filter.h), kept in the zone table.
+ * The default is the TEMP_FILT_TYPE filter of TEMP_FILT_N samples (a
+ * 9-sample moving average); Temperature_SetFilter() changes it at run
+ * time. The length sets the same group delay for every type: the window
+ * of the moving average and the median (odd, at most 9), and the EMA and
+ * Kalman gains whose low-frequency delay is that of the window.
  */
 
 #include "temperature.h"
+#include "memmap.h"
 #include <math.h>
 #include "config.h"
+#include "ntc_lut.h"
+#include "zone.h"
 
-#define TEMP_FILT_N 9
+#include <string.h>
 
-float Temperature_FromRaw(uint16_t raw)
+static const ntc_params_t ntc_default = {
+  .r_fixed = R_FIXED,
+  .beta    = NTC_BETA,
+  .r0      = NTC_R0,
+  .t0_k    = NTC_T0_K,
+};
+
+static ntc_params_t ntc = {
+  .r_fixed = R_FIXED,
+  .beta    = NTC_BETA,
+  .r0      = NTC_R0,
+  .t0_k    = NTC_T0_K,
+};
+
+static float lut_ram[NTC_LUT_SIZE] DTCM_DATA;
+static const float *lut DTCM_DATA = ntc_lut_c;
+
+float Temperature_FromRawExact(uint16_t raw)
 {
   if (raw <= 0) raw = 1;
   if (raw >= 4095) raw = 4094;
 
   float v = ((float)raw / 4095.0f) * ADC_VREF;
 
-  float r_ntc = R_FIXED * (v / (ADC_VREF - v));
+  float r_ntc = ntc.r_fixed * (v / (ADC_VREF - v));
 
-  float invT = (1.0f / NTC_T0_K) + (1.0f / NTC_BETA) * logf(r_ntc / NTC_R0);
+  float invT = (1.0f / ntc.t0_k) + (1.0f / ntc.beta) * logf(r_ntc / ntc.r0);
   float T = 1.0f / invT;
 
   return T - 273.15f;
 }
 
-float Temperature_Filter9(float x)
+uint16_t Temperature_ToRaw(float t_c)
+{
+  float t_k   = t_c + 273.15f;
+  float r_ntc = ntc.r0 * expf(ntc.beta * (1.0f / t_k - 1.0f / ntc.t0_k));
+
+  // Divider: v / Vref = r_ntc / (R_FIXED + r_ntc)
+  float raw = 4095.0f * r_ntc / (ntc.r_fixed + r_ntc) + 0.5f;
+
+  if (!(raw > 0.0f)) return 0;
+  if (raw >= 4095.0f) return 4095;
+  return (uint16_t)raw;
+}
+
+ITCM_CODE float Temperature_FromRawQ4(uint16_t raw_q4)
+{
+  const uint32_t shift = NTC_LUT_SHIFT + 4U;
+  const uint32_t mask  = (1UL << shift) - 1U;
+
+  uint32_t i = (uint32_t)raw_q4 >> shift;
+  float frac = (float)((uint32_t)raw_q4 & mask) * (1.0f / (float)(1UL << shift));
+
+  float t0 = lut[i];
+  return t0 + (lut[i + 1U] - t0) * frac;
+}
+
+void Temperature_SetNtc(const ntc_params_t *p)
+{
+  ntc = *p;
+
+  if (memcmp(&ntc, &ntc_default, sizeof(ntc)) == 0) {
+    lut = ntc_lut_c;
+    return;
+  }
+
+  for (uint32_t i = 0; i < NTC_LUT_SIZE; i++) {
+    uint32_t raw = i << NTC_LUT_SHIFT;
+    lut_ram[i] = Temperature_FromRawExact((uint16_t)(raw > 4095U ? 4095U : raw));
+  }
+  lut = lut_ram;
+}
+
+const ntc_params_t *Temperature_GetNtc(void)
+{
+  return &ntc;
+}
+
+float Temperature_FromRaw(uint16_t raw)
+{
+  if (raw > 4095U) raw = 4095U;
+  return Temperature_FromRawQ4((uint16_t)(raw << 4));
+}
+
+void Temperature_Init(void)
+{
+  for (uint8_t ch = 0; ch < TEMP_NUM_CH; ch++) {
+    Temperature_SetFilter(ch, (filter_type_t)TEMP_FILT_TYPE, TEMP_FILT_N);
+  }
+}
+
+void Temperature_SetFilter(uint8_t ch, filter_type_t type, uint8_t n)
 {
-  static float buf[TEMP_FILT_N] = {0};
-  static uint8_t idx = 0;
-  static uint8_t filled = 0;
+  zone_table_t *zt = Zone_Table();
+  if (ch >= TEMP_NUM_CH) return;
+  if (n < 1U) n = 1U;
+  if (n > FILTER_MA_MAX_N) n = FILTER_MA_MAX_N;
+
+  zt->filter_type[ch] = (uint8_t)type;
+  zt->filter_n[ch]    = n;
 
-  buf[idx] = x;
-  idx = (uint8_t)((idx + 1u) % TEMP_FILT_N);
+  filter_t *f = &zt->filter[ch];
+  /* Gain k of the EMA / steady-state Kalman with the delay (n - 1) / 2
+     of the window: (1 - k) / k = (n - 1) / 2. */
+  float k = 2.0f / (float)(n + 1U);
+
+  switch (type) {
+  case FILTER_MA:
+    Filter_InitMA(f, n);
+    break;
+  case FILTER_EMA:
+    Filter_InitEMA(f, k);
+    break;
+  case FILTER_MEDIAN:
+    Filter_InitMedian(f, n);
+    break;
+  case FILTER_KALMAN: {
+    if (n == 1U) {
+      Filter_InitNone(f);
+      break;
+    }
+    /* Random walk with r = 1: steady-state prior p = k / (1 - k) and
+       p^2 = q (p + r), so q = p^2 / (p + 1). */
+    float p = k / (1.0f - k);
+    Filter_InitKalman(f, p * p / (p + 1.0f), 1.0f);
+    break;
+  }
+  default:
+    zt->filter_type[ch] = (uint8_t)FILTER_NONE;
+    Filter_InitNone(f);
+    break;
+  }
+}
 
-  if (filled < TEMP_FILT_N) filled++;
+float Temperature_GetFilterDelayS(uint8_t ch)
+{
+  return Filter_GroupDelay(Temperature_GetFilter(ch)) * CONTROL_TS_S;
+}
 
-  float sum = 0.0f;
-  for (uint8_t i = 0; i < filled; i++) sum += buf[i];
+ITCM_CODE filter_t *Temperature_GetFilter(uint8_t ch)
+{
+  zone_table_t *zt = Zone_Table();
+  return (ch < TEMP_NUM_CH) ? &zt->filter[ch] : &zt->filter[0];
+}
 
-  return sum / (float)filled;
+ITCM_CODE float Temperature_Filter(uint8_t ch, float t_c)
+{
+  return Filter_Update(Temperature_GetFilter(ch), t_c);
 }
 
 float Temperature_FromRawFiltered(uint16_t raw)
 {
-  float t = Temperature_FromRaw(raw);
-  return Temperature_Filter9(t);
+  return Temperature_Filter(0, Temperature_FromRaw(raw));
 }
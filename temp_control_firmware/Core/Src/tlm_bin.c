@@ -0,0 +1,117 @@
+/**
+ * @file tlm_bin.c
+ * @brief Implementation of binary telemetry packets.
+ *
+ * Packets are assembled in a small buffer, then the CRC is appended and
+ * the result is COBS encoded straight into the caller's output buffer.
+ * Multi-byte values are stored little endian regardless of the host.
+ */
+
+#include "tlm_bin.h"
+#include "crc32.h"
+#include <string.h>
+
+#define TLMB_NFIELDS_OFS  8U
+
+static void put_bytes(tlmb_packet_t *p, const uint8_t *src, uint16_t n)
+{
+    if (p->overflow || (uint32_t)p->len + n + TLMB_CRC_LEN > TLMB_MAX_RAW) {
+        p->overflow = true;
+        return;
+    }
+    memcpy(&p->buf[p->len], src, n);
+    p->len = (uint16_t)(p->len + n);
+}
+
+static void put_le(uint8_t *dst, uint32_t v, uint8_t n)
+{
+    for (uint8_t i = 0; i < n; i++) {
+        dst[i] = (uint8_t)(v >> (8U * i));
+    }
+}
+
+static void add_field(tlmb_packet_t *p, uint8_t id, tlmb_vtype_t vt, uint32_t v, uint8_t n)
+{
+    uint8_t tmp[6];
+    tmp[0] = id;
+    tmp[1] = (uint8_t)vt;
+    put_le(&tmp[2], v, n);
+
+    put_bytes(p, tmp, (uint16_t)(2U + n));
+    if (!p->overflow) p->buf[TLMB_NFIELDS_OFS]++;
+}
+
+void TLMB_Begin(tlmb_packet_t *p, tlmb_type_t type, uint16_t seq, uint32_t timestamp_ms)
+{
+    p->buf[0] = TLMB_VERSION;
+    p->buf[1] = (uint8_t)type;
+    put_le(&p->buf[2], seq, 2);
+    put_le(&p->buf[4], timestamp_ms, 4);
+    p->buf[TLMB_NFIELDS_OFS] = 0;
+    p->len = TLMB_HDR_LEN;
+    p->overflow = false;
+}
+
+void TLMB_AddU8(tlmb_packet_t *p, uint8_t id, uint8_t v)   { add_field(p, id, TLMB_VT_U8, v, 1); }
+void TLMB_AddU16(tlmb_packet_t *p, uint8_t id, uint16_t v) { add_field(p, id, TLMB_VT_U16, v, 2); }
+void TLMB_AddU32(tlmb_packet_t *p, uint8_t id, uint32_t v) { add_field(p, id, TLMB_VT_U32, v, 4); }
+void TLMB_AddI16(tlmb_packet_t *p, uint8_t id, int16_t v)  { add_field(p, id, TLMB_VT_I16, (uint16_t)v, 2); }
+void TLMB_AddI32(tlmb_packet_t *p, uint8_t id, int32_t v)  { add_field(p, id, TLMB_VT_I32, (uint32_t)v, 4); }
+
+void TLMB_AddF32(tlmb_packet_t *p, uint8_t id, float v)
+{
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    add_field(p, id, TLMB_VT_F32, bits, 4);
+}
+
+void TLMB_AddStr(tlmb_packet_t *p, uint8_t id, const char *s)
+{
+    size_t n = strlen(s);
+    uint8_t hdr[3] = {id, (uint8_t)TLMB_VT_STR, (uint8_t)(n > 255U ? 255U : n)};
+
+    put_bytes(p, hdr, sizeof(hdr));
+    put_bytes(p, (const uint8_t *)s, hdr[2]);
+    if (!p->overflow) p->buf[TLMB_NFIELDS_OFS]++;
+}
+
+uint16_t TLMB_Finish(tlmb_packet_t *p, uint8_t *out, uint16_t cap)
+{
+    if (p->overflow) return 0;
+
+    uint32_t crc = CRC32_Compute(p->buf, p->len);
+    put_le(&p->buf[p->len], crc, TLMB_CRC_LEN);
+    uint16_t raw_len = (uint16_t)(p->len + TLMB_CRC_LEN);
+
+    if (TLMB_FRAME_LEN((uint32_t)raw_len) > cap) return 0;
+
+    uint16_t n = COBS_Encode(p->buf, raw_len, out);
+    out[n++] = 0x00;
+    return n;
+}
+
+uint16_t COBS_Encode(const uint8_t *in, uint16_t len, uint8_t *out)
+{
+    uint16_t code_idx = 0;
+    uint16_t o = 1;
+    uint8_t  code = 1;
+
+    for (uint16_t i = 0; i < len; i++) {
+        if (in[i] == 0x00) {
+            out[code_idx] = code;
+            code_idx = o++;
+            code = 1;
+            continue;
+        }
+
+        out[o++] = in[i];
+        if (++code == 0xFF) {
+            out[code_idx] = code;
+            code_idx = o++;
+            code = 1;
+        }
+    }
+
+    out[code_idx] = code;
+    return o;
+}
@@ -0,0 +1,168 @@
+/**
+ * @file tlm_stream.c
+ * @brief Implementation of the telemetry stream.
+ *
+ * Frames are built in the control task and handed to the UART transmit
+ * queue, which accepts them completely or not at all. A rejected frame
+ * is a dropped sample; the control task is never delayed by the link.
+ */
+
+#include "tlm_stream.h"
+#include "tlm_bin.h"
+#include "uart_tx.h"
+#include "uart_if.h"
+#include "json_build.h"
+#include "main.h"
+
+/* A JSON frame with every field, the floats up to five integer digits,
+   is 288 bytes; a wider one overflows and counts as a drop. */
+#define STREAM_FRAME_MAX  320U
+
+/* Binary frame with every field: zone, fan and id flags, raw, and the
+   F32 / U32 values. */
+#define STREAM_BIN_LEN  (TLMB_HDR_LEN + 3U * TLMB_FIELD_LEN(1U) + TLMB_FIELD_LEN(2U) + \
+                         13U * TLMB_FIELD_LEN(4U) + TLMB_CRC_LEN)
+
+_Static_assert(STREAM_BIN_LEN <= TLMB_MAX_RAW, "stream packet exceeds TLMB_MAX_RAW");
+
+static bool     active     = false;
+static uint16_t decimation = 1;
+static uint16_t field_mask = STREAM_F_ALL;
+static uint16_t zone_mask  = STREAM_ZONES_ALL;
+static uint16_t decim_cnt  = 0;
+static uint32_t sample_no  = 0;
+static uint32_t drops      = 0;
+
+void Stream_Init(void)
+{
+    active = false;
+    decimation = 1;
+    field_mask = STREAM_F_ALL;
+    zone_mask = STREAM_ZONES_ALL;
+    decim_cnt = 0;
+    sample_no = 0;
+    drops = 0;
+}
+
+bool Stream_Start(uint16_t decim, uint16_t mask, uint16_t zones)
+{
+    mask  &= STREAM_F_ALL;
+    zones &= STREAM_ZONES_ALL;
+    if (decim == 0U || mask == 0U || zones == 0U) return false;
+
+    decimation = decim;
+    field_mask = mask;
+    zone_mask  = zones;
+    decim_cnt  = 0;
+    sample_no  = 0;
+    drops      = 0;
+    active     = true;
+    return true;
+}
+
+void Stream_Stop(void)
+{
+    active = false;
+}
+
+bool Stream_IsActive(void)
+{
+    return active;
+}
+
+uint32_t Stream_GetDrops(void)
+{
+    return drops;
+}
+
+/* ===================== Frame builders ===================== */
+
+static uint16_t build_binary(const stream_sample_t *s, uint8_t *out, uint16_t cap)
+{
+    tlmb_packet_t pkt;
+
+    /* The 16-bit sequence is the sample number, not a per-frame counter. */
+    TLMB_Begin(&pkt, TLMB_TYPE_TELEMETRY, (uint16_t)sample_no, HAL_GetTick());
+    TLMB_AddU8(&pkt, TLMB_F_ZONE, s->zone);
+
+    if (field_mask & STREAM_F_T_MEAS)     TLMB_AddF32(&pkt, TLMB_F_T_MEAS, s->t_meas);
+    if (field_mask & STREAM_F_RAW)        TLMB_AddU16(&pkt, TLMB_F_RAW, s->raw);
+    if (field_mask & STREAM_F_T_REF)      TLMB_AddF32(&pkt, TLMB_F_T_REF, s->t_ref);
+    if (field_mask & STREAM_F_PWM)        TLMB_AddF32(&pkt, TLMB_F_PWM, s->pwm);
+    if (field_mask & STREAM_F_ERROR)      TLMB_AddF32(&pkt, TLMB_F_ERROR, s->error);
+    if (field_mask & STREAM_F_INTEGRATOR) TLMB_AddF32(&pkt, TLMB_F_INTEGRATOR, s->i_term);
+    if (field_mask & STREAM_F_FAN)        TLMB_AddU8(&pkt, TLMB_F_FAN, s->fan ? 1U : 0U);
+    if (field_mask & STREAM_F_TIMING) {
+        TLMB_AddU32(&pkt, TLMB_F_PERIOD_US, s->period_us);
+        TLMB_AddU32(&pkt, TLMB_F_EXEC_US, s->exec_us);
+    }
+    if (field_mask & STREAM_F_MODEL) {
+        TLMB_AddF32(&pkt, TLMB_F_ID_K, s->model->k_c_per_pct);
+        TLMB_AddF32(&pkt, TLMB_F_ID_TAU, s->model->tau_s);
+        TLMB_AddF32(&pkt, TLMB_F_ID_DEAD, s->model->dead_s);
+        TLMB_AddF32(&pkt, TLMB_F_ID_K_RSD, s->model->k_rsd);
+        TLMB_AddF32(&pkt, TLMB_F_ID_TAU_RSD, s->model->tau_rsd);
+        TLMB_AddU8(&pkt, TLMB_F_ID_FLAGS, s->model->flags);
+    }
+    TLMB_AddU32(&pkt, TLMB_F_DROPS, drops);
+
+    return TLMB_Finish(&pkt, out, cap);
+}
+
+static uint16_t build_json(const stream_sample_t *s, char *out, uint16_t cap)
+{
+    jsonb_t jb;
+
+    JSONB_Begin(&jb, out, cap);
+    JSONB_AddUint(&jb, "n", sample_no);
+    JSONB_AddUint(&jb, "t", HAL_GetTick());
+    JSONB_AddUint(&jb, "zone", s->zone);
+
+    if (field_mask & STREAM_F_T_MEAS)     JSONB_AddFloat(&jb, "T_meas", s->t_meas, 2);
+    if (field_mask & STREAM_F_RAW)        JSONB_AddUint(&jb, "raw", s->raw);
+    if (field_mask & STREAM_F_T_REF)      JSONB_AddFloat(&jb, "T_ref", s->t_ref, 2);
+    if (field_mask & STREAM_F_PWM)        JSONB_AddFloat(&jb, "PWM", s->pwm, 1);
+    if (field_mask & STREAM_F_ERROR)      JSONB_AddFloat(&jb, "err", s->error, 3);
+    if (field_mask & STREAM_F_INTEGRATOR) JSONB_AddFloat(&jb, "I", s->i_term, 2);
+    if (field_mask & STREAM_F_FAN)        JSONB_AddUint(&jb, "fan", s->fan ? 1U : 0U);
+    if (field_mask & STREAM_F_TIMING) {
+        JSONB_AddUint(&jb, "dt_us", s->period_us);
+        JSONB_AddUint(&jb, "exec_us", s->exec_us);
+    }
+    if (field_mask & STREAM_F_MODEL) {
+        JSONB_AddFloat(&jb, "K", s->model->k_c_per_pct, 3);
+        JSONB_AddFloat(&jb, "tau", s->model->tau_s, 1);
+        JSONB_AddFloat(&jb, "dead", s->model->dead_s, 1);
+        JSONB_AddFloat(&jb, "K_rsd", s->model->k_rsd, 3);
+        JSONB_AddFloat(&jb, "tau_rsd", s->model->tau_rsd, 3);
+        JSONB_AddUint(&jb, "id", s->model->flags);
+    }
+    JSONB_AddUint(&jb, "drop", drops);
+
+    return JSONB_End(&jb);
+}
+
+/* ===================== Sample input ===================== */
+
+void Stream_OnSample(const stream_sample_t *s, uint8_t n)
+{
+    if (!active) return;
+
+    if (++decim_cnt < decimation) return;
+    decim_cnt = 0;
+
+    const bool binary = (UARTIF_GetProtocol() == UARTIF_PROTO_BINARY);
+    uint8_t frame[STREAM_FRAME_MAX];
+
+    for (uint8_t i = 0; i < n; i++) {
+        if (s[i].zone >= ZONE_COUNT || (zone_mask & (1U << s[i].zone)) == 0U) continue;
+
+        uint16_t len = binary ? build_binary(&s[i], frame, sizeof(frame))
+                              : build_json(&s[i], (char *)frame, sizeof(frame));
+
+        if (len == 0U || !UARTTX_Write(frame, len)) {
+            drops++;
+        }
+    }
+    sample_no++;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file trace.c
+ * @brief Event trace implementation.
+ *
+ * The write index counts records since Trace_Start() and is never
+ * wrapped; the slot is the index modulo TRACE_BUF_LEN. A reader takes the
+ * last TRACE_BUF_LEN indices below the write index.
+ */
+
+#include "trace.h"
+#include "config.h"
+#include "main.h"
+#include "memmap.h"
+#include "perf.h"
+
+#include <string.h>
+
+static trace_rec_t       ring[TRACE_BUF_LEN];
+static volatile uint32_t head;
+static volatile uint8_t  mask;
+static volatile bool     recording;
+static volatile bool     reading;
+
+void Trace_Init(void)
+{
+    Trace_Start(TRACE_MASK_DEFAULT);
+}
+
+void Trace_Start(uint8_t m)
+{
+    recording = false;
+    memset(ring, 0, sizeof(ring));
+    head      = 0;
+    mask      = (uint8_t)((m & TRACE_C_ALL) | TRACE_C_EVENT);
+    reading   = false;
+    recording = true;
+}
+
+void Trace_Stop(void)
+{
+    recording = false;
+}
+
+bool Trace_IsRecording(void)
+{
+    return recording;
+}
+
+uint8_t Trace_GetMask(void)
+{
+    return mask;
+}
+
+ITCM_CODE void Trace_Record(trace_ev_t id, uint16_t arg)
+{
+    if (!recording || reading || !(mask & (1U << ((uint32_t)id >> 6)))) return;
+
+    uint32_t i = __atomic_fetch_add(&head, 1U, __ATOMIC_RELAXED);
+    trace_rec_t *r = &ring[i & (TRACE_BUF_LEN - 1U)];
+
+    r->ts  = Perf_Now();
+    r->arg = arg;
+    r->id  = (uint8_t)id;
+    r->ctx = (uint8_t)__get_IPSR();
+}
+
+uint32_t Trace_BeginRead(uint32_t *first)
+{
+    reading = true;
+
+    uint32_t end = head;
+    *first = (end > TRACE_BUF_LEN) ? end - TRACE_BUF_LEN : 0U;
+    return end;
+}
+
+const trace_rec_t *Trace_Get(uint32_t index)
+{
+    return &ring[index & (TRACE_BUF_LEN - 1U)];
+}
+
+void Trace_EndRead(void)
+{
+    reading = false;
+}
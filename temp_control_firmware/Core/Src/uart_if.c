@@ -6,26 +6,134 @@
  * communication with an external PC application (terminal, Python GUI,
  * MATLAB logger, etc.).
  *
- * Supported commands:
- *  - "T<value>"  : set temperature setpoint (°C)
- *  - "?"         : request telemetry data
+ * Supported commands (<z> = zone index 0..ZONE_COUNT-1, default 0):
+ *  - "T<value>", "T<z>:<value>"
+ *                : set temperature setpoint (°C) of a zone, as
+ *                  "SET sp:<z> <value>": refused outside sp_min..sp_max,
+ *                  takes effect at the next control step and stops a
+ *                  running profile of the zone
+ *  - "?", "?<z>" : request telemetry data of a zone
+ *  - "D", "D<z>" : send the diagnostics report of a zone
+ *  - "M<n>"      : select output protocol, 0 = JSON text, 1 = binary
+ *  - "S<d>[,<m>[,<zm>]]"
+ *                : stream every d-th control sample with field mask m
+ *                  and zone mask zm (hex, default all, see
+ *                  tlm_stream.h); "S0" stops
+ *  - "A"         : re-arm the heater output after a hardware overtemp
+ *                  trip (refused while the sensor is still out of range)
+ *  - "U<r>", "U<z>:<r>"
+ *                : relay autotune of a zone with rule r = Z (Ziegler-
+ *                  Nichols), T (Tyreus-Luyben) or S (SIMC); r = X stops
+ *                  the session, r = ? sends the autotune report
+ *  - "IR", "I<z>:R"
+ *                : take the identified plant model of a zone as the new
+ *                  drift reference (refused while it is not valid)
+ *  - "F<n>", "F<z>:<n>"
+ *                : model-based feed-forward of a zone off (0) or on (1)
+ *  - "E<value>"  : use a fixed ambient temperature (°C) for the
+ *                  feed-forward; "EM" selects the MCU sensor
+ *  - "P<n>", "P<z>:<n>"
+ *                : Smith predictor of a zone off (0) or on (1)
+ *  - "P<K>,<tau>,<L>", "P<z>:<K>,<tau>,<L>"
+ *                : predictor model of a zone: gain (°C/%), time constant
+ *                  and dead time (s); "PI", "P<z>:I" takes the identified
+ *                  model (refused while it is not valid)
+ *  - "R<c>", "R<z>:<c>"
+ *                : setpoint profile of a zone (profile.h), c =
+ *                  A<rate>,<target>,<hold>[,<loop_to>,<repeat>] appends a
+ *                  segment (°C/s, °C, s), C clears the profile, G starts
+ *                  it (or resumes it), H pauses it, X stops it
+ *  - "PERF?"     : send the section timing report (perf.h); "PERF0"
+ *                  clears the statistics
+ *  - "TRACE?"    : dump the event trace (trace.h); "TRACE0" stops
+ *                  recording, "TRACE1[,<mask>]" clears the trace and
+ *                  records the event classes of mask (hex, TRACE_C_*)
+ *  - "STORE0"    : erase the settings saved in flash and return the
+ *                  parameters to their defaults (settings.h)
+ *  - "LIST"      : describe every parameter of the registry (param.h)
+ *  - "GET <p>"   : describe parameter p, given by name or id
+ *  - "SET <p>[:<z>] <value>"
+ *                : set parameter p (of zone z); refused out of range,
+ *                  for read-only parameters and against related values
+ *                  (setpoint within its limits, lower limits below upper
+ *                  ones). Takes effect at the next control step.
  *
- * Telemetry format (JSON, no CRC):
- *  {"T_meas":xx.xx,"T_ref":yy.yy,"PWM":zz.z}
+ * Telemetry format in JSON mode (default, no CRC):
+ *  {"zone":n,"T_meas":xx.xx,"T_ref":yy.yy,"PWM":zz.z,"Kp":k,"Ki":k,
+ *   "prof":s,"seg":i,"seg_t":t}
  *
- * UART reception is interrupt-driven and uses a line buffer terminated
- * by CR or LF characters.
+ * prof is the profile state (profile_state_t), seg the current segment
+ * and seg_t the time spent in it [s]. The periodic telemetry sends a
+ * frame per zone at once, so frames are kept to TLM_FRAME_MAX bytes.
+ *
+ * Diagnostics report, on request only:
+ *  {"diag":n,"tune":s,"K":k,"tau":t,"dead":l,"K_rsd":r,"tau_rsd":r,
+ *   "id":f,"ff":u,"T_amb":a,"sp":p,"res":r,"res_rms":r}
+ *
+ * tune is the autotune state of the zone (at_state_t). K, tau and dead
+ * are the identified plant model, *_rsd their relative standard
+ * deviations and id the IDENT_* flags (ident.h). ff is the feed-forward
+ * part of PWM (0 when off) and T_amb the ambient estimate. sp is the
+ * Smith predictor state (bit 0 on, bit 1 model mismatch), res and res_rms
+ * the mean and RMS of its residual (smith.h).
+ * The identified model can also be streamed with every control sample
+ * (STREAM_F_MODEL, tlm_stream.h).
+ *
+ * Autotune report (tune = at_state_t, rule = at_rule_t, L = dead time):
+ *  {"zone":n,"tune":s,"rule":r,"Ku":k,"Pu":p,"amp":a,"L":l,"Kp":k,"Ki":k}
+ *
+ * Timing report, a loop line and one line per section; times in ticks
+ * of hz, n the loop periods or section executions, over the overruns:
+ *  {"hz":f,"n":n,"jit_min":j,"jit_max":j,"over":o}
+ *  {"sec":"adc","n":n,"min":t,"max":t,"mean":t,"hist":[h0,...]}
+ * The lines follow one per UART task run, so the sections are read a few
+ * milliseconds apart.
+ *
+ * Parameter, one line each (dtype = param_type_t, flags = PARAM_F_*,
+ * val has a value per zone for PARAM_F_ZONE, else one):
+ *  {"par":id,"name":s,"unit":u,"dtype":t,"flags":f,"min":a,"max":b,
+ *   "def":d,"val":[v0,...]}
+ * LIST sends them like a trace dump, over several UART task runs.
+ *
+ * Trace dump, a header line then one line per record, oldest first
+ * (lost = records overwritten before the dump, t in ticks of hz):
+ *  {"trace":n,"lost":l,"hz":f,"mask":m}
+ *  {"t":t,"ev":id,"ctx":c,"arg":a}
+ * The records follow over several UART task runs, as space in the
+ * transmit queue allows; recording pauses until the last one is queued.
+ *
+ * In binary mode telemetry and command acknowledgements are COBS-framed
+ * packets with a device timestamp and CRC-32 (see tlm_bin.h). Commands
+ * are always received as text lines.
+ *
+ * UART reception uses circular DMA with idle-line detection and queues
+ * complete lines terminated by CR or LF characters (uart_rx.c). All replies and telemetry frames go through the
+ * non-blocking DMA transmit queue (uart_tx.c).
  *
  * @author
  * Borys Ovsiyenko
  */
 
 #include "uart_if.h"
-#include "setpoint.h"
+#include "uart_tx.h"
+#include "uart_rx.h"
+#include "tlm_bin.h"
+#include "tlm_stream.h"
+#include "trace.h"
+#include "json_build.h"
+#include "adc_sampler.h"
+#include "overtemp.h"
+#include "param.h"
+#include "perf.h"
+#include "profile.h"
+#include "settings.h"
+#include "ambient.h"
+#include "autotune.h"
+#include "control.h"
+#include "zone.h"
 
 #include <string.h>
 #include <stdlib.h>
-#include <stdio.h>
 #include <ctype.h>
 
 #include <stddef.h>
@@ -37,107 +145,886 @@
 
 extern UART_HandleTypeDef UARTIF_HUART;
 
-static uint8_t  rx_byte;
-static char     line_buf[64];
-static uint32_t line_len = 0;
-
-static volatile bool  telemetry_req     = false;
+static volatile uint16_t telemetry_req = 0;      /* zone mask */
 static volatile bool  has_setpoint      = false;
 static volatile float last_setpoint_c   = 0.0f;
-static volatile bool  line_ready        = false;
+static uartif_proto_t proto             = UARTIF_PROTO_JSON;
+static uint16_t       tx_seq            = 0;
 
-/* ===================== UART RX ===================== */
+/* Telemetry frame of one zone, JSON or binary. A JSON frame that would
+   not fit is dropped by the builder. */
+#define TLM_FRAME_MAX  128U
 
-static void start_rx_it(void)
+/* Binary packets: telemetry has 3 U8 and 6 F32 fields, the diagnostics
+   report 4 U8 and 9 F32 fields. */
+#define TLM_BIN_LEN   (TLMB_HDR_LEN + 3U * TLMB_FIELD_LEN(1U) + 6U * TLMB_FIELD_LEN(4U) + TLMB_CRC_LEN)
+#define DIAG_BIN_LEN  (TLMB_HDR_LEN + 4U * TLMB_FIELD_LEN(1U) + 9U * TLMB_FIELD_LEN(4U) + TLMB_CRC_LEN)
+
+_Static_assert(TLM_BIN_LEN <= TLMB_MAX_RAW, "telemetry packet exceeds TLMB_MAX_RAW");
+_Static_assert(DIAG_BIN_LEN <= TLMB_MAX_RAW, "diagnostics packet exceeds TLMB_MAX_RAW");
+_Static_assert(TLMB_FRAME_LEN(TLM_BIN_LEN) <= TLM_FRAME_MAX, "telemetry frame exceeds TLM_FRAME_MAX");
+/* Periodic telemetry queues every zone in one task run; the paced dumps
+   (LIST, TRACE?) keep the other half free. */
+_Static_assert(ZONE_COUNT * TLM_FRAME_MAX <= UARTTX_BUF_SIZE / 2U,
+               "telemetry of every zone must fit half the transmit queue");
+
+/* Trace dump in progress: records trace_next .. trace_end - 1 to send. */
+static bool     trace_dump = false;
+static uint32_t trace_next = 0;
+static uint32_t trace_end  = 0;
+
+/* PERF? in progress: report lines perf_next .. PERF_SEC_COUNT to send. */
+static bool     perf_dump = false;
+static uint32_t perf_next = 0;
+
+/* LIST in progress: parameters list_next .. PARAM_COUNT - 1 to send. */
+static bool     list_dump = false;
+static uint32_t list_next = 0;
+
+/* ===================== Init / UART errors ===================== */
+
+static void send_str(const char *s)
 {
-    HAL_UART_Receive_IT(&UARTIF_HUART, &rx_byte, 1);
+    UARTTX_Write(s, (uint16_t)strlen(s));
+}
+
+static void send_packet(tlmb_packet_t *pkt)
+{
+    uint8_t frame[TLMB_MAX_FRAME];
+    uint16_t n = TLMB_Finish(pkt, frame, sizeof(frame));
+    if (n > 0U) {
+        UARTTX_Write(frame, n);
+    }
+}
+
+static void send_ack(bool ok)
+{
+    if (proto == UARTIF_PROTO_JSON) {
+        send_str(ok ? "OK\n" : "ERR\n");
+        return;
+    }
+
+    tlmb_packet_t pkt;
+    TLMB_Begin(&pkt, TLMB_TYPE_ACK, tx_seq++, HAL_GetTick());
+    TLMB_AddU8(&pkt, TLMB_F_STATUS, ok ? 0U : 1U);
+    send_packet(&pkt);
 }
 
 void UARTIF_Init(void)
 {
-    line_len = 0;
-    line_buf[0] = '\0';
+    UARTTX_Init();
 
-    telemetry_req   = false;
+    telemetry_req   = 0;
     has_setpoint    = false;
     last_setpoint_c = 0.0f;
-    line_ready      = false;
+    proto           = UARTIF_PROTO_JSON;
+    tx_seq          = 0;
+    trace_dump      = false;
+    list_dump       = false;
+    perf_dump       = false;
 
-    start_rx_it();
+    Stream_Init();
+    UARTRX_Init();
 }
 
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
 {
     if (huart != &UARTIF_HUART) return;
 
-    if (line_ready) {
-        start_rx_it();
+    /* The HAL stops a transfer on error; restart whatever was stopped. */
+    if (huart->gState == HAL_UART_STATE_READY) {
+        UARTTX_OnError();
+    }
+    if (huart->RxState == HAL_UART_STATE_READY) {
+        UARTRX_OnError();
+    }
+}
+
+/* ===================== Command handling ===================== */
+
+/*
+ * Optional "<z>:" zone prefix of a command argument.
+ * @return Start of the value, NULL if the zone is out of range.
+ */
+static const char *parse_zone(const char *arg, uint8_t *zone)
+{
+    char *end;
+    unsigned long z = strtoul(arg, &end, 10);
+
+    if (end == arg || *end != ':') {
+        *zone = 0;
+        return arg;
+    }
+    if (z >= ZONE_COUNT) return NULL;
+
+    *zone = (uint8_t)z;
+    return end + 1;
+}
+
+static void send_tune_report(void)
+{
+    const at_result_t *r = Autotune_GetResult();
+
+    if (proto == UARTIF_PROTO_BINARY) {
+        tlmb_packet_t pkt;
+        TLMB_Begin(&pkt, TLMB_TYPE_TUNE, tx_seq++, HAL_GetTick());
+        TLMB_AddU8(&pkt, TLMB_F_ZONE, r->zone);
+        TLMB_AddU8(&pkt, TLMB_F_TUNE, (uint8_t)r->state);
+        TLMB_AddU8(&pkt, TLMB_F_TUNE_RULE, (uint8_t)r->rule);
+        TLMB_AddF32(&pkt, TLMB_F_KU, r->ku);
+        TLMB_AddF32(&pkt, TLMB_F_PU, r->pu_s);
+        TLMB_AddF32(&pkt, TLMB_F_AMP, r->amp_c);
+        TLMB_AddF32(&pkt, TLMB_F_DEAD, r->dead_s);
+        TLMB_AddF32(&pkt, TLMB_F_KP, r->kp);
+        TLMB_AddF32(&pkt, TLMB_F_KI, r->ki);
+        send_packet(&pkt);
+        return;
+    }
+
+    char frame[192];
+    jsonb_t jb;
+
+    JSONB_Begin(&jb, frame, sizeof(frame));
+    JSONB_AddUint(&jb, "zone", r->zone);
+    JSONB_AddUint(&jb, "tune", (uint32_t)r->state);
+    JSONB_AddUint(&jb, "rule", (uint32_t)r->rule);
+    JSONB_AddFloat(&jb, "Ku", r->ku, 3);
+    JSONB_AddFloat(&jb, "Pu", r->pu_s, 2);
+    JSONB_AddFloat(&jb, "amp", r->amp_c, 3);
+    JSONB_AddFloat(&jb, "L", r->dead_s, 2);
+    JSONB_AddFloat(&jb, "Kp", r->kp, 3);
+    JSONB_AddFloat(&jb, "Ki", r->ki, 4);
+
+    uint16_t n = JSONB_End(&jb);
+    if (n > 0U) {
+        UARTTX_Write(frame, n);
+    }
+}
+
+static void send_diag_report(uint8_t zone)
+{
+    const at_result_t *at = Autotune_GetResult();
+    uint8_t tune = (at->zone == zone) ? (uint8_t)at->state : (uint8_t)AT_IDLE;
+    const ident_model_t *m = Ident_GetModel(&Zone_Table()->ident[zone]);
+    const smith_t *sp = &Zone_Table()->smith[zone];
+    uint8_t sp_state = (uint8_t)((Zone_Table()->smith_enable[zone] ? 0x01U : 0U) |
+                                 ((sp->flags & SMITH_MISMATCH) ? 0x02U : 0U));
+    float ff = Control_GetPID(zone)->ff;
+
+    if (proto == UARTIF_PROTO_BINARY) {
+        tlmb_packet_t pkt;
+        TLMB_Begin(&pkt, TLMB_TYPE_DIAG, tx_seq++, HAL_GetTick());
+        TLMB_AddU8(&pkt, TLMB_F_ZONE, zone);
+        TLMB_AddU8(&pkt, TLMB_F_TUNE, tune);
+        TLMB_AddF32(&pkt, TLMB_F_ID_K, m->k_c_per_pct);
+        TLMB_AddF32(&pkt, TLMB_F_ID_TAU, m->tau_s);
+        TLMB_AddF32(&pkt, TLMB_F_ID_DEAD, m->dead_s);
+        TLMB_AddF32(&pkt, TLMB_F_ID_K_RSD, m->k_rsd);
+        TLMB_AddF32(&pkt, TLMB_F_ID_TAU_RSD, m->tau_rsd);
+        TLMB_AddU8(&pkt, TLMB_F_ID_FLAGS, m->flags);
+        TLMB_AddF32(&pkt, TLMB_F_FF, ff);
+        TLMB_AddF32(&pkt, TLMB_F_T_AMB, Ambient_GetC());
+        TLMB_AddU8(&pkt, TLMB_F_SMITH, sp_state);
+        TLMB_AddF32(&pkt, TLMB_F_RESID, sp->resid_mean_c);
+        TLMB_AddF32(&pkt, TLMB_F_RESID_RMS, Smith_GetResidualRms(sp));
+        send_packet(&pkt);
         return;
     }
 
-    char c = (char)rx_byte;
+    char frame[192];
+    jsonb_t jb;
+
+    JSONB_Begin(&jb, frame, sizeof(frame));
+    JSONB_AddUint(&jb, "diag", zone);
+    JSONB_AddUint(&jb, "tune", tune);
+    JSONB_AddFloat(&jb, "K", m->k_c_per_pct, 3);
+    JSONB_AddFloat(&jb, "tau", m->tau_s, 1);
+    JSONB_AddFloat(&jb, "dead", m->dead_s, 1);
+    JSONB_AddFloat(&jb, "K_rsd", m->k_rsd, 3);
+    JSONB_AddFloat(&jb, "tau_rsd", m->tau_rsd, 3);
+    JSONB_AddUint(&jb, "id", m->flags);
+    JSONB_AddFloat(&jb, "ff", ff, 1);
+    JSONB_AddFloat(&jb, "T_amb", Ambient_GetC(), 1);
+    JSONB_AddUint(&jb, "sp", sp_state);
+    JSONB_AddFloat(&jb, "res", sp->resid_mean_c, 2);
+    JSONB_AddFloat(&jb, "res_rms", Smith_GetResidualRms(sp), 2);
 
-    if (c == '\r' || c == '\n') {
-        if (line_len > 0) {
-            line_buf[line_len] = '\0';
-            line_ready = true;
+    uint16_t n = JSONB_End(&jb);
+    if (n > 0U) {
+        UARTTX_Write(frame, n);
+    }
+}
+
+static void handle_tune(const char *arg)
+{
+    uint8_t zone;
+    const char *r = parse_zone(arg, &zone);
+
+    if (r == NULL) {
+        send_ack(false);
+        return;
+    }
+
+    switch (r[0]) {
+    case 'Z':
+    case 'T':
+    case 'S': {
+        at_rule_t rule = (r[0] == 'Z') ? AT_RULE_ZN :
+                         (r[0] == 'T') ? AT_RULE_TL : AT_RULE_SIMC;
+        /* The relay needs a healthy sensor and an enabled output stage. */
+        bool ok = !Zone_Table()->alarm[zone] && !OverTemp_IsTripped() &&
+                  Autotune_Start(zone, rule);
+        send_ack(ok);
+        return;
+    }
+    case 'X':
+        Autotune_Abort(zone);
+        send_ack(true);
+        return;
+    case '?':
+        send_ack(true);
+        send_tune_report();
+        return;
+    default:
+        send_ack(false);
+        return;
+    }
+}
+
+static void handle_smith(const char *arg)
+{
+    uint8_t zone;
+    const char *val = parse_zone(arg, &zone);
+    smith_model_t m;
+
+    if (val == NULL) {
+        send_ack(false);
+        return;
+    }
+
+    if (val[0] == 'I') {
+        const ident_model_t *id = Ident_GetModel(&Zone_Table()->ident[zone]);
+        if (!(id->flags & IDENT_VALID)) {
+            send_ack(false);
+            return;
         }
-    } else {
-        if (line_len < (sizeof(line_buf) - 1U)) {
-            line_buf[line_len++] = c;
-            line_buf[line_len] = '\0';
+        m.k_c_per_pct = id->k_c_per_pct;
+        m.tau_s       = id->tau_s;
+        m.dead_s      = id->dead_s;
+        send_ack(Control_SetSmithModel(zone, &m));
+        return;
+    }
+
+    if (strchr(val, ',') != NULL) {
+        char *end;
+        m.k_c_per_pct = strtof(val, &end);
+        if (*end != ',') {
+            send_ack(false);
+            return;
+        }
+        m.tau_s = strtof(end + 1, &end);
+        if (*end != ',') {
+            send_ack(false);
+            return;
+        }
+        m.dead_s = strtof(end + 1, &end);
+        send_ack(Control_SetSmithModel(zone, &m));
+        return;
+    }
+
+    if (val[0] != '0' && val[0] != '1') {
+        send_ack(false);
+        return;
+    }
+    Control_SetSmith(zone, val[0] == '1');
+    send_ack(true);
+}
+
+/* Line i of the timing report: 0 the loop, then one per section. */
+static void send_perf_line(uint32_t i)
+{
+    const perf_loop_t *lp = Perf_GetLoop();
+    const perf_sec_t sec = (perf_sec_t)(i - 1U);
+
+    if (proto == UARTIF_PROTO_BINARY) {
+        tlmb_packet_t pkt;
+        TLMB_Begin(&pkt, TLMB_TYPE_PERF, tx_seq++, HAL_GetTick());
+        if (i == 0U) {
+            TLMB_AddU32(&pkt, TLMB_F_PERF_HZ, Perf_GetHz());
+            TLMB_AddU32(&pkt, TLMB_F_PERF_N, lp->n);
+            TLMB_AddI32(&pkt, TLMB_F_PERF_JMIN, lp->jitter_min);
+            TLMB_AddI32(&pkt, TLMB_F_PERF_JMAX, lp->jitter_max);
+            TLMB_AddU32(&pkt, TLMB_F_PERF_OVER, lp->overruns);
         } else {
-            line_len = 0;
-            line_buf[0] = '\0';
+            const perf_stat_t *st = Perf_GetStat(sec);
+            TLMB_AddU8(&pkt, TLMB_F_PERF_SEC, (uint8_t)sec);
+            TLMB_AddU32(&pkt, TLMB_F_PERF_N, st->n);
+            TLMB_AddU32(&pkt, TLMB_F_PERF_MIN, st->min);
+            TLMB_AddU32(&pkt, TLMB_F_PERF_MAX, st->max);
+            TLMB_AddU32(&pkt, TLMB_F_PERF_MEAN, Perf_GetMean(sec));
+            for (uint8_t b = 0; b < PERF_HIST_BINS; b++) {
+                TLMB_AddU32(&pkt, TLMB_F_PERF_HIST, st->hist[b]);
+            }
         }
+        send_packet(&pkt);
+        return;
     }
 
+    char frame[256];
+    jsonb_t jb;
 
-    start_rx_it();
+    JSONB_Begin(&jb, frame, sizeof(frame));
+    if (i == 0U) {
+        JSONB_AddUint(&jb, "hz", Perf_GetHz());
+        JSONB_AddUint(&jb, "n", lp->n);
+        JSONB_AddInt(&jb, "jit_min", lp->jitter_min);
+        JSONB_AddInt(&jb, "jit_max", lp->jitter_max);
+        JSONB_AddUint(&jb, "over", lp->overruns);
+    } else {
+        const perf_stat_t *st = Perf_GetStat(sec);
+        JSONB_AddStr(&jb, "sec", Perf_SectionName(sec));
+        JSONB_AddUint(&jb, "n", st->n);
+        JSONB_AddUint(&jb, "min", st->min);
+        JSONB_AddUint(&jb, "max", st->max);
+        JSONB_AddUint(&jb, "mean", Perf_GetMean(sec));
+        JSONB_AddUintArray(&jb, "hist", st->hist, (uint16_t)PERF_HIST_BINS);
+    }
+
+    uint16_t n = JSONB_End(&jb);
+    if (n > 0U) {
+        UARTTX_Write(frame, n);
+    }
 }
 
-/* ===================== Command handling ===================== */
+/*
+ * One line of the timing report per task run, once the transmit queue is
+ * less than half full, like send_trace_records().
+ */
+static void send_perf_report(void)
+{
+    if (!perf_dump || UARTTX_Free() < UARTTX_BUF_SIZE / 2U) return;
+
+    send_perf_line(perf_next++);
+    if (perf_next > (uint32_t)PERF_SEC_COUNT) perf_dump = false;
+}
+
+static void handle_perf(const char *arg)
+{
+    if (!PERF_ENABLE) {
+        send_ack(false);
+        return;
+    }
+
+    switch (arg[0]) {
+    case '?':
+        send_ack(true);
+        perf_next = 0;
+        perf_dump = true;
+        return;
+    case '0':
+        Perf_Reset();
+        send_ack(true);
+        return;
+    default:
+        send_ack(false);
+        return;
+    }
+}
+
+/*
+ * Send trace records while the transmit queue is less than half full, so
+ * that a dump does not crowd out telemetry; continued on every task run.
+ */
+static void send_trace_records(void)
+{
+    while (trace_dump && UARTTX_Free() >= UARTTX_BUF_SIZE / 2U) {
+        if (trace_next == trace_end) {
+            trace_dump = false;
+            Trace_EndRead();
+            return;
+        }
+
+        const trace_rec_t *r = Trace_Get(trace_next++);
+
+        if (proto == UARTIF_PROTO_BINARY) {
+            tlmb_packet_t pkt;
+            TLMB_Begin(&pkt, TLMB_TYPE_TRACE, tx_seq++, HAL_GetTick());
+            TLMB_AddU32(&pkt, TLMB_F_TR_T, r->ts);
+            TLMB_AddU8(&pkt, TLMB_F_TR_EV, r->id);
+            TLMB_AddU8(&pkt, TLMB_F_TR_CTX, r->ctx);
+            TLMB_AddU16(&pkt, TLMB_F_TR_ARG, r->arg);
+            send_packet(&pkt);
+            continue;
+        }
+
+        char frame[64];
+        jsonb_t jb;
+
+        JSONB_Begin(&jb, frame, sizeof(frame));
+        JSONB_AddUint(&jb, "t", r->ts);
+        JSONB_AddUint(&jb, "ev", r->id);
+        JSONB_AddUint(&jb, "ctx", r->ctx);
+        JSONB_AddUint(&jb, "arg", r->arg);
+
+        uint16_t n = JSONB_End(&jb);
+        if (n > 0U) {
+            UARTTX_Write(frame, n);
+        }
+    }
+}
+
+static void start_trace_dump(void)
+{
+    uint32_t first;
+
+    if (trace_dump) Trace_EndRead();
+    trace_end  = Trace_BeginRead(&first);
+    trace_next = first;
+    trace_dump = true;
+
+    if (proto == UARTIF_PROTO_BINARY) {
+        tlmb_packet_t pkt;
+        TLMB_Begin(&pkt, TLMB_TYPE_TRACE, tx_seq++, HAL_GetTick());
+        TLMB_AddU32(&pkt, TLMB_F_TR_N, trace_end - first);
+        TLMB_AddU32(&pkt, TLMB_F_TR_LOST, first);
+        TLMB_AddU32(&pkt, TLMB_F_PERF_HZ, Perf_GetHz());
+        TLMB_AddU8(&pkt, TLMB_F_TR_MASK, Trace_GetMask());
+        send_packet(&pkt);
+        return;
+    }
+
+    char frame[96];
+    jsonb_t jb;
+
+    JSONB_Begin(&jb, frame, sizeof(frame));
+    JSONB_AddUint(&jb, "trace", trace_end - first);
+    JSONB_AddUint(&jb, "lost", first);
+    JSONB_AddUint(&jb, "hz", Perf_GetHz());
+    JSONB_AddUint(&jb, "mask", Trace_GetMask());
+
+    uint16_t n = JSONB_End(&jb);
+    if (n > 0U) {
+        UARTTX_Write(frame, n);
+    }
+}
+
+static void handle_trace(const char *arg)
+{
+    switch (arg[0]) {
+    case '?':
+        send_ack(true);
+        start_trace_dump();
+        return;
+    case '0':
+        Trace_Stop();
+        send_ack(true);
+        return;
+    case '1': {
+        unsigned long mask = TRACE_MASK_DEFAULT;
+        if (arg[1] == ',') mask = strtoul(&arg[2], NULL, 16);
+        /* Clearing the ring ends a dump of it. */
+        trace_dump = false;
+        Trace_Start((uint8_t)mask);
+        send_ack(true);
+        return;
+    }
+    default:
+        send_ack(false);
+        return;
+    }
+}
+
+static void send_param(param_id_t id)
+{
+    const param_desc_t *d = Param_Desc(id);
+    uint8_t n = Param_Count(id);
+    float   v[ZONE_COUNT];
+
+    for (uint8_t z = 0; z < n; z++) {
+        (void)Param_Get(id, z, &v[z]);
+    }
+
+    if (proto == UARTIF_PROTO_BINARY) {
+        tlmb_packet_t pkt;
+        TLMB_Begin(&pkt, TLMB_TYPE_PARAM, tx_seq++, HAL_GetTick());
+        TLMB_AddU8(&pkt, TLMB_F_PAR_ID, (uint8_t)id);
+        TLMB_AddStr(&pkt, TLMB_F_PAR_NAME, d->name);
+        TLMB_AddStr(&pkt, TLMB_F_PAR_UNIT, d->unit);
+        TLMB_AddU8(&pkt, TLMB_F_PAR_TYPE, d->type);
+        TLMB_AddU8(&pkt, TLMB_F_PAR_FLAGS, d->flags);
+        TLMB_AddF32(&pkt, TLMB_F_PAR_MIN, d->min);
+        TLMB_AddF32(&pkt, TLMB_F_PAR_MAX, d->max);
+        TLMB_AddF32(&pkt, TLMB_F_PAR_DEF, d->def);
+        for (uint8_t z = 0; z < n; z++) {
+            TLMB_AddF32(&pkt, TLMB_F_PAR_VAL, v[z]);
+        }
+        send_packet(&pkt);
+        return;
+    }
+
+    char frame[192];
+    jsonb_t jb;
+
+    JSONB_Begin(&jb, frame, sizeof(frame));
+    JSONB_AddUint(&jb, "par", (uint32_t)id);
+    JSONB_AddStr(&jb, "name", d->name);
+    JSONB_AddStr(&jb, "unit", d->unit);
+    JSONB_AddUint(&jb, "dtype", d->type);
+    JSONB_AddUint(&jb, "flags", d->flags);
+    if (d->type == PARAM_T_U32) {
+        uint32_t u[ZONE_COUNT];
+        for (uint8_t z = 0; z < n; z++) u[z] = (uint32_t)v[z];
+        JSONB_AddUint(&jb, "min", (uint32_t)d->min);
+        JSONB_AddUint(&jb, "max", (uint32_t)d->max);
+        JSONB_AddUint(&jb, "def", (uint32_t)d->def);
+        JSONB_AddUintArray(&jb, "val", u, n);
+    } else {
+        JSONB_AddFloat(&jb, "min", d->min, 4);
+        JSONB_AddFloat(&jb, "max", d->max, 4);
+        JSONB_AddFloat(&jb, "def", d->def, 4);
+        JSONB_AddFloatArray(&jb, "val", v, n, 4);
+    }
+
+    uint16_t len = JSONB_End(&jb);
+    if (len > 0U) {
+        UARTTX_Write(frame, len);
+    }
+}
+
+/* Continued on every task run, like send_trace_records(). */
+static void send_param_list(void)
+{
+    while (list_dump && UARTTX_Free() >= UARTTX_BUF_SIZE / 2U) {
+        if (list_next == PARAM_COUNT) {
+            list_dump = false;
+            return;
+        }
+        send_param((param_id_t)list_next++);
+    }
+}
+
+/*
+ * Parameter given by name or id, up to a ':', a space or the end.
+ * @return Id, -1 if there is no such parameter; *end after the name.
+ */
+static int parse_param(const char *s, const char **end)
+{
+    size_t len = strcspn(s, ": ");
+    *end = s + len;
+
+    if (len == 0U) return -1;
+    if (isdigit((unsigned char)s[0])) {
+        char *e;
+        unsigned long id = strtoul(s, &e, 10);
+        return (e == *end && id < PARAM_COUNT) ? (int)id : -1;
+    }
+    return Param_Find(s, len);
+}
+
+static void handle_get(const char *arg)
+{
+    const char *end;
+    while (*arg == ' ') arg++;
+    int id = parse_param(arg, &end);
+    while (*end == ' ') end++;
+
+    if (id < 0 || *end != '\0') {
+        send_ack(false);
+        return;
+    }
+    send_ack(true);
+    send_param((param_id_t)id);
+}
+
+static void handle_set(const char *arg)
+{
+    const char *p;
+    while (*arg == ' ') arg++;
+    int id = parse_param(arg, &p);
+    unsigned long zone = 0;
+
+    if (id < 0) {
+        send_ack(false);
+        return;
+    }
+    if (*p == ':') {
+        char *e;
+        zone = strtoul(p + 1, &e, 10);
+        if (e == p + 1 || zone > 0xFFUL) {
+            send_ack(false);
+            return;
+        }
+        p = e;
+    }
+    if (*p != ' ') {
+        send_ack(false);
+        return;
+    }
+
+    char *e;
+    float v = strtof(p, &e);
+    if (e == p) {
+        send_ack(false);
+        return;
+    }
+    while (*e == ' ') e++;
+    if (*e != '\0') {
+        send_ack(false);
+        return;
+    }
+    send_ack(Param_Set((param_id_t)id, (uint8_t)zone, v));
+}
+
+static void handle_profile(const char *arg)
+{
+    uint8_t zone;
+    const char *val = parse_zone(arg, &zone);
+
+    if (val == NULL) {
+        send_ack(false);
+        return;
+    }
+
+    switch (val[0]) {
+    case 'A': {
+        profile_seg_t seg = {0};
+        char *end;
+        seg.rate_c_per_s = strtof(&val[1], &end);
+        if (end == &val[1] || *end != ',') break;
+        seg.target_c = strtof(end + 1, &end);
+        if (*end != ',') break;
+        seg.hold_s = strtof(end + 1, &end);
+        if (*end == ',') {
+            unsigned long loop_to = strtoul(end + 1, &end, 10);
+            if (*end != ',') break;
+            unsigned long repeat = strtoul(end + 1, NULL, 10);
+            if (loop_to > 0xFFUL || repeat > 0xFFUL) break;
+            seg.loop_to = (uint8_t)loop_to;
+            seg.repeat  = (uint8_t)repeat;
+        }
+        send_ack(Profile_AddSegment(zone, &seg));
+        return;
+    }
+    case 'C':
+        Profile_Clear(zone);
+        send_ack(true);
+        return;
+    case 'G':
+        send_ack(Profile_Start(zone));
+        return;
+    case 'H':
+        Profile_Pause(zone);
+        send_ack(true);
+        return;
+    case 'X':
+        Profile_Stop(zone);
+        send_ack(true);
+        return;
+    default:
+        break;
+    }
+    send_ack(false);
+}
 
 static void handle_line(const char *s)
 {
     while (*s && isspace((unsigned char)*s)) s++;
 
+    Trace_Record(TRACE_EV_UART_LINE, (uint8_t)s[0]);
+
+    /* Before "T", which takes every other argument. */
+    if (strncmp(s, "TRACE", 5) == 0) {
+        handle_trace(&s[5]);
+        return;
+    }
+
     if (s[0] == 'T') {
-        float v = (float)atof(&s[1]);
+        uint8_t zone;
+        const char *val = parse_zone(&s[1], &zone);
+        if (val == NULL) {
+            send_ack(false);
+            return;
+        }
+        float v = (float)atof(val);
 
-        Setpoint_SetC(v);
+        /* Same path as SET sp:<z>, checked against the staged limits. */
+        if (!Param_Set(PARAM_SP, zone, v)) {
+            send_ack(false);
+            return;
+        }
+        Trace_Record(TRACE_EV_SETPOINT, TRACE_ZARG(zone, v * 10.0f + 0.5f));
         has_setpoint = true;
         last_setpoint_c = v;
 
-        const char *ok = "OK\n";
-        HAL_UART_Transmit(&UARTIF_HUART, (uint8_t*)ok, (uint16_t)strlen(ok), 50);
+        send_ack(true);
         return;
     }
 
     if (s[0] == '?') {
-        telemetry_req = true;
-        const char *ok = "OK\n";
-        HAL_UART_Transmit(&UARTIF_HUART, (uint8_t*)ok, (uint16_t)strlen(ok), 50);
+        unsigned long zone = 0;
+        if (isdigit((unsigned char)s[1])) zone = strtoul(&s[1], NULL, 10);
+        if (zone >= ZONE_COUNT) {
+            send_ack(false);
+            return;
+        }
+        telemetry_req |= (uint16_t)(1U << zone);
+        send_ack(true);
         return;
     }
 
-    const char *err = "ERR\n";
-    HAL_UART_Transmit(&UARTIF_HUART, (uint8_t*)err, (uint16_t)strlen(err), 50);
+    if (s[0] == 'D') {
+        unsigned long zone = 0;
+        if (isdigit((unsigned char)s[1])) zone = strtoul(&s[1], NULL, 10);
+        if (zone >= ZONE_COUNT) {
+            send_ack(false);
+            return;
+        }
+        send_ack(true);
+        send_diag_report((uint8_t)zone);
+        return;
+    }
+
+    if (strncmp(s, "GET", 3) == 0) {
+        handle_get(&s[3]);
+        return;
+    }
+
+    if (strncmp(s, "LIST", 4) == 0) {
+        send_ack(true);
+        list_next = 0;
+        list_dump = true;
+        return;
+    }
+
+    /* Before "S", which takes every other argument. */
+    if (strncmp(s, "SET", 3) == 0) {
+        handle_set(&s[3]);
+        return;
+    }
+
+    if (strncmp(s, "STORE", 5) == 0) {
+        send_ack(s[5] == '0' && Settings_Restore());
+        return;
+    }
+
+    if (s[0] == 'S') {
+        char *end;
+        unsigned long decim = strtoul(&s[1], &end, 10);
+        unsigned long mask  = STREAM_F_ALL;
+        unsigned long zones = STREAM_ZONES_ALL;
+
+        if (end == &s[1]) {
+            send_ack(false);
+            return;
+        }
+        if (*end == ',') {
+            mask = strtoul(end + 1, &end, 16);
+            if (*end == ',') {
+                zones = strtoul(end + 1, NULL, 16);
+            }
+        }
+
+        if (decim == 0UL) {
+            Stream_Stop();
+            send_ack(true);
+            return;
+        }
+        send_ack(decim <= 0xFFFFUL &&
+                 Stream_Start((uint16_t)decim, (uint16_t)mask, (uint16_t)zones));
+        return;
+    }
+
+    if (s[0] == 'A') {
+        uint16_t q4[ADCS_NUM_CH];
+        uint16_t raw[ADCS_NUM_CH];
+        bool ok = ADCS_GetLatestAll(q4) != 0U;
+
+        for (uint8_t ch = 0; ch < ADCS_NUM_CH; ch++) {
+            raw[ch] = (uint16_t)((q4[ch] + 8U) >> 4);
+        }
+        send_ack(ok && OverTemp_Rearm(raw, (uint8_t)ADCS_NUM_CH));
+        return;
+    }
+
+    if (s[0] == 'U') {
+        handle_tune(&s[1]);
+        return;
+    }
+
+    if (s[0] == 'I') {
+        uint8_t zone;
+        const char *val = parse_zone(&s[1], &zone);
+        send_ack(val != NULL && val[0] == 'R' &&
+                 Ident_Rebase(&Zone_Table()->ident[zone]));
+        return;
+    }
+
+    if (s[0] == 'F') {
+        uint8_t zone;
+        const char *val = parse_zone(&s[1], &zone);
+        if (val == NULL || (val[0] != '0' && val[0] != '1')) {
+            send_ack(false);
+            return;
+        }
+        Control_SetFeedForward(zone, val[0] == '1');
+        send_ack(true);
+        return;
+    }
+
+    if (s[0] == 'E') {
+        char *end;
+        if (s[1] == 'M') {
+            Ambient_SetSource(AMBIENT_SRC_MCU);
+            send_ack(true);
+            return;
+        }
+        float v = strtof(&s[1], &end);
+        if (end == &s[1]) {
+            send_ack(false);
+            return;
+        }
+        Ambient_SetFixedC(v);
+        send_ack(true);
+        return;
+    }
+
+    /* Before "P", which takes every other argument. */
+    if (strncmp(s, "PERF", 4) == 0) {
+        handle_perf(&s[4]);
+        return;
+    }
+
+    if (s[0] == 'P') {
+        handle_smith(&s[1]);
+        return;
+    }
+
+    if (s[0] == 'R') {
+        handle_profile(&s[1]);
+        return;
+    }
+
+    if (s[0] == 'M' && (s[1] == '0' || s[1] == '1')) {
+        proto = (s[1] == '1') ? UARTIF_PROTO_BINARY : UARTIF_PROTO_JSON;
+        /* Acknowledged in the newly selected protocol. */
+        send_ack(true);
+        return;
+    }
+
+    send_ack(false);
 }
 
 void UARTIF_Task(void)
 {
-    if (!line_ready) return;
-
-    char tmp[64];
-    strncpy(tmp, line_buf, sizeof(tmp) - 1U);
-    tmp[sizeof(tmp) - 1U] = '\0';
+    char line[UARTRX_LINE_MAX];
 
-    line_len = 0;
-    line_buf[0] = '\0';
-    line_ready = false;
-
-    handle_line(tmp);
+    /* Handle every complete line received since the last call. */
+    while (UARTRX_GetLine(line, sizeof(line))) {
+        handle_line(line);
+    }
+    send_trace_records();
+    send_param_list();
+    send_perf_report();
 }
 
 
@@ -153,26 +1040,59 @@ float UARTIF_GetSetpointC(void)
     return last_setpoint_c;
 }
 
-bool UARTIF_ConsumeTelemetryRequest(void)
+uartif_proto_t UARTIF_GetProtocol(void)
 {
-    if (telemetry_req) {
-        telemetry_req = false;
-        return true;
-    }
-    return false;
+    return proto;
+}
+
+uint16_t UARTIF_ConsumeTelemetryRequest(void)
+{
+    uint16_t zones = telemetry_req;
+    telemetry_req = 0;
+    return zones;
 }
 
 /* ===================== Telemetry TX ===================== */
 
-void UARTIF_SendTelemetry(float t_meas, float t_ref, float pwm)
+void UARTIF_SendTelemetry(uint8_t zone, float t_meas, float t_ref, float pwm)
 {
-    char frame[128];
-    int n = snprintf(frame, sizeof(frame),
-                     "{\"T_meas\":%.2f,\"T_ref\":%.2f,\"PWM\":%.1f}\r\n",
-                     (double)t_meas, (double)t_ref, (double)pwm);
-    if (n < 0 || n >= (int)sizeof(frame)) return;
+    const pid_ctrl_t *pid = Control_GetPID(zone);
+    const profile_t *prof = Profile_Get(zone);
+
+    if (proto == UARTIF_PROTO_BINARY) {
+        tlmb_packet_t pkt;
+        TLMB_Begin(&pkt, TLMB_TYPE_TELEMETRY, tx_seq++, HAL_GetTick());
+        TLMB_AddU8(&pkt, TLMB_F_ZONE, zone);
+        TLMB_AddF32(&pkt, TLMB_F_T_MEAS, t_meas);
+        TLMB_AddF32(&pkt, TLMB_F_T_REF, t_ref);
+        TLMB_AddF32(&pkt, TLMB_F_PWM, pwm);
+        TLMB_AddF32(&pkt, TLMB_F_KP, pid->p.kp);
+        TLMB_AddF32(&pkt, TLMB_F_KI, pid->p.ki);
+        TLMB_AddU8(&pkt, TLMB_F_PROF_STATE, prof->state);
+        TLMB_AddU8(&pkt, TLMB_F_PROF_SEG, prof->i);
+        TLMB_AddF32(&pkt, TLMB_F_PROF_SEG_T, Profile_GetSegmentTimeS(zone));
+        send_packet(&pkt);
+        return;
+    }
+
+    char frame[TLM_FRAME_MAX];
+    jsonb_t jb;
 
-    HAL_UART_Transmit(&UARTIF_HUART, (uint8_t*)frame, (uint16_t)strlen(frame), 100);
+    JSONB_Begin(&jb, frame, sizeof(frame));
+    JSONB_AddUint(&jb, "zone", zone);
+    JSONB_AddFloat(&jb, "T_meas", t_meas, 2);
+    JSONB_AddFloat(&jb, "T_ref", t_ref, 2);
+    JSONB_AddFloat(&jb, "PWM", pwm, 1);
+    JSONB_AddFloat(&jb, "Kp", pid->p.kp, 3);
+    JSONB_AddFloat(&jb, "Ki", pid->p.ki, 4);
+    JSONB_AddUint(&jb, "prof", prof->state);
+    JSONB_AddUint(&jb, "seg", prof->i);
+    JSONB_AddFloat(&jb, "seg_t", Profile_GetSegmentTimeS(zone), 1);
+
+    uint16_t n = JSONB_End(&jb);
+    if (n > 0U) {
+        UARTTX_Write(frame, n);
+    }
 }
 
 
@@ -0,0 +1,142 @@
+/**
+ * @file uart_rx.c
+ * @brief Implementation of DMA/idle-line UART reception.
+ *
+ * HAL_UARTEx_ReceiveToIdle_DMA() in circular mode reports the current
+ * DMA write position through HAL_UARTEx_RxEventCallback() on half
+ * transfer, transfer complete and IDLE. Everything between the last
+ * processed position and the reported one is new data.
+ *
+ * The line queue is written only from the UART/DMA interrupt and read
+ * only from thread mode. Head and tail are free-running 8-bit counters,
+ * each side writes just one of them.
+ */
+
+#include "uart_rx.h"
+#include "main.h"
+#include "memmap.h"
+#include <string.h>
+
+#ifndef UARTIF_HUART
+#define UARTIF_HUART huart3
+#endif
+
+#define LINEQ_MASK  (UARTRX_LINEQ_DEPTH - 1U)
+
+_Static_assert((UARTRX_LINEQ_DEPTH & LINEQ_MASK) == 0U, "UARTRX_LINEQ_DEPTH must be a power of two");
+
+extern UART_HandleTypeDef UARTIF_HUART;
+
+static uint8_t  rx_dma[UARTRX_DMA_SIZE] DMA_BUFFER;
+static uint16_t rx_pos = 0;
+
+/* Line being assembled (interrupt context only). */
+static char     asm_buf[UARTRX_LINE_MAX];
+static uint32_t asm_len = 0;
+static bool     asm_overflow = false;
+
+static char             lineq[UARTRX_LINEQ_DEPTH][UARTRX_LINE_MAX];
+static volatile uint8_t q_head = 0;
+static volatile uint8_t q_tail = 0;
+
+static uartrx_stats_t stats;
+
+static void start_rx_dma(void)
+{
+    rx_pos = 0;
+    HAL_UARTEx_ReceiveToIdle_DMA(&UARTIF_HUART, rx_dma, UARTRX_DMA_SIZE);
+}
+
+static void push_line(void)
+{
+    uint8_t h = q_head;
+
+    if ((uint8_t)(h - q_tail) >= UARTRX_LINEQ_DEPTH) {
+        stats.lines_dropped++;
+        return;
+    }
+
+    memcpy(lineq[h & LINEQ_MASK], asm_buf, asm_len);
+    lineq[h & LINEQ_MASK][asm_len] = '\0';
+
+    __DMB();
+    q_head = (uint8_t)(h + 1U);
+    stats.lines++;
+}
+
+static void feed(uint8_t b)
+{
+    char c = (char)b;
+
+    if (c == '\r' || c == '\n') {
+        if (asm_overflow) {
+            stats.overlong++;
+        } else if (asm_len > 0U) {
+            push_line();
+        }
+        asm_len = 0;
+        asm_overflow = false;
+        return;
+    }
+
+    if (asm_len < (UARTRX_LINE_MAX - 1U)) {
+        asm_buf[asm_len++] = c;
+    } else {
+        asm_overflow = true;
+    }
+}
+
+void UARTRX_Init(void)
+{
+    asm_len = 0;
+    asm_overflow = false;
+    q_head = 0;
+    q_tail = 0;
+    memset(&stats, 0, sizeof(stats));
+
+    start_rx_dma();
+}
+
+bool UARTRX_GetLine(char *dst, size_t cap)
+{
+    uint8_t t = q_tail;
+    if (t == q_head || cap == 0U) return false;
+
+    __DMB();
+    strncpy(dst, lineq[t & LINEQ_MASK], cap - 1U);
+    dst[cap - 1U] = '\0';
+
+    __DMB();
+    q_tail = (uint8_t)(t + 1U);
+    return true;
+}
+
+void UARTRX_GetStats(uartrx_stats_t *out)
+{
+    *out = stats;
+}
+
+void UARTRX_OnError(void)
+{
+    stats.rx_errors++;
+
+    /* A partial line may have lost bytes: discard it. */
+    asm_len = 0;
+    asm_overflow = false;
+
+    start_rx_dma();
+}
+
+/* ===================== HAL callbacks ===================== */
+
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    if (huart != &UARTIF_HUART) return;
+
+    uint16_t pos = (uint16_t)(Size % UARTRX_DMA_SIZE);
+
+    while (rx_pos != pos) {
+        feed(rx_dma[rx_pos]);
+        rx_pos = (uint16_t)((rx_pos + 1U) % UARTRX_DMA_SIZE);
+    }
+}
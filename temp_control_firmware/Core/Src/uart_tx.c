@@ -0,0 +1,145 @@
+/**
+ * @file uart_tx.c
+ * @brief Implementation of the DMA-driven UART transmit queue.
+ *
+ * Single producer (application tasks in thread mode), single consumer
+ * (DMA completion interrupt). The producer only moves the head index,
+ * the interrupt only moves the tail index. Starting a DMA transfer is
+ * done from both sides and is therefore guarded by a short critical
+ * section.
+ *
+ * A DMA transfer always covers one contiguous block: from the tail to
+ * the head, or to the end of the buffer if the data wraps around. The
+ * wrapped rest is sent by the next transfer.
+ */
+
+#include "uart_tx.h"
+#include "main.h"
+#include "memmap.h"
+#include <string.h>
+
+#ifndef UARTIF_HUART
+#define UARTIF_HUART huart3
+#endif
+
+#define UARTTX_MASK  (UARTTX_BUF_SIZE - 1U)
+
+_Static_assert((UARTTX_BUF_SIZE & UARTTX_MASK) == 0U, "UARTTX_BUF_SIZE must be a power of two");
+
+extern UART_HandleTypeDef UARTIF_HUART;
+
+static uint8_t  tx_buf[UARTTX_BUF_SIZE] DMA_BUFFER;
+static volatile uint32_t head = 0;      /* next byte to write */
+static volatile uint32_t tail = 0;      /* next byte to send */
+static volatile uint16_t inflight = 0;  /* bytes in the running DMA transfer */
+static volatile bool     busy = false;
+
+static uarttx_stats_t stats;
+
+static uint32_t used_bytes(void)
+{
+    return (head - tail) & UARTTX_MASK;
+}
+
+/* Must be called with interrupts disabled or from the TX interrupt. */
+static void start_next(void)
+{
+    if (busy) return;
+
+    uint32_t h = head;
+    uint32_t t = tail;
+    if (h == t) return;
+
+    uint32_t len = (h > t) ? (h - t) : (UARTTX_BUF_SIZE - t);
+
+    busy = true;
+    inflight = (uint16_t)len;
+    if (HAL_UART_Transmit_DMA(&UARTIF_HUART, &tx_buf[t], (uint16_t)len) != HAL_OK) {
+        busy = false;
+        inflight = 0;
+    }
+}
+
+void UARTTX_Init(void)
+{
+    head = 0;
+    tail = 0;
+    inflight = 0;
+    busy = false;
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool UARTTX_Write(const void *data, uint16_t len)
+{
+    if (len == 0U) return true;
+
+    /* One byte stays unused to tell a full buffer from an empty one. */
+    if (len > UARTTX_Free()) {
+        stats.msgs_dropped++;
+        stats.bytes_dropped += len;
+        return false;
+    }
+
+    const uint8_t *src = (const uint8_t *)data;
+    uint32_t h = head;
+    uint32_t first = UARTTX_BUF_SIZE - h;
+    if (first > len) first = len;
+
+    memcpy(&tx_buf[h], src, first);
+    memcpy(&tx_buf[0], src + first, len - first);
+
+    __DMB();
+    head = (h + len) & UARTTX_MASK;
+
+    stats.bytes_queued += len;
+    uint32_t used = used_bytes();
+    if (used > stats.high_water) stats.high_water = (uint16_t)used;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    start_next();
+    __set_PRIMASK(primask);
+
+    return true;
+}
+
+uint16_t UARTTX_Free(void)
+{
+    return (uint16_t)(UARTTX_BUF_SIZE - 1U - used_bytes());
+}
+
+void UARTTX_GetStats(uarttx_stats_t *out)
+{
+    *out = stats;
+}
+
+/* ===================== HAL callbacks ===================== */
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart != &UARTIF_HUART) return;
+
+    stats.bytes_sent += inflight;
+    tail = (tail + inflight) & UARTTX_MASK;
+    inflight = 0;
+    busy = false;
+
+    start_next();
+}
+
+/**
+ * @brief Called by the UART error handler when a TX transfer failed.
+ *
+ * The bytes of the aborted transfer are discarded and the queue moves on.
+ */
+void UARTTX_OnError(void)
+{
+    if (!busy) return;
+
+    stats.tx_errors++;
+    tail = (tail + inflight) & UARTTX_MASK;
+    inflight = 0;
+    busy = false;
+
+    start_next();
+}
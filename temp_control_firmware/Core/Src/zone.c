@@ -0,0 +1,57 @@
+/**
+ * @file zone.c
+ * @brief Zone table storage and defaults.
+ */
+
+#include "zone.h"
+#include "adc_sampler.h"
+#include "config.h"
+#include "main.h"
+#include "memmap.h"
+
+#include <string.h>
+
+#if ZONE_COUNT > ADCS_NUM_CH
+#error "every zone needs an ADC channel in the scan sequence"
+#endif
+
+static const uint32_t pwm_channels[ZONE_MAX] = {
+    TIM_CHANNEL_1, TIM_CHANNEL_2, TIM_CHANNEL_3, TIM_CHANNEL_4
+};
+
+static const smith_model_t smith_default = {
+    .k_c_per_pct = SMITH_K_C_PER_PCT,
+    .tau_s       = SMITH_TAU_S,
+    .dead_s      = SMITH_DEAD_S,
+};
+
+static zone_table_t zones DTCM_DATA;
+
+void Zone_Init(void)
+{
+    memset(&zones, 0, sizeof(zones));
+
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+        zones.adc_ch[z]      = z;
+        zones.pwm_ch[z]      = pwm_channels[z];
+        zones.sp_min_c[z]    = T_SAFE_MIN_C;
+        zones.sp_max_c[z]    = T_SAFE_MAX_C;
+        zones.alarm_min_c[z] = T_ALARM_MIN_C;
+        zones.alarm_max_c[z] = T_ALARM_MAX_C;
+        zones.fan_on_c[z]    = FAN_ON_ABOVE_C;
+        zones.fan_off_c[z]   = FAN_OFF_ABOVE_C;
+        zones.setpoint_c[z]  = T_SETPOINT_DEFAULT_C;
+        zones.kp[z]          = KP;
+        zones.ki[z]          = KI;
+        zones.ff_enable[z]   = (FF_ENABLE_DEFAULT != 0);
+        zones.ff_k[z]        = FF_K_C_PER_PCT;
+        zones.ff_tau[z]      = FF_TAU_S;
+        zones.smith_enable[z] = (SMITH_ENABLE_DEFAULT != 0);
+        zones.smith[z].m     = smith_default;
+    }
+}
+
+ITCM_CODE zone_table_t *Zone_Table(void)
+{
+    return &zones;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file bench.h
+ * @brief Timing helpers for the host benchmarks.
+ *
+ * Times are those of the build machine, useful to compare implementations
+ * with each other, not as target figures: the Cortex-M7 has no double
+ * precision FPU and runs the hot paths from ITCM. Cycles are the time
+ * stamp counter on x86 and 0 elsewhere.
+ */
+
+#ifndef HOST_BENCH_BENCH_H_
+#define HOST_BENCH_BENCH_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+typedef struct {
+    uint64_t ns;
+    uint64_t cycles;
+} bench_t;
+
+static inline bench_t bench_now(void)
+{
+    struct timespec ts;
+    bench_t b;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    b.ns = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#if defined(__x86_64__) || defined(__i386__)
+    b.cycles = __rdtsc();
+#else
+    b.cycles = 0;
+#endif
+    return b;
+}
+
+/** Nanoseconds per operation since @p start. */
+static inline double bench_ns(bench_t start, uint32_t ops)
+{
+    return (double)(bench_now().ns - start.ns) / ops;
+}
+
+/** Counter cycles per operation since @p start. */
+static inline double bench_cycles(bench_t start, uint32_t ops)
+{
+    return (double)(bench_now().cycles - start.cycles) / ops;
+}
+
+/** Iterations from the first argument, @p def without one. */
+static inline uint32_t bench_iterations(int argc, char **argv, uint32_t def)
+{
+    if (argc > 1) {
+        unsigned long n = strtoul(argv[1], NULL, 0);
+        if (n > 0UL) return (uint32_t)n;
+    }
+    return def;
+}
+
+#endif /* HOST_BENCH_BENCH_H_ */
@@ -0,0 +1,80 @@
+/**
+ * @file bench_fmt.c
+ * @brief fmt.c and json_build.c against the C library printf.
+ *
+ * Prints the time and cycles per number of FMT_Float() and snprintf() at
+ * the telemetry precision, and per frame of a three-field JSON line built
+ * with JSONB_* and with one snprintf(). Equivalence is checked by
+ * test_fmt.
+ *
+ *   bench_fmt [iterations]
+ */
+
+#include "bench.h"
+#include "fmt.h"
+#include "json_build.h"
+
+#include <stdio.h>
+
+#define NVAL  1024U
+
+static float t_meas[NVAL], t_ref[NVAL], pwm[NVAL];
+
+static uint32_t rnd(void)
+{
+    static uint32_t x = 2463534242U;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+int main(int argc, char **argv)
+{
+    const uint32_t n = bench_iterations(argc, argv, 2000000U);
+    volatile uint32_t sink = 0;
+    char buf[128];
+    bench_t t;
+
+    for (uint32_t i = 0; i < NVAL; i++) {
+        t_meas[i] = 20.0f + (float)(rnd() % 6000U) / 100.0f + 0.0037f;
+        t_ref[i]  = 35.0f + (float)(rnd() % 50U) / 2.0f;
+        pwm[i]    = (float)(rnd() % 1000U) / 10.0f;
+    }
+
+    printf("%u iterations:\n", n);
+
+    t = bench_now();
+    for (uint32_t i = 0; i < n; i++) {
+        sink += (uint32_t)snprintf(buf, sizeof(buf), "%.2f", (double)t_meas[i & (NVAL - 1U)]);
+    }
+    printf("  snprintf %%.2f     %7.1f ns  %7.1f cycles\n", bench_ns(t, n), bench_cycles(t, n));
+
+    t = bench_now();
+    for (uint32_t i = 0; i < n; i++) sink += FMT_Float(buf, t_meas[i & (NVAL - 1U)], 2);
+    printf("  FMT_Float 2       %7.1f ns  %7.1f cycles\n", bench_ns(t, n), bench_cycles(t, n));
+
+    t = bench_now();
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t k = i & (NVAL - 1U);
+        sink += (uint32_t)snprintf(buf, sizeof(buf),
+                                   "{\"T_meas\":%.2f,\"T_ref\":%.2f,\"PWM\":%.1f}\r\n",
+                                   (double)t_meas[k], (double)t_ref[k], (double)pwm[k]);
+    }
+    printf("  snprintf frame    %7.1f ns  %7.1f cycles\n", bench_ns(t, n), bench_cycles(t, n));
+
+    t = bench_now();
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t k = i & (NVAL - 1U);
+        jsonb_t jb;
+        JSONB_Begin(&jb, buf, sizeof(buf));
+        JSONB_AddFloat(&jb, "T_meas", t_meas[k], 2);
+        JSONB_AddFloat(&jb, "T_ref", t_ref[k], 2);
+        JSONB_AddFloat(&jb, "PWM", pwm[k], 1);
+        sink += JSONB_End(&jb);
+    }
+    printf("  JSONB frame       %7.1f ns  %7.1f cycles\n", bench_ns(t, n), bench_cycles(t, n));
+
+    (void)sink;
+    return 0;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file bench_ntc.c
+ * @brief NTC conversion: interpolated table against the Beta model.
+ *
+ * Prints the error of Temperature_FromRaw() against
+ * Temperature_FromRawExact() over the alarm range and over -40 .. 150 C,
+ * then the time and cycles per conversion of the exact model, the
+ * 12-bit table lookup and the 12.4 lookup used by the control loop.
+ *
+ *   bench_ntc [iterations]
+ */
+
+#include "bench.h"
+#include "config.h"
+#include "temperature.h"
+#include "zone.h"
+
+#include <math.h>
+#include <stdio.h>
+
+static void accuracy(float t_min, float t_max)
+{
+    double worst = 0.0, sum = 0.0;
+    uint16_t worst_raw = 0;
+    uint32_t n = 0;
+
+    for (uint16_t raw = 1; raw < 4095U; raw++) {
+        float exact = Temperature_FromRawExact(raw);
+        if (exact < t_min || exact > t_max) continue;
+
+        double e = fabs((double)Temperature_FromRaw(raw) - exact);
+        sum += e;
+        n++;
+        if (e > worst) {
+            worst = e;
+            worst_raw = raw;
+        }
+    }
+    printf("  %7.1f .. %5.1f C: max %.4f C at code %4u, mean %.5f C (%u codes)\n",
+           t_min, t_max, worst, worst_raw, n > 0U ? sum / n : 0.0, n);
+}
+
+int main(int argc, char **argv)
+{
+    const uint32_t n = bench_iterations(argc, argv, 20000000U);
+    volatile float sink = 0.0f;
+    float acc;
+    bench_t t;
+
+    Zone_Init();
+    Temperature_Init();
+
+    printf("table error against the Beta model:\n");
+    accuracy(T_ALARM_MIN_C, T_ALARM_MAX_C);
+    accuracy(-40.0f, 150.0f);
+
+    /* Codes 400 .. 2447 sweep about 3 .. 80 C. */
+    printf("\n%u conversions each:\n", n);
+
+    acc = 0.0f;
+    t = bench_now();
+    for (uint32_t i = 0; i < n; i++) acc += Temperature_FromRawExact((uint16_t)(400U + (i & 2047U)));
+    sink = acc;
+    printf("  exact (logf)  %6.2f ns  %6.1f cycles\n", bench_ns(t, n), bench_cycles(t, n));
+
+    acc = 0.0f;
+    t = bench_now();
+    for (uint32_t i = 0; i < n; i++) acc += Temperature_FromRaw((uint16_t)(400U + (i & 2047U)));
+    sink = acc;
+    printf("  table 12-bit  %6.2f ns  %6.1f cycles\n", bench_ns(t, n), bench_cycles(t, n));
+
+    acc = 0.0f;
+    t = bench_now();
+    for (uint32_t i = 0; i < n; i++) acc += Temperature_FromRawQ4((uint16_t)(6400U + (i & 32767U)));
+    sink = acc;
+    printf("  table 12.4    %6.2f ns  %6.1f cycles\n", bench_ns(t, n), bench_cycles(t, n));
+
+    (void)sink;
+    return 0;
+}
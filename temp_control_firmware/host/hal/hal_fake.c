@@ -0,0 +1,623 @@
+/**
+ * @file hal_fake.c
+ * @brief Host implementation of the HAL stand-in.
+ *
+ * Also defines the peripheral handles that main.c owns on target
+ * (hadc1, htim1, htim7, huart3, hcrc and the DMA handles), so the
+ * firmware modules link without main.c.
+ */
+
+#include "stm32f7xx_hal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HALFAKE_CAPTURE_SIZE  65536U
+#define HALFAKE_FLASH_SIZE    (1024U * 1024U)
+
+uint32_t     halfake_primask;
+GPIO_TypeDef halfake_gpio[11];
+ADC_TypeDef  halfake_adc1;
+TIM_TypeDef  halfake_tim1;
+TIM_TypeDef  halfake_tim7;
+USART_TypeDef halfake_usart3;
+
+/* Typical STM32F7 sensor: 0.76 V at 25 degC, 2.5 mV/degC. */
+uint16_t halfake_ts_cal[2] = {958U, 1207U};
+
+ADC_HandleTypeDef  hadc1;
+CRC_HandleTypeDef  hcrc;
+TIM_HandleTypeDef  htim1;
+TIM_HandleTypeDef  htim7;
+UART_HandleTypeDef huart3;
+DMA_HandleTypeDef  hdma_adc1;
+DMA_HandleTypeDef  hdma_usart3_rx;
+DMA_HandleTypeDef  hdma_usart3_tx;
+
+static uint32_t tick;
+
+static uint16_t *adc_buf;
+static uint32_t  adc_len;
+static uint32_t  adc_pos;
+static uint16_t  adc_injected;
+static bool      adc_injected_cfg;
+static bool      adc_pend_awd;
+static bool      adc_pend_half;
+static bool      adc_pend_full;
+
+static const uint8_t *tx_data;
+static uint16_t       tx_len;
+static void         (*tx_sink)(const uint8_t *data, uint16_t len);
+static uint8_t        capture[HALFAKE_CAPTURE_SIZE];
+static size_t         capture_len;
+
+static uint8_t  *rx_buf;
+static uint16_t  rx_size;
+static uint16_t  rx_pos;
+
+static uint8_t  flash_mem[HALFAKE_FLASH_SIZE];
+static bool     flash_blank_done;
+static bool     flash_locked = true;
+static uint32_t flash_ops;
+static bool     flash_cut_armed;
+static uint32_t flash_cut_at;
+static uint32_t flash_rng;
+static bool     flash_dead;
+static bool     flash_erasing;
+static void   (*flash_erase_hook)(uint32_t sector);
+
+void Error_Handler(void)
+{
+    fprintf(stderr, "Error_Handler called\n");
+    abort();
+}
+
+void HALFAKE_Reset(void)
+{
+    halfake_primask = 0;
+    memset(halfake_gpio, 0, sizeof(halfake_gpio));
+    memset(&halfake_adc1, 0, sizeof(halfake_adc1));
+    memset(&halfake_tim1, 0, sizeof(halfake_tim1));
+    memset(&halfake_tim7, 0, sizeof(halfake_tim7));
+
+    /* Values from MX_TIM1_Init() and MX_TIM7_Init(). */
+    htim1.Instance = TIM1;
+    htim1.Init.Prescaler = 0;
+    htim1.Init.Period = 3599;
+    halfake_tim1.ARR = 3599;
+
+    htim7.Instance = TIM7;
+    htim7.Init.Prescaler = 720 - 1;
+    htim7.Init.Period = 100 - 1;
+    halfake_tim7.ARR = 100 - 1;
+
+    hadc1.Instance = ADC1;
+    hadc1.DMA_Handle = &hdma_adc1;
+
+    huart3.Instance = USART3;
+    huart3.gState = HAL_UART_STATE_READY;
+    huart3.RxState = HAL_UART_STATE_READY;
+
+    tick = 0;
+    adc_buf = NULL;
+    adc_len = 0;
+    adc_pos = 0;
+    adc_injected = HALFAKE_ADC_TempSensorCode(30.0f);
+    adc_injected_cfg = false;
+    adc_pend_awd = false;
+    adc_pend_half = false;
+    adc_pend_full = false;
+    tx_data = NULL;
+    tx_len = 0;
+    tx_sink = NULL;
+    capture_len = 0;
+    rx_buf = NULL;
+    rx_size = 0;
+    rx_pos = 0;
+    flash_locked = true;
+    flash_erasing = false;
+    flash_erase_hook = NULL;
+}
+
+/* ===================== Tick ===================== */
+
+uint32_t HAL_GetTick(void)
+{
+    return tick;
+}
+
+void HAL_IncTick(void)
+{
+    tick++;
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+    tick += Delay;
+}
+
+void HALFAKE_SetTick(uint32_t ms)
+{
+    tick = ms;
+}
+
+void HALFAKE_AdvanceTick(uint32_t ms)
+{
+    tick += ms;
+}
+
+/* ===================== GPIO ===================== */
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    if (PinState == GPIO_PIN_SET) GPIOx->ODR |= GPIO_Pin;
+    else                          GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    GPIOx->ODR ^= GPIO_Pin;
+}
+
+void HALFAKE_GPIO_SetInput(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state)
+{
+    if (state == GPIO_PIN_SET) port->IDR |= pin;
+    else                       port->IDR &= ~(uint32_t)pin;
+}
+
+/* ===================== ADC ===================== */
+
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef *hadc, uint32_t *pData, uint32_t Length)
+{
+    (void)hadc;
+    if (pData == NULL || Length == 0U) return HAL_ERROR;
+
+    /* 12-bit data is transferred as half-words, as in the DMA setup. */
+    adc_buf = (uint16_t *)pData;
+    adc_len = Length;
+    adc_pos = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_Stop_DMA(ADC_HandleTypeDef *hadc)
+{
+    (void)hadc;
+    adc_buf = NULL;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_AnalogWDGConfig(ADC_HandleTypeDef *hadc, ADC_AnalogWDGConfTypeDef *AnalogWDGConfig)
+{
+    ADC_TypeDef *adc = hadc->Instance;
+    uint32_t cr1 = adc->CR1 & ~(ADC_CR1_AWDCH | ADC_CR1_AWDSGL | ADC_CR1_AWDEN | ADC_CR1_AWDIE);
+
+    cr1 |= AnalogWDGConfig->WatchdogMode | (AnalogWDGConfig->Channel & ADC_CR1_AWDCH);
+    if (AnalogWDGConfig->ITMode == ENABLE) cr1 |= ADC_CR1_AWDIE;
+
+    adc->HTR = AnalogWDGConfig->HighThreshold;
+    adc->LTR = AnalogWDGConfig->LowThreshold;
+    adc->CR1 = cr1;
+    return HAL_OK;
+}
+
+/* A software break clears MOE; EGR bits read back as zero. */
+static void tim_apply_events(TIM_TypeDef *tim)
+{
+    if (tim->EGR & TIM_EGR_BG) {
+        tim->BDTR &= ~TIM_BDTR_MOE;
+        tim->SR |= TIM_FLAG_BREAK;
+    }
+    tim->EGR = 0;
+}
+
+static void adc_watchdog(ADC_TypeDef *adc, uint16_t value)
+{
+    /* Every sample is checked: single-channel mode (AWDSGL) is not
+       modelled, the fake does not track the scan position. */
+    if ((adc->CR1 & ADC_CR1_AWDEN) == 0U) return;
+    if (value >= adc->LTR && value <= adc->HTR) return;
+
+    adc->SR |= ADC_SR_AWD;
+    if (adc->CR1 & ADC_CR1_AWDIE) {
+        if (flash_erasing) {
+            adc_pend_awd = true;
+            return;
+        }
+        HAL_ADC_LevelOutOfWindowCallback(&hadc1);
+        adc->SR &= ~ADC_SR_AWD;
+        tim_apply_events(&halfake_tim1);
+    }
+}
+
+/* Interrupts held back by a flash erase: the ADC one first. */
+static void adc_run_pending(void)
+{
+    if (adc_pend_awd) {
+        adc_pend_awd = false;
+        HAL_ADC_LevelOutOfWindowCallback(&hadc1);
+        halfake_adc1.SR &= ~ADC_SR_AWD;
+        tim_apply_events(&halfake_tim1);
+    }
+    if (adc_pend_half) {
+        adc_pend_half = false;
+        HAL_ADC_ConvHalfCpltCallback(&hadc1);
+    }
+    if (adc_pend_full) {
+        adc_pend_full = false;
+        HAL_ADC_ConvCpltCallback(&hadc1);
+    }
+}
+
+void HALFAKE_ADC_Push(const uint16_t *samples, uint32_t count)
+{
+    if (adc_buf == NULL) return;
+
+    for (uint32_t i = 0; i < count; i++) {
+        halfake_adc1.DR = samples[i];
+        adc_watchdog(&halfake_adc1, samples[i]);
+        adc_buf[adc_pos++] = samples[i];
+
+        if (adc_pos == adc_len / 2U) {
+            if (flash_erasing) adc_pend_half = true;
+            else               HAL_ADC_ConvHalfCpltCallback(&hadc1);
+        } else if (adc_pos == adc_len) {
+            adc_pos = 0;
+            if (flash_erasing) adc_pend_full = true;
+            else               HAL_ADC_ConvCpltCallback(&hadc1);
+        }
+    }
+}
+
+HAL_StatusTypeDef HAL_ADCEx_InjectedConfigChannel(ADC_HandleTypeDef *hadc, ADC_InjectionConfTypeDef *sConfigInjected)
+{
+    (void)hadc;
+    if (sConfigInjected->InjectedRank != ADC_INJECTED_RANK_1) return HAL_ERROR;
+    adc_injected_cfg = true;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADCEx_InjectedStart(ADC_HandleTypeDef *hadc)
+{
+    if (!adc_injected_cfg) return HAL_ERROR;
+
+    /* Converted at once; the regular DMA stream is not disturbed. */
+    hadc->Instance->JDR1 = adc_injected;
+    hadc->Instance->SR |= ADC_SR_JEOC;
+    return HAL_OK;
+}
+
+uint32_t HAL_ADCEx_InjectedGetValue(ADC_HandleTypeDef *hadc, uint32_t InjectedRank)
+{
+    (void)InjectedRank;
+    hadc->Instance->SR &= ~ADC_SR_JEOC;
+    return hadc->Instance->JDR1;
+}
+
+void HALFAKE_ADC_SetInjected(uint16_t code)
+{
+    adc_injected = code;
+}
+
+uint16_t HALFAKE_ADC_TempSensorCode(float t_c)
+{
+    float code = (float)halfake_ts_cal[0] +
+                 (t_c - 30.0f) * (float)(halfake_ts_cal[1] - halfake_ts_cal[0]) / 80.0f;
+    if (code < 0.0f) code = 0.0f;
+    if (code > 4095.0f) code = 4095.0f;
+    return (uint16_t)(code + 0.5f);
+}
+
+__weak void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
+{
+    (void)hadc;
+}
+
+__weak void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc)
+{
+    (void)hadc;
+}
+
+__weak void HAL_ADC_LevelOutOfWindowCallback(ADC_HandleTypeDef *hadc)
+{
+    (void)hadc;
+}
+
+/* ===================== TIM ===================== */
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel)
+{
+    (void)Channel;
+    /* Advanced-control timer: the HAL also sets the main output enable. */
+    if (htim->Instance == TIM1) htim->Instance->BDTR |= TIM_BDTR_MOE;
+    htim->Instance->CR1 |= 1U;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim)
+{
+    htim->Instance->CR1 |= 1U;
+    return HAL_OK;
+}
+
+__weak void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+{
+    (void)htim;
+}
+
+/* ===================== UART ===================== */
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size)
+{
+    if (huart->gState != HAL_UART_STATE_READY) return HAL_BUSY;
+    if (pData == NULL || Size == 0U) return HAL_ERROR;
+
+    huart->gState = HAL_UART_STATE_BUSY_TX;
+    tx_data = pData;
+    tx_len = Size;
+    return HAL_OK;
+}
+
+bool HALFAKE_UART_TxComplete(void)
+{
+    if (huart3.gState != HAL_UART_STATE_BUSY_TX) return false;
+
+    if (tx_sink != NULL) {
+        tx_sink(tx_data, tx_len);
+    } else {
+        size_t n = tx_len;
+        if (n > HALFAKE_CAPTURE_SIZE - capture_len) n = HALFAKE_CAPTURE_SIZE - capture_len;
+        memcpy(&capture[capture_len], tx_data, n);
+        capture_len += n;
+    }
+
+    tx_data = NULL;
+    tx_len = 0;
+    huart3.gState = HAL_UART_STATE_READY;
+    HAL_UART_TxCpltCallback(&huart3);
+    return true;
+}
+
+void HALFAKE_UART_Flush(void)
+{
+    while (HALFAKE_UART_TxComplete()) {
+    }
+}
+
+void HALFAKE_UART_SetSink(void (*sink)(const uint8_t *data, uint16_t len))
+{
+    tx_sink = sink;
+}
+
+size_t HALFAKE_UART_TakeOutput(uint8_t *dst, size_t cap)
+{
+    size_t n = (capture_len < cap) ? capture_len : cap;
+    memcpy(dst, capture, n);
+    memmove(capture, &capture[n], capture_len - n);
+    capture_len -= n;
+    return n;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    if (pData == NULL || Size == 0U) return HAL_ERROR;
+
+    /* Circular mode: the reception stays active, RxState stays busy. */
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    rx_buf = pData;
+    rx_size = Size;
+    rx_pos = 0;
+    return HAL_OK;
+}
+
+void HALFAKE_UART_Inject(const void *data, size_t len)
+{
+    const uint8_t *src = (const uint8_t *)data;
+    if (rx_buf == NULL) return;
+
+    for (size_t i = 0; i < len; i++) {
+        rx_buf[rx_pos++] = src[i];
+
+        /* Half and full buffer events, as the HAL reports them. */
+        if (rx_pos == rx_size / 2U) {
+            HAL_UARTEx_RxEventCallback(&huart3, rx_pos);
+        } else if (rx_pos == rx_size) {
+            HAL_UARTEx_RxEventCallback(&huart3, rx_pos);
+            rx_pos = 0;
+        }
+    }
+
+    /* Idle line after the burst. */
+    if (rx_pos != 0U && rx_pos != rx_size / 2U) {
+        HAL_UARTEx_RxEventCallback(&huart3, rx_pos);
+    }
+}
+
+__weak void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+}
+
+__weak void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+}
+
+__weak void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    (void)huart;
+    (void)Size;
+}
+
+/* ===================== CRC ===================== */
+
+uint32_t HAL_CRC_Calculate(CRC_HandleTypeDef *hcrc_, uint32_t pBuffer[], uint32_t BufferLength)
+{
+    (void)hcrc_;
+    const uint8_t *p = (const uint8_t *)pBuffer;
+    uint32_t crc = 0xFFFFFFFFU;
+
+    for (uint32_t i = 0; i < BufferLength; i++) {
+        crc ^= (uint32_t)p[i] << 24;
+        for (uint8_t k = 0; k < 8U; k++) {
+            crc = (crc & 0x80000000U) ? ((crc << 1) ^ 0x04C11DB7U) : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/* ===================== FLASH ===================== */
+
+/* Sectors of the single-bank F746: 4 x 32K, 128K, 3 x 256K. */
+static const uint32_t flash_sector_kb[8] = {32U, 32U, 32U, 32U, 128U, 256U, 256U, 256U};
+
+/* The image is erased on first use, a static initialiser would put 1 MB
+   of 0xFF into the executable. */
+static void flash_blank(void)
+{
+    if (!flash_blank_done) {
+        memset(flash_mem, 0xFF, sizeof(flash_mem));
+        flash_blank_done = true;
+    }
+}
+
+static uint32_t flash_random(void)
+{
+    flash_rng = flash_rng * 1664525U + 1013904223U;
+    return flash_rng >> 8;
+}
+
+/* Count an operation; false if the power is lost before it completes. */
+static bool flash_op_survives(void)
+{
+    flash_ops++;
+    if (!flash_cut_armed) return true;
+    if (flash_cut_at > 0U) {
+        flash_cut_at--;
+        return true;
+    }
+    flash_cut_armed = false;
+    flash_dead = true;
+    return false;
+}
+
+const void *HALFAKE_FLASH_Ptr(uint32_t addr)
+{
+    if (addr < FLASH_BASE || addr - FLASH_BASE >= HALFAKE_FLASH_SIZE) return NULL;
+    flash_blank();
+    return &flash_mem[addr - FLASH_BASE];
+}
+
+void HALFAKE_FLASH_Wipe(void)
+{
+    memset(flash_mem, 0xFF, sizeof(flash_mem));
+    flash_blank_done = true;
+    flash_ops = 0;
+}
+
+uint32_t HALFAKE_FLASH_Ops(void)
+{
+    return flash_ops;
+}
+
+void HALFAKE_FLASH_CutPower(uint32_t ops, uint32_t seed)
+{
+    flash_cut_armed = true;
+    flash_cut_at = ops;
+    flash_rng = seed;
+}
+
+void HALFAKE_FLASH_PowerOn(void)
+{
+    flash_cut_armed = false;
+    flash_dead = false;
+}
+
+void HALFAKE_FLASH_SetEraseHook(void (*hook)(uint32_t sector))
+{
+    flash_erase_hook = hook;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void)
+{
+    flash_locked = false;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void)
+{
+    flash_locked = true;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data)
+{
+    static const uint32_t size[4] = {1U, 2U, 4U, 8U};
+
+    if (flash_locked || flash_dead || TypeProgram > FLASH_TYPEPROGRAM_DOUBLEWORD) return HAL_ERROR;
+
+    uint32_t n = size[TypeProgram];
+    uint8_t *p = (uint8_t *)(uintptr_t)HALFAKE_FLASH_Ptr(Address);
+    if (p == NULL || (Address & (n - 1U)) != 0U ||
+        Address - FLASH_BASE + n > HALFAKE_FLASH_SIZE) {
+        return HAL_ERROR;
+    }
+
+    bool done = flash_op_survives();
+
+    /* Little endian; programming only takes bits from 1 to 0. */
+    for (uint32_t i = 0; i < n; i++) {
+        uint8_t b = (uint8_t)(Data >> (8U * i));
+        if (!done) b |= (uint8_t)flash_random();
+        p[i] &= b;
+    }
+    return done ? HAL_OK : HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *SectorError)
+{
+    *SectorError = 0xFFFFFFFFU;
+    if (flash_locked || flash_dead || pEraseInit->TypeErase != FLASH_TYPEERASE_SECTORS) return HAL_ERROR;
+
+    for (uint32_t s = pEraseInit->Sector; s < pEraseInit->Sector + pEraseInit->NbSectors; s++) {
+        if (s >= 8U) {
+            *SectorError = s;
+            return HAL_ERROR;
+        }
+
+        uint32_t start = 0;
+        for (uint32_t i = 0; i < s; i++) start += flash_sector_kb[i] * 1024U;
+        uint32_t len = flash_sector_kb[s] * 1024U;
+        uint8_t *p = (uint8_t *)(uintptr_t)HALFAKE_FLASH_Ptr(FLASH_BASE + start);
+
+        if (flash_erase_hook != NULL) {
+            flash_erasing = true;
+            flash_erase_hook(s);
+            flash_erasing = false;
+        }
+
+        if (flash_op_survives()) {
+            memset(p, 0xFF, len);
+            adc_run_pending();
+            continue;
+        }
+
+        for (uint32_t i = 0; i < len; i += 4U) {
+            uint32_t r = flash_random();
+            switch (r % 3U) {
+            case 0:  memset(&p[i], 0xFF, 4U); break;
+            case 1:  break;
+            default: memcpy(&p[i], &r, 4U); break;
+            }
+        }
+        adc_run_pending();
+        *SectorError = s;
+        return HAL_ERROR;
+    }
+    return HAL_OK;
+}
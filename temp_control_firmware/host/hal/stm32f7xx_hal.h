@@ -0,0 +1,453 @@
+/**
+ * @file stm32f7xx_hal.h
+ * @brief Host stand-in for the STM32F7 HAL.
+ *
+ * Found before the real HAL on the host include path, so the unmodified
+ * Core/Src modules (through main.h) compile and run on a PC. Only the
+ * parts of the HAL used by the firmware modules are provided:
+ *
+ *  - GPIO       : per-port IDR/ODR registers
+ *  - ADC        : DMA start, samples pushed with HALFAKE_ADC_Push(),
+ *                 analog watchdog on every pushed sample; injected
+ *                 software conversion that completes at once with the
+ *                 value of HALFAKE_ADC_SetInjected(), temperature
+ *                 sensor calibration values
+ *  - TIM        : register block with ARR/CCRx/CNT/SR, PWM start, MOE
+ *                 and software break (EGR.BG) on TIM1
+ *  - UART       : DMA transmit captured by HALFAKE_UART_*, idle-line
+ *                 DMA reception fed with HALFAKE_UART_Inject()
+ *  - tick       : HAL_GetTick() on a virtual millisecond counter
+ *  - CRC        : software CRC-32/MPEG-2 (hardware reset configuration)
+ *  - FLASH      : RAM image of the 1 MB flash with the F746 sector
+ *                 layout; programming only clears bits, as on the
+ *                 device. Read it through HALFAKE_FLASH_Ptr(). A power
+ *                 loss can be injected in the middle of any program or
+ *                 erase operation (HALFAKE_FLASH_CutPower()). An
+ *                 erase stalls the interrupts, as on the device: ADC
+ *                 callbacks due during it run when it ends
+ *  - CMSIS      : PRIMASK, barriers, WFI and cache maintenance as
+ *                 no-ops, IPSR always 0 (thread mode)
+ *
+ * Interrupts do not exist on the host: callbacks run synchronously from
+ * the HALFAKE_* calls, in the thread of the caller.
+ */
+
+#ifndef HOST_STM32F7XX_HAL_H_
+#define HOST_STM32F7XX_HAL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef __weak
+#define __weak __attribute__((weak))
+#endif
+
+typedef enum {
+    HAL_OK      = 0x00U,
+    HAL_ERROR   = 0x01U,
+    HAL_BUSY    = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+/* ===================== CMSIS ===================== */
+
+extern uint32_t halfake_primask;
+
+static inline void     __DMB(void) { }
+static inline void     __DSB(void) { }
+static inline void     __ISB(void) { }
+static inline void     __NOP(void) { }
+static inline void     __WFI(void) { }
+static inline void     __disable_irq(void) { halfake_primask = 1U; }
+static inline void     __enable_irq(void) { halfake_primask = 0U; }
+static inline uint32_t __get_PRIMASK(void) { return halfake_primask; }
+static inline uint32_t __get_IPSR(void) { return 0U; }
+static inline void     __set_PRIMASK(uint32_t v) { halfake_primask = v; }
+static inline void     SCB_InvalidateDCache_by_Addr(uint32_t *addr, int32_t dsize) { (void)addr; (void)dsize; }
+
+/* ===================== GPIO ===================== */
+
+typedef struct {
+    volatile uint32_t IDR;
+    volatile uint32_t ODR;
+} GPIO_TypeDef;
+
+typedef enum {
+    GPIO_PIN_RESET = 0,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+extern GPIO_TypeDef halfake_gpio[11];
+
+#define GPIOA  (&halfake_gpio[0])
+#define GPIOB  (&halfake_gpio[1])
+#define GPIOC  (&halfake_gpio[2])
+#define GPIOD  (&halfake_gpio[3])
+#define GPIOE  (&halfake_gpio[4])
+#define GPIOF  (&halfake_gpio[5])
+#define GPIOG  (&halfake_gpio[6])
+#define GPIOH  (&halfake_gpio[7])
+#define GPIOI  (&halfake_gpio[8])
+#define GPIOJ  (&halfake_gpio[9])
+#define GPIOK  (&halfake_gpio[10])
+
+#define GPIO_PIN_0   ((uint16_t)0x0001U)
+#define GPIO_PIN_1   ((uint16_t)0x0002U)
+#define GPIO_PIN_2   ((uint16_t)0x0004U)
+#define GPIO_PIN_3   ((uint16_t)0x0008U)
+#define GPIO_PIN_4   ((uint16_t)0x0010U)
+#define GPIO_PIN_5   ((uint16_t)0x0020U)
+#define GPIO_PIN_6   ((uint16_t)0x0040U)
+#define GPIO_PIN_7   ((uint16_t)0x0080U)
+#define GPIO_PIN_8   ((uint16_t)0x0100U)
+#define GPIO_PIN_9   ((uint16_t)0x0200U)
+#define GPIO_PIN_10  ((uint16_t)0x0400U)
+#define GPIO_PIN_11  ((uint16_t)0x0800U)
+#define GPIO_PIN_12  ((uint16_t)0x1000U)
+#define GPIO_PIN_13  ((uint16_t)0x2000U)
+#define GPIO_PIN_14  ((uint16_t)0x4000U)
+#define GPIO_PIN_15  ((uint16_t)0x8000U)
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+
+/* ===================== DMA ===================== */
+
+typedef struct {
+    void *Instance;
+} DMA_HandleTypeDef;
+
+/* ===================== Common ===================== */
+
+typedef enum {
+    DISABLE = 0U,
+    ENABLE  = 1U
+} FunctionalState;
+
+/* ===================== ADC ===================== */
+
+typedef struct {
+    volatile uint32_t SR;
+    volatile uint32_t CR1;
+    volatile uint32_t HTR;
+    volatile uint32_t LTR;
+    volatile uint32_t JDR1;
+    volatile uint32_t DR;
+} ADC_TypeDef;
+
+#define ADC_SR_AWD      0x00000001U
+#define ADC_SR_JEOC     0x00000004U
+#define ADC_CR1_AWDCH   0x0000001FU
+#define ADC_CR1_AWDIE   0x00000040U
+#define ADC_CR1_AWDSGL  0x00000200U
+#define ADC_CR1_AWDEN   0x00800000U
+
+#define ADC_FLAG_AWD    ADC_SR_AWD
+#define ADC_FLAG_JEOC   ADC_SR_JEOC
+#define ADC_IT_AWD      ADC_CR1_AWDIE
+
+#define ADC_CHANNEL_0           0x00000000U
+#define ADC_CHANNEL_TEMPSENSOR  (0x00000012U | 0x10000000U)
+
+#define ADC_SAMPLETIME_480CYCLES            0x00000007U
+#define ADC_INJECTED_RANK_1                 0x00000001U
+#define ADC_INJECTED_SOFTWARE_START         0x00000010U
+#define ADC_EXTERNALTRIGINJECCONVEDGE_NONE  0x00000000U
+
+/* Factory calibration of the temperature sensor (30 / 110 degC at 3.3 V). */
+extern uint16_t halfake_ts_cal[2];
+#define TEMPSENSOR_CAL1_ADDR_CMSIS  (&halfake_ts_cal[0])
+#define TEMPSENSOR_CAL2_ADDR_CMSIS  (&halfake_ts_cal[1])
+
+#define ADC_ANALOGWATCHDOG_SINGLE_REG  (ADC_CR1_AWDSGL | ADC_CR1_AWDEN)
+#define ADC_ANALOGWATCHDOG_ALL_REG     ADC_CR1_AWDEN
+
+typedef struct {
+    uint32_t        WatchdogMode;
+    uint32_t        HighThreshold;
+    uint32_t        LowThreshold;
+    uint32_t        Channel;
+    FunctionalState ITMode;
+    uint32_t        WatchdogNumber;
+} ADC_AnalogWDGConfTypeDef;
+
+typedef struct {
+    uint32_t        InjectedChannel;
+    uint32_t        InjectedRank;
+    uint32_t        InjectedSamplingTime;
+    uint32_t        InjectedOffset;
+    uint32_t        InjectedNbrOfConversion;
+    FunctionalState InjectedDiscontinuousConvMode;
+    FunctionalState AutoInjectedConv;
+    uint32_t        ExternalTrigInjecConv;
+    uint32_t        ExternalTrigInjecConvEdge;
+} ADC_InjectionConfTypeDef;
+
+#define __HAL_ADC_ENABLE_IT(__HANDLE__, __IT__)    ((__HANDLE__)->Instance->CR1 |= (__IT__))
+#define __HAL_ADC_DISABLE_IT(__HANDLE__, __IT__)   ((__HANDLE__)->Instance->CR1 &= ~(uint32_t)(__IT__))
+#define __HAL_ADC_CLEAR_FLAG(__HANDLE__, __FLAG__) ((__HANDLE__)->Instance->SR = ~(uint32_t)(__FLAG__))
+#define __HAL_ADC_GET_FLAG(__HANDLE__, __FLAG__)   ((((__HANDLE__)->Instance->SR) & (__FLAG__)) == (__FLAG__))
+
+extern ADC_TypeDef halfake_adc1;
+#define ADC1  (&halfake_adc1)
+
+typedef struct {
+    ADC_TypeDef       *Instance;
+    DMA_HandleTypeDef *DMA_Handle;
+} ADC_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef *hadc, uint32_t *pData, uint32_t Length);
+HAL_StatusTypeDef HAL_ADC_Stop_DMA(ADC_HandleTypeDef *hadc);
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc);
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc);
+HAL_StatusTypeDef HAL_ADC_AnalogWDGConfig(ADC_HandleTypeDef *hadc, ADC_AnalogWDGConfTypeDef *AnalogWDGConfig);
+void HAL_ADC_LevelOutOfWindowCallback(ADC_HandleTypeDef *hadc);
+HAL_StatusTypeDef HAL_ADCEx_InjectedConfigChannel(ADC_HandleTypeDef *hadc, ADC_InjectionConfTypeDef *sConfigInjected);
+HAL_StatusTypeDef HAL_ADCEx_InjectedStart(ADC_HandleTypeDef *hadc);
+uint32_t HAL_ADCEx_InjectedGetValue(ADC_HandleTypeDef *hadc, uint32_t InjectedRank);
+
+/* ===================== TIM ===================== */
+
+typedef struct {
+    volatile uint32_t CR1;
+    volatile uint32_t SR;
+    volatile uint32_t EGR;
+    volatile uint32_t CNT;
+    volatile uint32_t PSC;
+    volatile uint32_t ARR;
+    volatile uint32_t CCR1;
+    volatile uint32_t CCR2;
+    volatile uint32_t CCR3;
+    volatile uint32_t CCR4;
+    volatile uint32_t BDTR;
+} TIM_TypeDef;
+
+extern TIM_TypeDef halfake_tim1;
+extern TIM_TypeDef halfake_tim7;
+#define TIM1  (&halfake_tim1)
+#define TIM7  (&halfake_tim7)
+
+typedef struct {
+    uint32_t Prescaler;
+    uint32_t Period;
+} TIM_Base_InitTypeDef;
+
+typedef struct {
+    TIM_TypeDef          *Instance;
+    TIM_Base_InitTypeDef  Init;
+} TIM_HandleTypeDef;
+
+#define TIM_CHANNEL_1    0x00000000U
+#define TIM_CHANNEL_2    0x00000004U
+#define TIM_CHANNEL_3    0x00000008U
+#define TIM_CHANNEL_4    0x0000000CU
+
+#define TIM_FLAG_UPDATE  0x00000001U
+#define TIM_FLAG_BREAK   0x00000080U
+
+#define TIM_EGR_BG       0x00000080U
+#define TIM_BDTR_OSSI    0x00000400U
+#define TIM_BDTR_MOE     0x00008000U
+
+#define __HAL_TIM_MOE_ENABLE(__HANDLE__)  ((__HANDLE__)->Instance->BDTR |= TIM_BDTR_MOE)
+#define __HAL_TIM_MOE_DISABLE_UNCONDITIONALLY(__HANDLE__)  (__HANDLE__)->Instance->BDTR &= ~(TIM_BDTR_MOE)
+
+#define __HAL_TIM_GET_AUTORELOAD(__HANDLE__)  ((__HANDLE__)->Instance->ARR)
+#define __HAL_TIM_GET_COUNTER(__HANDLE__)     ((__HANDLE__)->Instance->CNT)
+#define __HAL_TIM_GET_FLAG(__HANDLE__, __FLAG__) \
+    (((__HANDLE__)->Instance->SR & (__FLAG__)) == (__FLAG__))
+#define __HAL_TIM_SET_COMPARE(__HANDLE__, __CHANNEL__, __COMPARE__)          \
+    (((__CHANNEL__) == TIM_CHANNEL_1) ? ((__HANDLE__)->Instance->CCR1 = (__COMPARE__)) : \
+     ((__CHANNEL__) == TIM_CHANNEL_2) ? ((__HANDLE__)->Instance->CCR2 = (__COMPARE__)) : \
+     ((__CHANNEL__) == TIM_CHANNEL_3) ? ((__HANDLE__)->Instance->CCR3 = (__COMPARE__)) : \
+                                        ((__HANDLE__)->Instance->CCR4 = (__COMPARE__)))
+#define __HAL_TIM_GET_COMPARE(__HANDLE__, __CHANNEL__)                        \
+    (((__CHANNEL__) == TIM_CHANNEL_1) ? ((__HANDLE__)->Instance->CCR1) :     \
+     ((__CHANNEL__) == TIM_CHANNEL_2) ? ((__HANDLE__)->Instance->CCR2) :     \
+     ((__CHANNEL__) == TIM_CHANNEL_3) ? ((__HANDLE__)->Instance->CCR3) :     \
+                                        ((__HANDLE__)->Instance->CCR4))
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef *htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim);
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim);
+void HAL_TIM_MspPostInit(TIM_HandleTypeDef *htim);
+
+/* ===================== UART ===================== */
+
+typedef struct {
+    volatile uint32_t ISR;
+} USART_TypeDef;
+
+extern USART_TypeDef halfake_usart3;
+#define USART3  (&halfake_usart3)
+
+typedef enum {
+    HAL_UART_STATE_RESET   = 0x00U,
+    HAL_UART_STATE_READY   = 0x20U,
+    HAL_UART_STATE_BUSY_TX = 0x21U,
+    HAL_UART_STATE_BUSY_RX = 0x22U
+} HAL_UART_StateTypeDef;
+
+typedef struct {
+    USART_TypeDef                  *Instance;
+    volatile HAL_UART_StateTypeDef  gState;
+    volatile HAL_UART_StateTypeDef  RxState;
+} UART_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart);
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size);
+
+/* ===================== CRC ===================== */
+
+typedef struct {
+    void *Instance;
+} CRC_HandleTypeDef;
+
+/**
+ * Byte input format, as configured by MX_CRC_Init(): @p BufferLength is
+ * in bytes.
+ */
+uint32_t HAL_CRC_Calculate(CRC_HandleTypeDef *hcrc, uint32_t pBuffer[], uint32_t BufferLength);
+
+/* ===================== FLASH ===================== */
+
+#define FLASH_BASE                 0x08000000U
+
+#define FLASH_TYPEPROGRAM_BYTE        0x00U
+#define FLASH_TYPEPROGRAM_HALFWORD    0x01U
+#define FLASH_TYPEPROGRAM_WORD        0x02U
+#define FLASH_TYPEPROGRAM_DOUBLEWORD  0x03U
+
+#define FLASH_TYPEERASE_SECTORS    0x00U
+#define FLASH_VOLTAGE_RANGE_3      0x02U
+
+#define FLASH_SECTOR_0  0U   /* 32K */
+#define FLASH_SECTOR_1  1U
+#define FLASH_SECTOR_2  2U
+#define FLASH_SECTOR_3  3U
+#define FLASH_SECTOR_4  4U   /* 128K */
+#define FLASH_SECTOR_5  5U   /* 256K */
+#define FLASH_SECTOR_6  6U
+#define FLASH_SECTOR_7  7U
+
+typedef struct {
+    uint32_t TypeErase;
+    uint32_t Sector;
+    uint32_t NbSectors;
+    uint32_t VoltageRange;
+} FLASH_EraseInitTypeDef;
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void);
+HAL_StatusTypeDef HAL_FLASH_Lock(void);
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data);
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *SectorError);
+
+/* ===================== Tick ===================== */
+
+uint32_t HAL_GetTick(void);
+void HAL_IncTick(void);
+void HAL_Delay(uint32_t Delay);
+
+/* ===================== Host controls ===================== */
+
+/** Reset every fake peripheral to its post-MX_Init state. */
+void HALFAKE_Reset(void);
+
+void HALFAKE_SetTick(uint32_t ms);
+void HALFAKE_AdvanceTick(uint32_t ms);
+
+/**
+ * @brief Write samples into the running ADC DMA buffer.
+ *
+ * Half-transfer and transfer-complete callbacks fire when the write
+ * position crosses the middle or the end of the buffer, as on target.
+ * The analog watchdog checks each sample before it is stored; its
+ * callback runs immediately and a software break written to TIM1 EGR
+ * is applied when it returns.
+ */
+void HALFAKE_ADC_Push(const uint16_t *samples, uint32_t count);
+
+/** Result of the next injected conversions (12-bit code). */
+void HALFAKE_ADC_SetInjected(uint16_t code);
+
+/** Temperature sensor code at @p t_c, from the fake calibration values. */
+uint16_t HALFAKE_ADC_TempSensorCode(float t_c);
+
+/**
+ * @brief Complete the running UART TX DMA transfer.
+ *
+ * The transferred bytes go to the output sink, then the TX complete
+ * callback runs (which may start the next transfer).
+ * @return false if no transfer was running.
+ */
+bool HALFAKE_UART_TxComplete(void);
+
+/** Complete TX transfers until the transmit queue is idle. */
+void HALFAKE_UART_Flush(void);
+
+/** Output sink for transmitted bytes; NULL keeps them in the capture buffer. */
+void HALFAKE_UART_SetSink(void (*sink)(const uint8_t *data, uint16_t len));
+
+/**
+ * @brief Take captured output bytes (when no sink is set).
+ * @return Number of bytes copied to @p dst.
+ */
+size_t HALFAKE_UART_TakeOutput(uint8_t *dst, size_t cap);
+
+/** Receive bytes on the UART, followed by an idle-line event. */
+void HALFAKE_UART_Inject(const void *data, size_t len);
+
+/**
+ * @brief Host address of the flash byte at target address @p addr.
+ *
+ * The image survives HALFAKE_Reset(), as the flash survives a reset of
+ * the MCU. NULL outside the flash.
+ */
+const void *HALFAKE_FLASH_Ptr(uint32_t addr);
+
+/** Erase the whole flash image, as a new device. */
+void HALFAKE_FLASH_Wipe(void);
+
+/** Program and erase operations started since the last wipe. */
+uint32_t HALFAKE_FLASH_Ops(void);
+
+/**
+ * @brief Lose the power during a later flash operation.
+ *
+ * After @p ops more operations complete, the next one is interrupted:
+ * a program leaves a random part of its zero bits programmed, an erase
+ * leaves every word of the sector erased, unchanged or random. Every
+ * operation after it fails with HAL_ERROR until HALFAKE_FLASH_PowerOn().
+ * @param seed Seed of the random damage.
+ */
+void HALFAKE_FLASH_CutPower(uint32_t ops, uint32_t seed);
+
+/** Restore the power: cancels a pending cut, flash operations work again. */
+void HALFAKE_FLASH_PowerOn(void);
+
+/**
+ * @brief Function called in the middle of every sector erase, NULL for
+ *        none.
+ *
+ * It sees the state of the device while the erase runs; samples pushed
+ * from it are converted, but their callbacks wait for the erase to end.
+ */
+void HALFAKE_FLASH_SetEraseHook(void (*hook)(uint32_t sector));
+
+/** Set the level read back from an input pin. */
+void HALFAKE_GPIO_SetInput(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_STM32F7XX_HAL_H_ */
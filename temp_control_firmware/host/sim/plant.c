@@ -0,0 +1,151 @@
+/**
+ * @file plant.c
+ * @brief Implementation of the thermal plant model.
+ *
+ * The first-order part is integrated with the exact discretisation for a
+ * piecewise constant input, so the step size only limits the dead-time
+ * resolution, not the accuracy.
+ */
+
+#include "plant.h"
+#include "config.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+/* xorshift64* */
+static inline uint64_t next_u64(plant_t *pl)
+{
+    pl->rng ^= pl->rng >> 12;
+    pl->rng ^= pl->rng << 25;
+    pl->rng ^= pl->rng >> 27;
+    return pl->rng * 0x2545F4914F6CDD1DULL;
+}
+
+void Plant_DefaultParams(plant_params_t *p)
+{
+    p->k_c_per_pct   = 0.5;
+    p->tau_s         = 21.0;
+    p->dead_s        = 0.5;
+    p->ambient_c     = 25.0;
+    p->t0_c          = 25.0;
+    p->ntc_offset_c  = 0.0;
+    p->ntc_noise_c   = 0.05;
+    p->adc_noise_lsb = 2.0;
+    p->seed          = 1;
+}
+
+int Plant_Init(plant_t *pl, const plant_params_t *p, double dt_s)
+{
+    pl->p = *p;
+    pl->dt_s = dt_s;
+    pl->t_c = p->t0_c;
+    pl->rng = p->seed ? p->seed : 0x9E3779B97F4A7C15ULL;
+    pl->has_spare = 0;
+
+    pl->delay_len = (uint32_t)lround(p->dead_s / dt_s);
+    pl->delay_idx = 0;
+    pl->delay = NULL;
+    if (pl->delay_len > 0U) {
+        pl->delay = calloc(pl->delay_len, sizeof(float));
+        if (pl->delay == NULL) return -1;
+    }
+    return 0;
+}
+
+void Plant_Free(plant_t *pl)
+{
+    free(pl->delay);
+    pl->delay = NULL;
+}
+
+void Plant_Step(plant_t *pl, float duty_pct)
+{
+    float u = duty_pct;
+
+    if (pl->delay_len > 0U) {
+        u = pl->delay[pl->delay_idx];
+        pl->delay[pl->delay_idx] = duty_pct;
+        if (++pl->delay_idx >= pl->delay_len) pl->delay_idx = 0;
+    }
+
+    double t_ss = pl->p.ambient_c + pl->p.k_c_per_pct * (double)u;
+    double a = exp(-pl->dt_s / pl->p.tau_s);
+    pl->t_c = t_ss + (pl->t_c - t_ss) * a;
+}
+
+double Plant_TempToAdc(double t_c)
+{
+    double t_k = t_c + 273.15;
+    double r_ntc = NTC_R0 * exp(NTC_BETA * (1.0 / t_k - 1.0 / NTC_T0_K));
+
+    return ADC_MAX * r_ntc / (R_FIXED + r_ntc);
+}
+
+uint16_t Plant_SampleAdc(plant_t *pl)
+{
+    double t = pl->t_c + pl->p.ntc_offset_c;
+    if (pl->p.ntc_noise_c > 0.0) t += pl->p.ntc_noise_c * Plant_Gauss(pl);
+
+    double code = Plant_TempToAdc(t);
+    if (pl->p.adc_noise_lsb > 0.0) code += pl->p.adc_noise_lsb * Plant_Gauss(pl);
+
+    long q = lround(code);
+    if (q < 0) q = 0;
+    if (q > 4095) q = 4095;
+    return (uint16_t)q;
+}
+
+void Plant_SampleAdcBlock(plant_t *pl, uint16_t *out, uint32_t n)
+{
+    double t = pl->t_c + pl->p.ntc_offset_c;
+    double code  = Plant_TempToAdc(t);
+    double slope = (Plant_TempToAdc(t + 0.05) - Plant_TempToAdc(t - 0.05)) / 0.1;
+    double sd_ntc = slope * pl->p.ntc_noise_c;
+    double sd = sqrt(sd_ntc * sd_ntc + pl->p.adc_noise_lsb * pl->p.adc_noise_lsb);
+
+    /* Sum of four 16-bit uniforms: mean 2^17 - 2, variance 4 * 2^32 / 12. */
+    const double k = sd * sqrt(3.0) / 65536.0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        double c = code;
+        if (sd > 0.0) {
+            uint64_t r = next_u64(pl);
+            uint32_t sum = (uint32_t)(r & 0xFFFFU) + (uint32_t)((r >> 16) & 0xFFFFU)
+                         + (uint32_t)((r >> 32) & 0xFFFFU) + (uint32_t)(r >> 48);
+            c += k * ((double)sum - 131070.0);
+        }
+
+        long q = lround(c);
+        if (q < 0) q = 0;
+        if (q > 4095) q = 4095;
+        out[i] = (uint16_t)q;
+    }
+}
+
+/* ===================== Random numbers ===================== */
+
+double Plant_Uniform(plant_t *pl)
+{
+    return (double)(next_u64(pl) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+double Plant_Gauss(plant_t *pl)
+{
+    if (pl->has_spare) {
+        pl->has_spare = 0;
+        return pl->spare;
+    }
+
+    double u, v, s;
+    do {
+        u = 2.0 * Plant_Uniform(pl) - 1.0;
+        v = 2.0 * Plant_Uniform(pl) - 1.0;
+        s = u * u + v * v;
+    } while (s >= 1.0 || s == 0.0);
+
+    double m = sqrt(-2.0 * log(s) / s);
+    pl->spare = v * m;
+    pl->has_spare = 1;
+    return u * m;
+}
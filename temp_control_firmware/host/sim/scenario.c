@@ -0,0 +1,85 @@
+/**
+ * @file scenario.c
+ * @brief Implementation of scenario loading.
+ */
+
+#include "scenario.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int Scenario_Load(scenario_t *sc, const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    char line[256];
+    unsigned lineno = 0;
+    sc->n = 0;
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        lineno++;
+        char *hash = strchr(line, '#');
+        if (hash != NULL) *hash = '\0';
+
+        char *p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0' || *p == '\n' || *p == '\r') continue;
+
+        char *end;
+        double t = strtod(p, &end);
+        if (end == p) {
+            if (sc->n == 0) continue;   /* header */
+            fprintf(stderr, "%s:%u: expected a number\n", path, lineno);
+            fclose(f);
+            return -1;
+        }
+
+        p = end;
+        while (*p == ' ' || *p == ',' || *p == ';' || *p == '\t') p++;
+        double ref = strtod(p, &end);
+        if (end == p) {
+            fprintf(stderr, "%s:%u: missing setpoint\n", path, lineno);
+            fclose(f);
+            return -1;
+        }
+
+        if (sc->n >= SCENARIO_MAX_STEPS) {
+            fprintf(stderr, "%s: more than %d steps\n", path, SCENARIO_MAX_STEPS);
+            fclose(f);
+            return -1;
+        }
+        if (sc->n > 0 && t <= sc->t_s[sc->n - 1]) {
+            fprintf(stderr, "%s:%u: times must increase\n", path, lineno);
+            fclose(f);
+            return -1;
+        }
+
+        sc->t_s[sc->n] = t;
+        sc->ref_c[sc->n] = ref;
+        sc->n++;
+    }
+    fclose(f);
+
+    if (sc->n < 2) {
+        fprintf(stderr, "%s: need at least one step and an end time\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+double Scenario_RefAt(const scenario_t *sc, double t_s)
+{
+    size_t i = 0;
+    while (i + 1 < sc->n - 1 && t_s >= sc->t_s[i + 1]) i++;
+    return sc->ref_c[i];
+}
+
+double Scenario_Duration(const scenario_t *sc)
+{
+    return sc->t_s[sc->n - 1];
+}
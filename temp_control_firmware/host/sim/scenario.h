@@ -0,0 +1,39 @@
+/**
+ * @file scenario.h
+ * @brief Setpoint scenarios for host simulations.
+ *
+ * A scenario is a staircase: each step holds its setpoint from its start
+ * time until the next step. The last entry only marks the end time.
+ *
+ * File format (CSV, '#' starts a comment, a non-numeric first line is a
+ * header):
+ *
+ *   t_s,T_ref_C
+ *   0,30
+ *   40,35
+ *   ...
+ *   280,60
+ */
+
+#ifndef HOST_SIM_SCENARIO_H_
+#define HOST_SIM_SCENARIO_H_
+
+#include <stddef.h>
+
+#define SCENARIO_MAX_STEPS  64
+
+typedef struct {
+    double t_s[SCENARIO_MAX_STEPS];
+    double ref_c[SCENARIO_MAX_STEPS];
+    size_t n;          /**< number of entries, including the end marker */
+} scenario_t;
+
+/** @return 0 on success, -1 on I/O or format error (message on stderr). */
+int Scenario_Load(scenario_t *sc, const char *path);
+
+/** Setpoint at time @p t_s. */
+double Scenario_RefAt(const scenario_t *sc, double t_s);
+
+double Scenario_Duration(const scenario_t *sc);
+
+#endif /* HOST_SIM_SCENARIO_H_ */
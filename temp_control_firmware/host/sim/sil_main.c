@@ -0,0 +1,533 @@
+/**
+ * @file sil_main.c
+ * @brief Software-in-the-loop closed-loop simulator.
+ *
+ * Runs the firmware measurement and control path against the thermal
+ * plant (plant.h) on a virtual 1 ms clock:
+ *
+ *  - the plant is sampled at the ADC rate (TIM1 trigger, 20 kHz) and the
+ *    codes are pushed into the real ADC DMA decimator (adc_sampler.c);
+ *    the plant is zone 0, the other scan channels read the ambient
+ *    temperature
+ *  - every CONTROL_PERIOD_MS the control step of Task_Control() runs:
+ *    Temperature_FromRawQ4() + Temperature_Filter(), Control_Update(),
+ *    Heater_SetDutyPercent()
+ *  - the plant input is the duty read back from the zone 0 compare register
+ *
+ * The safety logic (alarm, fan) is not part of the simulated step.
+ *
+ * With --autotune the run starts with a tuning phase at the first
+ * scenario setpoint: the loop settles with the configured gains for
+ * --tune-settle seconds, then the relay autotuner (autotune.h) runs
+ * through Control_Update() exactly as on the target until it applies
+ * its gains. The scenario then plays with the tuned gains, continuing
+ * from the plant state the tuning left.
+ *
+ * The online plant identification of zone 0 (ident.h) runs inside
+ * Control_Update(); its final model is printed next to the true plant.
+ * --drift T:K changes the plant gain to K at scenario time T (a degrading
+ * heater) and reports when the identification flags the drift.
+ *
+ * --ff turns on the model-based feed-forward of zone 0 (control.h). The
+ * ambient estimate comes from the MCU sensor path of ambient.c, fed with
+ * the plant ambient plus the configured die self-heating, so with an
+ * ideal sensor the estimate equals the plant ambient.
+ *
+ * --smith closes zone 0 on the Smith predictor (smith.h) with the true
+ * plant model; --smith-model K:tau:L gives the predictor a different
+ * model instead, to see the effect of a mismatch. The residual of the
+ * predictor is reported in both cases, and whether it flagged a mismatch.
+ *
+ * The scenario is played through the setpoint profile engine of the
+ * firmware (profile.h): every step becomes a segment with rate 0 and the
+ * step length as hold, and Profile_Update() drives the setpoint in the
+ * control step. The run checks that the profile follows the scenario.
+ * Scenarios with more steps than PROFILE_MAX_SEG set the setpoint
+ * directly.
+ *
+ * --perf prints the execution times of the control step sections, timed
+ * with the perf.h sections of the firmware on the host clock.
+ *
+ * Every step also reports its settling time: from the setpoint change to
+ * the last sample outside the tolerance band.
+ *
+ * After the run the steady-state error of every scenario step is taken
+ * as the mean of T_meas - T_ref over the last --ss-window seconds of the
+ * step and checked against the accuracy requirement: 1 % of the control
+ * range T_SAFE_MIN_C..T_SAFE_MAX_C. The exit code is 0 when every step
+ * passes, 1 when one fails and 2 on usage or I/O errors.
+ *
+ * The default run, config.h gains on the default staircase, fails: with
+ * KP 0.7 and KI 0.5 the loop takes 100..150 s to settle on the default
+ * plant, and the staircase holds each step for 40 s. The CTest runs use
+ * the reference gains 5 / 0.3, the autotuner, and the config.h gains on
+ * sim/temp_setpoint_slow_staircase.csv (host/CMakeLists.txt).
+ */
+
+#include "main.h"
+#include "adc_sampler.h"
+#include "ambient.h"
+#include "autotune.h"
+#include "config.h"
+#include "control.h"
+#include "heater.h"
+#include "ident.h"
+#include "perf.h"
+#include "profile.h"
+#include "setpoint.h"
+#include "smith.h"
+#include "temperature.h"
+#include "zone.h"
+
+#include "plant.h"
+#include "scenario.h"
+
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+extern TIM_HandleTypeDef htim1;
+
+#define SIL_DT_MS        1U
+#define ADC_RATE_HZ      20000U    /* TIM1 update rate, ADC trigger */
+#define ADC_PER_TICK     (ADC_RATE_HZ / 1000U * SIL_DT_MS)
+
+typedef struct {
+    plant_t  plant;
+    uint16_t idle_code;      /**< ADC code of the channels without a plant */
+    uint32_t ms;             /**< virtual clock */
+    uint32_t last_seq;
+    float    t_meas;
+    float    pwm;
+} sil_t;
+
+typedef struct {
+    double sum_meas;
+    double sum_plant;
+    double max_abs;
+    unsigned n;
+    double settle_s;         /**< last time outside the band, from the step start */
+} step_stats_t;
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --scenario FILE   setpoint staircase (default: %s)\n"
+        "  --csv FILE        write a trace at the control rate\n"
+        "  --k V             plant gain [degC/%%]\n"
+        "  --tau V           plant time constant [s]\n"
+        "  --dead V          plant dead time [s]\n"
+        "  --ambient V       ambient temperature [degC]\n"
+        "  --t0 V            initial temperature [degC]\n"
+        "  --ntc-noise V     sensor noise std [degC]\n"
+        "  --adc-noise V     ADC noise std [LSB]\n"
+        "  --seed N          random seed\n"
+        "  --ss-window V     steady-state window at the end of each step [s]\n"
+        "  --tol-pct V       allowed error in %% of the control range (default 1)\n"
+        "  --kp V --ki V     controller gains (default KP, KI from config.h)\n"
+        "  --autotune R      tune the gains first, rule Z, T or S (see autotune.h)\n"
+        "  --tune-settle V   settling time before the autotune [s] (default 60)\n"
+        "  --drift T:K       change the plant gain to K at scenario time T [s]\n"
+        "  --ff              model-based feed-forward on (see control.h)\n"
+        "  --smith           Smith predictor on, with the plant model\n"
+        "  --smith-model K:tau:L\n"
+        "                    Smith predictor on, with this model\n"
+        "  --perf            print the execution times of the control step\n",
+        prog, SIL_DEFAULT_SCENARIO);
+}
+
+/*
+ * One 1 ms tick: the ADC conversions of the tick, the control step when
+ * it is due (returns true) and the plant step with the PWM duty.
+ */
+static bool sil_tick(sil_t *s, float t_ref)
+{
+    bool control = (s->ms % CONTROL_PERIOD_MS == 0U);
+
+    HALFAKE_SetTick(s->ms);
+    if (s->ms % AMBIENT_PERIOD_MS == 0U) Ambient_Task();
+
+    uint16_t samples[ADC_PER_TICK];
+    uint16_t frames[ADC_PER_TICK * ADCS_NUM_CH];
+    Plant_SampleAdcBlock(&s->plant, samples, ADC_PER_TICK);
+    for (uint32_t i = 0; i < ADC_PER_TICK; i++) {
+        for (uint32_t ch = 0; ch < ADCS_NUM_CH; ch++) frames[i * ADCS_NUM_CH + ch] = s->idle_code;
+        frames[i * ADCS_NUM_CH + Zone_Table()->adc_ch[0]] = samples[i];
+    }
+    HALFAKE_ADC_Push(frames, ADC_PER_TICK * ADCS_NUM_CH);
+
+    if (control) {
+        PERF_BEGIN(PERF_LOOP);
+        PERF_BEGIN(PERF_ADC);
+        adcs_sample_t smp;
+        bool fresh = ADCS_GetLatest(Zone_Table()->adc_ch[0], &smp) && smp.seq != s->last_seq;
+        PERF_END(PERF_ADC);
+
+        PERF_BEGIN(PERF_FILTER);
+        if (fresh) {
+            s->last_seq = smp.seq;
+            s->t_meas = Temperature_Filter(0, Temperature_FromRawQ4(smp.raw_q4));
+        }
+        PERF_END(PERF_FILTER);
+
+        PERF_BEGIN(PERF_CONTROL);
+        if (Profile_Get(0)->state == PROFILE_RUNNING) {
+            Profile_Update(0);
+        } else {
+            Setpoint_SetC(0, t_ref);
+        }
+        s->pwm = Control_Update(0, Setpoint_GetC(0), s->t_meas);
+        Heater_SetDutyPercent(0, s->pwm);
+        PERF_END(PERF_CONTROL);
+        PERF_END(PERF_LOOP);
+    }
+
+    uint32_t arr = __HAL_TIM_GET_AUTORELOAD(&htim1);
+    float duty = 100.0f * (float)__HAL_TIM_GET_COMPARE(&htim1, Zone_Table()->pwm_ch[0]) / (float)(arr + 1U);
+    Plant_Step(&s->plant, duty);
+
+    s->ms += SIL_DT_MS;
+    return control;
+}
+
+/*
+ * Execution times of the control step sections, with the log2 histogram
+ * of perf.h: one column per bin, from < 2^(PERF_HIST_SHIFT + 1) ticks.
+ */
+static void sil_print_perf(void)
+{
+    printf("section     n        min_us   mean_us  max_us   histogram\n");
+    for (int i = 0; i < PERF_SEC_COUNT; i++) {
+        const perf_stat_t *st = Perf_GetStat((perf_sec_t)i);
+        if (st->n == 0U) continue;
+
+        printf("%-10s  %-7u  %7.3f  %7.3f  %7.3f ", Perf_SectionName((perf_sec_t)i),
+               st->n, Perf_ToUs(st->min), Perf_ToUs(Perf_GetMean((perf_sec_t)i)),
+               Perf_ToUs(st->max));
+        for (uint32_t b = 0; b < PERF_HIST_BINS; b++) printf(" %u", st->hist[b]);
+        printf("\n");
+    }
+}
+
+/*
+ * Load the scenario as the profile of zone 0: one step segment per
+ * scenario step, held until the next one.
+ * @return false if it does not fit.
+ */
+static bool sil_load_profile(const scenario_t *sc)
+{
+    Profile_Clear(0);
+    for (size_t k = 0; k + 1 < sc->n; k++) {
+        const profile_seg_t seg = {
+            .rate_c_per_s = 0.0f,
+            .target_c     = (float)sc->ref_c[k],
+            .hold_s       = (float)(sc->t_s[k + 1] - sc->t_s[k]),
+        };
+        if (!Profile_AddSegment(0, &seg)) {
+            Profile_Clear(0);
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Settle at @p t_ref, then run an autotune session to its end.
+ * @return 0 when the gains were applied.
+ */
+static int sil_autotune(sil_t *s, at_rule_t rule, float t_ref, double settle_s, FILE *csv)
+{
+    static const char *const state_name[] = {"idle", "running", "done", "failed", "aborted"};
+    const uint32_t t0 = s->ms;
+    const uint32_t settle_ms = (uint32_t)llround(settle_s * 1000.0);
+    bool started = false;
+
+    while (!started || Autotune_IsRunning(0)) {
+        if (!started && s->ms - t0 >= settle_ms) {
+            started = Autotune_Start(0, rule);
+            if (!started) return 1;
+        }
+        if (sil_tick(s, t_ref) && csv != NULL) {
+            fprintf(csv, "%.1f,%.2f,%.4f,%.4f,%.3f\n",
+                    (s->ms - SIL_DT_MS) / 1000.0, t_ref, s->t_meas, s->plant.t_c, s->pwm);
+        }
+    }
+
+    const at_result_t *r = Autotune_GetResult();
+    printf("autotune: rule %c, %s after %u cycles, %.1f s\n",
+           "ZTS"[r->rule], state_name[r->state], r->cycles,
+           (s->ms - t0 - settle_ms) / 1000.0);
+    printf("  Ku=%.3f %%/degC  Pu=%.2f s  a=%.3f degC  L=%.2f s  ->  kp=%.3f ki=%.4f\n",
+           r->ku, r->pu_s, r->amp_c, r->dead_s, r->kp, r->ki);
+
+    return (r->state == AT_DONE) ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    const char *scenario_path = SIL_DEFAULT_SCENARIO;
+    const char *csv_path = NULL;
+    double ss_window_s = 5.0;
+    double tol_pct = 1.0;
+    float kp = KP;
+    float ki = KI;
+    int tune_rule = -1;
+    double tune_settle_s = 60.0;
+    double drift_t_s = -1.0;
+    double drift_k = 0.0;
+    bool ff = false;
+    bool smith = false;
+    bool perf = false;
+    smith_model_t sm = {0.0f, 0.0f, -1.0f};   /* dead_s < 0: plant model */
+    plant_params_t pp;
+    Plant_DefaultParams(&pp);
+
+    static const struct option opts[] = {
+        {"scenario",  required_argument, NULL, 's'},
+        {"csv",       required_argument, NULL, 'c'},
+        {"k",         required_argument, NULL, 'k'},
+        {"tau",       required_argument, NULL, 't'},
+        {"dead",      required_argument, NULL, 'd'},
+        {"ambient",   required_argument, NULL, 'a'},
+        {"t0",        required_argument, NULL, '0'},
+        {"ntc-noise", required_argument, NULL, 'n'},
+        {"adc-noise", required_argument, NULL, 'q'},
+        {"seed",      required_argument, NULL, 'r'},
+        {"ss-window", required_argument, NULL, 'w'},
+        {"tol-pct",   required_argument, NULL, 'p'},
+        {"kp",        required_argument, NULL, 'P'},
+        {"ki",        required_argument, NULL, 'I'},
+        {"autotune",  required_argument, NULL, 'U'},
+        {"tune-settle", required_argument, NULL, 'S'},
+        {"drift",     required_argument, NULL, 'D'},
+        {"ff",        no_argument,       NULL, 'F'},
+        {"smith",     no_argument,       NULL, 'M'},
+        {"smith-model", required_argument, NULL, 'L'},
+        {"perf",      no_argument,       NULL, 'X'},
+        {"help",      no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "h", opts, NULL)) != -1) {
+        switch (c) {
+        case 's': scenario_path = optarg; break;
+        case 'c': csv_path = optarg; break;
+        case 'k': pp.k_c_per_pct = atof(optarg); break;
+        case 't': pp.tau_s = atof(optarg); break;
+        case 'd': pp.dead_s = atof(optarg); break;
+        case 'a': pp.ambient_c = atof(optarg); break;
+        case '0': pp.t0_c = atof(optarg); break;
+        case 'n': pp.ntc_noise_c = atof(optarg); break;
+        case 'q': pp.adc_noise_lsb = atof(optarg); break;
+        case 'r': pp.seed = strtoull(optarg, NULL, 0); break;
+        case 'w': ss_window_s = atof(optarg); break;
+        case 'p': tol_pct = atof(optarg); break;
+        case 'P': kp = (float)atof(optarg); break;
+        case 'I': ki = (float)atof(optarg); break;
+        case 'U':
+            switch (optarg[0]) {
+            case 'Z': tune_rule = AT_RULE_ZN;   break;
+            case 'T': tune_rule = AT_RULE_TL;   break;
+            case 'S': tune_rule = AT_RULE_SIMC; break;
+            default:  usage(argv[0]); return 2;
+            }
+            break;
+        case 'S': tune_settle_s = atof(optarg); break;
+        case 'D':
+            if (sscanf(optarg, "%lf:%lf", &drift_t_s, &drift_k) != 2) {
+                usage(argv[0]);
+                return 2;
+            }
+            break;
+        case 'F': ff = true; break;
+        case 'M': smith = true; break;
+        case 'X': perf = true; break;
+        case 'L':
+            if (sscanf(optarg, "%f:%f:%f", &sm.k_c_per_pct, &sm.tau_s, &sm.dead_s) != 3) {
+                usage(argv[0]);
+                return 2;
+            }
+            smith = true;
+            break;
+        default:  usage(argv[0]); return 2;
+        }
+    }
+
+    scenario_t sc;
+    if (Scenario_Load(&sc, scenario_path) != 0) return 2;
+
+    sil_t sim = {0};
+    if (Plant_Init(&sim.plant, &pp, SIL_DT_MS / 1000.0) != 0) {
+        fprintf(stderr, "out of memory\n");
+        return 2;
+    }
+
+    FILE *csv = NULL;
+    if (csv_path != NULL) {
+        csv = fopen(csv_path, "w");
+        if (csv == NULL) {
+            perror(csv_path);
+            return 2;
+        }
+        fprintf(csv, "t_s,T_ref_C,T_meas_C,T_plant_C,PWM_percent\n");
+    }
+
+    /* Firmware init, same order as main(). */
+    HALFAKE_Reset();
+    Perf_Init();
+    Zone_Init();
+    Temperature_Init();
+    Control_Init(0);
+    PID_SetGains(Control_GetPID(0), kp, ki, KD);
+    Control_SetFeedForward(0, ff);
+    if (sm.dead_s < 0.0f) {
+        sm.k_c_per_pct = (float)pp.k_c_per_pct;
+        sm.tau_s       = (float)pp.tau_s;
+        sm.dead_s      = (float)pp.dead_s;
+    }
+    if (!Control_SetSmithModel(0, &sm)) {
+        fprintf(stderr, "invalid Smith predictor model\n");
+        return 2;
+    }
+    Control_SetSmith(0, smith);
+    Heater_Init();
+    Ambient_Init();
+    Ambient_SetSource(AMBIENT_SRC_MCU);
+    HALFAKE_ADC_SetInjected(HALFAKE_ADC_TempSensorCode((float)pp.ambient_c + AMBIENT_MCU_OFFSET_C));
+    ADCS_Init(ADC_OVERSAMPLE_RATIO);
+    if (!ADCS_Start()) {
+        fprintf(stderr, "ADCS_Start failed\n");
+        return 2;
+    }
+
+    step_stats_t steps[SCENARIO_MAX_STEPS] = {0};
+    const uint32_t dur_ms = (uint32_t)llround(Scenario_Duration(&sc) * 1000.0);
+    sim.idle_code = Plant_TempToAdc(pp.ambient_c);
+    sim.t_meas = (float)pp.t0_c;
+
+    clock_t wall0 = clock();
+
+    if (tune_rule >= 0) {
+        if (sil_autotune(&sim, (at_rule_t)tune_rule, (float)sc.ref_c[0], tune_settle_s, csv) != 0) {
+            printf("FAIL\n");
+            return 1;
+        }
+        kp = Control_GetPID(0)->p.kp;
+        ki = Control_GetPID(0)->p.ki;
+    }
+
+    const bool profile = sil_load_profile(&sc) && Profile_Start(0);
+    unsigned profile_diff = 0;
+
+    const double tol_c = tol_pct / 100.0 * (T_SAFE_MAX_C - T_SAFE_MIN_C);
+    const uint32_t t0_ms = sim.ms;
+    const ident_model_t *id = Ident_GetModel(&Zone_Table()->ident[0]);
+    double t_valid_s = -1.0;
+    double t_flag_s = -1.0;
+    const smith_t *sp = &Zone_Table()->smith[0];
+    double t_mismatch_s = -1.0;
+    double resid_rms_max = 0.0;
+
+    while (sim.ms - t0_ms < dur_ms) {
+        double t_s = (sim.ms - t0_ms) / 1000.0;
+        float t_ref = (float)Scenario_RefAt(&sc, t_s);
+
+        if (drift_t_s >= 0.0 && t_s >= drift_t_s) sim.plant.p.k_c_per_pct = drift_k;
+
+        if (!sil_tick(&sim, t_ref)) continue;
+        if (profile && fabsf(Setpoint_GetC(0) - t_ref) > 1e-4f) profile_diff++;
+
+        if (t_valid_s < 0.0 && (id->flags & IDENT_VALID)) t_valid_s = t_s;
+        if (t_flag_s < 0.0 && (id->flags & (IDENT_DRIFT_GAIN | IDENT_DRIFT_TAU))) t_flag_s = t_s;
+        if (t_mismatch_s < 0.0 && (sp->flags & SMITH_MISMATCH)) t_mismatch_s = t_s;
+        if (Smith_GetResidualRms(sp) > resid_rms_max) resid_rms_max = Smith_GetResidualRms(sp);
+
+        /* The trace runs on the virtual clock, tuning phase included. */
+        if (csv != NULL) {
+            fprintf(csv, "%.1f,%.2f,%.4f,%.4f,%.3f\n",
+                    (t0_ms + t_s * 1000.0) / 1000.0, t_ref, sim.t_meas, sim.plant.t_c, sim.pwm);
+        }
+
+        size_t k = 0;
+        while (k + 1 < sc.n - 1 && t_s >= sc.t_s[k + 1]) k++;
+        if (fabs(sim.t_meas - t_ref) > tol_c) steps[k].settle_s = t_s - sc.t_s[k];
+
+        /* Steady-state window at the end of the current step. */
+        if (t_s >= sc.t_s[k + 1] - ss_window_s) {
+            double e = sim.t_meas - t_ref;
+            steps[k].sum_meas  += e;
+            steps[k].sum_plant += sim.plant.t_c - t_ref;
+            if (fabs(e) > steps[k].max_abs) steps[k].max_abs = fabs(e);
+            steps[k].n++;
+        }
+    }
+
+    double wall_s = (double)(clock() - wall0) / CLOCKS_PER_SEC;
+    if (csv != NULL) fclose(csv);
+    Plant_Free(&sim.plant);
+
+    int failed = 0;
+
+    printf("plant: K=%.3f degC/%% tau=%.1f s L=%.2f s ambient=%.1f degC\n",
+           pp.k_c_per_pct, pp.tau_s, pp.dead_s, pp.ambient_c);
+    printf("controller: kp=%.3f ki=%.3f, feed-forward %s, Smith predictor %s\n",
+           kp, ki, ff ? "on" : "off", smith ? "on" : "off");
+    if (profile) {
+        printf("setpoint: profile of %u segments, %s the scenario\n", Profile_Get(0)->n,
+               profile_diff ? "DIFFERS from" : "matches");
+        if (profile_diff) failed = 1;
+    } else {
+        printf("setpoint: scenario longer than %u segments, set directly\n", PROFILE_MAX_SEG);
+    }
+    printf("step  t_start  T_ref   e_meas   e_plant  max|e|   settle  result\n");
+
+    for (size_t k = 0; k + 1 < sc.n; k++) {
+        const step_stats_t *st = &steps[k];
+        if (st->n == 0U) {
+            printf("%4zu  %7.1f  %5.1f   (step shorter than the window)\n",
+                   k, sc.t_s[k], sc.ref_c[k]);
+            failed = 1;
+            continue;
+        }
+        double e_meas  = st->sum_meas / st->n;
+        double e_plant = st->sum_plant / st->n;
+        int ok = fabs(e_meas) <= tol_c;
+        if (!ok) failed = 1;
+
+        printf("%4zu  %7.1f  %5.1f  %+7.3f  %+7.3f  %6.3f  %6.1f   %s\n",
+               k, sc.t_s[k], sc.ref_c[k], e_meas, e_plant, st->max_abs, st->settle_s,
+               ok ? "PASS" : "FAIL");
+    }
+
+    double sim_s = sim.ms / 1000.0;
+    printf("tolerance %.3f degC (%.1f %% of %.0f..%.0f degC)\n",
+           tol_c, tol_pct, (double)T_SAFE_MIN_C, (double)T_SAFE_MAX_C);
+    printf("simulated %.0f s in %.3f s (%.0fx real time)\n",
+           sim_s, wall_s, wall_s > 0.0 ? sim_s / wall_s : 0.0);
+    printf("ident: K=%.3f degC/%% (rsd %.3f) tau=%.1f s (rsd %.3f) L=%.1f s ambient=%.1f degC, %s\n",
+           id->k_c_per_pct, id->k_rsd, id->tau_s, id->tau_rsd, id->dead_s, id->ambient_c,
+           (id->flags & IDENT_VALID) ? "valid" : "not valid");
+    if (t_valid_s >= 0.0) printf("  valid from t=%.0f s\n", t_valid_s);
+    if (drift_t_s >= 0.0) {
+        printf("  plant gain %.3f -> %.3f degC/%% at t=%.0f s\n",
+               pp.k_c_per_pct, drift_k, drift_t_s);
+    }
+    if (t_flag_s >= 0.0) {
+        printf("  drift flagged at t=%.0f s (%s%s)\n", t_flag_s,
+               (id->flags & IDENT_DRIFT_GAIN) ? "gain " : "",
+               (id->flags & IDENT_DRIFT_TAU) ? "tau" : "");
+    }
+    printf("predictor: K=%.3f degC/%% tau=%.1f s L=%.2f s, residual mean %+.3f degC "
+           "rms %.3f degC (max %.3f)\n",
+           sp->m.k_c_per_pct, sp->m.tau_s, sp->m.dead_s, sp->resid_mean_c,
+           Smith_GetResidualRms(sp), resid_rms_max);
+    if (t_mismatch_s >= 0.0) printf("  mismatch flagged at t=%.0f s\n", t_mismatch_s);
+    if (perf) sil_print_perf();
+    printf("%s\n", failed ? "FAIL" : "PASS");
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,426 @@
+/**
+ * @file tune_sweep.c
+ * @brief Parallel Monte Carlo sweep of PI gains over plant uncertainty.
+ *
+ * For every (kp, ki) pair of a grid, a setpoint step is simulated on N
+ * randomized plants. The plant parameters are drawn around the default
+ * plant (plant.h):
+ *
+ *   heater gain K      uniform +-k_var   (heater power)
+ *   time constant tau  uniform +-tau_var (thermal mass)
+ *   sensor offset      uniform +-offset  [degC] (NTC tolerance)
+ *
+ * Plant i uses the same random parameters for every gain pair (common
+ * random numbers), so gain pairs are compared on the same set of units.
+ *
+ * The controller is the firmware PID object (pid.c) configured like
+ * Control_Init(), except that the anti-windup tracking time follows the
+ * integral time of each pair (tt = kp/ki, see PID_TT_S). The measurement goes through Temperature_FromRawQ4()
+ * and a filter_t with the firmware default (9-sample moving average).
+ * ADC oversampling is reproduced by summing ADC_OVERSAMPLE_RATIO plant
+ * samples per control step. The firmware singletons (control.c,
+ * adc_sampler.c) are not used, since they are not thread-safe.
+ *
+ * Each run starts at equilibrium at the initial setpoint (integrator
+ * preloaded with the steady-state duty) and steps to the final setpoint.
+ * Metrics use the true plant temperature:
+ *
+ *   overshoot   max excursion beyond the final setpoint, % of the step
+ *   settling    last time |T - T_ref| left the band (default 5 % of step)
+ *   IAE         integral of |T - T_ref| [degC*s]
+ *   saturation  time with the output at 0 % or 100 % [s]
+ *
+ * Jobs (gain pair x plant) are distributed over worker threads with an
+ * atomic counter. Results are printed as a table ranked by mean IAE
+ * (pairs that left any plant unsettled rank last) and can be written as
+ * CSV in grid order for heat maps.
+ */
+
+#include "config.h"
+#include "filter.h"
+#include "pid.h"
+#include "temperature.h"
+
+#include "plant.h"
+
+#include <getopt.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PLANT_DT_S         0.01
+#define STEPS_PER_CONTROL  ((unsigned)(CONTROL_TS_S / PLANT_DT_S + 0.5))
+#define SWEEP_FILT_N       9U    /* TEMP_FILT_N in temperature.c */
+
+typedef struct {
+    double overshoot_pct;
+    double settle_s;
+    double iae;
+    double sat_s;
+    int    settled;
+} metrics_t;
+
+typedef struct {
+    /* grid */
+    double kp_min, kp_max;
+    double ki_min, ki_max;
+    unsigned n_kp, n_ki;
+    /* Monte Carlo */
+    unsigned n_cases;
+    double k_var, tau_var, offset_c;
+    uint64_t seed;
+    /* scenario */
+    double t_from, t_to, duration_s, band_pct;
+    plant_params_t nominal;
+} sweep_cfg_t;
+
+static sweep_cfg_t cfg;
+static metrics_t  *results;         /* [gain][case] */
+static atomic_uint next_job;
+static atomic_uint jobs_done;
+
+static double grid_value(double lo, double hi, unsigned n, unsigned i)
+{
+    return (n <= 1U) ? lo : lo + (hi - lo) * (double)i / (double)(n - 1U);
+}
+
+/* splitmix64, used to derive per-case seeds */
+static uint64_t mix64(uint64_t x)
+{
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+static void case_params(unsigned c, plant_params_t *pp)
+{
+    plant_t rng;
+    plant_params_t seed_only = cfg.nominal;
+    seed_only.dead_s = 0.0;
+    seed_only.seed = mix64(cfg.seed ^ ((uint64_t)c << 32)) | 1U;
+    Plant_Init(&rng, &seed_only, 1.0);
+
+    *pp = cfg.nominal;
+    pp->k_c_per_pct *= 1.0 + cfg.k_var * (2.0 * Plant_Uniform(&rng) - 1.0);
+    pp->tau_s       *= 1.0 + cfg.tau_var * (2.0 * Plant_Uniform(&rng) - 1.0);
+    pp->ntc_offset_c = cfg.offset_c * (2.0 * Plant_Uniform(&rng) - 1.0);
+    pp->seed = mix64(seed_only.seed);
+
+    Plant_Free(&rng);
+}
+
+/* One decimated ADC reading in Q4, like ADCS_ProcessBlock(). */
+static uint16_t sample_q4(plant_t *pl, uint16_t *adc)
+{
+    Plant_SampleAdcBlock(pl, adc, ADC_OVERSAMPLE_RATIO);
+    uint32_t sum = 0;
+    for (unsigned j = 0; j < ADC_OVERSAMPLE_RATIO; j++) sum += adc[j];
+    return (uint16_t)((sum * 16U + ADC_OVERSAMPLE_RATIO / 2U) / ADC_OVERSAMPLE_RATIO);
+}
+
+static void run_case(double kp, double ki, unsigned c, metrics_t *m)
+{
+    plant_params_t pp;
+    case_params(c, &pp);
+
+    /* Equilibrium at the initial setpoint. */
+    double u0 = (cfg.t_from - pp.ambient_c) / pp.k_c_per_pct;
+    if (u0 < 0.0) u0 = 0.0;
+    if (u0 > 100.0) u0 = 100.0;
+    pp.t0_c = pp.ambient_c + pp.k_c_per_pct * u0;
+
+    plant_t pl;
+    if (Plant_Init(&pl, &pp, PLANT_DT_S) != 0) {
+        memset(m, 0, sizeof(*m));
+        return;
+    }
+    for (uint32_t i = 0; i < pl.delay_len; i++) pl.delay[i] = (float)u0;
+
+    const pid_params_t params = {
+        .kp = (float)kp, .ki = (float)ki, .kd = KD,
+        .ts_s = CONTROL_TS_S,
+        .b = PID_SP_WEIGHT_B, .c = 0.0f,
+        .tf_s = PID_TF_S, .tt_s = (ki > 0.0) ? (float)(kp / ki) : PID_TT_S,
+        .out_min = 0.0f, .out_max = 100.0f,
+        .rate_max = PID_RATE_MAX,
+    };
+    pid_ctrl_t pid;
+    PID_Init(&pid, &params);
+    pid.i_term = (float)u0;
+    pid.u = (float)u0;
+
+    filter_t filt;
+    Filter_InitMA(&filt, SWEEP_FILT_N);
+
+    const double ref = cfg.t_to;
+    const double step = fabs(cfg.t_to - cfg.t_from);
+    const double band = cfg.band_pct / 100.0 * (step > 0.0 ? step : 1.0);
+    const unsigned n_ctrl = (unsigned)(cfg.duration_s / CONTROL_TS_S + 0.5);
+    const double dir = (cfg.t_to >= cfg.t_from) ? 1.0 : -1.0;
+
+    uint16_t adc[ADC_OVERSAMPLE_RATIO];
+    double max_excess = 0.0, iae = 0.0, sat = 0.0, last_out = -1.0;
+    float u = (float)u0;
+
+    /* Prime the filter at the initial temperature. */
+    for (unsigned i = 0; i < SWEEP_FILT_N; i++) {
+        Filter_Update(&filt, Temperature_FromRawQ4(sample_q4(&pl, adc)));
+    }
+
+    for (unsigned k = 0; k < n_ctrl; k++) {
+        float t_meas = Filter_Update(&filt, Temperature_FromRawQ4(sample_q4(&pl, adc)));
+        u = PID_Update(&pid, (float)ref, t_meas);
+        if (u <= 0.0f || u >= 100.0f) sat += CONTROL_TS_S;
+
+        for (unsigned s = 0; s < STEPS_PER_CONTROL; s++) {
+            Plant_Step(&pl, u);
+            double e = pl.t_c - ref;
+            iae += fabs(e) * PLANT_DT_S;
+            double excess = dir * e;
+            if (excess > max_excess) max_excess = excess;
+            if (fabs(e) > band) last_out = (k * STEPS_PER_CONTROL + s + 1) * PLANT_DT_S;
+        }
+    }
+    Plant_Free(&pl);
+
+    m->overshoot_pct = (step > 0.0) ? 100.0 * max_excess / step : 0.0;
+    m->settle_s = (last_out < 0.0) ? 0.0 : last_out;
+    m->settled = last_out < cfg.duration_s - 1e-9;
+    m->iae = iae;
+    m->sat_s = sat;
+}
+
+static void *worker(void *arg)
+{
+    (void)arg;
+    const unsigned n_gain = cfg.n_kp * cfg.n_ki;
+    const unsigned n_jobs = n_gain * cfg.n_cases;
+
+    for (;;) {
+        unsigned job = atomic_fetch_add(&next_job, 1U);
+        if (job >= n_jobs) break;
+
+        unsigned g = job / cfg.n_cases;
+        unsigned c = job % cfg.n_cases;
+        double kp = grid_value(cfg.kp_min, cfg.kp_max, cfg.n_kp, g / cfg.n_ki);
+        double ki = grid_value(cfg.ki_min, cfg.ki_max, cfg.n_ki, g % cfg.n_ki);
+
+        run_case(kp, ki, c, &results[job]);
+        atomic_fetch_add(&jobs_done, 1U);
+    }
+    return NULL;
+}
+
+typedef struct {
+    double kp, ki;
+    double os_mean, os_max;
+    double st_mean, st_max;
+    double iae_mean, iae_max;
+    double sat_mean;
+    unsigned unsettled;
+} summary_t;
+
+static int cmp_summary(const void *a, const void *b)
+{
+    const summary_t *x = a, *y = b;
+    if ((x->unsettled > 0U) != (y->unsettled > 0U)) return (x->unsettled > 0U) ? 1 : -1;
+    if (x->iae_mean < y->iae_mean) return -1;
+    if (x->iae_mean > y->iae_mean) return 1;
+    return 0;
+}
+
+static int parse_range(const char *s, double *lo, double *hi, unsigned *n)
+{
+    /* min:max:n or a single value */
+    char *end;
+    *lo = strtod(s, &end);
+    if (end == s) return -1;
+    if (*end == '\0') {
+        *hi = *lo;
+        *n = 1;
+        return 0;
+    }
+    if (*end != ':') return -1;
+    s = end + 1;
+    *hi = strtod(s, &end);
+    if (end == s || *end != ':') return -1;
+    long v = strtol(end + 1, &end, 10);
+    if (*end != '\0' || v < 1) return -1;
+    *n = (unsigned)v;
+    return 0;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --kp MIN:MAX:N     proportional gain grid (default 1:20:20)\n"
+        "  --ki MIN:MAX:N     integral gain grid (default 0.05:2:14)\n"
+        "  --cases N          random plants per gain pair (default 64)\n"
+        "  --k-var F          heater gain spread, fraction (default 0.2)\n"
+        "  --tau-var F        time constant spread, fraction (default 0.3)\n"
+        "  --offset C         sensor offset spread [degC] (default 0.2)\n"
+        "  --from C --to C    setpoint step (default 40 -> 50)\n"
+        "  --duration S       simulated time per case (default 200)\n"
+        "  --band PCT         settling band, %% of the step (default 5)\n"
+        "  --threads N        worker threads (default: all CPUs)\n"
+        "  --seed N           Monte Carlo seed\n"
+        "  --top N            rows of the ranked table (default 15)\n"
+        "  --csv FILE         per-pair results in grid order (heat map)\n",
+        prog);
+}
+
+int main(int argc, char **argv)
+{
+    Plant_DefaultParams(&cfg.nominal);
+    cfg.kp_min = 1.0;  cfg.kp_max = 20.0; cfg.n_kp = 20;
+    cfg.ki_min = 0.05; cfg.ki_max = 2.0;  cfg.n_ki = 14;
+    cfg.n_cases = 64;
+    cfg.k_var = 0.2;
+    cfg.tau_var = 0.3;
+    cfg.offset_c = 0.2;
+    cfg.seed = 1;
+    cfg.t_from = 40.0;
+    cfg.t_to = 50.0;
+    cfg.duration_s = 200.0;
+    cfg.band_pct = 5.0;
+
+    long n_threads = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned top = 15;
+    const char *csv_path = NULL;
+
+    static const struct option opts[] = {
+        {"kp",       required_argument, NULL, 'p'},
+        {"ki",       required_argument, NULL, 'i'},
+        {"cases",    required_argument, NULL, 'n'},
+        {"k-var",    required_argument, NULL, 'k'},
+        {"tau-var",  required_argument, NULL, 't'},
+        {"offset",   required_argument, NULL, 'o'},
+        {"from",     required_argument, NULL, 'f'},
+        {"to",       required_argument, NULL, 'T'},
+        {"duration", required_argument, NULL, 'd'},
+        {"band",     required_argument, NULL, 'b'},
+        {"threads",  required_argument, NULL, 'j'},
+        {"seed",     required_argument, NULL, 's'},
+        {"top",      required_argument, NULL, 'N'},
+        {"csv",      required_argument, NULL, 'c'},
+        {"help",     no_argument,       NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "h", opts, NULL)) != -1) {
+        switch (c) {
+        case 'p':
+            if (parse_range(optarg, &cfg.kp_min, &cfg.kp_max, &cfg.n_kp) != 0) { usage(argv[0]); return 2; }
+            break;
+        case 'i':
+            if (parse_range(optarg, &cfg.ki_min, &cfg.ki_max, &cfg.n_ki) != 0) { usage(argv[0]); return 2; }
+            break;
+        case 'n': cfg.n_cases = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'k': cfg.k_var = atof(optarg); break;
+        case 't': cfg.tau_var = atof(optarg); break;
+        case 'o': cfg.offset_c = atof(optarg); break;
+        case 'f': cfg.t_from = atof(optarg); break;
+        case 'T': cfg.t_to = atof(optarg); break;
+        case 'd': cfg.duration_s = atof(optarg); break;
+        case 'b': cfg.band_pct = atof(optarg); break;
+        case 'j': n_threads = strtol(optarg, NULL, 0); break;
+        case 's': cfg.seed = strtoull(optarg, NULL, 0); break;
+        case 'N': top = (unsigned)strtoul(optarg, NULL, 0); break;
+        case 'c': csv_path = optarg; break;
+        default:  usage(argv[0]); return 2;
+        }
+    }
+    if (cfg.n_cases == 0U || n_threads < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    const unsigned n_gain = cfg.n_kp * cfg.n_ki;
+    const unsigned n_jobs = n_gain * cfg.n_cases;
+    results = calloc(n_jobs, sizeof(*results));
+    summary_t *sum = calloc(n_gain, sizeof(*sum));
+    pthread_t *th = calloc((size_t)n_threads, sizeof(*th));
+    if (results == NULL || sum == NULL || th == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 2;
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    atomic_store(&next_job, 0U);
+    atomic_store(&jobs_done, 0U);
+    for (long i = 0; i < n_threads; i++) pthread_create(&th[i], NULL, worker, NULL);
+    for (long i = 0; i < n_threads; i++) pthread_join(th[i], NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double wall = (double)(t1.tv_sec - t0.tv_sec) + 1e-9 * (double)(t1.tv_nsec - t0.tv_nsec);
+
+    for (unsigned g = 0; g < n_gain; g++) {
+        summary_t *s = &sum[g];
+        s->kp = grid_value(cfg.kp_min, cfg.kp_max, cfg.n_kp, g / cfg.n_ki);
+        s->ki = grid_value(cfg.ki_min, cfg.ki_max, cfg.n_ki, g % cfg.n_ki);
+
+        for (unsigned k = 0; k < cfg.n_cases; k++) {
+            const metrics_t *m = &results[g * cfg.n_cases + k];
+            s->os_mean  += m->overshoot_pct;
+            s->st_mean  += m->settle_s;
+            s->iae_mean += m->iae;
+            s->sat_mean += m->sat_s;
+            if (m->overshoot_pct > s->os_max) s->os_max = m->overshoot_pct;
+            if (m->settle_s > s->st_max) s->st_max = m->settle_s;
+            if (m->iae > s->iae_max) s->iae_max = m->iae;
+            if (!m->settled) s->unsettled++;
+        }
+        s->os_mean  /= cfg.n_cases;
+        s->st_mean  /= cfg.n_cases;
+        s->iae_mean /= cfg.n_cases;
+        s->sat_mean /= cfg.n_cases;
+    }
+
+    if (csv_path != NULL) {
+        FILE *f = fopen(csv_path, "w");
+        if (f == NULL) {
+            perror(csv_path);
+            return 2;
+        }
+        fprintf(f, "kp,ki,overshoot_mean_pct,overshoot_max_pct,settle_mean_s,settle_max_s,"
+                   "iae_mean,iae_max,sat_mean_s,unsettled\n");
+        for (unsigned g = 0; g < n_gain; g++) {
+            const summary_t *s = &sum[g];
+            fprintf(f, "%.4f,%.4f,%.3f,%.3f,%.2f,%.2f,%.3f,%.3f,%.2f,%u\n",
+                    s->kp, s->ki, s->os_mean, s->os_max, s->st_mean, s->st_max,
+                    s->iae_mean, s->iae_max, s->sat_mean, s->unsettled);
+        }
+        fclose(f);
+    }
+
+    qsort(sum, n_gain, sizeof(*sum), cmp_summary);
+
+    printf("step %.1f -> %.1f degC, %u plants per pair (K +-%.0f %%, tau +-%.0f %%, offset +-%.2f degC)\n",
+           cfg.t_from, cfg.t_to, cfg.n_cases, 100.0 * cfg.k_var, 100.0 * cfg.tau_var, cfg.offset_c);
+    printf("rank     kp     ki   OS mean/max [%%]   settle mean/max [s]   IAE mean/max     sat [s]  unsettled\n");
+    for (unsigned r = 0; r < top && r < n_gain; r++) {
+        const summary_t *s = &sum[r];
+        printf("%4u  %6.3f %6.3f   %6.1f / %6.1f    %7.1f / %7.1f    %7.2f / %7.2f  %6.1f  %u/%u\n",
+               r + 1U, s->kp, s->ki, s->os_mean, s->os_max, s->st_mean, s->st_max,
+               s->iae_mean, s->iae_max, s->sat_mean, s->unsettled, cfg.n_cases);
+    }
+
+    double sim_s = (double)n_jobs * cfg.duration_s;
+    printf("%u gain pairs x %u plants = %u runs on %ld threads in %.2f s (%.0f simulated s per wall s)\n",
+           n_gain, cfg.n_cases, n_jobs, n_threads, wall, wall > 0.0 ? sim_s / wall : 0.0);
+
+    free(th);
+    free(sum);
+    free(results);
+    return 0;
+}
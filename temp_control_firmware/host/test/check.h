@@ -0,0 +1,33 @@
+/**
+ * @file check.h
+ * @brief Minimal assertions for the host tests.
+ *
+ * CHECK() reports a failed condition with its location and keeps going,
+ * so one run lists every failure; a test returns CHECK_RESULT() from
+ * main(), non-zero if anything failed, which is what ctest looks at.
+ */
+
+#ifndef HOST_TEST_CHECK_H_
+#define HOST_TEST_CHECK_H_
+
+#include <stdio.h>
+
+static int check_failures;
+
+#define CHECK(cond, ...)                                                  \
+    do {                                                                  \
+        if (!(cond)) {                                                    \
+            check_failures++;                                             \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed: ", __FILE__,        \
+                    __LINE__, #cond);                                     \
+            fprintf(stderr, __VA_ARGS__);                                 \
+            fputc('\n', stderr);                                          \
+        }                                                                 \
+    } while (0)
+
+#define CHECK_RESULT()                                                    \
+    (check_failures == 0                                                  \
+         ? (printf("PASS\n"), 0)                                          \
+         : (printf("FAIL: %d check(s)\n", check_failures), 1))
+
+#endif /* HOST_TEST_CHECK_H_ */
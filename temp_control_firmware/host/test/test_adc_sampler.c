@@ -0,0 +1,191 @@
+/**
+ * @file test_adc_sampler.c
+ * @brief ADC decimator fed from synthetic sample streams.
+ *
+ * Checks the Q4 averages per channel (rounding included), the
+ * oversampling ratio, how the block sequence number of
+ * ADCS_GetLatestAll() advances, and the DMA path: samples pushed through
+ * the HAL stand-in reach ADCS_ProcessBlock() from the half and full
+ * transfer callbacks.
+ */
+
+#include "check.h"
+#include "adc_sampler.h"
+#include "main.h"
+
+#include <string.h>
+
+#define HALF_FRAMES  32U   /* adc_sampler.c: ADCS_DMA_FRAMES / 2 */
+
+/* Sample of channel ch in frame f of a test pattern. */
+typedef uint16_t (*pattern_t)(uint32_t f, uint32_t ch);
+
+static uint16_t constant(uint32_t f, uint32_t ch)
+{
+    static const uint16_t v[4] = {0, 1000, 2047, 4095};
+    (void)f;
+    return v[ch];
+}
+
+/* Channel 0 alternates 1000 / 1001: mean 1000.5. Channel 1 is 1 in one
+   frame of 32 and 0 otherwise: 1/32 = 0.5 LSB of Q4. Channel 2 ramps
+   over the block, channel 3 is full scale noise between 4094 and 4095. */
+static uint16_t mixed(uint32_t f, uint32_t ch)
+{
+    switch (ch) {
+    case 0:  return (uint16_t)(1000U + (f & 1U));
+    case 1:  return (uint16_t)((f % 32U) == 0U ? 1U : 0U);
+    case 2:  return (uint16_t)(f % 64U);
+    default: return (uint16_t)(4094U + ((f >> 1) & 1U));
+    }
+}
+
+static void fill(uint16_t *buf, uint32_t first_frame, uint32_t frames, pattern_t p)
+{
+    for (uint32_t f = 0; f < frames; f++) {
+        for (uint32_t ch = 0; ch < ADCS_NUM_CH; ch++) {
+            buf[f * ADCS_NUM_CH + ch] = p(first_frame + f, ch);
+        }
+    }
+}
+
+/* Expected Q4 mean of frames first .. first + n - 1, rounded half up. */
+static uint16_t expect_q4(pattern_t p, uint32_t ch, uint32_t first, uint32_t n)
+{
+    uint32_t sum = 0;
+    for (uint32_t f = first; f < first + n; f++) sum += p(f, ch);
+    return (uint16_t)((sum * 16U + n / 2U) / n);
+}
+
+static void test_averages(void)
+{
+    uint16_t buf[HALF_FRAMES * ADCS_NUM_CH];
+    uint16_t q4[ADCS_NUM_CH];
+
+    for (uint32_t ratio = ADCS_OVERSAMPLE_MIN; ratio <= ADCS_OVERSAMPLE_MAX; ratio *= 2U) {
+        pattern_t pats[2] = {constant, mixed};
+
+        for (uint32_t k = 0; k < 2U; k++) {
+            ADCS_Init(ratio);
+            CHECK(ADCS_GetLatestAll(q4) == 0U, "ratio %u: value before the first block", ratio);
+
+            /* One ratio worth of frames, in half DMA blocks or less. */
+            uint32_t done = 0;
+            while (done < ratio) {
+                uint32_t n = (ratio - done < HALF_FRAMES) ? ratio - done : HALF_FRAMES;
+                fill(buf, done, n, pats[k]);
+                ADCS_ProcessBlock(buf, n * ADCS_NUM_CH);
+                done += n;
+            }
+
+            CHECK(ADCS_GetLatestAll(q4) == 1U, "ratio %u: one block", ratio);
+            for (uint32_t ch = 0; ch < ADCS_NUM_CH; ch++) {
+                uint16_t want = expect_q4(pats[k], ch, 0, ratio);
+                CHECK(q4[ch] == want, "ratio %u pattern %u ch %u: q4 %u, want %u",
+                      ratio, k, ch, q4[ch], want);
+
+                adcs_sample_t s;
+                CHECK(ADCS_GetLatest((uint8_t)ch, &s), "ratio %u ch %u: no value", ratio, ch);
+                uint32_t raw = (want + 8U) >> 4;
+                if (raw > 4095U) raw = 4095U;
+                CHECK(s.raw_q4 == want && s.raw == raw && s.seq == 1U,
+                      "ratio %u ch %u: raw %u q4 %u seq %u", ratio, ch, s.raw, s.raw_q4, s.seq);
+            }
+        }
+    }
+}
+
+static void test_ratio(void)
+{
+    static const uint32_t asked[] = {1, 16, 17, 31, 32, 100, 128, 255, 256, 1000};
+    static const uint32_t got[]   = {16, 16, 16, 16, 32, 64, 128, 128, 256, 256};
+    uint16_t buf[HALF_FRAMES * ADCS_NUM_CH];
+    uint16_t q4[ADCS_NUM_CH];
+
+    for (uint32_t i = 0; i < sizeof(asked) / sizeof(asked[0]); i++) {
+        ADCS_Init(asked[i]);
+        CHECK(ADCS_GetOversample() == got[i], "ADCS_Init(%u): ratio %u, want %u",
+              asked[i], ADCS_GetOversample(), got[i]);
+
+        /* 40 half blocks: 1280 frames, one output per ratio frames. */
+        fill(buf, 0, HALF_FRAMES, constant);
+        for (uint32_t b = 0; b < 40U; b++) {
+            ADCS_ProcessBlock(buf, HALF_FRAMES * ADCS_NUM_CH);
+        }
+        uint32_t want = 40U * HALF_FRAMES / got[i];
+        CHECK(ADCS_GetLatestAll(q4) == want, "ratio %u: %u blocks, want %u",
+              got[i], ADCS_GetLatestAll(q4), want);
+    }
+}
+
+static void test_sequence(void)
+{
+    uint16_t buf[HALF_FRAMES * ADCS_NUM_CH];
+    uint16_t q4[ADCS_NUM_CH];
+
+    /* Ratio 64: a new block every second half; the values of a block are
+       those of its own frames and appear together. */
+    ADCS_Init(64);
+    uint32_t frame = 0;
+    uint32_t last  = 0;
+
+    for (uint32_t half = 0; half < 16U; half++) {
+        fill(buf, frame, HALF_FRAMES, mixed);
+        ADCS_ProcessBlock(buf, HALF_FRAMES * ADCS_NUM_CH);
+        frame += HALF_FRAMES;
+
+        uint32_t seq = ADCS_GetLatestAll(q4);
+        if ((half & 1U) == 0U) {
+            CHECK(seq == last, "half %u: sequence moved to %u mid block", half, seq);
+            continue;
+        }
+        CHECK(seq == last + 1U, "half %u: sequence %u after %u", half, seq, last);
+        last = seq;
+        for (uint32_t ch = 0; ch < ADCS_NUM_CH; ch++) {
+            uint16_t want = expect_q4(mixed, ch, frame - 64U, 64U);
+            CHECK(q4[ch] == want, "block %u ch %u: q4 %u, want %u", seq, ch, q4[ch], want);
+        }
+    }
+
+    /* Re-initialising clears the block count and the values. */
+    ADCS_Init(64);
+    adcs_sample_t s;
+    CHECK(ADCS_GetLatestAll(q4) == 0U && !ADCS_GetLatest(0, &s), "values kept by ADCS_Init()");
+}
+
+static void test_dma(void)
+{
+    uint16_t buf[HALF_FRAMES * ADCS_NUM_CH];
+    uint16_t q4[ADCS_NUM_CH];
+
+    HALFAKE_Reset();
+    ADCS_Init(16);
+    CHECK(ADCS_Start(), "ADCS_Start() failed");
+
+    /* A half buffer gives two blocks at ratio 16 through the half-transfer
+       callback, the other half two more through transfer-complete. */
+    uint32_t frame = 0;
+    for (uint32_t half = 0; half < 6U; half++) {
+        fill(buf, frame, HALF_FRAMES, mixed);
+        HALFAKE_ADC_Push(buf, HALF_FRAMES * ADCS_NUM_CH - 1U);
+        CHECK(ADCS_GetLatestAll(q4) == 2U * half, "half %u: processed before complete", half);
+        HALFAKE_ADC_Push(&buf[HALF_FRAMES * ADCS_NUM_CH - 1U], 1);
+        frame += HALF_FRAMES;
+
+        CHECK(ADCS_GetLatestAll(q4) == 2U * (half + 1U), "half %u: %u blocks",
+              half, ADCS_GetLatestAll(q4));
+        for (uint32_t ch = 0; ch < ADCS_NUM_CH; ch++) {
+            uint16_t want = expect_q4(mixed, ch, frame - 16U, 16U);
+            CHECK(q4[ch] == want, "half %u ch %u: q4 %u, want %u", half, ch, q4[ch], want);
+        }
+    }
+}
+
+int main(void)
+{
+    test_averages();
+    test_ratio();
+    test_sequence();
+    test_dma();
+    return CHECK_RESULT();
+}
@@ -0,0 +1,134 @@
+/**
+ * @file test_control.c
+ * @brief Plant identification and Smith predictor across an alarm.
+ *
+ * A zone loop runs on a first-order-plus-dead-time plant equal to the
+ * predictor model of config.h. While the zone is held off in alarm,
+ * Control_Hold() must advance both models with the heater at 0 %: the
+ * predictor residual stays at the sensor level through the alarm and
+ * after it, and the identified model stays valid. Without a usable
+ * measurement both must restart.
+ */
+
+#include "check.h"
+#include "ambient.h"
+#include "config.h"
+#include "control.h"
+#include "ident.h"
+#include "main.h"
+#include "smith.h"
+#include "zone.h"
+
+#include <math.h>
+
+#define PLANT_K     SMITH_K_C_PER_PCT
+#define PLANT_TAU   SMITH_TAU_S
+#define PLANT_DEAD  10U   /* SMITH_DEAD_S in control steps */
+#define AMB_C       25.0f
+
+static float    plant_x;
+static float    plant_u[PLANT_DEAD + 1U];
+static uint32_t plant_head;
+
+static float plant_t(void)
+{
+    return AMB_C + plant_x;
+}
+
+/* One control period with duty u applied now. */
+static void plant_step(float u)
+{
+    plant_u[plant_head] = u;
+    plant_head = (plant_head + 1U) % (PLANT_DEAD + 1U);
+    const float u_d = plant_u[plant_head];
+    plant_x += (1.0f - expf(-CONTROL_TS_S / PLANT_TAU)) * (PLANT_K * u_d - plant_x);
+}
+
+static void start(void)
+{
+    HALFAKE_Reset();
+    Zone_Init();
+    Ambient_SetSource(AMBIENT_SRC_FIXED);
+    Ambient_SetFixedC(AMB_C);
+    Control_Init(0);
+    Control_SetSmith(0, false);
+
+    plant_x = 0.0f;
+    plant_head = 0;
+    for (uint32_t i = 0; i <= PLANT_DEAD; i++) plant_u[i] = 0.0f;
+}
+
+/* Closed loop for @p s seconds, the setpoint alternating every 60 s. */
+static void run(float s)
+{
+    static uint32_t step;
+    for (uint32_t i = 0; i < (uint32_t)(s / CONTROL_TS_S); i++, step++) {
+        const float ref = ((step / 600U) % 2U) ? 50.0f : 40.0f;
+        plant_step(Control_Update(0, ref, plant_t()));
+    }
+}
+
+/* Alarm for @p s seconds: heater off. */
+static void hold(float s, bool meas_ok)
+{
+    Control_Reset(0);
+    for (uint32_t i = 0; i < (uint32_t)(s / CONTROL_TS_S); i++) {
+        Control_Hold(0, plant_t(), meas_ok);
+        plant_step(0.0f);
+    }
+}
+
+static void test_hold(void)
+{
+    const zone_table_t *zt = Zone_Table();
+    const ident_t *id = &zt->ident[0];
+    const smith_t *sp = &zt->smith[0];
+
+    start();
+    run(300.0f);
+    CHECK(Ident_GetModel(id)->flags & IDENT_VALID, "no valid model before the alarm");
+    const uint32_t blocks = id->blocks;
+
+    /* The plant cools by several degC; an unfed predictor would not. */
+    hold(30.0f, true);
+    CHECK(plant_x < 10.0f, "plant at %.1f degC, did not cool", plant_t());
+    CHECK(fabsf(sp->resid_c) < 0.05f, "residual %.3f degC at the end of the alarm", sp->resid_c);
+    CHECK(id->blocks == blocks + 30U, "%u blocks during the alarm, want 30",
+          id->blocks - blocks);
+    CHECK(id->u_hist[0] == 0.0f, "duty %.2f in the last block", id->u_hist[0]);
+
+    run(60.0f);
+    const ident_model_t *m = Ident_GetModel(id);
+    CHECK(fabsf(sp->resid_c) < 0.05f, "residual %.3f degC after the alarm", sp->resid_c);
+    CHECK(m->flags & IDENT_VALID, "model not valid after the alarm");
+    CHECK(fabsf(m->k_c_per_pct - PLANT_K) < 0.1f * PLANT_K, "K %.3f, plant %.3f",
+          m->k_c_per_pct, PLANT_K);
+    CHECK(fabsf(m->tau_s - PLANT_TAU) < 0.1f * PLANT_TAU, "tau %.2f, plant %.2f",
+          m->tau_s, PLANT_TAU);
+}
+
+static void test_no_measurement(void)
+{
+    const zone_table_t *zt = Zone_Table();
+    const ident_t *id = &zt->ident[0];
+    const smith_t *sp = &zt->smith[0];
+
+    start();
+    run(300.0f);
+    hold(0.5f, false);
+    CHECK(id->blocks == 0U && Ident_GetModel(id)->flags == 0U,
+          "identification not restarted: %u blocks, flags 0x%02X",
+          id->blocks, Ident_GetModel(id)->flags);
+    CHECK(sp->x == 0.0f && sp->line[sp->head] == 0.0f, "predictor not refilled at 0 %%");
+
+    /* The usable samples after it continue from the restart. */
+    hold(5.0f, true);
+    CHECK(id->blocks == 5U, "%u blocks after the restart, want 5", id->blocks);
+}
+
+int main(void)
+{
+    test_hold();
+    test_no_measurement();
+    return CHECK_RESULT();
+}
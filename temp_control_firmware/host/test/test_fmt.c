@@ -0,0 +1,140 @@
+/**
+ * @file test_fmt.c
+ * @brief fmt.c against the C library printf.
+ *
+ * FMT_Float() must produce the same bytes as snprintf("%.*f") for every
+ * float and precision 0 .. FMT_MAX_DECIMALS, FMT_Uint() / FMT_Int() the
+ * same as "%lu" / "%ld". Compared: random bit patterns, a dense sweep of
+ * the telemetry range 16 .. 128 C at the precisions used on the wire,
+ * exact ties (rounded half to even), and the special values.
+ */
+
+#include "check.h"
+#include "fmt.h"
+#include "json_build.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static uint32_t mismatches;
+
+/* xorshift64: the same sequence on every run. */
+static uint32_t rnd(void)
+{
+    static uint64_t x = 88172645463325252ULL;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return (uint32_t)x;
+}
+
+static void check_float(float f, uint8_t decimals)
+{
+    char want[64], got[FMT_FLOAT_MAX + 1U];
+    int n = snprintf(want, sizeof(want), "%.*f", decimals, (double)f);
+    uint8_t m = FMT_Float(got, f, decimals);
+
+    /* The sign of a NaN is not defined by printf. */
+    if (isnan(f)) return;
+    if (n == m && memcmp(want, got, m) == 0) return;
+
+    /* Report the first few only. */
+    if (++mismatches <= 10U) {
+        got[m] = '\0';
+        CHECK(false, "%a %%.%uf: snprintf \"%s\", FMT_Float \"%s\"", (double)f, decimals, want, got);
+    }
+}
+
+static void test_float(void)
+{
+    static const float special[] = {
+        0.0f, -0.0f, INFINITY, -INFINITY, 3.4028235e38f, -3.4028235e38f,
+        1e-45f, 0.005f, 0.015f, 0.125f, 0.375f, 2.5f, 9.995f, 99.995f,
+        1e10f, 9.2233720e18f, 1.8446744e19f,
+    };
+
+    for (uint32_t i = 0; i < sizeof(special) / sizeof(special[0]); i++) {
+        for (uint8_t d = 0; d <= FMT_MAX_DECIMALS; d++) check_float(special[i], d);
+    }
+
+    for (uint32_t i = 0; i < 500000U; i++) {
+        uint32_t bits = rnd();
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        check_float(f, (uint8_t)(rnd() % (FMT_MAX_DECIMALS + 1U)));
+    }
+
+    /* Every 61st float of 16 .. 128, at the precisions sent. */
+    uint32_t lo, hi;
+    const float f_lo = 16.0f, f_hi = 128.0f;
+    memcpy(&lo, &f_lo, sizeof(lo));
+    memcpy(&hi, &f_hi, sizeof(hi));
+    for (uint32_t bits = lo; bits < hi; bits += 61U) {
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        check_float(f, 1);
+        check_float(f, 2);
+        check_float(-f, 2);
+    }
+
+    /* Multiples of 1/8 end in 5 at the next decimal: ties. */
+    for (uint32_t i = 0; i < 100000U; i++) {
+        for (uint8_t d = 0; d < 4U; d++) check_float((float)i / 8.0f, d);
+    }
+
+    CHECK(mismatches == 0U, "%u float mismatches", mismatches);
+}
+
+static void test_int(void)
+{
+    static const uint32_t special[] = {0U, 1U, 9U, 10U, 99U, 100U, 0x7FFFFFFFU, 0x80000000U,
+                                       0xFFFFFFFFU};
+    uint32_t bad = 0;
+
+    for (uint32_t i = 0; i < 1000000U + sizeof(special) / sizeof(special[0]); i++) {
+        uint32_t v = (i < sizeof(special) / sizeof(special[0])) ? special[i] : rnd();
+        char want[16], got[16];
+
+        int n = snprintf(want, sizeof(want), "%lu", (unsigned long)v);
+        uint8_t m = FMT_Uint(got, v);
+        if (n != m || memcmp(want, got, m) != 0) bad++;
+
+        n = snprintf(want, sizeof(want), "%ld", (long)(int32_t)v);
+        m = FMT_Int(got, (int32_t)v);
+        if (n != m || memcmp(want, got, m) != 0) bad++;
+    }
+    CHECK(bad == 0U, "%u integer mismatches", bad);
+}
+
+/* A JSON telemetry frame built with json_build.h against one printed. */
+static void test_frame(void)
+{
+    uint32_t bad = 0;
+
+    for (uint32_t i = 0; i < 10000U; i++) {
+        float t_meas = 20.0f + (float)(rnd() % 6000U) / 100.0f + 0.0037f;
+        float t_ref  = 35.0f + (float)(rnd() % 50U) / 2.0f;
+        float pwm    = (float)(rnd() % 1000U) / 10.0f;
+        char want[128], got[128];
+        jsonb_t jb;
+
+        int n = snprintf(want, sizeof(want), "{\"T_meas\":%.2f,\"T_ref\":%.2f,\"PWM\":%.1f}\r\n",
+                         (double)t_meas, (double)t_ref, (double)pwm);
+        JSONB_Begin(&jb, got, sizeof(got));
+        JSONB_AddFloat(&jb, "T_meas", t_meas, 2);
+        JSONB_AddFloat(&jb, "T_ref", t_ref, 2);
+        JSONB_AddFloat(&jb, "PWM", pwm, 1);
+        uint16_t m = JSONB_End(&jb);
+        if (n != (int)m || memcmp(want, got, m) != 0) bad++;
+    }
+    CHECK(bad == 0U, "%u frames differ", bad);
+}
+
+int main(void)
+{
+    test_float();
+    test_int();
+    test_frame();
+    return CHECK_RESULT();
+}
@@ -0,0 +1,138 @@
+/**
+ * @file test_overtemp.c
+ * @brief Overtemperature cutoff, alone and across a flash erase.
+ *
+ * A sample outside the watchdog window must clear MOE and zero the duty
+ * of every zone. During a sector erase of the parameter store no
+ * interrupt runs (the HAL stand-in holds them back, as the device does):
+ * the outputs must be off for the whole erase, a violation during it must
+ * trip as soon as the erase ends, and the outputs must come back only if
+ * nothing tripped.
+ */
+
+#include "check.h"
+#include "adc_sampler.h"
+#include "heater.h"
+#include "main.h"
+#include "overtemp.h"
+#include "store.h"
+#include "zone.h"
+
+extern TIM_HandleTypeDef htim1;
+
+#define RAW_OK   2048U   /* 25 degC */
+#define RAW_HOT  300U    /* above T_ALARM_MAX_C (code 462) */
+
+static uint32_t erases;
+static uint32_t erases_with_output_on;
+static bool     push_hot;
+static bool     tripped_in_erase;
+
+static bool moe(void)
+{
+    return (htim1.Instance->BDTR & TIM_BDTR_MOE) != 0U;
+}
+
+static void push(uint16_t raw)
+{
+    uint16_t s[ADCS_NUM_CH];
+    for (uint32_t ch = 0; ch < ADCS_NUM_CH; ch++) s[ch] = raw;
+    HALFAKE_ADC_Push(s, ADCS_NUM_CH);
+}
+
+static void on_erase(uint32_t sector)
+{
+    (void)sector;
+    erases++;
+    if (moe()) erases_with_output_on++;
+
+    bool before = OverTemp_IsTripped();
+    push(push_hot ? RAW_HOT : RAW_OK);
+    if (!before && OverTemp_IsTripped()) tripped_in_erase = true;
+}
+
+static void start(void)
+{
+    HALFAKE_Reset();
+    HALFAKE_FLASH_Wipe();
+    Zone_Init();
+    ADCS_Init(ADCS_OVERSAMPLE_MIN);
+    CHECK(ADCS_Start(), "ADC start failed");
+    Heater_Init();
+    OverTemp_Init();
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) Heater_SetDutyPercent(z, 50.0f);
+
+    erases = 0;
+    erases_with_output_on = 0;
+    push_hot = false;
+    tripped_in_erase = false;
+    HALFAKE_FLASH_SetEraseHook(on_erase);
+}
+
+static void test_trip(void)
+{
+    start();
+    push(RAW_OK);
+    CHECK(!OverTemp_IsTripped() && moe(), "tripped in the window");
+
+    push(RAW_HOT);
+    CHECK(OverTemp_IsTripped(), "no trip at raw %u", RAW_HOT);
+    CHECK(!moe(), "MOE still set after the trip");
+    CHECK(htim1.Instance->CCR1 == 0U, "duty %u after the trip", htim1.Instance->CCR1);
+    CHECK(OverTemp_GetTripRaw() == RAW_HOT, "trip raw %u", OverTemp_GetTripRaw());
+
+    uint16_t raw[ZONE_COUNT];
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) raw[z] = RAW_HOT;
+    CHECK(!OverTemp_Rearm(raw, ZONE_COUNT), "rearmed while hot");
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) raw[z] = RAW_OK;
+    CHECK(OverTemp_Rearm(raw, ZONE_COUNT) && moe(), "no rearm in the window");
+}
+
+/* Fresh flash: the mount formats the store into flash sector 1, one erase. */
+static void test_erase_no_fault(void)
+{
+    start();
+    uint32_t ccr = htim1.Instance->CCR1;
+
+    CHECK(Store_Init(), "mount failed");
+    CHECK(erases == 1U, "%u erases, want 1", erases);
+    CHECK(erases_with_output_on == 0U, "outputs on during %u erases", erases_with_output_on);
+    CHECK(moe(), "outputs not released after the erase");
+    CHECK(htim1.Instance->CCR1 == ccr, "duty %u, was %u", htim1.Instance->CCR1, ccr);
+    CHECK(!OverTemp_IsTripped(), "tripped without a fault");
+}
+
+static void test_erase_fault(void)
+{
+    start();
+    push_hot = true;
+
+    CHECK(Store_Format(), "format failed");
+    CHECK(erases > 0U, "no erase");
+    CHECK(erases_with_output_on == 0U, "outputs on during %u erases", erases_with_output_on);
+    CHECK(!tripped_in_erase, "watchdog interrupt ran during the erase");
+    CHECK(OverTemp_IsTripped(), "fault during the erase not tripped after it");
+    CHECK(OverTemp_GetTripRaw() == RAW_HOT, "trip raw %u", OverTemp_GetTripRaw());
+    CHECK(!moe(), "outputs released after a trip");
+    CHECK(htim1.Instance->CCR1 == 0U, "duty %u after the trip", htim1.Instance->CCR1);
+}
+
+/* Tripped before the erase: it must not turn the outputs back on. */
+static void test_erase_after_trip(void)
+{
+    start();
+    push(RAW_HOT);
+    CHECK(OverTemp_IsTripped(), "no trip");
+
+    CHECK(Store_Format(), "format failed");
+    CHECK(!moe(), "outputs released by the erase after a trip");
+}
+
+int main(void)
+{
+    test_trip();
+    test_erase_no_fault();
+    test_erase_fault();
+    test_erase_after_trip();
+    return CHECK_RESULT();
+}
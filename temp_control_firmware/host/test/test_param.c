@@ -0,0 +1,290 @@
+/**
+ * @file test_param.c
+ * @brief Parameter registry: name lookup, staging, apply order, checks.
+ *
+ * Name lookup goes through an FNV-1a hash table with linear probing
+ * (param.c). Every name must be found, including names whose hash lands
+ * on an occupied slot, and names that are not registered must not be,
+ * even when they share a slot with one that is. Values are staged by
+ * Param_Set() and only take effect in Param_Apply(), limits before the
+ * setpoint. Out of range, read only and contradicting values are refused,
+ * against the staged values as well. The T command of the UART goes
+ * through the same staging and checks. The filter type and length of a
+ * zone select its measurement filter, and filter_delay reports the group
+ * delay of the one in use.
+ */
+
+#include "check.h"
+#include "config.h"
+#include "control.h"
+#include "filter.h"
+#include "main.h"
+#include "param.h"
+#include "pid.h"
+#include "temperature.h"
+#include "uart_if.h"
+#include "zone.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define HASH_SLOTS  64U   /* param.c */
+
+/* FNV-1a, as param.c. */
+static uint32_t fnv1a(const char *s, size_t len)
+{
+    uint32_t h = 2166136261UL;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)s[i];
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+static void start(void)
+{
+    HALFAKE_Reset();
+    Zone_Init();
+    Param_Init();
+    Temperature_Init();
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) Control_Init(z);
+}
+
+static float get(param_id_t id, uint8_t z)
+{
+    float v = NAN;
+    CHECK(Param_Get(id, z, &v), "get %s:%u failed", Param_Desc(id)->name, z);
+    return v;
+}
+
+static void test_find(void)
+{
+    uint8_t used[HASH_SLOTS] = {0};
+    uint32_t collisions = 0;
+
+    start();
+    for (uint32_t id = 0; id < PARAM_COUNT; id++) {
+        const char *name = Param_Desc((param_id_t)id)->name;
+        size_t      len  = strlen(name);
+        CHECK(Param_Find(name, len) == (int)id, "%s: id %d, want %u",
+              name, Param_Find(name, len), id);
+
+        /* Not terminated: the length counts, not the '\0'. */
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%s 1.5", name);
+        CHECK(Param_Find(buf, len) == (int)id, "%s in a line: id %d", name, Param_Find(buf, len));
+
+        if (used[fnv1a(name, len) & (HASH_SLOTS - 1U)]++ > 0U) collisions++;
+    }
+    /* Otherwise the probing below is not exercised by the real names. */
+    CHECK(collisions > 0U, "no two names share a hash slot");
+
+    CHECK(Param_Find("sp", 2) == PARAM_SP, "sp");
+    CHECK(Param_Find("sp_m", 4) == -1, "prefix of sp_min found");
+    CHECK(Param_Find("sp_minx", 7) == -1, "sp_min with a suffix found");
+    CHECK(Param_Find("", 0) == -1, "empty name found");
+
+    /* Unknown names on every occupied slot: the probe must stop at the
+       first empty slot without a false match. */
+    uint32_t tried = 0;
+    for (uint32_t i = 0; i < 20000U; i++) {
+        char name[16];
+        int  len = snprintf(name, sizeof(name), "x%u", i);
+        if (used[fnv1a(name, (size_t)len) & (HASH_SLOTS - 1U)] == 0U) continue;
+        CHECK(Param_Find(name, (size_t)len) == -1, "%s found", name);
+        tried++;
+    }
+    CHECK(tried > 1000U, "only %u unknown names on occupied slots", tried);
+}
+
+static void test_staging(void)
+{
+    start();
+    float kp0 = get(PARAM_KP, 0);
+
+    CHECK(Param_Set(PARAM_KP, 0, 3.0f), "kp 3 refused");
+    CHECK(get(PARAM_KP, 0) == kp0, "kp %.3f before the apply", get(PARAM_KP, 0));
+
+    /* A second set of the same value replaces the staged one. */
+    CHECK(Param_Set(PARAM_KP, 0, 4.0f), "kp 4 refused");
+    CHECK(Param_Set(PARAM_KI, 0, 0.2f), "ki 0.2 refused");
+    Param_Apply();
+    CHECK(get(PARAM_KP, 0) == 4.0f, "kp %.3f, want 4", get(PARAM_KP, 0));
+    CHECK(Control_GetPID(0)->p.kp == 4.0f && Control_GetPID(0)->p.ki == 0.2f,
+          "PID gains %.3f %.3f", Control_GetPID(0)->p.kp, Control_GetPID(0)->p.ki);
+    CHECK(fabsf(Control_GetPID(0)->p.tt_s - 20.0f) < 1e-4f, "tt %.3f, want kp/ki",
+          Control_GetPID(0)->p.tt_s);
+    if (ZONE_COUNT > 1U) {
+        CHECK(get(PARAM_KP, 1) == KP, "zone 1 kp %.3f changed", get(PARAM_KP, 1));
+    }
+
+    /* Nothing staged: Param_Apply() changes nothing. */
+    Param_Apply();
+    CHECK(get(PARAM_KP, 0) == 4.0f, "kp %.3f after an empty apply", get(PARAM_KP, 0));
+
+    /* NTC constants staged together are applied as one table rebuild. */
+    CHECK(Param_Set(PARAM_NTC_BETA, 0, 3435.0f) && Param_Set(PARAM_R_FIXED, 0, 4700.0f),
+          "NTC constants refused");
+    Param_Apply();
+    CHECK(Temperature_GetNtc()->beta == 3435.0f && Temperature_GetNtc()->r_fixed == 4700.0f,
+          "NTC %.0f %.0f", Temperature_GetNtc()->beta, Temperature_GetNtc()->r_fixed);
+}
+
+static void test_order(void)
+{
+    start();
+
+    /* Setpoint checked against the staged limits, and applied after them:
+       with the old limits 30..60 applied last, 65 would be clamped. */
+    CHECK(Param_Set(PARAM_SP_MAX, 0, 50.0f), "sp_max 50 refused");
+    CHECK(!Param_Set(PARAM_SP, 0, 55.0f), "sp 55 above the staged sp_max");
+    CHECK(Param_Set(PARAM_SP_MIN, 0, 40.0f), "sp_min 40 refused");
+    CHECK(!Param_Set(PARAM_SP, 0, 35.0f), "sp 35 below the staged sp_min");
+    CHECK(Param_Set(PARAM_SP, 0, 45.0f), "sp 45 refused");
+    CHECK(get(PARAM_SP_MAX, 0) == T_SAFE_MAX_C, "sp_max applied early");
+    Param_Apply();
+    CHECK(get(PARAM_SP_MIN, 0) == 40.0f && get(PARAM_SP_MAX, 0) == 50.0f,
+          "limits %.1f %.1f", get(PARAM_SP_MIN, 0), get(PARAM_SP_MAX, 0));
+    CHECK(get(PARAM_SP, 0) == 45.0f, "sp %.2f, want 45", get(PARAM_SP, 0));
+
+    /* Limits that move past the current setpoint take it along. */
+    CHECK(Param_Set(PARAM_SP_MAX, 0, 42.0f), "sp_max 42 refused");
+    Param_Apply();
+    CHECK(get(PARAM_SP, 0) == 42.0f, "sp %.2f, want it clamped to 42", get(PARAM_SP, 0));
+}
+
+static void test_refused(void)
+{
+    start();
+
+    /* Ordered pairs, against the current and the staged values. */
+    CHECK(!Param_Set(PARAM_SP_MIN, 0, T_SAFE_MAX_C), "sp_min = sp_max");
+    CHECK(!Param_Set(PARAM_ALARM_MAX, 0, T_ALARM_MIN_C), "alarm_max = alarm_min");
+    CHECK(!Param_Set(PARAM_FAN_OFF, 0, FAN_ON_ABOVE_C), "fan_off = fan_on");
+    CHECK(!Param_Set(PARAM_FAN_ON, 0, FAN_OFF_ABOVE_C - 0.5f), "fan_on below fan_off");
+    CHECK(Param_Set(PARAM_ALARM_MIN, 0, 20.0f), "alarm_min 20 refused");
+    CHECK(!Param_Set(PARAM_ALARM_MAX, 0, 15.0f), "alarm_max below the staged alarm_min");
+
+    /* Range, type, read only, zone. */
+    CHECK(!Param_Set(PARAM_SP, 0, T_SAFE_MAX_C + 1.0f), "sp above T_SAFE_MAX_C");
+    CHECK(!Param_Set(PARAM_ALARM_MAX, 0, T_ALARM_MAX_C + 1.0f), "alarm_max above the cutoff");
+    CHECK(!Param_Set(PARAM_KP, 0, NAN), "kp NaN");
+    CHECK(!Param_Set(PARAM_TLM_PERIOD, 0, 1000.5f), "tlm_period 1000.5");
+    CHECK(Param_Set(PARAM_TLM_PERIOD, 0, 1000.0f), "tlm_period 1000 refused");
+    CHECK(!Param_Set(PARAM_CONTROL_TS, 0, CONTROL_TS_S), "control_ts is read only");
+    CHECK(!Param_Set(PARAM_KP, ZONE_COUNT, 1.0f), "kp of zone %u", ZONE_COUNT);
+    CHECK(!Param_Set(PARAM_NTC_BETA, 1, 3435.0f), "ntc_beta has no zone 1");
+    CHECK(!Param_Set(PARAM_COUNT, 0, 1.0f), "id PARAM_COUNT");
+
+    Param_Apply();
+    CHECK(get(PARAM_ALARM_MIN, 0) == 20.0f && get(PARAM_ALARM_MAX, 0) == T_ALARM_MAX_C,
+          "alarm %.1f %.1f", get(PARAM_ALARM_MIN, 0), get(PARAM_ALARM_MAX, 0));
+
+    /* Saved values are loaded one at a time; a contradicting pair falls
+       back to the defaults of both. */
+    CHECK(Param_Load(PARAM_SP_MIN, 0, 55.0f) && Param_Load(PARAM_SP_MAX, 0, 40.0f),
+          "load refused");
+    Param_CheckLimits();
+    Param_Apply();
+    CHECK(get(PARAM_SP_MIN, 0) == T_SAFE_MIN_C && get(PARAM_SP_MAX, 0) == T_SAFE_MAX_C,
+          "limits %.1f %.1f after the check", get(PARAM_SP_MIN, 0), get(PARAM_SP_MAX, 0));
+}
+
+static void test_filter(void)
+{
+    start();
+    const float ts = CONTROL_TS_S;
+    filter_t *f = Temperature_GetFilter(0);
+
+    CHECK(get(PARAM_FILTER, 0) == (float)TEMP_FILT_TYPE && get(PARAM_FILTER_N, 0) == TEMP_FILT_N,
+          "filter %.0f n %.0f", get(PARAM_FILTER, 0), get(PARAM_FILTER_N, 0));
+    CHECK(fabsf(get(PARAM_FILTER_DELAY, 0) - 0.5f * (TEMP_FILT_N - 1U) * ts) < 1e-5f,
+          "default delay %.3f s", get(PARAM_FILTER_DELAY, 0));
+
+    /* Type and length staged together, applied to zone 0 only. */
+    CHECK(Param_Set(PARAM_FILTER, 0, (float)FILTER_MEDIAN) && Param_Set(PARAM_FILTER_N, 0, 5.0f),
+          "median 5 refused");
+    CHECK(f->type == FILTER_MA, "filter changed before the apply");
+    Param_Apply();
+    CHECK(f->type == FILTER_MEDIAN && f->s.med.n == 5U, "type %d n %u", f->type, f->s.med.n);
+    CHECK(fabsf(get(PARAM_FILTER_DELAY, 0) - 2.0f * ts) < 1e-5f, "median 5: delay %.3f s",
+          get(PARAM_FILTER_DELAY, 0));
+    if (ZONE_COUNT > 1U) {
+        CHECK(Temperature_GetFilter(1)->type == FILTER_MA, "zone 1 filter changed");
+    }
+
+    /* EMA and Kalman: the delay of the window of the same length. */
+    CHECK(Param_Set(PARAM_FILTER, 0, (float)FILTER_EMA), "EMA refused");
+    Param_Apply();
+    CHECK(f->type == FILTER_EMA && fabsf(get(PARAM_FILTER_DELAY, 0) - 2.0f * ts) < 1e-4f,
+          "EMA 5: delay %.3f s", get(PARAM_FILTER_DELAY, 0));
+    CHECK(Param_Set(PARAM_FILTER, 0, (float)FILTER_KALMAN) && Param_Set(PARAM_FILTER_N, 0, 16.0f),
+          "Kalman 16 refused");
+    Param_Apply();
+    CHECK(f->type == FILTER_KALMAN && fabsf(get(PARAM_FILTER_DELAY, 0) - 7.5f * ts) < 1e-3f,
+          "Kalman 16: delay %.3f s", get(PARAM_FILTER_DELAY, 0));
+
+    /* A median window is odd and at most FILTER_MEDIAN_MAX_N: the delay
+       tells what a longer one gives. */
+    CHECK(Param_Set(PARAM_FILTER, 0, (float)FILTER_MEDIAN), "median 16 refused");
+    Param_Apply();
+    CHECK(get(PARAM_FILTER_N, 0) == 16.0f && f->s.med.n == FILTER_MEDIAN_MAX_N,
+          "median 16: n %u", f->s.med.n);
+    CHECK(fabsf(get(PARAM_FILTER_DELAY, 0) - 0.5f * (FILTER_MEDIAN_MAX_N - 1U) * ts) < 1e-5f,
+          "median 16: delay %.3f s", get(PARAM_FILTER_DELAY, 0));
+
+    CHECK(Param_Set(PARAM_FILTER, 0, (float)FILTER_NONE), "none refused");
+    Param_Apply();
+    CHECK(f->type == FILTER_NONE && get(PARAM_FILTER_DELAY, 0) == 0.0f, "none: delay %.3f s",
+          get(PARAM_FILTER_DELAY, 0));
+
+    CHECK(!Param_Set(PARAM_FILTER, 0, (float)FILTER_KALMAN + 1.0f), "unknown filter type");
+    CHECK(!Param_Set(PARAM_FILTER_N, 0, 0.0f), "filter_n 0");
+    CHECK(!Param_Set(PARAM_FILTER_N, 0, FILTER_MA_MAX_N + 1.0f), "filter_n above the MA buffer");
+    CHECK(!Param_Set(PARAM_FILTER_DELAY, 0, 0.0f), "filter_delay is read only");
+}
+
+/* Send a command line, return the reply. */
+static const char *command(const char *line)
+{
+    static char reply[64];
+
+    HALFAKE_UART_Inject(line, strlen(line));
+    UARTIF_Task();
+    HALFAKE_UART_Flush();
+    size_t n = HALFAKE_UART_TakeOutput((uint8_t *)reply, sizeof(reply) - 1U);
+    reply[n] = '\0';
+    return reply;
+}
+
+static void test_t_command(void)
+{
+    start();
+    UARTIF_Init();
+
+    CHECK(strcmp(command("SET sp_max:0 50\n"), "OK\n") == 0, "SET sp_max refused");
+
+    /* Checked against the staged limit, not applied before the step. */
+    CHECK(strcmp(command("T0:55\n"), "ERR\n") == 0, "T0:55 above the staged sp_max");
+    CHECK(strcmp(command("T0:45\n"), "OK\n") == 0, "T0:45 refused");
+    CHECK(get(PARAM_SP, 0) == T_SETPOINT_DEFAULT_C, "T applied before the step");
+    Param_Apply();
+    CHECK(get(PARAM_SP, 0) == 45.0f, "sp %.2f after T0:45", get(PARAM_SP, 0));
+
+    CHECK(strcmp(command("T0:20\n"), "ERR\n") == 0, "T0:20 below T_SAFE_MIN_C");
+    CHECK(strcmp(command("T9:40\n"), "ERR\n") == 0, "T9: no such zone");
+    Param_Apply();
+    CHECK(get(PARAM_SP, 0) == 45.0f, "sp %.2f after refused T", get(PARAM_SP, 0));
+}
+
+int main(void)
+{
+    test_find();
+    test_staging();
+    test_order();
+    test_refused();
+    test_filter();
+    test_t_command();
+    return CHECK_RESULT();
+}
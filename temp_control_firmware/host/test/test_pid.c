@@ -0,0 +1,184 @@
+/**
+ * @file test_pid.c
+ * @brief PID controller object: anti-windup, bumpless transfer, manual mode.
+ *
+ * Checks that the integrator stays bounded in saturation with the back
+ * calculation and stays put with clamping, so the output leaves the
+ * limit as soon as the error reverses; that manual/auto switching, gain
+ * changes and bumpless feed-forward changes do not step the output;
+ * the derivative filter and its missing kick on the first sample; and
+ * the output rate limit. Two instances must not share state.
+ */
+
+#include "check.h"
+#include "pid.h"
+
+#include <math.h>
+
+#define TS  0.1f
+
+static const pid_params_t base = {
+    .kp = 2.0f, .ki = 0.5f, .kd = 0.0f, .ts_s = TS,
+    .b = 1.0f, .c = 0.0f, .tf_s = 0.5f, .tt_s = 2.0f,
+    .out_min = 0.0f, .out_max = 100.0f, .rate_max = 0.0f,
+};
+
+static bool near(float a, float b, float tol)
+{
+    return fabsf(a - b) <= tol;
+}
+
+static void test_back_calculation(void)
+{
+    pid_ctrl_t pid;
+    PID_Init(&pid, &base);
+
+    /* 100 s at the upper limit, error 100: without anti-windup the
+       integrator would reach ki * e * t = 5000 %. The back calculation
+       holds it where ki * e = (v - u) / tt. */
+    float u = 0.0f;
+    for (int i = 0; i < 1000; i++) u = PID_Update(&pid, 100.0f, 0.0f);
+    CHECK(u == 100.0f, "u %.2f, want the upper limit", u);
+    CHECK(fabsf(pid.i_term) < 1.0f, "integrator %.2f in saturation", pid.i_term);
+
+    /* Error reversed: off the limit on the first step. */
+    u = PID_Update(&pid, 50.0f, 55.0f);
+    CHECK(u < 100.0f, "u %.2f one step after the error reversed", u);
+}
+
+static void test_clamping(void)
+{
+    pid_params_t p = base;
+    p.tt_s = 0.0f;
+    pid_ctrl_t pid;
+    PID_Init(&pid, &p);
+
+    for (int i = 0; i < 100; i++) (void)PID_Update(&pid, 100.0f, 0.0f);
+    CHECK(pid.i_term == 0.0f, "integrator %.2f while clamped high", pid.i_term);
+
+    /* An error that drives away from the limit still integrates. */
+    (void)PID_Update(&pid, 100.0f, 99.0f);
+    CHECK(near(pid.i_term, p.ki * TS * 1.0f, 1e-5f), "integrator %.4f off the limit",
+          pid.i_term);
+}
+
+static void test_manual(void)
+{
+    pid_ctrl_t pid;
+    PID_Init(&pid, &base);
+    float u = 0.0f;
+    for (int i = 0; i < 50; i++) u = PID_Update(&pid, 40.0f, 30.0f);
+
+    /* Auto -> manual holds the output. */
+    PID_SetMode(&pid, PID_MODE_MANUAL);
+    CHECK(PID_Update(&pid, 40.0f, 30.0f) == u, "output moved on the switch to manual");
+
+    PID_SetManual(&pid, 30.0f);
+    CHECK(PID_Update(&pid, 40.0f, 35.0f) == 30.0f, "manual output not applied");
+    PID_SetManual(&pid, 150.0f);
+    CHECK(PID_Update(&pid, 40.0f, 35.0f) == 100.0f, "manual output not limited");
+    PID_SetManual(&pid, 30.0f);
+    (void)PID_Update(&pid, 40.0f, 35.0f);
+
+    /* Manual -> auto starts from the manual output: only one integral
+       step of ki * Ts * e away. */
+    PID_SetMode(&pid, PID_MODE_AUTO);
+    u = PID_Update(&pid, 40.0f, 35.0f);
+    CHECK(near(u, 30.0f, base.ki * TS * 5.0f + 1e-4f), "u %.3f after manual -> auto, want 30", u);
+}
+
+static void test_bumpless_changes(void)
+{
+    pid_ctrl_t pid;
+    PID_Init(&pid, &base);
+    for (int i = 0; i < 50; i++) (void)PID_Update(&pid, 40.0f, 38.0f);
+    const float step = base.ki * TS * 2.0f;   /* integral step at e = 2 */
+
+    float u0 = pid.u;
+    PID_SetGains(&pid, 6.0f, 0.5f, 0.0f);
+    float u = PID_Update(&pid, 40.0f, 38.0f);
+    CHECK(near(u, u0 + step, 1e-4f), "u %.3f after a kp change, was %.3f", u, u0);
+
+    u0 = u;
+    PID_SetFeedForwardBumpless(&pid, 20.0f);
+    u = PID_Update(&pid, 40.0f, 38.0f);
+    CHECK(near(u, u0 + step, 1e-4f), "u %.3f after a bumpless feed-forward, was %.3f", u, u0);
+
+    /* The plain setter acts on the output. */
+    u0 = u;
+    PID_SetFeedForward(&pid, 30.0f);
+    u = PID_Update(&pid, 40.0f, 38.0f);
+    CHECK(near(u, u0 + 10.0f + step, 1e-4f), "u %.3f after a feed-forward of +10, was %.3f",
+          u, u0);
+}
+
+static void test_derivative(void)
+{
+    pid_params_t p = base;
+    p.kp = 0.0f;
+    p.ki = 0.0f;
+    p.kd = 4.0f;
+    pid_ctrl_t pid;
+    PID_Init(&pid, &p);
+
+    CHECK(PID_Update(&pid, 40.0f, 30.0f) == 0.0f, "derivative kick on the first sample");
+
+    /* meas falls by 1: D = kd / (tf + Ts) = 6.67 %, then decays by
+       tf / (tf + Ts) per step. */
+    const float den = p.tf_s + TS;
+    float d = p.kd / den;
+    (void)PID_Update(&pid, 40.0f, 29.0f);
+    CHECK(near(pid.d_term, d, 1e-4f), "D %.4f, want %.4f", pid.d_term, d);
+    for (int i = 0; i < 5; i++) {
+        (void)PID_Update(&pid, 40.0f, 29.0f);
+        d *= p.tf_s / den;
+    }
+    CHECK(near(pid.d_term, d, 1e-4f), "D %.4f after 5 steps, want %.4f", pid.d_term, d);
+
+    /* c = 0: a setpoint step does not reach the derivative. */
+    (void)PID_Update(&pid, 60.0f, 29.0f);
+    d *= p.tf_s / den;
+    CHECK(near(pid.d_term, d, 1e-4f), "D %.4f after a setpoint step, want %.4f", pid.d_term, d);
+}
+
+static void test_rate_limit(void)
+{
+    pid_params_t p = base;
+    p.rate_max = 5.0f;   /* 0.5 % per step */
+    pid_ctrl_t pid;
+    PID_Init(&pid, &p);
+
+    float prev = pid.u;
+    bool ok = true;
+    for (int i = 0; i < 20; i++) {
+        float u = PID_Update(&pid, 60.0f, 30.0f);
+        if (u - prev > p.rate_max * TS + 1e-5f) ok = false;
+        prev = u;
+    }
+    CHECK(ok, "output rose faster than %.1f %%/s", p.rate_max);
+    CHECK(near(prev, 20.0f * p.rate_max * TS, 1e-4f), "u %.3f after 20 steps", prev);
+}
+
+static void test_instances(void)
+{
+    pid_ctrl_t a, b;
+    PID_Init(&a, &base);
+    PID_Init(&b, &base);
+    for (int i = 0; i < 20; i++) (void)PID_Update(&a, 50.0f, 40.0f);
+    CHECK(b.i_term == 0.0f && b.u == 0.0f, "second instance changed");
+
+    PID_Reset(&a);
+    CHECK(a.i_term == 0.0f && a.u == 0.0f && !a.started, "reset left state");
+}
+
+int main(void)
+{
+    test_back_calculation();
+    test_clamping();
+    test_manual();
+    test_bumpless_changes();
+    test_derivative();
+    test_rate_limit();
+    test_instances();
+    return CHECK_RESULT();
+}
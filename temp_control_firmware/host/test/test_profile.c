@@ -0,0 +1,192 @@
+/**
+ * @file test_profile.c
+ * @brief Setpoint profiles: ramps, holds, nested repeat / loop_to.
+ *
+ * Checks the ramp and hold timing in control steps, the order in which
+ * segments run with loops nested inside each other and a segment that
+ * loops onto itself, with the inner loop counted again on every pass of
+ * the outer one; the setpoint after the last segment, pause and resume,
+ * a restart, and the segments Profile_AddSegment() refuses.
+ */
+
+#include "check.h"
+#include "config.h"
+#include "main.h"
+#include "profile.h"
+#include "setpoint.h"
+#include "zone.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define STEPS_PER_S  ((uint32_t)(1.0f / CONTROL_TS_S + 0.5f))
+#define VISITS_MAX   64U
+
+/* Segments entered, in order. */
+static uint8_t  visits[VISITS_MAX];
+static uint32_t n_visits;
+
+static void start(void)
+{
+    HALFAKE_Reset();
+    Zone_Init();
+    Profile_Clear(0);
+    n_visits = 0;
+}
+
+static void add(float rate, float target, float hold, uint8_t loop_to, uint8_t repeat)
+{
+    const profile_seg_t s = {rate, target, hold, loop_to, repeat};
+    CHECK(Profile_AddSegment(0, &s), "segment %.1f degC refused", target);
+}
+
+/* Run until the profile ends, recording every segment entered. */
+static uint32_t run_to_end(uint32_t max_steps)
+{
+    const profile_t *p = Profile_Get(0);
+    uint32_t n = 0;
+    int last = -1;
+
+    while (p->state == PROFILE_RUNNING && n < max_steps) {
+        Profile_Update(0);
+        n++;
+        if (p->state == PROFILE_RUNNING && (p->seg_n == 1U || (int)p->i != last)) {
+            if (n_visits < VISITS_MAX) visits[n_visits++] = p->i;
+            last = p->i;
+        }
+    }
+    return n;
+}
+
+static void test_ramp_hold(void)
+{
+    start();
+    Setpoint_SetC(0, 40.0f);
+    add(1.0f, 45.0f, 2.0f, 0, 0);   /* 5 s ramp, 2 s hold */
+    add(0.0f, 35.0f, 1.0f, 0, 0);   /* step, 1 s hold */
+    CHECK(Profile_Start(0), "start refused");
+
+    for (uint32_t i = 0; i < 2U * STEPS_PER_S; i++) Profile_Update(0);
+    CHECK(fabsf(Setpoint_GetC(0) - 42.0f) < 1e-3f, "setpoint %.3f after 2 s of ramp",
+          Setpoint_GetC(0));
+    CHECK(fabsf(Profile_GetSegmentTimeS(0) - 2.0f) < 1e-3f, "segment time %.2f s",
+          Profile_GetSegmentTimeS(0));
+
+    const uint32_t n = 2U * STEPS_PER_S + run_to_end(1000);
+    CHECK(Setpoint_GetC(0) == 35.0f, "setpoint %.2f after the end", Setpoint_GetC(0));
+    CHECK(Profile_Get(0)->state == PROFILE_DONE, "state %u", Profile_Get(0)->state);
+    /* Ramp 5 s + hold 2 s, step + hold 1 s: 8 s in control steps, one
+       more if the float sum of the 0.1 degC increments misses the target
+       by a rounding error on the 50th. */
+    CHECK(n == 8U * STEPS_PER_S || n == 8U * STEPS_PER_S + 1U, "%u steps, want %u",
+          n, 8U * STEPS_PER_S);
+
+    /* After the end the setpoint stays at the last target. */
+    for (uint32_t i = 0; i < 50U; i++) Profile_Update(0);
+    CHECK(Setpoint_GetC(0) == 35.0f, "setpoint %.2f after the profile", Setpoint_GetC(0));
+}
+
+static void test_nested_loops(void)
+{
+    /* 0 A, 1 B, 2 C (back to 1, twice), 3 D (back to 0, once),
+       4 E (onto itself, twice). */
+    static const uint8_t want[] = {
+        0, 1, 2, 1, 2, 1, 2, 3,
+        0, 1, 2, 1, 2, 1, 2, 3,
+        4, 4, 4,
+    };
+
+    start();
+    add(0.0f, 31.0f, 0.5f, 0, 0);
+    add(0.0f, 32.0f, 0.5f, 0, 0);
+    add(0.0f, 33.0f, 0.5f, 1, 2);
+    add(0.0f, 34.0f, 0.5f, 0, 1);
+    add(0.0f, 35.0f, 0.5f, 4, 2);
+    CHECK(Profile_Start(0), "start refused");
+    const uint32_t n = run_to_end(1000);
+
+    bool same = (n_visits == sizeof(want)) && memcmp(visits, want, sizeof(want)) == 0;
+    CHECK(same, "%u segments run, want %u", n_visits, (unsigned)sizeof(want));
+    if (!same) {
+        for (uint32_t i = 0; i < n_visits; i++) fprintf(stderr, "%u ", visits[i]);
+        fputc('\n', stderr);
+    }
+    /* The hold counts from the step that reaches the target, and the next
+       segment starts in the step that ends it: one step for the first
+       target, then 0.5 s per segment run. */
+    CHECK(n == 1U + sizeof(want) * STEPS_PER_S / 2U, "%u steps, want %u", n,
+          (unsigned)(1U + sizeof(want) * STEPS_PER_S / 2U));
+    CHECK(Setpoint_GetC(0) == 35.0f, "setpoint %.2f at the end", Setpoint_GetC(0));
+
+    /* A restart counts every loop from the beginning again. */
+    n_visits = 0;
+    CHECK(Profile_Start(0), "restart refused");
+    (void)run_to_end(1000);
+    CHECK(n_visits == sizeof(want) && memcmp(visits, want, sizeof(want)) == 0,
+          "%u segments on the restart", n_visits);
+}
+
+static void test_pause(void)
+{
+    start();
+    Setpoint_SetC(0, 40.0f);
+    add(1.0f, 50.0f, 0.0f, 0, 0);
+    CHECK(Profile_Start(0), "start refused");
+    for (uint32_t i = 0; i < 3U * STEPS_PER_S; i++) Profile_Update(0);
+
+    Profile_Pause(0);
+    for (uint32_t i = 0; i < 100U; i++) Profile_Update(0);
+    CHECK(fabsf(Setpoint_GetC(0) - 43.0f) < 1e-3f, "setpoint %.3f while paused",
+          Setpoint_GetC(0));
+    CHECK(fabsf(Profile_GetSegmentTimeS(0) - 3.0f) < 1e-3f, "segment time %.2f s while paused",
+          Profile_GetSegmentTimeS(0));
+
+    /* Resume continues the ramp where it stopped. */
+    CHECK(Profile_Start(0), "resume refused");
+    for (uint32_t i = 0; i < STEPS_PER_S; i++) Profile_Update(0);
+    CHECK(fabsf(Setpoint_GetC(0) - 44.0f) < 1e-3f, "setpoint %.3f after resuming",
+          Setpoint_GetC(0));
+
+    Profile_Stop(0);
+    Profile_Update(0);
+    CHECK(Profile_Get(0)->state == PROFILE_IDLE && fabsf(Setpoint_GetC(0) - 44.0f) < 1e-3f,
+          "stop moved the setpoint");
+}
+
+static void test_refused(void)
+{
+    const profile_seg_t ok = {0.0f, 40.0f, 1.0f, 0, 0};
+    profile_seg_t s;
+
+    start();
+    CHECK(!Profile_Start(0), "empty profile started");
+
+    s = ok; s.loop_to = 1;
+    CHECK(!Profile_AddSegment(0, &s), "loop_to past the segment");
+    s = ok; s.target_c = T_SAFE_MAX_C + 1.0f;
+    CHECK(!Profile_AddSegment(0, &s), "target above sp_max");
+    s = ok; s.rate_c_per_s = -1.0f;
+    CHECK(!Profile_AddSegment(0, &s), "negative rate");
+    s = ok; s.hold_s = NAN;
+    CHECK(!Profile_AddSegment(0, &s), "hold NaN");
+    CHECK(!Profile_AddSegment(ZONE_COUNT, &ok), "zone %u", ZONE_COUNT);
+
+    for (uint32_t i = 0; i < PROFILE_MAX_SEG; i++) {
+        CHECK(Profile_AddSegment(0, &ok), "segment %u refused", i);
+    }
+    CHECK(!Profile_AddSegment(0, &ok), "segment %u accepted", PROFILE_MAX_SEG + 1U);
+
+    Profile_Clear(0);
+    CHECK(Profile_AddSegment(0, &ok) && Profile_Start(0), "start refused");
+    CHECK(!Profile_AddSegment(0, &ok), "segment added while running");
+}
+
+int main(void)
+{
+    test_ramp_hold();
+    test_nested_loops();
+    test_pause();
+    test_refused();
+    return CHECK_RESULT();
+}
@@ -0,0 +1,237 @@
+/**
+ * @file test_scheduler.c
+ * @brief Scheduler driven by a fake tick through Sched_Init().
+ *
+ * Checks the release times of tasks with periods and phases, the order of
+ * tasks due on the same tick, counting and skipping of missed releases,
+ * a 32-bit wrap of the tick, Sched_SetPeriod() shortening and lengthening
+ * a period, Sched_FindTask(), the argument checks and the internal tick
+ * of Sched_TickISR().
+ */
+
+#include "check.h"
+#include "scheduler.h"
+
+#include <stddef.h>
+
+#define LOG_MAX  64U
+
+static uint32_t now;
+
+static uint32_t fake_tick(void)
+{
+    return now;
+}
+
+/* Run log: tick and task of every run, in order. */
+static uint32_t log_t[LOG_MAX];
+static char     log_task[LOG_MAX];
+static uint32_t log_n;
+
+static void record(char task)
+{
+    if (log_n < LOG_MAX) {
+        log_t[log_n]    = now;
+        log_task[log_n] = task;
+        log_n++;
+    }
+}
+
+static void task_a(void) { record('a'); }
+static void task_b(void) { record('b'); }
+static void task_c(void) { record('c'); }
+
+static void start(uint32_t t0)
+{
+    now   = t0;
+    log_n = 0;
+    Sched_Init(fake_tick);
+}
+
+/* Call Sched_RunPending() on every tick from now to now + ms - 1. */
+static void run_for(uint32_t ms)
+{
+    for (uint32_t i = 0; i < ms; i++) {
+        (void)Sched_RunPending();
+        now++;
+    }
+}
+
+/* Runs of one task in the log, their ticks in @p t. */
+static uint32_t runs_of(char task, uint32_t *t, uint32_t max)
+{
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < log_n; i++) {
+        if (log_task[i] != task) continue;
+        if (n < max) t[n] = log_t[i];
+        n++;
+    }
+    return n;
+}
+
+static void test_period_phase(void)
+{
+    uint32_t t[LOG_MAX];
+
+    start(0);
+    int a = Sched_AddTask("a", task_a, 10, 0);
+    int b = Sched_AddTask("b", task_b, 10, 5);
+    int c = Sched_AddTask("c", task_c, 4, 0);
+    CHECK(a == 0 && b == 1 && c == 2, "ids %d %d %d", a, b, c);
+
+    run_for(40);
+
+    uint32_t n = runs_of('a', t, LOG_MAX);
+    CHECK(n == 4U, "a: %u runs, want 4", n);
+    for (uint32_t i = 0; i < n && i < 4U; i++) {
+        CHECK(t[i] == 10U * i, "a run %u at %u, want %u", i, t[i], 10U * i);
+    }
+
+    n = runs_of('b', t, LOG_MAX);
+    CHECK(n == 4U, "b: %u runs, want 4", n);
+    for (uint32_t i = 0; i < n && i < 4U; i++) {
+        CHECK(t[i] == 10U * i + 5U, "b run %u at %u, want %u", i, t[i], 10U * i + 5U);
+    }
+
+    n = runs_of('c', t, LOG_MAX);
+    CHECK(n == 10U, "c: %u runs, want 10", n);
+    for (uint32_t i = 0; i < n && i < 10U; i++) {
+        CHECK(t[i] == 4U * i, "c run %u at %u, want %u", i, t[i], 4U * i);
+    }
+
+    /* Due on the same tick (0, 20): registration order. */
+    CHECK(log_task[0] == 'a' && log_task[1] == 'c', "order at 0: %c %c", log_task[0], log_task[1]);
+
+    CHECK(Sched_GetTask(a)->runs == 4U, "a runs %u", Sched_GetTask(a)->runs);
+    CHECK(Sched_GetTotalMisses() == 0U, "%u misses", Sched_GetTotalMisses());
+    CHECK(Sched_GetTask(a)->max_late_ms == 0U, "a late %u ms", Sched_GetTask(a)->max_late_ms);
+}
+
+/* The loop is stalled for 25 ms after the first run. */
+static void test_missed(void)
+{
+    uint32_t t[LOG_MAX];
+
+    start(0);
+    int a = Sched_AddTask("a", task_a, 10, 0);
+    run_for(1);
+
+    now = 35;
+    (void)Sched_RunPending();
+    const sched_task_t *ta = Sched_GetTask(a);
+    CHECK(ta->misses == 2U, "%u misses, want 2 (10, 20)", ta->misses);
+    CHECK(ta->max_late_ms == 25U, "late %u ms, want 25", ta->max_late_ms);
+    CHECK(ta->next_due_ms == 40U, "next at %u, want 40", ta->next_due_ms);
+
+    now = 36;
+    run_for(20);
+    uint32_t n = runs_of('a', t, LOG_MAX);
+    CHECK(n == 4U && t[1] == 35U && t[2] == 40U && t[3] == 50U,
+          "%u runs at %u %u %u, want 0 35 40 50", n, t[1], t[2], t[3]);
+    CHECK(Sched_GetTotalMisses() == 2U, "total %u misses", Sched_GetTotalMisses());
+}
+
+static void test_wrap(void)
+{
+    uint32_t t[LOG_MAX];
+
+    start(0xFFFFFFF0UL);
+    (void)Sched_AddTask("a", task_a, 10, 0);
+    (void)Sched_AddTask("b", task_b, 7, 20);
+
+    run_for(40);
+
+    uint32_t n = runs_of('a', t, LOG_MAX);
+    CHECK(n == 4U, "a: %u runs across the wrap, want 4", n);
+    for (uint32_t i = 0; i < n && i < 4U; i++) {
+        uint32_t want = 0xFFFFFFF0UL + 10U * i;
+        CHECK(t[i] == want, "a run %u at 0x%08X, want 0x%08X", i, t[i], want);
+    }
+
+    /* Released after the wrap: 0x04, 0x0B, 0x12. */
+    n = runs_of('b', t, LOG_MAX);
+    CHECK(n == 3U && t[0] == 0x04U, "b: %u runs, first at 0x%08X", n, t[0]);
+    CHECK(Sched_GetTotalMisses() == 0U, "%u misses across the wrap", Sched_GetTotalMisses());
+}
+
+static void test_set_period(void)
+{
+    uint32_t t[LOG_MAX];
+
+    start(0);
+    int a = Sched_AddTask("a", task_a, 100, 0);
+    run_for(20);
+
+    /* Shorter: the next release is one new period from now, not at 100. */
+    CHECK(Sched_SetPeriod(a, 10), "SetPeriod failed");
+    CHECK(Sched_GetTask(a)->next_due_ms == 30U, "next at %u, want 30",
+          Sched_GetTask(a)->next_due_ms);
+    run_for(21);
+
+    /* Longer: the pending release (50) stays, then every 50 ms. */
+    CHECK(Sched_SetPeriod(a, 50), "SetPeriod failed");
+    run_for(70);
+
+    uint32_t n = runs_of('a', t, LOG_MAX);
+    CHECK(n == 5U, "%u runs, want 5", n);
+    const uint32_t want[5] = {0, 30, 40, 50, 100};
+    for (uint32_t i = 0; i < n && i < 5U; i++) {
+        CHECK(t[i] == want[i], "run %u at %u, want %u", i, t[i], want[i]);
+    }
+    CHECK(Sched_GetTask(a)->misses == 0U, "%u misses", Sched_GetTask(a)->misses);
+
+    CHECK(!Sched_SetPeriod(a, 0), "zero period accepted");
+    CHECK(!Sched_SetPeriod(-1, 10), "id -1 accepted");
+    CHECK(!Sched_SetPeriod(1, 10), "unregistered id accepted");
+    CHECK(Sched_GetTask(a)->period_ms == 50U, "period %u after rejected calls",
+          Sched_GetTask(a)->period_ms);
+}
+
+static void test_table(void)
+{
+    start(0);
+    CHECK(Sched_AddTask("x", NULL, 10, 0) == -1, "NULL task accepted");
+    CHECK(Sched_AddTask("x", task_a, 0, 0) == -1, "zero period accepted");
+
+    int none = Sched_AddTask(NULL, task_a, 10, 0);
+    int b    = Sched_AddTask("b", task_b, 10, 0);
+    int c    = Sched_AddTask("c", task_c, 10, 0);
+    CHECK(Sched_FindTask("b") == b && Sched_FindTask("c") == c,
+          "find b %d c %d", Sched_FindTask("b"), Sched_FindTask("c"));
+    CHECK(Sched_FindTask("d") == -1, "found an unknown name");
+    CHECK(none == 0 && Sched_GetTask(none)->name == NULL, "unnamed task");
+
+    while (Sched_GetTaskCount() < SCHED_MAX_TASKS) {
+        CHECK(Sched_AddTask("f", task_a, 10, 0) >= 0, "table full at %u", Sched_GetTaskCount());
+    }
+    CHECK(Sched_AddTask("g", task_a, 10, 0) == -1, "task %u accepted", SCHED_MAX_TASKS + 1U);
+    CHECK(Sched_GetTask((int)SCHED_MAX_TASKS) == NULL, "task past the table");
+    CHECK(Sched_GetTask(-1) == NULL, "task -1");
+}
+
+/* NULL tick source: the counter of Sched_TickISR(). */
+static void test_internal_tick(void)
+{
+    log_n = 0;
+    Sched_Init(NULL);
+    CHECK(Sched_GetTick() == 0U, "tick %u after init", Sched_GetTick());
+
+    (void)Sched_AddTask("a", task_a, 5, 0);
+    for (uint32_t i = 0; i < 20U; i++) {
+        (void)Sched_RunPending();
+        Sched_TickISR();
+    }
+    CHECK(Sched_GetTick() == 20U, "tick %u, want 20", Sched_GetTick());
+    CHECK(Sched_GetTask(0)->runs == 4U, "%u runs, want 4", Sched_GetTask(0)->runs);
+}
+
+int main(void)
+{
+    test_period_phase();
+    test_missed();
+    test_wrap();
+    test_set_period();
+    test_table();
+    test_internal_tick();
+    return CHECK_RESULT();
+}
@@ -0,0 +1,204 @@
+/**
+ * @file test_store.c
+ * @brief Flash log store under random power loss.
+ *
+ * The HAL stand-in cuts the power at a random program or erase operation
+ * and leaves the word being written partly programmed. After every cut
+ * the store is mounted again as at boot, and every key must read back
+ * either the last value written successfully or, for the write that was
+ * cut, the new one. Covered: torn records, compactions cut at run time
+ * and at boot, replay of the log at mount, and a second mount after the
+ * recovery.
+ */
+
+#include "check.h"
+#include "store.h"
+#include "main.h"
+
+#define NKEYS  40U
+
+static uint32_t model[NKEYS];
+static bool     model_set[NKEYS];
+
+/* xorshift32: the same sequence on every run. */
+static uint32_t rnd(void)
+{
+    static uint32_t x = 12345U;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+static void power_cycle(void)
+{
+    HALFAKE_FLASH_PowerOn();
+    HALFAKE_Reset();
+    CHECK(Store_Init(), "mount failed");
+}
+
+/* Compare every key with the model. The write of cut_key may or may not
+   have reached the flash: either value is accepted and the model follows
+   the store. Returns false on a mismatch. */
+static bool verify(int cut_key, uint32_t cut_value, const char *when, uint32_t it)
+{
+    bool ok = true;
+
+    for (uint32_t k = 0; k < NKEYS; k++) {
+        uint32_t v = 0;
+        bool have = Store_Read((uint16_t)k, &v);
+
+        if ((int)k == cut_key && have && v == cut_value) {
+            model[k] = v;
+            model_set[k] = true;
+            continue;
+        }
+        if (have != model_set[k] || (have && v != model[k])) {
+            CHECK(false, "%s %u: key %u read %s%u, want %s%u", when, it, k,
+                  have ? "" : "nothing ", v, model_set[k] ? "" : "nothing ", model[k]);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+static bool write(uint32_t key, uint32_t value)
+{
+    if (!Store_Write((uint16_t)key, value)) return false;
+    model[key] = value;
+    model_set[key] = true;
+    return true;
+}
+
+static void test_plain(void)
+{
+    store_info_t in;
+
+    HALFAKE_Reset();
+    HALFAKE_FLASH_Wipe();
+    CHECK(Store_Init(), "fresh mount failed");
+    Store_GetInfo(&in);
+    CHECK(in.mounted && in.used == 0U && in.keys == 0U, "fresh store: used %u keys %u",
+          in.used, in.keys);
+
+    /* Several compactions, then replay at boot. */
+    for (uint32_t i = 0; i < 10000U; i++) {
+        uint32_t k = rnd() % NKEYS;
+        CHECK(write(k, rnd() % 7U), "write %u failed", i);
+    }
+    Store_GetInfo(&in);
+    CHECK(in.generation > 1U && in.keys == NKEYS, "generation %u keys %u",
+          in.generation, in.keys);
+
+    power_cycle();
+    verify(-1, 0, "reboot", 0);
+
+    /* An unchanged value is not written again. */
+    uint32_t ops = HALFAKE_FLASH_Ops();
+    CHECK(write(0, model[0]), "rewrite failed");
+    CHECK(HALFAKE_FLASH_Ops() == ops, "unchanged value written");
+}
+
+static void test_cut_writes(void)
+{
+    uint32_t cuts = 0, torn = 0;
+    store_info_t in;
+
+    for (uint32_t it = 0; it < 3000U; it++) {
+        HALFAKE_FLASH_CutPower(rnd() % 600U, rnd());
+
+        int cut_key = -1;
+        uint32_t cut_value = 0;
+        for (uint32_t j = 0; j < 2000U; j++) {
+            uint32_t k = rnd() % NKEYS;
+            uint32_t v = rnd();
+            if (!write(k, v)) {
+                cut_key = (int)k;
+                cut_value = v;
+                break;
+            }
+        }
+        if (cut_key >= 0) cuts++;
+
+        power_cycle();
+        Store_GetInfo(&in);
+        if (in.bad > 0U) torn++;
+        if (!verify(cut_key, cut_value, "cut write", it)) break;
+
+        /* The recovered state is stable. */
+        power_cycle();
+        if (!verify(-1, 0, "second mount", it)) break;
+    }
+
+    CHECK(cuts > 2500U, "only %u writes cut", cuts);
+    CHECK(torn > 0U, "no torn record seen at mount");
+}
+
+static void test_cut_compactions(void)
+{
+    uint32_t boot_cut = 0, run_cut = 0;
+    store_info_t in;
+
+    for (uint32_t it = 0; it < 2000U; it++) {
+        bool at_boot = (it & 1U) != 0U;
+
+        /* Past 3/4 a mount compacts; a full sector compacts on the next
+           write. */
+        Store_GetInfo(&in);
+        uint16_t target = at_boot ? (uint16_t)(in.slots * 3U / 4U + 10U) : in.slots;
+        while (in.used < target) {
+            uint32_t k = rnd() % NKEYS;
+            if (!write(k, rnd())) {
+                CHECK(false, "fill write failed");
+                return;
+            }
+            Store_GetInfo(&in);
+        }
+        uint32_t generation = in.generation;
+
+        /* A sector erase and up to NKEYS records and the commit word. */
+        HALFAKE_FLASH_CutPower(rnd() % (NKEYS * 3U + 10U), rnd());
+
+        int cut_key = -1;
+        uint32_t cut_value = 0;
+        if (at_boot) {
+            HALFAKE_Reset();
+            (void)Store_Init();
+            Store_GetInfo(&in);
+            if (in.generation == generation) boot_cut++;
+        } else {
+            uint32_t k = rnd() % NKEYS;
+            uint32_t v = rnd();
+            if (!write(k, v)) {
+                run_cut++;
+                cut_key = (int)k;
+                cut_value = v;
+            }
+        }
+
+        power_cycle();
+        if (!verify(cut_key, cut_value, at_boot ? "boot compaction" : "compaction", it)) break;
+    }
+
+    CHECK(boot_cut > 0U, "no boot compaction cut");
+    CHECK(run_cut > 0U, "no run-time compaction cut");
+}
+
+static void test_format(void)
+{
+    uint32_t v;
+
+    CHECK(Store_Format(), "format failed");
+    CHECK(!Store_Read(1, &v), "value left by format");
+    power_cycle();
+    CHECK(!Store_Read(1, &v), "value back after format");
+}
+
+int main(void)
+{
+    test_plain();
+    test_cut_writes();
+    test_cut_compactions();
+    test_format();
+    return CHECK_RESULT();
+}
@@ -0,0 +1,49 @@
+/**
+ * @file test_temperature.c
+ * @brief Temperature_ToRaw(): watchdog thresholds and inverse of the model.
+ *
+ * The analog watchdog (overtemp.c) gets its window from
+ * Temperature_ToRaw(T_ALARM_MAX_C / T_ALARM_MIN_C). The codes for the
+ * config.h NTC constants are fixed here, and every code the conversion
+ * returns must be the one whose Beta-model temperature is nearest.
+ */
+
+#include "check.h"
+#include "config.h"
+#include "temperature.h"
+
+#include <math.h>
+
+int main(void)
+{
+    /* config.h: R_FIXED = NTC_R0 = 10k, NTC_BETA = 3950, NTC_T0_K = 298.15 */
+    CHECK(Temperature_ToRaw(T_ALARM_MIN_C) == 3156U, "0 degC -> %u", Temperature_ToRaw(T_ALARM_MIN_C));
+    CHECK(Temperature_ToRaw(T_ALARM_MAX_C) == 462U, "80 degC -> %u", Temperature_ToRaw(T_ALARM_MAX_C));
+
+    /* NTC in the lower leg: the code falls as the temperature rises. */
+    CHECK(Temperature_ToRaw(25.0f) == 2048U, "25 degC -> %u", Temperature_ToRaw(25.0f));
+
+    /* Round trip raw -> degC -> raw over the usable range. */
+    for (uint16_t raw = 1; raw <= 4094U; raw++) {
+        float t = Temperature_FromRawExact(raw);
+        uint16_t back = Temperature_ToRaw(t);
+        CHECK(back == raw, "raw %u -> %.4f degC -> %u", raw, t, back);
+    }
+
+    /* degC -> raw -> degC: the code is the nearest one. */
+    for (float t = -20.0f; t <= 150.0f; t += 0.25f) {
+        uint16_t raw = Temperature_ToRaw(t);
+        if (raw <= 1U || raw >= 4094U) continue;
+        float e  = fabsf(Temperature_FromRawExact(raw) - t);
+        float lo = fabsf(Temperature_FromRawExact((uint16_t)(raw + 1U)) - t);
+        float hi = fabsf(Temperature_FromRawExact((uint16_t)(raw - 1U)) - t);
+        CHECK(e <= lo + 1e-3f && e <= hi + 1e-3f,
+              "%.2f degC -> %u, neighbours closer", t, raw);
+    }
+
+    /* Clamped to the ADC range. */
+    CHECK(Temperature_ToRaw(-150.0f) == 4095U, "-150 degC -> %u", Temperature_ToRaw(-150.0f));
+    CHECK(Temperature_ToRaw(NAN) == 0U, "NaN -> %u", Temperature_ToRaw(NAN));
+
+    return CHECK_RESULT();
+}
@@ -0,0 +1,165 @@
+/**
+ * @file test_tlm_bin.c
+ * @brief Binary telemetry packets: COBS framing and CRC-32 against the PC decoder.
+ *
+ * The decoder here is a transcription of cobs_decode() and the CRC of
+ * pc_gui/binproto.py. Checks the CRC-32/MPEG-2 check value, COBS round
+ * trips across the 254-byte block boundary with and without zero bytes,
+ * the frame size bound of TLMB_FRAME_LEN(), and one packet byte for byte
+ * against the frame that binproto.py decodes to the same fields. A packet
+ * that overflowed, or an output buffer that is too small, gives no frame.
+ */
+
+#include "check.h"
+#include "crc32.h"
+#include "main.h"
+#include "tlm_bin.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define BUF_MAX  1024U
+
+/* binproto.crc32_mpeg2(), bitwise. */
+static uint32_t crc_ref(const uint8_t *d, size_t n)
+{
+    uint32_t crc = 0xFFFFFFFFUL;
+    for (size_t i = 0; i < n; i++) {
+        crc ^= (uint32_t)d[i] << 24;
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x80000000UL) ? (crc << 1) ^ 0x04C11DB7UL : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/* binproto.cobs_decode(). @return decoded length, -1 on a protocol error. */
+static int cobs_decode(const uint8_t *in, size_t n, uint8_t *out)
+{
+    size_t i = 0, o = 0;
+    while (i < n) {
+        uint8_t code = in[i];
+        if (code == 0U) return -1;
+        i++;
+        size_t end = i + code - 1U;
+        if (end > n) return -1;
+        memcpy(&out[o], &in[i], end - i);
+        o += end - i;
+        i = end;
+        if (code != 0xFFU && i < n) out[o++] = 0U;
+    }
+    return (int)o;
+}
+
+static void test_crc(void)
+{
+    static const uint8_t check[] = "123456789";
+    CHECK(CRC32_Compute(check, 9) == 0x0376E6E7UL, "check value 0x%08X, want 0x0376E6E7",
+          CRC32_Compute(check, 9));
+
+    /* Odd lengths and offsets: byte-wise input, no alignment needed. */
+    uint8_t buf[64];
+    for (unsigned i = 0; i < sizeof(buf); i++) buf[i] = (uint8_t)(i * 29U + 7U);
+    bool ok = true;
+    for (unsigned off = 0; off < 4U; off++) {
+        for (unsigned n = 0; n + off <= sizeof(buf); n += 5U) {
+            if (CRC32_Compute(&buf[off], n) != crc_ref(&buf[off], n)) ok = false;
+        }
+    }
+    CHECK(ok, "CRC differs from the reference");
+}
+
+static void test_cobs(void)
+{
+    static uint8_t in[BUF_MAX], enc[BUF_MAX + 8U], dec[BUF_MAX + 8U];
+
+    /* Vectors of the COBS paper. */
+    static const uint8_t z1[] = {0x00};
+    static const uint8_t z1_enc[] = {0x01, 0x01};
+    static const uint8_t v4[] = {0x11, 0x22, 0x00, 0x33};
+    static const uint8_t v4_enc[] = {0x03, 0x11, 0x22, 0x02, 0x33};
+    CHECK(COBS_Encode(z1, 1, enc) == 2U && memcmp(enc, z1_enc, 2) == 0, "encoding of 00");
+    CHECK(COBS_Encode(v4, 4, enc) == 5U && memcmp(enc, v4_enc, 5) == 0,
+          "encoding of 11 22 00 33");
+    CHECK(COBS_Encode(in, 0, enc) == 1U && enc[0] == 0x01U, "encoding of nothing");
+
+    /* 254 non-zero bytes fill one block exactly: code 0xFF, no zero. */
+    for (unsigned i = 0; i < 254U; i++) in[i] = (uint8_t)(i + 1U);
+    uint16_t n = COBS_Encode(in, 254, enc);
+    CHECK(enc[0] == 0xFFU && memcmp(&enc[1], in, 254) == 0, "254-byte block");
+    CHECK(cobs_decode(enc, n, dec) == 254 && memcmp(dec, in, 254) == 0, "254-byte round trip");
+
+    /* Random data, every length to 600, zero bytes rare to dense. */
+    srand(1);
+    bool ok = true, zero_free = true, bound = true;
+    for (unsigned density = 0; density < 4U; density++) {
+        for (uint16_t len = 0; len <= 600U; len++) {
+            for (uint16_t i = 0; i < len; i++) {
+                in[i] = (uint8_t)(rand() & 0xFF);
+                if (density > 0U && (rand() % (1 << (2U * density))) == 0) in[i] = 0U;
+                if (density == 0U && in[i] == 0U) in[i] = 1U;
+            }
+            n = COBS_Encode(in, len, enc);
+            if (n + 1U > TLMB_FRAME_LEN(len)) bound = false;
+            if (memchr(enc, 0, n) != NULL) zero_free = false;
+            if (cobs_decode(enc, n, dec) != (int)len || memcmp(dec, in, len) != 0) ok = false;
+        }
+    }
+    CHECK(ok, "round trip failed");
+    CHECK(zero_free, "zero byte inside an encoded frame");
+    CHECK(bound, "frame longer than TLMB_FRAME_LEN()");
+}
+
+/* Frame that binproto.parse_packet() decodes to type 1, seq 0x1234,
+   timestamp 16909060, T_meas 45.5, raw 2048, zone 0, drop 0,
+   jit_min -5, name "kp". */
+static const uint8_t golden[] = {
+    0x0C, 0x02, 0x01, 0x34, 0x12, 0x04, 0x03, 0x02, 0x01, 0x06, 0x01, 0x06,
+    0x01, 0x05, 0x36, 0x42, 0x05, 0x02, 0x04, 0x08, 0x0C, 0x01, 0x03, 0x0B,
+    0x03, 0x01, 0x01, 0x01, 0x10, 0x2A, 0x05, 0xFB, 0xFF, 0xFF, 0xFF, 0x35,
+    0x07, 0x02, 0x6B, 0x70, 0xB5, 0x14, 0x88, 0x7A, 0x00,
+};
+
+static void test_packet(void)
+{
+    tlmb_packet_t p;
+    uint8_t frame[TLMB_MAX_FRAME];
+
+    TLMB_Begin(&p, TLMB_TYPE_TELEMETRY, 0x1234U, 16909060UL);
+    TLMB_AddF32(&p, TLMB_F_T_MEAS, 45.5f);
+    TLMB_AddU16(&p, TLMB_F_RAW, 2048U);
+    TLMB_AddU8(&p, TLMB_F_ZONE, 0U);
+    TLMB_AddU32(&p, TLMB_F_DROPS, 0U);
+    TLMB_AddI32(&p, TLMB_F_PERF_JMIN, -5);
+    TLMB_AddStr(&p, TLMB_F_PAR_NAME, "kp");
+    uint16_t n = TLMB_Finish(&p, frame, sizeof(frame));
+    CHECK(n == sizeof(golden) && memcmp(frame, golden, sizeof(golden)) == 0,
+          "frame of %u bytes differs from binproto.py", n);
+
+    /* Decoded: the CRC over the body matches the one sent. */
+    uint8_t raw[TLMB_MAX_RAW];
+    int len = cobs_decode(frame, n - 1U, raw);
+    CHECK(len == 43, "decoded %d bytes, want 43", len);
+    if (len >= 4) {
+        uint32_t crc = (uint32_t)raw[len - 4] | ((uint32_t)raw[len - 3] << 8) |
+                       ((uint32_t)raw[len - 2] << 16) | ((uint32_t)raw[len - 1] << 24);
+        CHECK(crc == crc_ref(raw, (size_t)len - 4U), "CRC 0x%08X", crc);
+    }
+
+    /* Out of room: no frame. */
+    CHECK(TLMB_Finish(&p, frame, (uint16_t)(sizeof(golden) - 1U)) == 0U,
+          "frame written into a short buffer");
+    TLMB_Begin(&p, TLMB_TYPE_TELEMETRY, 0, 0);
+    for (unsigned i = 0; i < TLMB_MAX_RAW / 6U + 1U; i++) TLMB_AddF32(&p, TLMB_F_PWM, 1.0f);
+    CHECK(p.overflow && TLMB_Finish(&p, frame, sizeof(frame)) == 0U,
+          "overflowed packet framed");
+}
+
+int main(void)
+{
+    HALFAKE_Reset();
+    test_crc();
+    test_cobs();
+    test_packet();
+    return CHECK_RESULT();
+}
@@ -0,0 +1,150 @@
+/**
+ * @file test_tlm_stream.c
+ * @brief Telemetry stream: decimation, zone and field selection, drop count.
+ *
+ * Every decim-th sample must go out, one frame per selected zone with
+ * only the selected fields, numbered by the sample counter. A frame that
+ * does not fit into the transmit queue must be dropped and counted, the
+ * count reported in the next frame that goes out; Stream_Start() clears
+ * the counters and refuses empty selections. Frames are checked in the
+ * JSON protocol, the default of the UART.
+ */
+
+#include "check.h"
+#include "main.h"
+#include "tlm_stream.h"
+#include "uart_tx.h"
+#include "zone.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static ident_model_t model;
+static stream_sample_t smp[ZONE_COUNT];
+
+static char     out[16384];
+static uint32_t frames;
+
+static void start(void)
+{
+    HALFAKE_Reset();
+    UARTTX_Init();
+    Stream_Init();
+    for (uint8_t z = 0; z < ZONE_COUNT; z++) {
+        smp[z] = (stream_sample_t){
+            .zone = z, .t_meas = 40.0f + z, .raw = 2000U, .t_ref = 45.0f,
+            .pwm = 12.5f, .error = 5.0f - z, .i_term = 3.0f, .period_us = 100000U,
+            .exec_us = 50U, .model = &model,
+        };
+    }
+}
+
+/* Offer @p n samples with the queue drained after each. */
+static void offer(uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++) {
+        Stream_OnSample(smp, ZONE_COUNT);
+        HALFAKE_UART_Flush();
+    }
+}
+
+/* Take the output; count its frames (lines). */
+static void take(void)
+{
+    size_t n = HALFAKE_UART_TakeOutput((uint8_t *)out, sizeof(out) - 1U);
+    out[n] = '\0';
+    frames = 0;
+    for (const char *p = out; (p = strchr(p, '\n')) != NULL; p++) frames++;
+}
+
+static void test_decimation(void)
+{
+    start();
+    CHECK(Stream_Start(5, STREAM_F_ALL, STREAM_ZONES_ALL), "start refused");
+
+    offer(4);
+    take();
+    CHECK(frames == 0U, "%u frames before the 5th sample", frames);
+
+    offer(16);
+    take();
+    CHECK(frames == 4U * ZONE_COUNT, "%u frames for 20 samples at 1/5, want %u",
+          frames, 4U * ZONE_COUNT);
+    /* Numbered per sent sample, one frame per zone. */
+    CHECK(strstr(out, "{\"n\":0,") == out, "first frame not sample 0");
+    char key[32];
+    snprintf(key, sizeof(key), "\"n\":3,\"t\":0,\"zone\":%u,", ZONE_COUNT - 1U);
+    CHECK(strstr(out, key) != NULL, "no frame of sample 3, zone %u", ZONE_COUNT - 1U);
+    CHECK(strstr(out, "\"n\":4,") == NULL, "sample 4 sent");
+    CHECK(strstr(out, "\"K\":") != NULL && strstr(out, "\"drop\":0}") != NULL,
+          "model or drop count missing");
+
+    Stream_Stop();
+    offer(10);
+    take();
+    CHECK(frames == 0U && !Stream_IsActive(), "%u frames after the stop", frames);
+}
+
+static void test_selection(void)
+{
+    start();
+    CHECK(Stream_Start(1, STREAM_F_T_MEAS, 1U << (ZONE_COUNT - 1U)), "start refused");
+    offer(3);
+    take();
+    CHECK(frames == 3U, "%u frames for one zone, want 3", frames);
+
+    char want[64];
+    snprintf(want, sizeof(want), "{\"n\":0,\"t\":0,\"zone\":%u,\"T_meas\":%u.00,\"drop\":0}\r\n",
+             ZONE_COUNT - 1U, 40U + ZONE_COUNT - 1U);
+    CHECK(strncmp(out, want, strlen(want)) == 0, "frame %.60s, want %s", out, want);
+
+    /* Empty selections, unknown bits only, no decimation. */
+    CHECK(!Stream_Start(0, STREAM_F_ALL, STREAM_ZONES_ALL), "decimation 0 accepted");
+    CHECK(!Stream_Start(1, 0, STREAM_ZONES_ALL), "empty field mask accepted");
+    CHECK(!Stream_Start(1, 0xFE00U, STREAM_ZONES_ALL), "unknown fields only accepted");
+    CHECK(!Stream_Start(1, STREAM_F_ALL, 0), "empty zone mask accepted");
+    CHECK(!Stream_Start(1, STREAM_F_ALL, (uint16_t)~STREAM_ZONES_ALL), "missing zones only accepted");
+}
+
+static void test_drops(void)
+{
+    start();
+    CHECK(Stream_Start(1, STREAM_F_ALL, STREAM_ZONES_ALL), "start refused");
+
+    /* The link stalls: frames are queued until the buffer is full, the
+       rest of the samples are dropped. */
+    uint32_t n = 0;
+    while (Stream_GetDrops() == 0U && n < 100U) {
+        Stream_OnSample(smp, ZONE_COUNT);
+        n++;
+    }
+    CHECK(Stream_GetDrops() > 0U, "no drop with the link stalled");
+    for (uint32_t i = 0; i < 5U; i++) Stream_OnSample(smp, ZONE_COUNT);
+    const uint32_t drops = Stream_GetDrops();
+    CHECK(drops >= 5U * ZONE_COUNT, "%u drops, want at least %u", drops, 5U * ZONE_COUNT);
+
+    /* The link recovers: the next frame reports the count. */
+    HALFAKE_UART_Flush();
+    take();
+    offer(1);
+    take();
+    char key[32];
+    snprintf(key, sizeof(key), "\"drop\":%u}", drops);
+    CHECK(frames == ZONE_COUNT && strstr(out, key) != NULL, "drop count %u not reported", drops);
+
+    /* A restart clears the count and the numbering. */
+    CHECK(Stream_Start(1, STREAM_F_ALL, STREAM_ZONES_ALL), "restart refused");
+    CHECK(Stream_GetDrops() == 0U, "%u drops after the restart", Stream_GetDrops());
+    offer(1);
+    take();
+    CHECK(strstr(out, "{\"n\":0,") == out && strstr(out, "\"drop\":0}") != NULL,
+          "counters not cleared by the restart");
+}
+
+int main(void)
+{
+    test_decimation();
+    test_selection();
+    test_drops();
+    return CHECK_RESULT();
+}
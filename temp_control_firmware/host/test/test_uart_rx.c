@@ -0,0 +1,152 @@
+/**
+ * @file test_uart_rx.c
+ * @brief UART line reception: line assembler and line queue.
+ *
+ * Lines end at CR or LF (CRLF counts once, empty lines are skipped) and
+ * may arrive in pieces across idle events and across the wrap of the
+ * circular DMA buffer. A line of UARTRX_LINE_MAX - 1 characters is kept,
+ * a longer one is discarded and counted without disturbing the next.
+ * Lines beyond the queue depth are dropped and counted, the queued ones
+ * stay intact, and a UART error discards the partial line.
+ */
+
+#include "check.h"
+#include "main.h"
+#include "uart_rx.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static void start(void)
+{
+    HALFAKE_Reset();
+    UARTRX_Init();
+}
+
+static void send(const char *s)
+{
+    HALFAKE_UART_Inject(s, strlen(s));
+}
+
+/* Next line, or "" if none is pending. */
+static const char *line(void)
+{
+    static char buf[UARTRX_LINE_MAX];
+    if (!UARTRX_GetLine(buf, sizeof(buf))) buf[0] = '\0';
+    return buf;
+}
+
+static void test_terminators(void)
+{
+    start();
+    send("T0:45\rT1:50\nS10\r\n\r\n\nD0\n");
+    CHECK(strcmp(line(), "T0:45") == 0, "CR line");
+    CHECK(strcmp(line(), "T1:50") == 0, "LF line");
+    CHECK(strcmp(line(), "S10") == 0, "CRLF line");
+    CHECK(strcmp(line(), "D0") == 0, "line after empty lines");
+    CHECK(strcmp(line(), "") == 0, "empty line queued");
+
+    /* In pieces, each piece ending in an idle event. */
+    send("SET k");
+    CHECK(strcmp(line(), "") == 0, "partial line queued");
+    send("p:0 5.");
+    send("5\n");
+    CHECK(strcmp(line(), "SET kp:0 5.5") == 0, "line from three pieces");
+}
+
+static void test_wrap(void)
+{
+    char sent[32], got[UARTRX_LINE_MAX];
+    bool ok = true;
+
+    start();
+    /* 100 lines of 10 to 11 bytes: the DMA buffer wraps several times,
+       lines straddle the half and the end of it. */
+    for (int i = 0; i < 100; i++) {
+        int n = snprintf(sent, sizeof(sent), "L%02d,%05d\n", i, i * 37);
+        HALFAKE_UART_Inject(sent, (size_t)n / 2U);
+        HALFAKE_UART_Inject(&sent[n / 2], (size_t)n - (size_t)n / 2U);
+
+        sent[n - 1] = '\0';
+        if (!UARTRX_GetLine(got, sizeof(got)) || strcmp(got, sent) != 0) ok = false;
+    }
+    CHECK(ok, "line corrupted across the DMA wrap");
+}
+
+static void test_overlong(void)
+{
+    char s[UARTRX_LINE_MAX + 8];
+    uartrx_stats_t st;
+
+    start();
+    memset(s, 'a', UARTRX_LINE_MAX - 1U);
+    s[UARTRX_LINE_MAX - 1U] = '\n';
+    HALFAKE_UART_Inject(s, UARTRX_LINE_MAX);
+    CHECK(strlen(line()) == UARTRX_LINE_MAX - 1U, "longest line not kept");
+
+    memset(s, 'b', UARTRX_LINE_MAX);
+    s[UARTRX_LINE_MAX] = '\n';
+    HALFAKE_UART_Inject(s, UARTRX_LINE_MAX + 1U);
+    send("P?\n");
+    CHECK(strcmp(line(), "P?") == 0, "line after an overlong one");
+
+    UARTRX_GetStats(&st);
+    CHECK(st.overlong == 1U && st.lines == 2U, "overlong %u lines %u", st.overlong, st.lines);
+}
+
+static void test_queue_full(void)
+{
+    char s[16];
+    uartrx_stats_t st;
+
+    start();
+    for (unsigned i = 0; i < UARTRX_LINEQ_DEPTH + 3U; i++) {
+        snprintf(s, sizeof(s), "C%u\n", i);
+        send(s);
+    }
+    UARTRX_GetStats(&st);
+    CHECK(st.lines == UARTRX_LINEQ_DEPTH && st.lines_dropped == 3U, "lines %u dropped %u",
+          st.lines, st.lines_dropped);
+
+    /* The queued lines, oldest first; the newest were dropped. */
+    bool ok = true;
+    for (unsigned i = 0; i < UARTRX_LINEQ_DEPTH; i++) {
+        snprintf(s, sizeof(s), "C%u", i);
+        if (strcmp(line(), s) != 0) ok = false;
+    }
+    CHECK(ok, "queued lines changed by the drops");
+    CHECK(strcmp(line(), "") == 0, "more lines than the queue depth");
+
+    /* Room again. */
+    send("C99\n");
+    CHECK(strcmp(line(), "C99") == 0, "no line after the queue drained");
+
+    /* A small destination truncates, the line is consumed. */
+    char small[4];
+    send("ABCDEF\n");
+    CHECK(UARTRX_GetLine(small, sizeof(small)) && strcmp(small, "ABC") == 0, "truncated %s", small);
+    CHECK(strcmp(line(), "") == 0, "truncated line still queued");
+}
+
+static void test_error(void)
+{
+    uartrx_stats_t st;
+
+    start();
+    send("T0:4");
+    UARTRX_OnError();
+    send("T1:50\n");
+    CHECK(strcmp(line(), "T1:50") == 0, "partial line survived the error");
+    UARTRX_GetStats(&st);
+    CHECK(st.rx_errors == 1U, "%u errors", st.rx_errors);
+}
+
+int main(void)
+{
+    test_terminators();
+    test_wrap();
+    test_overlong();
+    test_queue_full();
+    test_error();
+    return CHECK_RESULT();
+}
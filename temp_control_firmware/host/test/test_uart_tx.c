@@ -0,0 +1,139 @@
+/**
+ * @file test_uart_tx.c
+ * @brief UART transmit queue: drop policy, wrap-around, error recovery.
+ *
+ * A message must be queued completely or dropped and counted, never cut
+ * and never overwriting queued bytes; the buffer holds at most
+ * UARTTX_BUF_SIZE - 1 bytes. The bytes must leave in order across the
+ * wrap of the ring, split into two DMA transfers there, and an aborted
+ * transfer must be discarded without stalling the queue.
+ */
+
+#include "check.h"
+#include "main.h"
+#include "uart_tx.h"
+
+#include <string.h>
+
+extern UART_HandleTypeDef huart3;
+
+#define OUT_MAX  8192U
+
+static uint8_t  out[OUT_MAX];
+static uint32_t out_n;
+static uint32_t transfers;
+
+static void sink(const uint8_t *data, uint16_t len)
+{
+    if (out_n + len <= OUT_MAX) memcpy(&out[out_n], data, len);
+    out_n += len;
+    transfers++;
+}
+
+static void start(void)
+{
+    HALFAKE_Reset();
+    HALFAKE_UART_SetSink(sink);
+    UARTTX_Init();
+    out_n = 0;
+    transfers = 0;
+}
+
+/* Message of @p len bytes counting up from @p first. */
+static const uint8_t *msg(uint8_t first, uint16_t len)
+{
+    static uint8_t buf[UARTTX_BUF_SIZE + 1U];
+    for (uint16_t i = 0; i < len; i++) buf[i] = (uint8_t)(first + i);
+    return buf;
+}
+
+static void test_drop(void)
+{
+    uarttx_stats_t st;
+
+    start();
+    CHECK(UARTTX_Free() == UARTTX_BUF_SIZE - 1U, "free %u when empty", UARTTX_Free());
+
+    /* The first message goes to DMA at once; the others queue behind it
+       while the transfer runs. */
+    CHECK(UARTTX_Write(msg(0, 400), 400), "message 1 dropped");
+    CHECK(UARTTX_Write(msg(100, 400), 400), "message 2 dropped");
+    CHECK(UARTTX_Free() == UARTTX_BUF_SIZE - 1U - 800U, "free %u", UARTTX_Free());
+
+    /* 300 bytes do not fit in 223: dropped whole, nothing written. */
+    CHECK(!UARTTX_Write(msg(200, 300), 300), "oversize message queued");
+    CHECK(UARTTX_Free() == UARTTX_BUF_SIZE - 1U - 800U, "free %u after the drop", UARTTX_Free());
+    /* Exactly the free space fits. */
+    CHECK(UARTTX_Write(msg(50, 223), 223), "message filling the buffer dropped");
+    CHECK(UARTTX_Free() == 0U, "free %u when full", UARTTX_Free());
+    CHECK(!UARTTX_Write(msg(0, 1), 1), "byte queued into a full buffer");
+
+    UARTTX_GetStats(&st);
+    CHECK(st.msgs_dropped == 2U && st.bytes_dropped == 301U, "dropped %u msgs %u bytes",
+          st.msgs_dropped, st.bytes_dropped);
+    CHECK(st.high_water == UARTTX_BUF_SIZE - 1U, "high water %u", st.high_water);
+
+    HALFAKE_UART_Flush();
+    CHECK(out_n == 1023U, "%u bytes sent, want 1023", out_n);
+    CHECK(memcmp(&out[0], msg(0, 400), 400) == 0, "message 1 corrupted");
+    CHECK(memcmp(&out[400], msg(100, 400), 400) == 0, "message 2 corrupted");
+    CHECK(memcmp(&out[800], msg(50, 223), 223) == 0, "message 3 corrupted");
+
+    UARTTX_GetStats(&st);
+    CHECK(st.bytes_sent == 1023U && st.bytes_queued == 1023U, "sent %u queued %u",
+          st.bytes_sent, st.bytes_queued);
+    CHECK(UARTTX_Free() == UARTTX_BUF_SIZE - 1U, "free %u after the flush", UARTTX_Free());
+
+    /* Larger than the whole buffer: never fits. */
+    CHECK(!UARTTX_Write(msg(0, UARTTX_BUF_SIZE), UARTTX_BUF_SIZE), "%u bytes queued",
+          UARTTX_BUF_SIZE);
+}
+
+static void test_wrap(void)
+{
+    start();
+
+    /* Move the indices to 1000, then queue 100 bytes across the end. */
+    CHECK(UARTTX_Write(msg(0, 1000), 1000), "fill dropped");
+    HALFAKE_UART_Flush();
+    out_n = 0;
+    transfers = 0;
+
+    CHECK(UARTTX_Write(msg(7, 100), 100), "wrapping message dropped");
+    HALFAKE_UART_Flush();
+    CHECK(out_n == 100U && memcmp(out, msg(7, 100), 100) == 0, "wrapped message corrupted");
+    CHECK(transfers == 2U, "%u transfers, want 2 (24 + 76 bytes)", transfers);
+}
+
+static void test_error(void)
+{
+    uarttx_stats_t st;
+
+    start();
+    CHECK(UARTTX_Write(msg(0, 50), 50), "message 1 dropped");
+    CHECK(UARTTX_Write(msg(100, 20), 20), "message 2 dropped");
+
+    /* Transfer of message 1 aborted, the HAL has returned the handle to
+       READY: the rest of it is discarded, message 2 goes next. */
+    huart3.gState = HAL_UART_STATE_READY;
+    UARTTX_OnError();
+    HALFAKE_UART_Flush();
+    CHECK(out_n == 20U && memcmp(out, msg(100, 20), 20) == 0, "%u bytes after the error", out_n);
+
+    UARTTX_GetStats(&st);
+    CHECK(st.tx_errors == 1U, "%u errors", st.tx_errors);
+    CHECK(UARTTX_Free() == UARTTX_BUF_SIZE - 1U, "free %u, aborted bytes kept", UARTTX_Free());
+
+    /* Idle: an error report changes nothing. */
+    UARTTX_OnError();
+    UARTTX_GetStats(&st);
+    CHECK(st.tx_errors == 1U, "error counted while idle");
+}
+
+int main(void)
+{
+    test_drop();
+    test_wrap();
+    test_error();
+    return CHECK_RESULT();
+}
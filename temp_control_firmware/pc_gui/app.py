@@ -2,7 +2,7 @@ import json
 import time
 import threading
 import tkinter as tk
-from tkinter import ttk, messagebox
+from tkinter import ttk, messagebox, filedialog
 
 # Optional serial
 try:
@@ -11,6 +11,11 @@ try:
 except Exception:
     serial = None
 
+import binproto
+
+# Heated zones in the firmware (config.h ZONE_ACTIVE_COUNT)
+ZONE_COUNT = 4
+
 # Plot
 import matplotlib
 matplotlib.use("TkAgg")
@@ -25,6 +30,12 @@ class TelemetrySource:
     def is_connected(self) -> bool: raise NotImplementedError
     def set_setpoint(self, t_ref_c: float): raise NotImplementedError
     def read_telemetry(self) -> dict: raise NotImplementedError
+    def autotune(self, rule: str): raise NotImplementedError
+    def feed_forward(self, on: bool): raise NotImplementedError
+    def smith(self, on: bool): raise NotImplementedError
+    def run_profile(self, segments: list): raise NotImplementedError
+    def list_params(self) -> dict: raise NotImplementedError
+    def set_param(self, name: str, value: float, zone: int | None = None): raise NotImplementedError
 
 
 class DemoSource(TelemetrySource):
@@ -49,6 +60,24 @@ class DemoSource(TelemetrySource):
     def set_setpoint(self, t_ref_c: float):
         self.t_ref = float(t_ref_c)
 
+    def autotune(self, rule: str):
+        pass  # the fake controller has no gains to tune
+
+    def feed_forward(self, on: bool):
+        pass
+
+    def smith(self, on: bool):
+        pass
+
+    def run_profile(self, segments: list):
+        pass  # the fake controller only follows T_ref
+
+    def list_params(self) -> dict:
+        return {}  # no parameter registry
+
+    def set_param(self, name: str, value: float, zone: int | None = None):
+        pass
+
     def read_telemetry(self) -> dict:
         # Simple first-order thermal response with PI-like behavior (fake)
         now = time.time()
@@ -72,23 +101,46 @@ class DemoSource(TelemetrySource):
 
 class SerialSource(TelemetrySource):
     """
-    Protocol (NO CRC):
-      Setpoint:           "T35.0\\n"
-      Telemetry request:  "?\\n"
-      Response:           '{"T_meas":..,"T_ref":..,"PWM":..}\\r\\n'
+    Protocol:
+      Setpoint:           "T<zone>:35.0\\n"
+      Telemetry request:  "?<zone>\\n"
+      Diagnostics report: "D<zone>\\n"
+      Autotune:           "U<zone>:<rule>\\n", rule Z/T/S, X stops
+      Protocol select:    "M0\\n" (JSON) / "M1\\n" (binary)
+      Response, JSON:     '{"zone":..,"T_meas":..,"T_ref":..,"PWM":..,
+                            "Kp":..,"Ki":..,"prof":..,"seg":..,
+                            "seg_t":..}\\r\\n' (NO CRC)
+      Diagnostics, JSON:  '{"diag":..,"tune":..,"K":..,"tau":..,"dead":..,
+                            "K_rsd":..,"tau_rsd":..,"id":..,"ff":..,
+                            "T_amb":..,"sp":..,"res":..,"res_rms":..}\\r\\n'
+      Model reference:    "I<zone>:R\\n"
+      Feed-forward:       "F<zone>:<0|1>\\n"
+      Smith predictor:    "P<zone>:<0|1>\\n"
+      Setpoint profile:   "R<zone>:C\\n", then "R<zone>:A<rate>,<target>,<hold>
+                          [,<loop_to>,<repeat>]\\n" per segment, "R<zone>:G\\n"
+      Parameters:         "LIST\\n", one '{"par":..,"name":..,"unit":..,
+                          "dtype":..,"flags":..,"min":..,"max":..,"def":..,
+                          "val":[..]}' line each; "SET <name>[:<zone>] <v>\\n"
+      Response, binary:   COBS frame with CRC-32, see binproto.py
     """
-    def __init__(self, port: str, baud: int = 115200, timeout: float = 0.5):
+    def __init__(self, port: str, baud: int = 115200, timeout: float = 0.5,
+                 binary: bool = False):
         if serial is None:
             raise RuntimeError("pyserial is not installed")
         self.port = port
         self.baud = baud
         self.timeout = timeout
+        self.binary = binary
+        self.zone = 0
         self.ser = None
         self._connected = False
+        self._reader = binproto.FrameReader()
 
     def connect(self):
         self.ser = serial.Serial(self.port, self.baud, timeout=self.timeout)
         self._connected = True
+        self.ser.write(b"M1\n" if self.binary else b"M0\n")
+        time.sleep(0.05)
         self.ser.reset_input_buffer()
         self.ser.reset_output_buffer()
 
@@ -107,9 +159,73 @@ class SerialSource(TelemetrySource):
     def set_setpoint(self, t_ref_c: float):
         if not self.is_connected():
             return
-        msg = f"T{float(t_ref_c):.1f}\n"
+        msg = f"T{self.zone}:{float(t_ref_c):.1f}\n"
         self.ser.write(msg.encode("ascii"))
 
+    def autotune(self, rule: str):
+        if not self.is_connected():
+            return
+        self.ser.write(f"U{self.zone}:{rule}\n".encode("ascii"))
+
+    def feed_forward(self, on: bool):
+        if not self.is_connected():
+            return
+        self.ser.write(f"F{self.zone}:{1 if on else 0}\n".encode("ascii"))
+
+    def smith(self, on: bool):
+        if not self.is_connected():
+            return
+        self.ser.write(f"P{self.zone}:{1 if on else 0}\n".encode("ascii"))
+
+    def run_profile(self, segments: list):
+        if not self.is_connected():
+            return
+        lines = [f"R{self.zone}:C"]
+        for seg in segments:
+            lines.append(f"R{self.zone}:A" + ",".join(f"{v:g}" for v in seg))
+        lines.append(f"R{self.zone}:G")
+        for line in lines:
+            self.ser.write((line + "\n").encode("ascii"))
+            time.sleep(0.02)  # one command per UART task period
+
+    def list_params(self) -> dict:
+        """Parameter registry of the firmware, name -> descriptor dict.
+
+        "val" is always a list, one value per zone for zone parameters
+        (flags bit 0).
+        """
+        if not self.is_connected():
+            return {}
+        self.ser.write(b"LIST\n")
+        params = {}
+        # Ends when the device goes quiet; stream frames may be interleaved.
+        for _ in range(200):
+            if self.binary:
+                data = self.ser.read_until(b"\x00")
+                if not data:
+                    break
+                found = [p for p in self._reader.feed(data)
+                         if p["type"] == binproto.TYPE_PARAM]
+            else:
+                line = self.ser.readline().decode("ascii", errors="ignore").strip()
+                if not line:
+                    break
+                try:
+                    found = [json.loads(line)] if line.startswith('{"par"') else []
+                except ValueError:
+                    continue
+            for p in found:
+                if not isinstance(p["val"], list):
+                    p["val"] = [p["val"]]
+                params[p["name"]] = p
+        return params
+
+    def set_param(self, name: str, value: float, zone: int | None = None):
+        if not self.is_connected():
+            return
+        target = name if zone is None else f"{name}:{zone}"
+        self.ser.write(f"SET {target} {value:g}\n".encode("ascii"))
+
     def _read_line(self, max_lines: int = 5) -> str | None:
         if not self.is_connected():
             return None
@@ -119,15 +235,38 @@ class SerialSource(TelemetrySource):
                 return line
         return None
 
+    def _read_binary(self) -> dict:
+        # Skip ACK packets until the telemetry and diagnostics packets arrive
+        tlm, diag = {}, {}
+        for _ in range(8):
+            data = self.ser.read_until(b"\x00")
+            if not data:
+                continue
+            for pkt in self._reader.feed(data):
+                if pkt.get("zone", 0) != self.zone:
+                    continue
+                if pkt["type"] == binproto.TYPE_TELEMETRY:
+                    tlm = pkt
+                elif pkt["type"] == binproto.TYPE_DIAG:
+                    diag = pkt
+            if tlm and diag:
+                break
+        return {**diag, **tlm} if tlm else {}
+
     def read_telemetry(self) -> dict:
+        """Telemetry of the selected zone with its diagnostics report."""
         if not self.is_connected():
             return {}
 
-        # Request telemetry
-        self.ser.write(b"?\n")
+        # Request telemetry and the model diagnostics
+        self.ser.write(f"?{self.zone}\nD{self.zone}\n".encode("ascii"))
+
+        if self.binary:
+            return self._read_binary()
 
         # Try a few lines because device might send OK/ERR before JSON
-        for _ in range(5):
+        tlm, diag = {}, {}
+        for _ in range(8):
             line = self._read_line(max_lines=1)
             if not line:
                 continue
@@ -137,11 +276,18 @@ class SerialSource(TelemetrySource):
                 continue
 
             try:
-                return json.loads(line)
+                msg = json.loads(line)
             except Exception:
                 continue
+            # stream frames of other zones may be interleaved
+            if msg.get("diag", -1) == self.zone:
+                diag = msg
+            elif msg.get("zone", -1) == self.zone:
+                tlm = msg
+            if tlm and diag:
+                break
 
-        return {}
+        return {**diag, **tlm} if tlm else {}
 
 
 class App(tk.Tk):
@@ -160,6 +306,9 @@ class App(tk.Tk):
         self.t_meas = []
         self.t_ref = []
 
+        # Firmware parameter registry, read on connect (name -> descriptor)
+        self.params = {}
+
         self._build_ui()
         self._refresh_ports()
 
@@ -184,9 +333,21 @@ class App(tk.Tk):
 
         ttk.Button(top, text="Refresh", command=self._refresh_ports).pack(side="left", padx=5)
 
+        self.binary_var = tk.BooleanVar(value=False)
+        ttk.Checkbutton(top, text="Binary", variable=self.binary_var).pack(side="left", padx=5)
+
         self.conn_btn = ttk.Button(top, text="Connect", command=self._toggle_connect)
         self.conn_btn.pack(side="left", padx=10)
 
+        # Zone selection (firmware ZONE_COUNT)
+        ttk.Label(top, text="Zone:").pack(side="left", padx=(20, 5))
+        self.zone_var = tk.StringVar(value="0")
+        zone_combo = ttk.Combobox(top, textvariable=self.zone_var, width=3,
+                                  values=[str(z) for z in range(ZONE_COUNT)],
+                                  state="readonly")
+        zone_combo.pack(side="left")
+        zone_combo.bind("<<ComboboxSelected>>", self._on_zone_change)
+
         # Setpoint controls
         ttk.Label(top, text="Setpoint (°C):").pack(side="left", padx=(20, 5))
         self.set_var = tk.StringVar(value="35.0")
@@ -194,6 +355,28 @@ class App(tk.Tk):
         self.set_entry.pack(side="left")
         ttk.Button(top, text="Set", command=self._send_setpoint).pack(side="left", padx=5)
 
+        # Relay autotune: rule letter as in the firmware command
+        self.rule_var = tk.StringVar(value="T")
+        ttk.Combobox(top, textvariable=self.rule_var, width=3, values=["Z", "T", "S"],
+                     state="readonly").pack(side="left", padx=(20, 5))
+        ttk.Button(top, text="Autotune", command=self._start_autotune).pack(side="left")
+
+        # Static feed-forward of the selected zone
+        self.ff_var = tk.BooleanVar(value=False)
+        ttk.Checkbutton(top, text="Feed-forward", variable=self.ff_var,
+                        command=self._send_feed_forward).pack(side="left", padx=(20, 0))
+
+        # Smith predictor of the selected zone (dead-time dominated zones)
+        self.smith_var = tk.BooleanVar(value=False)
+        ttk.Checkbutton(top, text="Smith predictor", variable=self.smith_var,
+                        command=self._send_smith).pack(side="left", padx=(10, 0))
+
+        # Setpoint profile from a CSV file (see sim/temp_setpoint_staircase_profile.csv)
+        ttk.Button(top, text="Profile...", command=self._load_profile).pack(side="left", padx=(20, 0))
+
+        # Firmware parameter registry (LIST / SET)
+        ttk.Button(top, text="Parameters...", command=self._show_params).pack(side="left", padx=(10, 0))
+
         # Middle: telemetry labels
         mid = ttk.Frame(self, padding=(10, 0, 10, 10))
         mid.pack(fill="x")
@@ -201,11 +384,15 @@ class App(tk.Tk):
         self.lbl_meas = ttk.Label(mid, text="T_meas: -- °C", font=("Segoe UI", 12))
         self.lbl_ref  = ttk.Label(mid, text="T_ref: -- °C",  font=("Segoe UI", 12))
         self.lbl_pwm  = ttk.Label(mid, text="PWM: -- %",     font=("Segoe UI", 12))
+        self.lbl_gains = ttk.Label(mid, text="Kp: --  Ki: --")
+        self.lbl_model = ttk.Label(mid, text="Model: --")
         self.lbl_status = ttk.Label(mid, text="Status: disconnected", foreground="gray")
 
         self.lbl_meas.pack(side="left", padx=10)
         self.lbl_ref.pack(side="left", padx=10)
         self.lbl_pwm.pack(side="left", padx=10)
+        self.lbl_gains.pack(side="left", padx=10)
+        self.lbl_model.pack(side="left", padx=10)
         self.lbl_status.pack(side="right")
 
         # Plot area
@@ -258,9 +445,12 @@ class App(tk.Tk):
                 if not port:
                     messagebox.showerror("Port", "Select a COM port first.")
                     return
-                self.source = SerialSource(port=port, baud=115200)
+                self.source = SerialSource(port=port, baud=115200,
+                                           binary=self.binary_var.get())
+                self.source.zone = int(self.zone_var.get())
                 self.source.connect()
 
+            self.params = self.source.list_params()
             self._update_conn_ui(True)
         except Exception as e:
             messagebox.showerror("Connect failed", str(e))
@@ -273,6 +463,12 @@ class App(tk.Tk):
             foreground=("green" if connected else "gray"),
         )
 
+    def _on_zone_change(self, _event=None):
+        if isinstance(self.source, SerialSource):
+            self.source.zone = int(self.zone_var.get())
+        # the plot shows one zone; start it over
+        self.ts, self.t_meas, self.t_ref = [], [], []
+
     def _send_setpoint(self):
         try:
             t_ref = float(self.set_var.get())
@@ -280,12 +476,109 @@ class App(tk.Tk):
             messagebox.showerror("Setpoint", "Enter a valid number, e.g. 35.0")
             return
 
-        # Optional clamp for your chosen range
-        t_ref = max(30.0, min(60.0, t_ref))
+        # Setpoint range of the zone, as the firmware clamps it
+        lo, hi = self._param_value("sp_min"), self._param_value("sp_max")
+        if lo is not None and hi is not None:
+            t_ref = max(lo, min(hi, t_ref))
         self.set_var.set(f"{t_ref:.1f}")
         if self.source.is_connected():
             self.source.set_setpoint(t_ref)
 
+    def _param_value(self, name: str):
+        """Value of a registry parameter for the selected zone, None if unknown."""
+        p = self.params.get(name)
+        if p is None:
+            return None
+        vals = p["val"]
+        zone = int(self.zone_var.get())
+        return float(vals[zone] if zone < len(vals) else vals[0])
+
+    def _show_params(self):
+        win = tk.Toplevel(self)
+        win.title("Parameters")
+        cols = ("unit", "min", "max", "def", "val")
+        tree = ttk.Treeview(win, columns=cols, height=16)
+        tree.heading("#0", text="name")
+        for c in cols:
+            tree.heading(c, text=c)
+            tree.column(c, width=90 if c != "val" else 240, anchor="e")
+        tree.pack(fill="both", expand=True, padx=10, pady=10)
+
+        def fill():
+            tree.delete(*tree.get_children())
+            for name, p in sorted(self.params.items(), key=lambda kv: kv[1]["par"]):
+                ro = " (read only)" if p["flags"] & 0x02 else ""
+                tree.insert("", "end", iid=name, text=name + ro,
+                            values=(p["unit"], f"{p['min']:g}", f"{p['max']:g}",
+                                    f"{p['def']:g}", " ".join(f"{v:g}" for v in p["val"])))
+
+        def refresh():
+            self.params = self.source.list_params()
+            fill()
+
+        def set_selected():
+            sel = tree.selection()
+            if not sel or not self.source.is_connected():
+                return
+            try:
+                value = float(value_var.get())
+            except ValueError:
+                messagebox.showerror("Parameter", "Enter a valid number", parent=win)
+                return
+            p = self.params[sel[0]]
+            zone = int(self.zone_var.get()) if p["flags"] & 0x01 else None
+            self.source.set_param(sel[0], value, zone)
+            # applied at the next control step
+            win.after(300, refresh)
+
+        bottom = ttk.Frame(win, padding=(10, 0, 10, 10))
+        bottom.pack(fill="x")
+        value_var = tk.StringVar()
+        ttk.Label(bottom, text="Value (selected zone):").pack(side="left")
+        ttk.Entry(bottom, textvariable=value_var, width=10).pack(side="left", padx=5)
+        ttk.Button(bottom, text="Set", command=set_selected).pack(side="left")
+        ttk.Button(bottom, text="Refresh", command=refresh).pack(side="right")
+        fill()
+
+    def _start_autotune(self):
+        if self.source.is_connected():
+            self.source.autotune(self.rule_var.get())
+
+    def _send_feed_forward(self):
+        if self.source.is_connected():
+            self.source.feed_forward(self.ff_var.get())
+
+    def _send_smith(self):
+        if self.source.is_connected():
+            self.source.smith(self.smith_var.get())
+
+    def _load_profile(self):
+        path = filedialog.askopenfilename(title="Setpoint profile",
+                                          filetypes=[("CSV", "*.csv"), ("All files", "*.*")])
+        if not path:
+            return
+        segments = []
+        try:
+            with open(path) as f:
+                for line in f:
+                    line = line.split("#", 1)[0].strip()
+                    if not line:
+                        continue
+                    try:
+                        seg = [float(v) for v in line.split(",")]
+                    except ValueError:
+                        if segments:
+                            raise
+                        continue  # header
+                    if len(seg) not in (3, 5):
+                        raise ValueError(f"expected 3 or 5 values: {line}")
+                    segments.append(seg)
+        except (OSError, ValueError) as e:
+            messagebox.showerror("Profile", str(e))
+            return
+        if self.source.is_connected():
+            self.source.run_profile(segments)
+
     def _ui_tick(self):
         # Poll and update UI
         if self.source.is_connected():
@@ -296,8 +589,38 @@ class App(tk.Tk):
                 pwm    = float(tlm.get("PWM", 0.0))
 
                 self.lbl_meas.configure(text=f"T_meas: {t_meas:.2f} °C")
-                self.lbl_ref.configure(text=f"T_ref: {t_ref:.2f} °C")
+                text = f"T_ref: {t_ref:.2f} °C"
+                # prof: 1 running, 2 paused (profile.h)
+                if int(tlm.get("prof", 0)) in (1, 2):
+                    text += f" (segment {int(tlm['seg'])}, {float(tlm['seg_t']):.0f} s)"
+                self.lbl_ref.configure(text=text)
                 self.lbl_pwm.configure(text=f"PWM: {pwm:.1f} %")
+                if "Kp" in tlm:
+                    # tune: 1 running, 3 failed, 4 aborted (autotune.h)
+                    state = {1: " (tuning)", 3: " (tune failed)", 4: " (tune stopped)"}
+                    self.lbl_gains.configure(
+                        text=f"Kp: {float(tlm['Kp']):.3g}  Ki: {float(tlm['Ki']):.3g}"
+                             + state.get(int(tlm.get("tune", 0)), ""))
+                if "id" in tlm:
+                    # id flags: 1 valid, 2 gain drift, 4 tau drift (ident.h)
+                    flags = int(tlm["id"])
+                    if flags & 1:
+                        text = (f"Model: K {float(tlm['K']):.3f} °C/%  "
+                                f"tau {float(tlm['tau']):.1f} s  L {float(tlm['dead']):.1f} s")
+                        if flags & 6:
+                            text += "  DRIFT"
+                    else:
+                        text = "Model: identifying"
+                    if "ff" in tlm:
+                        text += f"  FF {float(tlm['ff']):.1f} %  amb {float(tlm['T_amb']):.1f} °C"
+                    # sp: 1 predictor on, 2 model mismatch (smith.h)
+                    sp = int(tlm.get("sp", 0))
+                    if sp & 1:
+                        text += f"  Smith res {float(tlm['res_rms']):.2f} °C rms"
+                        if sp & 2:
+                            text += " MISMATCH"
+                    self.lbl_model.configure(text=text,
+                                             foreground=("red" if flags & 6 or sp & 2 else ""))
 
                 # Update plot data
                 t = time.time() - self.t0
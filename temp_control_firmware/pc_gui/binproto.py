@@ -0,0 +1,221 @@
+"""
+Decoder for the firmware's binary telemetry protocol (tlm_bin.h).
+
+Frame on the wire: COBS(packet + CRC32) followed by a single 0x00 byte.
+
+Packet (little endian):
+  u8 version, u8 type, u16 seq, u32 timestamp_ms, u8 nfields,
+  nfields * (u8 id, u8 value_type, value), u32 CRC-32/MPEG-2
+
+A STR value is a u8 length followed by that many ASCII characters.
+"""
+import struct
+
+VERSION = 2  # tlm_bin.h TLMB_VERSION; 2 added VT_STR
+
+TYPE_TELEMETRY = 1
+TYPE_ACK = 2
+TYPE_TUNE = 3
+TYPE_PERF = 4
+TYPE_TRACE = 5
+TYPE_PARAM = 6
+TYPE_DIAG = 7
+
+VT_STR = 7
+
+# value type -> struct format
+_VTYPES = {
+    1: "<B",  # U8
+    2: "<H",  # U16
+    3: "<I",  # U32
+    4: "<h",  # I16
+    5: "<i",  # I32
+    6: "<f",  # F32
+}
+
+# field id -> key used in telemetry dicts (same keys as the JSON mode)
+FIELD_NAMES = {
+    1: "T_meas",
+    2: "T_ref",
+    3: "PWM",
+    4: "status",
+    5: "raw",
+    6: "err",
+    7: "I",
+    8: "fan",
+    9: "dt_us",
+    10: "exec_us",
+    11: "drop",
+    12: "zone",
+    13: "Kp",
+    14: "Ki",
+    15: "tune",
+    16: "rule",
+    17: "Ku",
+    18: "Pu",
+    19: "amp",
+    20: "L",
+    21: "K",
+    22: "tau",
+    23: "dead",
+    24: "K_rsd",
+    25: "tau_rsd",
+    26: "id",
+    27: "ff",
+    28: "T_amb",
+    29: "sp",
+    30: "res",
+    31: "res_rms",
+    32: "prof",
+    33: "seg",
+    34: "seg_t",
+    35: "sec",
+    36: "n",
+    37: "min",
+    38: "max",
+    39: "mean",
+    40: "hist",
+    41: "hz",
+    42: "jit_min",
+    43: "jit_max",
+    44: "over",
+    45: "trace",
+    46: "lost",
+    47: "mask",
+    48: "t",
+    49: "ev",
+    50: "ctx",
+    51: "arg",
+    52: "par",
+    53: "name",
+    54: "unit",
+    55: "dtype",
+    56: "flags",
+    57: "min",
+    58: "max",
+    59: "def",
+    60: "val",
+}
+
+
+class ProtocolError(Exception):
+    pass
+
+
+def cobs_decode(data: bytes) -> bytes:
+    out = bytearray()
+    i = 0
+    n = len(data)
+    while i < n:
+        code = data[i]
+        if code == 0:
+            raise ProtocolError("zero byte inside COBS frame")
+        i += 1
+        end = i + code - 1
+        if end > n:
+            raise ProtocolError("truncated COBS frame")
+        out += data[i:end]
+        i = end
+        if code != 0xFF and i < n:
+            out.append(0)
+    return bytes(out)
+
+
+def _make_crc_table():
+    table = []
+    for b in range(256):
+        c = b << 24
+        for _ in range(8):
+            c = ((c << 1) ^ 0x04C11DB7) if (c & 0x80000000) else (c << 1)
+        table.append(c & 0xFFFFFFFF)
+    return table
+
+
+_CRC_TABLE = _make_crc_table()
+
+
+def crc32_mpeg2(data: bytes) -> int:
+    """CRC-32/MPEG-2, as computed by the STM32 CRC unit in its reset config."""
+    crc = 0xFFFFFFFF
+    for b in data:
+        crc = ((crc << 8) & 0xFFFFFFFF) ^ _CRC_TABLE[((crc >> 24) ^ b) & 0xFF]
+    return crc
+
+
+def parse_packet(frame: bytes) -> dict:
+    """
+    Decode one frame (without the 0x00 delimiter).
+
+    Returns a dict with "type", "seq", "timestamp_ms" and one entry per
+    field, named from FIELD_NAMES or "f<id>" for unknown ids. A field that
+    occurs more than once (the "hist" bins, the "val" of every zone) gives
+    a list in packet order.
+    """
+    raw = cobs_decode(frame)
+    if len(raw) < 13:
+        raise ProtocolError("packet too short")
+
+    body, crc = raw[:-4], struct.unpack("<I", raw[-4:])[0]
+    if crc32_mpeg2(body) != crc:
+        raise ProtocolError("CRC mismatch")
+
+    version, ptype, seq, ts, nfields = struct.unpack_from("<BBHIB", body, 0)
+    if version != VERSION:
+        raise ProtocolError(f"unsupported version {version}")
+
+    pkt = {"type": ptype, "seq": seq, "timestamp_ms": ts}
+    pos = 9
+    for _ in range(nfields):
+        if pos + 2 > len(body):
+            raise ProtocolError("truncated field header")
+        fid, vtype = body[pos], body[pos + 1]
+        if vtype == VT_STR:
+            if pos + 3 > len(body):
+                raise ProtocolError("truncated field value")
+            size = 1 + body[pos + 2]
+            if pos + 2 + size > len(body):
+                raise ProtocolError("truncated field value")
+            value = body[pos + 3:pos + 2 + size].decode("ascii", "replace")
+        else:
+            fmt = _VTYPES.get(vtype)
+            if fmt is None:
+                raise ProtocolError(f"unknown value type {vtype}")
+            size = struct.calcsize(fmt)
+            if pos + 2 + size > len(body):
+                raise ProtocolError("truncated field value")
+            (value,) = struct.unpack_from(fmt, body, pos + 2)
+        key = FIELD_NAMES.get(fid, f"f{fid}")
+        if key in pkt:
+            if not isinstance(pkt[key], list):
+                pkt[key] = [pkt[key]]
+            pkt[key].append(value)
+        else:
+            pkt[key] = value
+        pos += 2 + size
+
+    return pkt
+
+
+class FrameReader:
+    """Splits a byte stream into frames on 0x00 and decodes them."""
+
+    def __init__(self):
+        self._buf = bytearray()
+        self.errors = 0
+
+    def feed(self, data: bytes) -> list:
+        self._buf += data
+        packets = []
+        while True:
+            idx = self._buf.find(b"\x00")
+            if idx < 0:
+                break
+            frame = bytes(self._buf[:idx])
+            del self._buf[:idx + 1]
+            if not frame:
+                continue
+            try:
+                packets.append(parse_packet(frame))
+            except ProtocolError:
+                self.errors += 1
+        return packets
@@ -0,0 +1,143 @@
+"""
+Generate the NTC ADC-to-temperature lookup table (Core/Src/ntc_lut.c).
+
+The table is computed from the Beta model constants in Core/Inc/config.h
+(R_FIXED, NTC_BETA, NTC_R0, NTC_T0_K), using the same divider equation as
+Temperature_FromRawExact(). Entry i holds the temperature at raw code
+(i << shift); the firmware interpolates linearly between entries.
+
+Usage:
+  python tools/gen_ntc_lut.py [--shift N] [--check]
+
+  --shift N  table density: one entry every 2^N ADC codes (3..7, default 5)
+  --check    print the interpolation error against the exact model over
+             0..80 degC instead of writing the file
+
+Re-run this script after changing the NTC constants or NTC_LUT_SHIFT.
+"""
+
+import argparse
+import math
+import os
+import re
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(HERE)
+CONFIG_H = os.path.join(ROOT, "Core", "Inc", "config.h")
+NTC_LUT_H = os.path.join(ROOT, "Core", "Inc", "ntc_lut.h")
+OUT_C = os.path.join(ROOT, "Core", "Src", "ntc_lut.c")
+
+ADC_CODES = 4096
+RAW_MIN, RAW_MAX = 1, 4094   # same clamp as the exact conversion
+
+
+def read_config():
+    text = open(CONFIG_H, encoding="utf-8").read()
+    cfg = {}
+    for name in ("R_FIXED", "NTC_BETA", "NTC_R0", "NTC_T0_K"):
+        m = re.search(r"#define\s+%s\s+\(?([0-9.eE+-]+)f?\)?" % name, text)
+        if not m:
+            sys.exit("config.h: %s not found" % name)
+        cfg[name] = float(m.group(1).rstrip("f"))
+    return cfg
+
+
+def read_default_shift():
+    text = open(NTC_LUT_H, encoding="utf-8").read()
+    m = re.search(r"#define\s+NTC_LUT_SHIFT\s+(\d+)", text)
+    return int(m.group(1)) if m else 5
+
+
+def temp_exact(raw, cfg):
+    raw = min(max(raw, RAW_MIN), RAW_MAX)
+    ratio = raw / 4095.0
+    r_ntc = cfg["R_FIXED"] * (ratio / (1.0 - ratio))
+    inv_t = 1.0 / cfg["NTC_T0_K"] + math.log(r_ntc / cfg["NTC_R0"]) / cfg["NTC_BETA"]
+    return 1.0 / inv_t - 273.15
+
+
+def build_table(shift, cfg):
+    n = (ADC_CODES >> shift) + 1
+    return [temp_exact(i << shift, cfg) for i in range(n)]
+
+
+def interp(table, shift, raw):
+    i = raw >> shift
+    frac = (raw & ((1 << shift) - 1)) / float(1 << shift)
+    return table[i] + (table[i + 1] - table[i]) * frac
+
+
+def check(shift, cfg):
+    table = build_table(shift, cfg)
+    worst, worst_raw = 0.0, 0
+    for raw in range(RAW_MIN, RAW_MAX + 1):
+        t = temp_exact(raw, cfg)
+        if not 0.0 <= t <= 80.0:
+            continue
+        err = abs(interp(table, shift, raw) - t)
+        if err > worst:
+            worst, worst_raw = err, raw
+    print("shift %d: %d entries (%d bytes), max |error| 0..80 degC = %.4f degC at raw %d"
+          % (shift, len(table), 4 * len(table), worst, worst_raw))
+
+
+def write_c(shift, cfg):
+    table = build_table(shift, cfg)
+    rows = []
+    for i in range(0, len(table), 4):
+        rows.append("    " + " ".join("%11.5ff," % v for v in table[i:i + 4]))
+    out = """/**
+ * @file ntc_lut.c
+ * @brief NTC ADC-to-temperature lookup table.
+ *
+ * Generated by tools/gen_ntc_lut.py from the Beta model in config.h.
+ * Do not edit by hand, re-run the generator instead.
+ *
+ * R_FIXED = {R_FIXED:g}, NTC_BETA = {NTC_BETA:g}, NTC_R0 = {NTC_R0:g}, NTC_T0_K = {NTC_T0_K:g}
+ */
+
+#include "ntc_lut.h"
+#include "config.h"
+
+#if NTC_LUT_SHIFT != {shift}
+#error "ntc_lut.c was generated for a different NTC_LUT_SHIFT, re-run tools/gen_ntc_lut.py"
+#endif
+
+_Static_assert((int)R_FIXED == {R_FIXED_i} && (int)NTC_BETA == {NTC_BETA_i} &&
+               (int)NTC_R0 == {NTC_R0_i} && (int)(NTC_T0_K * 100.0f + 0.5f) == {NTC_T0_i},
+               "NTC constants changed, re-run tools/gen_ntc_lut.py");
+
+const float ntc_lut_c[NTC_LUT_SIZE] = {{
+{rows}
+}};
+""".format(shift=shift, rows="\n".join(rows),
+           R_FIXED_i=int(cfg["R_FIXED"]), NTC_BETA_i=int(cfg["NTC_BETA"]),
+           NTC_R0_i=int(cfg["NTC_R0"]), NTC_T0_i=int(round(cfg["NTC_T0_K"] * 100.0)),
+           **cfg)
+    with open(OUT_C, "w", encoding="utf-8", newline="\n") as f:
+        f.write(out)
+    print("wrote %s (%d entries)" % (os.path.relpath(OUT_C, ROOT), len(table)))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    ap.add_argument("--shift", type=int, default=None)
+    ap.add_argument("--check", action="store_true")
+    args = ap.parse_args()
+
+    shift = args.shift if args.shift is not None else read_default_shift()
+    if not 3 <= shift <= 7:
+        sys.exit("--shift must be in 3..7")
+
+    cfg = read_config()
+    if args.check:
+        check(shift, cfg)
+    else:
+        if shift != read_default_shift():
+            print("note: update NTC_LUT_SHIFT in Core/Inc/ntc_lut.h to %d" % shift)
+        write_c(shift, cfg)
+
+
+if __name__ == "__main__":
+    main()
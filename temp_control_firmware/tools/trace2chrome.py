@@ -0,0 +1,229 @@
+"""
+Convert a firmware event trace dump (Core/Inc/trace.h) to Chrome trace JSON.
+
+The dump is what the board sends after a "TRACE?" command, in either
+protocol: JSON text lines (M0) or binary packets (M1, decoded with
+pc_gui/binproto.py). The output opens in chrome://tracing or
+https://ui.perfetto.dev:
+
+  - one track per context: the main loop ("thread") and every interrupt
+    handler, so preemption shows as overlapping slices
+  - scheduler tasks (TRACE_C_TASK) and interrupt handlers (TRACE_C_ISR)
+    as slices, named from the Sched_AddTask() calls in Core/Src/main.c
+  - state changes (TRACE_C_EVENT) as instant events with their decoded
+    arguments
+
+Usage:
+  python tools/trace2chrome.py CAPTURE [-o trace.json]
+  python tools/trace2chrome.py --port /dev/ttyACM0 [--save CAPTURE] [-o trace.json]
+
+  CAPTURE      raw bytes received after "TRACE?", e.g. saved by a terminal
+  --port P     send "TRACE?" on serial port P (pyserial) and read the dump
+  --save FILE  also write the raw bytes read from --port
+  -o FILE      output file (default trace.json)
+
+Timestamps are unwrapped from the 32-bit tick counter with the difference
+to the previous record; the firmware's periodic sync records keep the gaps
+below half the counter range.
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(HERE)
+MAIN_C = os.path.join(ROOT, "Core", "Src", "main.c")
+
+sys.path.insert(0, os.path.join(ROOT, "pc_gui"))
+import binproto  # noqa: E402
+
+# trace_ev_t
+EV_SYNC, EV_UART_LINE, EV_SETPOINT, EV_ALARM = 0x01, 0x02, 0x03, 0x04
+EV_FAN, EV_ADC_TIMEOUT, EV_OVERTEMP, EV_PROFILE = 0x05, 0x06, 0x07, 0x08
+EV_TASK_BEGIN, EV_TASK_END = 0x40, 0x41
+EV_ISR_ENTER, EV_ISR_EXIT = 0x80, 0x81
+
+EVENT_NAMES = {
+    EV_SYNC: "sync",
+    EV_UART_LINE: "uart line",
+    EV_SETPOINT: "setpoint",
+    EV_ALARM: "alarm",
+    EV_FAN: "fan",
+    EV_ADC_TIMEOUT: "adc timeout",
+    EV_OVERTEMP: "overtemp trip",
+    EV_PROFILE: "profile segment",
+}
+
+# IRQn of the handlers in Core/Src/stm32f7xx_it.c
+IRQ_NAMES = {
+    12: "DMA1_Stream1 (UART RX)",
+    14: "DMA1_Stream3 (UART TX)",
+    18: "ADC",
+    39: "USART3",
+    55: "TIM7 (tick)",
+    56: "DMA2_Stream0 (ADC)",
+}
+
+
+def read_task_names():
+    try:
+        text = open(MAIN_C, encoding="utf-8").read()
+    except OSError:
+        return []
+    return re.findall(r'Sched_AddTask\("(\w+)"', text)
+
+
+def parse_capture(data):
+    """Return (header dict, list of (ts, id, ctx, arg)) from raw dump bytes."""
+    header, recs = None, []
+
+    if b'{"trace"' in data:
+        for line in data.decode("ascii", errors="ignore").splitlines():
+            line = line.strip()
+            if not line.startswith("{"):
+                continue
+            try:
+                obj = json.loads(line)
+            except ValueError:
+                continue
+            if "trace" in obj:
+                header, recs = obj, []
+            elif header is not None and "ev" in obj:
+                recs.append((obj["t"], obj["ev"], obj["ctx"], obj["arg"]))
+    else:
+        reader = binproto.FrameReader()
+        for pkt in reader.feed(data):
+            if pkt["type"] != binproto.TYPE_TRACE:
+                continue
+            if "trace" in pkt:
+                header, recs = pkt, []
+            elif header is not None:
+                recs.append((pkt["t"], pkt["ev"], pkt["ctx"], pkt["arg"]))
+
+    if header is None:
+        sys.exit("no trace dump found")
+    if len(recs) < header["trace"]:
+        print("warning: %d of %d records received" % (len(recs), header["trace"]),
+              file=sys.stderr)
+    return header, recs
+
+
+def read_port(port, baud, idle_s=1.0):
+    import serial
+    with serial.Serial(port, baud, timeout=0.1) as ser:
+        ser.reset_input_buffer()
+        ser.write(b"TRACE?\n")
+        data, last = bytearray(), time.time()
+        while time.time() - last < idle_s:
+            chunk = ser.read(4096)
+            if chunk:
+                data += chunk
+                last = time.time()
+    return bytes(data)
+
+
+def zarg(arg):
+    return arg >> 12, arg & 0x0FFF
+
+
+def event_args(ev, arg):
+    if ev == EV_SYNC:
+        return {"tick_s": arg}
+    if ev == EV_UART_LINE:
+        return {"command": chr(arg) if 32 <= arg < 127 else arg}
+    if ev == EV_SETPOINT:
+        zone, v = zarg(arg)
+        return {"zone": zone, "T_ref": v / 10.0}
+    if ev == EV_ALARM:
+        zone, v = zarg(arg)
+        return {"zone": zone, "state": "entry" if v else "exit"}
+    if ev == EV_FAN:
+        return {"on": bool(arg)}
+    if ev == EV_OVERTEMP:
+        return {"raw": arg}
+    if ev == EV_PROFILE:
+        zone, v = zarg(arg)
+        return {"zone": zone, "segment": v}
+    return {"arg": arg}
+
+
+def ctx_name(ctx):
+    if ctx == 0:
+        return "thread"
+    irq = ctx - 16
+    return "IRQ %d %s" % (irq, IRQ_NAMES.get(irq, "")) if irq >= 0 else "exception %d" % ctx
+
+
+def convert(header, recs, tasks):
+    hz = float(header["hz"]) or 1.0
+    out = [{"ph": "M", "pid": 0, "name": "process_name", "args": {"name": "STM32F746"}}]
+    for ctx in sorted({r[2] for r in recs}):
+        out.append({"ph": "M", "pid": 0, "tid": ctx, "name": "thread_name",
+                    "args": {"name": ctx_name(ctx)}})
+        out.append({"ph": "M", "pid": 0, "tid": ctx, "name": "thread_sort_index",
+                    "args": {"sort_index": ctx}})
+
+    t, prev = 0, None
+    depth = {}
+    for ts, ev, ctx, arg in recs:
+        if prev is not None:
+            d = (ts - prev) & 0xFFFFFFFF
+            t += d - (1 << 32) if d >= (1 << 31) else d
+        prev = ts
+        e = {"pid": 0, "tid": ctx, "ts": t * 1e6 / hz}
+
+        if ev in (EV_TASK_BEGIN, EV_ISR_ENTER):
+            name = (tasks[arg] if arg < len(tasks) else "task %d" % arg) \
+                if ev == EV_TASK_BEGIN else IRQ_NAMES.get(arg, "IRQ %d" % arg)
+            e.update(ph="B", name=name, cat="task" if ev == EV_TASK_BEGIN else "isr")
+            depth[ctx] = depth.get(ctx, 0) + 1
+        elif ev in (EV_TASK_END, EV_ISR_EXIT):
+            # The begin of a slice can have been overwritten in the ring.
+            if depth.get(ctx, 0) == 0:
+                continue
+            depth[ctx] -= 1
+            e.update(ph="E")
+        else:
+            e.update(ph="i", s="t", cat="event", name=EVENT_NAMES.get(ev, "event 0x%02x" % ev),
+                     args=event_args(ev, arg))
+        out.append(e)
+
+    return {"traceEvents": out, "displayTimeUnit": "ns",
+            "otherData": {"records": len(recs), "lost": header["lost"],
+                          "hz": header["hz"], "mask": header["mask"]}}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    ap.add_argument("capture", nargs="?")
+    ap.add_argument("--port")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--save")
+    ap.add_argument("-o", "--output", default="trace.json")
+    args = ap.parse_args()
+
+    if args.port:
+        data = read_port(args.port, args.baud)
+        if args.save:
+            with open(args.save, "wb") as f:
+                f.write(data)
+    elif args.capture:
+        with open(args.capture, "rb") as f:
+            data = f.read()
+    else:
+        ap.error("give a CAPTURE file or --port")
+
+    header, recs = parse_capture(data)
+    trace = convert(header, recs, read_task_names())
+    with open(args.output, "w", encoding="utf-8") as f:
+        json.dump(trace, f)
+    print("wrote %s: %d records, %d lost before the dump, %.0f Hz ticks"
+          % (args.output, len(recs), header["lost"], float(header["hz"])))
+
+
+if __name__ == "__main__":
+    main()